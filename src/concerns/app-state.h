@@ -168,7 +168,7 @@ struct WorldState
     // Starts at a large value and shrinks as camera approaches surfaces
     float maxCameraStep = 1.0f;
 
-    // Minimum surface distance from last frame (read back from GPU)
+    // Minimum surface distance from the most recent completed frame (read back from GPU)
     // Used to calculate maxCameraStep for terrain collision avoidance
     float minSurfaceDistance = 1000.0f;
 
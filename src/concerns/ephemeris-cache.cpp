@@ -0,0 +1,601 @@
+#include "ephemeris-cache.h"
+#include "ephemeris-table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace EphemerisCache
+{
+
+// ==================================
+// Module State
+// ==================================
+
+// Fitted segments for one body, most recently used first
+struct BodyCache
+{
+    int naifId = 0;
+    std::vector<Segment> segments;
+};
+
+// Bodies are stored densely; the map is only consulted to resolve a NAIF ID to its slot
+static std::vector<BodyCache> g_bodies;
+static std::unordered_map<int, size_t> g_bodySlots;
+
+static constexpr double PI_D = 3.14159265358979323846;
+static constexpr double TWO_PI_D = 2.0 * PI_D;
+static constexpr double KM_PER_AU = 149597870.7;
+static constexpr double SECONDS_PER_DAY = 86400.0;
+static constexpr double ARCSEC_PER_RADIAN = 206264.80624709636;
+
+// Time offset used to estimate the rotation rate of a body (days)
+// Small enough that even Jupiter (~0.41 day period) turns less than 10 degrees
+static constexpr double ROTATION_RATE_PROBE_DAYS = 0.01;
+
+// ==================================
+// Chebyshev Helpers
+// ==================================
+
+// Chebyshev node k in [-1, 1] (nodes are returned in descending order)
+static double chebyshevNode(int k)
+{
+    return std::cos(PI_D * (static_cast<double>(k) + 0.5) / CHEBYSHEV_COEFFS);
+}
+
+// Compute coefficients from samples taken at chebyshevNode(0..N-1)
+static void chebyshevFit(const double *samples, double *coeffs)
+{
+    for (int j = 0; j < CHEBYSHEV_COEFFS; j++)
+    {
+        double sum = 0.0;
+        for (int k = 0; k < CHEBYSHEV_COEFFS; k++)
+        {
+            sum += samples[k] * std::cos(PI_D * j * (static_cast<double>(k) + 0.5) / CHEBYSHEV_COEFFS);
+        }
+        coeffs[j] = sum * 2.0 / CHEBYSHEV_COEFFS;
+    }
+    coeffs[0] *= 0.5;
+}
+
+// Chebyshev basis T_0(x)..T_{N-1}(x)
+// Computed once per sample and shared by every fitted component of a segment
+static void chebyshevBasis(double x, double *basis)
+{
+    basis[0] = 1.0;
+    basis[1] = x;
+    double twoX = 2.0 * x;
+    for (int k = 2; k < CHEBYSHEV_COEFFS; k++)
+    {
+        basis[k] = twoX * basis[k - 1] - basis[k - 2];
+    }
+}
+
+// sum(c[k] * T_k(x)) for a precomputed basis
+static double chebyshevDot(const double *coeffs, const double *basis)
+{
+    double sum = 0.0;
+    for (int k = 0; k < CHEBYSHEV_COEFFS; k++)
+    {
+        sum += coeffs[k] * basis[k];
+    }
+    return sum;
+}
+
+// ==================================
+// Body Frame Helpers
+// ==================================
+
+// Ascending node of the body equator on the J2000 XY plane
+// Used as the zero reference for the prime meridian angle
+static glm::dvec3 equatorNode(const glm::dvec3 &pole)
+{
+    glm::dvec3 node = glm::cross(glm::dvec3(0.0, 0.0, 1.0), pole);
+    double len = glm::length(node);
+    if (len < 1e-9)
+    {
+        return glm::dvec3(1.0, 0.0, 0.0);
+    }
+    return node / len;
+}
+
+// Prime meridian angle W measured from the equator node around the pole
+static double rotationAngle(const glm::dvec3 &pole, const glm::dvec3 &primeMeridian)
+{
+    glm::dvec3 node = equatorNode(pole);
+    glm::dvec3 quadrature = glm::cross(pole, node);
+    return std::atan2(glm::dot(primeMeridian, quadrature), glm::dot(primeMeridian, node));
+}
+
+// Wrap an angle difference into (-pi, pi]
+static double wrapAngle(double angle)
+{
+    return angle - TWO_PI_D * std::round(angle / TWO_PI_D);
+}
+
+// ==================================
+// Segment Fitting
+// ==================================
+
+double getSegmentSpanDays(int naifId)
+{
+    // Barycenters and the Sun move slowly relative to the SSB
+    if (naifId >= SpiceEphemeris::NAIF_SSB && naifId <= SpiceEphemeris::NAIF_SUN)
+    {
+        return 8.0;
+    }
+    // Planet centers wobble around their barycenter with the period of their moons
+    if (naifId % 100 == 99)
+    {
+        return 2.0;
+    }
+    // Moons (Io orbits in ~1.77 days)
+    return 1.0;
+}
+
+bool fitSegment(int naifId, double startJD, double spanDays, Segment &segment)
+{
+    segment = Segment{};
+    segment.startJD = startJD;
+    segment.spanDays = spanDays;
+
+    double posSamples[3][CHEBYSHEV_COEFFS];
+    double velSamples[3][CHEBYSHEV_COEFFS];
+    double poleSamples[3][CHEBYSHEV_COEFFS];
+    double rotationSamples[CHEBYSHEV_COEFFS];
+
+    // Estimate rotation rate at the segment midpoint so sampled angles can be unwrapped
+    // (node spacing can exceed half a rotation for fast rotators)
+    double midJD = startJD + 0.5 * spanDays;
+    double midRotation = 0.0;
+    double rotationRate = 0.0;
+    glm::dvec3 pole, primeMeridian;
+    bool frameAvailable = SpiceEphemeris::getBodyFrame(naifId, midJD, pole, primeMeridian);
+    if (frameAvailable)
+    {
+        midRotation = rotationAngle(pole, primeMeridian);
+        frameAvailable =
+            SpiceEphemeris::getBodyFrame(naifId, midJD + ROTATION_RATE_PROBE_DAYS, pole, primeMeridian);
+        if (frameAvailable)
+        {
+            rotationRate = wrapAngle(rotationAngle(pole, primeMeridian) - midRotation) / ROTATION_RATE_PROBE_DAYS;
+        }
+    }
+
+    bool stateAvailable = true;
+    for (int k = 0; k < CHEBYSHEV_COEFFS; k++)
+    {
+        double jd = startJD + 0.5 * (chebyshevNode(k) + 1.0) * spanDays;
+
+        if (stateAvailable)
+        {
+            glm::dvec3 position, velocity;
+            stateAvailable = SpiceEphemeris::getBodyState(naifId, jd, position, velocity);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                posSamples[axis][k] = position[axis];
+                velSamples[axis][k] = velocity[axis];
+            }
+        }
+
+        if (frameAvailable)
+        {
+            frameAvailable = SpiceEphemeris::getBodyFrame(naifId, jd, pole, primeMeridian);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                poleSamples[axis][k] = pole[axis];
+            }
+            double predicted = midRotation + rotationRate * (jd - midJD);
+            double measured = rotationAngle(pole, primeMeridian);
+            rotationSamples[k] = predicted + wrapAngle(measured - predicted);
+        }
+    }
+
+    if (stateAvailable)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            chebyshevFit(posSamples[axis], segment.position[axis]);
+            chebyshevFit(velSamples[axis], segment.velocity[axis]);
+        }
+        segment.hasState = true;
+    }
+
+    if (frameAvailable)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            chebyshevFit(poleSamples[axis], segment.pole[axis]);
+        }
+        chebyshevFit(rotationSamples, segment.rotation);
+        segment.hasFrame = true;
+    }
+
+    return segment.hasState || segment.hasFrame;
+}
+
+bool loadSegment(int naifId, double startJD, double spanDays, Segment &segment)
+{
+    // Table segments share the grid, so a hit is an exact match
+    const Segment *stored = EphemerisTable::findSegment(naifId, startJD + 0.5 * spanDays);
+    if (stored && stored->startJD == startJD && stored->spanDays == spanDays)
+    {
+        segment = *stored;
+        return segment.hasState || segment.hasFrame;
+    }
+    return fitSegment(naifId, startJD, spanDays, segment);
+}
+
+// ==================================
+// Segment Evaluation
+// ==================================
+
+static double normalizedTime(const Segment &segment, double jdTdb)
+{
+    return 2.0 * (jdTdb - segment.startJD) / segment.spanDays - 1.0;
+}
+
+void evaluateState(const Segment &segment, double jdTdb, glm::dvec3 &position, glm::dvec3 &velocity)
+{
+    double basis[CHEBYSHEV_COEFFS];
+    chebyshevBasis(normalizedTime(segment, jdTdb), basis);
+    for (int axis = 0; axis < 3; axis++)
+    {
+        position[axis] = chebyshevDot(segment.position[axis], basis);
+        velocity[axis] = chebyshevDot(segment.velocity[axis], basis);
+    }
+}
+
+void evaluateFrame(const Segment &segment, double jdTdb, glm::dvec3 &pole, glm::dvec3 &primeMeridian)
+{
+    double basis[CHEBYSHEV_COEFFS];
+    chebyshevBasis(normalizedTime(segment, jdTdb), basis);
+    for (int axis = 0; axis < 3; axis++)
+    {
+        pole[axis] = chebyshevDot(segment.pole[axis], basis);
+    }
+    pole = glm::normalize(pole);
+
+    double w = chebyshevDot(segment.rotation, basis);
+    glm::dvec3 node = equatorNode(pole);
+    glm::dvec3 quadrature = glm::cross(pole, node);
+    primeMeridian = node * std::cos(w) + quadrature * std::sin(w);
+}
+
+// ==================================
+// Sliding Window Lookup
+// ==================================
+
+// Resolve a NAIF ID to its slot in g_bodies, creating one on first use
+static size_t bodySlot(int naifId)
+{
+    auto it = g_bodySlots.find(naifId);
+    if (it != g_bodySlots.end())
+    {
+        return it->second;
+    }
+
+    size_t slot = g_bodies.size();
+    g_bodies.emplace_back();
+    g_bodies.back().naifId = naifId;
+    g_bodySlots[naifId] = slot;
+    return slot;
+}
+
+// Find the segment covering jdTdb, fitting a new one if needed
+// Segments are aligned to multiples of the body's span so scrubbing back and forth reuses them
+static const Segment &findSegment(size_t slot, double jdTdb)
+{
+    const int naifId = g_bodies[slot].naifId;
+
+    // Precomputed segments are served straight from the mapped table
+    if (const Segment *stored = EphemerisTable::findSegment(naifId, jdTdb))
+    {
+        return *stored;
+    }
+
+    auto &segments = g_bodies[slot].segments;
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        if (segments[i].contains(jdTdb))
+        {
+            if (i != 0)
+            {
+                std::rotate(segments.begin(), segments.begin() + static_cast<std::ptrdiff_t>(i),
+                            segments.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            }
+            return segments.front();
+        }
+    }
+
+    double spanDays = getSegmentSpanDays(naifId);
+    double startJD = std::floor(jdTdb / spanDays) * spanDays;
+
+    // Failed fits are cached too, so an uncovered body doesn't refit every frame
+    Segment segment;
+    fitSegment(naifId, startJD, spanDays, segment);
+
+    if (segments.size() >= MAX_SEGMENTS_PER_BODY)
+    {
+        segments.pop_back();
+    }
+    segments.insert(segments.begin(), segment);
+    return segments.front();
+}
+
+// ==================================
+// Cached Queries
+// ==================================
+
+bool getBodyState(int naifId, double jdTdb, glm::dvec3 &position, glm::dvec3 &velocity)
+{
+    if (!SpiceEphemeris::isInitialized())
+    {
+        position = glm::dvec3(0.0);
+        velocity = glm::dvec3(0.0);
+        return false;
+    }
+
+    const Segment &segment = findSegment(bodySlot(naifId), jdTdb);
+    if (!segment.hasState)
+    {
+        return SpiceEphemeris::getBodyState(naifId, jdTdb, position, velocity);
+    }
+
+    evaluateState(segment, jdTdb, position, velocity);
+    return true;
+}
+
+glm::dvec3 getBodyPosition(int naifId, double jdTdb)
+{
+    glm::dvec3 pos, vel;
+    if (getBodyState(naifId, jdTdb, pos, vel))
+    {
+        return pos;
+    }
+    return glm::dvec3(0.0);
+}
+
+bool getBodyFrame(int naifId, double jdTdb, glm::dvec3 &pole, glm::dvec3 &primeMeridian)
+{
+    if (!SpiceEphemeris::isInitialized())
+    {
+        pole = glm::dvec3(0.0, 1.0, 0.0);
+        primeMeridian = glm::dvec3(1.0, 0.0, 0.0);
+        return false;
+    }
+
+    const Segment &segment = findSegment(bodySlot(naifId), jdTdb);
+    if (!segment.hasFrame)
+    {
+        return SpiceEphemeris::getBodyFrame(naifId, jdTdb, pole, primeMeridian);
+    }
+
+    evaluateFrame(segment, jdTdb, pole, primeMeridian);
+    return true;
+}
+
+size_t queryBatch(SpiceEphemeris::EphemerisBatch &batch)
+{
+    if (!SpiceEphemeris::isInitialized())
+    {
+        return SpiceEphemeris::queryBatch(batch);
+    }
+
+    batch.prepare();
+
+    const size_t bodyCount = batch.bodyCount();
+    size_t validStates = 0;
+
+    // Resolve slots up front so no lookups happen inside the sample loop
+    // (kept across calls to avoid a per-frame allocation; the cache is main-thread only)
+    static std::vector<size_t> slots;
+    slots.resize(bodyCount);
+    for (size_t b = 0; b < bodyCount; b++)
+    {
+        slots[b] = bodySlot(batch.naifIds[b]);
+    }
+
+    for (size_t e = 0; e < batch.epochs.size(); e++)
+    {
+        double jd = batch.epochs[e];
+
+        for (size_t b = 0; b < bodyCount; b++)
+        {
+            size_t i = batch.index(e, b);
+            const Segment &segment = findSegment(slots[b], jd);
+
+            glm::dvec3 position, velocity;
+            bool stateOk = true;
+            if (segment.hasState)
+            {
+                evaluateState(segment, jd, position, velocity);
+            }
+            else
+            {
+                stateOk = SpiceEphemeris::getBodyState(batch.naifIds[b], jd, position, velocity);
+            }
+            double positionArr[3] = {position.x, position.y, position.z};
+            double velocityArr[3] = {velocity.x, velocity.y, velocity.z};
+            batch.setState(i, positionArr, velocityArr);
+            batch.hasState[i] = stateOk ? 1 : 0;
+            validStates += stateOk ? 1 : 0;
+
+            glm::dvec3 pole, primeMeridian;
+            bool frameOk = true;
+            if (segment.hasFrame)
+            {
+                evaluateFrame(segment, jd, pole, primeMeridian);
+            }
+            else
+            {
+                frameOk = SpiceEphemeris::getBodyFrame(batch.naifIds[b], jd, pole, primeMeridian);
+            }
+            double poleArr[3] = {pole.x, pole.y, pole.z};
+            double primeMeridianArr[3] = {primeMeridian.x, primeMeridian.y, primeMeridian.z};
+            batch.setFrame(i, poleArr, primeMeridianArr);
+            batch.hasFrame[i] = frameOk ? 1 : 0;
+        }
+    }
+
+    return validStates;
+}
+
+void clear()
+{
+    g_bodies.clear();
+    g_bodySlots.clear();
+}
+
+// ==================================
+// Benchmark
+// ==================================
+
+// Angle between two unit vectors in arcseconds (stable for tiny angles)
+static double angleArcsec(const glm::dvec3 &a, const glm::dvec3 &b)
+{
+    double chord = glm::length(a - b);
+    return 2.0 * std::asin(std::min(1.0, 0.5 * chord)) * ARCSEC_PER_RADIAN;
+}
+
+void runBenchmark(double jdTdb, int frames, double stepDays)
+{
+    std::vector<SpiceEphemeris::BodyInfo> bodies = SpiceEphemeris::getAvailableBodies();
+    if (bodies.empty() || frames <= 0)
+    {
+        return;
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    const size_t bodyCount = bodies.size();
+    const size_t sampleCount = bodyCount * static_cast<size_t>(frames);
+
+    std::vector<glm::dvec3> refPosition(sampleCount), refVelocity(sampleCount);
+    std::vector<glm::dvec3> refPole(sampleCount), refMeridian(sampleCount);
+    std::vector<bool> refHasState(sampleCount), refHasFrame(sampleCount);
+
+    // Direct SPICE queries (what UpdateCelestialObjectPositions used to do every frame)
+    auto directStart = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        double jd = jdTdb + f * stepDays;
+        for (size_t b = 0; b < bodyCount; b++)
+        {
+            size_t i = static_cast<size_t>(f) * bodyCount + b;
+            refHasState[i] = SpiceEphemeris::getBodyState(bodies[b].naifId, jd, refPosition[i], refVelocity[i]);
+            refHasFrame[i] = SpiceEphemeris::getBodyFrame(bodies[b].naifId, jd, refPole[i], refMeridian[i]);
+        }
+    }
+    auto directEnd = Clock::now();
+
+    // Cached queries - first pass includes fitting, second pass is steady state
+    double sink = 0.0;
+    double coldSeconds = 0.0;
+    double warmSeconds = 0.0;
+    double maxPositionKm = 0.0;
+    double maxVelocityMmS = 0.0;
+    double maxPoleArcsec = 0.0;
+    double maxMeridianArcsec = 0.0;
+
+    clear();
+    for (int pass = 0; pass < 2; pass++)
+    {
+        auto passStart = Clock::now();
+        for (int f = 0; f < frames; f++)
+        {
+            double jd = jdTdb + f * stepDays;
+            for (size_t b = 0; b < bodyCount; b++)
+            {
+                glm::dvec3 position, velocity, pole, meridian;
+                getBodyState(bodies[b].naifId, jd, position, velocity);
+                getBodyFrame(bodies[b].naifId, jd, pole, meridian);
+                sink += position.x + pole.z + meridian.x;
+            }
+        }
+        auto passEnd = Clock::now();
+        double seconds = std::chrono::duration<double>(passEnd - passStart).count();
+        if (pass == 0)
+        {
+            coldSeconds = seconds;
+        }
+        else
+        {
+            warmSeconds = seconds;
+        }
+    }
+
+    // Batch query over the same frames (segments are already fitted)
+    SpiceEphemeris::EphemerisBatch batch;
+    for (const auto &body : bodies)
+    {
+        batch.naifIds.push_back(body.naifId);
+    }
+    batch.epochs.resize(1);
+    auto batchStart = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        batch.epochs[0] = jdTdb + f * stepDays;
+        EphemerisCache::queryBatch(batch);
+        sink += batch.positionX[0] + batch.poleZ[0];
+    }
+    auto batchEnd = Clock::now();
+    double batchSeconds = std::chrono::duration<double>(batchEnd - batchStart).count();
+
+    // Accuracy against the direct SPICE results (not timed)
+    for (int f = 0; f < frames; f++)
+    {
+        double jd = jdTdb + f * stepDays;
+        for (size_t b = 0; b < bodyCount; b++)
+        {
+            size_t i = static_cast<size_t>(f) * bodyCount + b;
+            glm::dvec3 position, velocity, pole, meridian;
+            if (refHasState[i] && getBodyState(bodies[b].naifId, jd, position, velocity))
+            {
+                maxPositionKm = std::max(maxPositionKm, glm::length(position - refPosition[i]) * KM_PER_AU);
+                maxVelocityMmS = std::max(maxVelocityMmS, glm::length(velocity - refVelocity[i]) * KM_PER_AU /
+                                                              SECONDS_PER_DAY * 1.0e6);
+            }
+            if (refHasFrame[i] && getBodyFrame(bodies[b].naifId, jd, pole, meridian))
+            {
+                maxPoleArcsec = std::max(maxPoleArcsec, angleArcsec(pole, refPole[i]));
+                maxMeridianArcsec = std::max(maxMeridianArcsec, angleArcsec(meridian, refMeridian[i]));
+            }
+        }
+    }
+
+    double directSeconds = std::chrono::duration<double>(directEnd - directStart).count();
+    double queries = static_cast<double>(sampleCount);
+
+    std::cout << "\n=== EPHEMERIS CACHE BENCHMARK ===\n";
+    std::cout << "Bodies: " << bodyCount << ", frames: " << frames << ", step: " << stepDays << " days\n";
+    std::cout << "Direct SPICE:      " << directSeconds / frames * 1.0e6 << " us/frame ("
+              << directSeconds / queries * 1.0e9 << " ns/body)\n";
+    std::cout << "Cache (with fits): " << coldSeconds / frames * 1.0e6 << " us/frame ("
+              << coldSeconds / queries * 1.0e9 << " ns/body)\n";
+    std::cout << "Cache (warm):      " << warmSeconds / frames * 1.0e6 << " us/frame ("
+              << warmSeconds / queries * 1.0e9 << " ns/body)\n";
+    std::cout << "Cache (batch):     " << batchSeconds / frames * 1.0e6 << " us/frame ("
+              << batchSeconds / queries * 1.0e9 << " ns/body)\n";
+    if (warmSeconds > 0.0 && batchSeconds > 0.0)
+    {
+        std::cout << "Speedup (warm):    " << directSeconds / warmSeconds << "x, batch: "
+                  << directSeconds / batchSeconds << "x\n";
+    }
+    std::cout << "Max position error:       " << maxPositionKm << " km\n";
+    std::cout << "Max velocity error:       " << maxVelocityMmS << " mm/s\n";
+    std::cout << "Max pole error:           " << maxPoleArcsec << " arcsec\n";
+    std::cout << "Max prime meridian error: " << maxMeridianArcsec << " arcsec\n";
+    std::cout << "=================================\n\n";
+
+    // Keep the timed loops from being optimized away
+    if (std::isnan(sink))
+    {
+        std::cout << "EphemerisCache: benchmark produced NaN values\n";
+    }
+}
+
+} // namespace EphemerisCache
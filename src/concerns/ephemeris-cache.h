@@ -0,0 +1,92 @@
+#pragma once
+
+#include "spice-ephemeris.h"
+
+#include <glm/glm.hpp>
+
+// ==================================
+// Ephemeris Cache Module
+// ==================================
+// Chebyshev-interpolated cache in front of SpiceEphemeris
+// Each body gets short polynomial segments fitted to SPICE samples over a sliding
+// time window. Positions, velocities and body frames are then served by polynomial
+// evaluation instead of spkezr_c/pxform_c calls every frame.
+// All positions are in AU relative to the SSB, velocities in AU/day, J2000 frame.
+
+namespace EphemerisCache
+{
+
+// Number of Chebyshev coefficients per fitted quantity (polynomial degree + 1)
+constexpr int CHEBYSHEV_COEFFS = 13;
+
+// Maximum number of segments kept per body (sliding window around the current epoch)
+constexpr int MAX_SEGMENTS_PER_BODY = 4;
+
+// ==================================
+// Segment Data
+// ==================================
+
+// One fitted time span for a single body
+// Coefficients use the convention f(x) = sum(c[k] * T_k(x)) with x in [-1, 1]
+struct Segment
+{
+    double startJD = 0.0;  // Segment start (TDB Julian Date)
+    double spanDays = 0.0; // Segment length in days
+
+    bool hasState = false; // Position/velocity coefficients are valid
+    bool hasFrame = false; // Pole/rotation coefficients are valid
+
+    double position[3][CHEBYSHEV_COEFFS] = {}; // Position in AU
+    double velocity[3][CHEBYSHEV_COEFFS] = {}; // Velocity in AU/day
+    double pole[3][CHEBYSHEV_COEFFS] = {};     // North pole direction (renormalized on evaluation)
+    double rotation[CHEBYSHEV_COEFFS] = {};    // Unwrapped prime meridian angle W in radians
+
+    bool contains(double jdTdb) const
+    {
+        return jdTdb >= startJD && jdTdb <= startJD + spanDays;
+    }
+};
+
+// Segment length used for a body (short for fast moons, long for barycenters)
+double getSegmentSpanDays(int naifId);
+
+// Fit a segment for a body starting at startJD by sampling SpiceEphemeris at Chebyshev nodes
+// Returns false if neither state nor frame data could be sampled
+bool fitSegment(int naifId, double startJD, double spanDays, Segment &segment);
+
+// Same as fitSegment, but copies the segment from the precomputed EphemerisTable when it has one
+bool loadSegment(int naifId, double startJD, double spanDays, Segment &segment);
+
+// Evaluate a fitted segment (caller guarantees segment.contains(jdTdb))
+void evaluateState(const Segment &segment, double jdTdb, glm::dvec3 &position, glm::dvec3 &velocity);
+void evaluateFrame(const Segment &segment, double jdTdb, glm::dvec3 &pole, glm::dvec3 &primeMeridian);
+
+// ==================================
+// Cached Queries
+// ==================================
+// Drop-in replacements for the SpiceEphemeris per-body queries
+// Segments are fitted lazily on first use; falls back to direct SPICE calls
+// when a segment could not be fitted (e.g. at the edge of kernel coverage)
+
+glm::dvec3 getBodyPosition(int naifId, double jdTdb);
+bool getBodyState(int naifId, double jdTdb, glm::dvec3 &position, glm::dvec3 &velocity);
+bool getBodyFrame(int naifId, double jdTdb, glm::dvec3 &pole, glm::dvec3 &primeMeridian);
+
+// Fill a structure-of-arrays batch from cached segments
+// Each body is resolved once per call, so multi-epoch batches (trails, time scrubbing)
+// cost one polynomial evaluation per sample. Returns the number of samples with a valid state
+size_t queryBatch(SpiceEphemeris::EphemerisBatch &batch);
+
+// Drop all fitted segments (call before SpiceEphemeris::cleanup)
+void clear();
+
+// ==================================
+// Benchmark
+// ==================================
+
+// Compare direct SPICE queries against cached queries for all available bodies
+// Simulates `frames` consecutive frames starting at jdTdb, advancing stepDays per frame,
+// and prints per-body timings plus the maximum position/velocity/frame errors
+void runBenchmark(double jdTdb, int frames, double stepDays);
+
+} // namespace EphemerisCache
@@ -0,0 +1,369 @@
+#include "ephemeris-prefetch.h"
+#include "ephemeris-cache.h"
+#include "helpers/triple-buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace EphemerisPrefetch
+{
+
+using EphemerisCache::Segment;
+
+// ==================================
+// Snapshot Data
+// ==================================
+
+// Published segments for one body; segments[i] covers grid index firstIndex + i
+// Grid index = floor(jd / spanDays), matching EphemerisCache's segment alignment
+struct BodyTrack
+{
+    int naifId = 0;
+    double spanDays = 1.0;
+    int64_t firstIndex = 0;
+    std::vector<Segment> segments;
+};
+
+// Everything the render loop needs, handed over as one value
+struct Snapshot
+{
+    std::vector<BodyTrack> bodies;
+};
+
+// Worker-side fitted segments for one body (contiguous grid indices)
+struct WorkerTrack
+{
+    int naifId = 0;
+    double spanDays = 1.0;
+    int64_t firstIndex = 0;
+    std::deque<Segment> segments;
+
+    int64_t lastIndex() const
+    {
+        return firstIndex + static_cast<int64_t>(segments.size()) - 1;
+    }
+};
+
+// ==================================
+// Module State
+// ==================================
+
+// Segments fitted per body in one worker pass before a snapshot is published
+static constexpr int FITS_PER_PASS = 4;
+
+// How long the worker sleeps when its window is already fully fitted
+static constexpr auto IDLE_WAIT = std::chrono::milliseconds(5);
+
+static TripleBuffer<Snapshot> g_snapshots;
+static std::vector<WorkerTrack> g_tracks; // Owned by the worker thread while running
+
+static std::thread g_worker;
+static std::atomic<bool> g_running{false};
+static std::atomic<bool> g_stopRequested{false};
+static std::atomic<double> g_clockJD{0.0};
+static std::atomic<double> g_clockRate{0.0};
+
+// Only used to wake the worker early; published data never goes through this lock
+static std::mutex g_wakeMutex;
+static std::condition_variable g_wake;
+
+// ==================================
+// Worker
+// ==================================
+
+static int64_t gridIndex(double jdTdb, double spanDays)
+{
+    return static_cast<int64_t>(std::floor(jdTdb / spanDays));
+}
+
+static Segment fitGridSegment(const WorkerTrack &track, int64_t index)
+{
+    Segment segment;
+    EphemerisCache::loadSegment(track.naifId, static_cast<double>(index) * track.spanDays, track.spanDays, segment);
+    return segment;
+}
+
+// Move a body's fitted window toward [clock - 1 segment, clock + lookahead] in the direction of time
+// Returns true if any segment was fitted or dropped
+static bool updateTrack(WorkerTrack &track, double jdTdb, double daysPerSecond, int fitBudget)
+{
+    const bool forward = daysPerSecond >= 0.0;
+    const double lookaheadDays = std::abs(daysPerSecond) * LOOKAHEAD_SECONDS;
+    const int64_t clockIndex = gridIndex(jdTdb, track.spanDays);
+
+    int64_t lo, hi;
+    if (forward)
+    {
+        lo = clockIndex - 1;
+        hi = std::max(clockIndex + 1, gridIndex(jdTdb + lookaheadDays, track.spanDays));
+        hi = std::min(hi, lo + MAX_SEGMENTS_PER_BODY - 1);
+    }
+    else
+    {
+        hi = clockIndex + 1;
+        lo = std::min(clockIndex - 1, gridIndex(jdTdb - lookaheadDays, track.spanDays));
+        lo = std::max(lo, hi - MAX_SEGMENTS_PER_BODY + 1);
+    }
+
+    bool changed = false;
+
+    // Window moved past everything we have (large jump) - start over at the clock
+    if (!track.segments.empty() && (track.lastIndex() < lo || track.firstIndex > hi))
+    {
+        track.segments.clear();
+        changed = true;
+    }
+
+    // Drop segments that fell out of the window
+    while (!track.segments.empty() && track.firstIndex < lo)
+    {
+        track.segments.pop_front();
+        track.firstIndex++;
+        changed = true;
+    }
+    while (!track.segments.empty() && track.lastIndex() > hi)
+    {
+        track.segments.pop_back();
+        changed = true;
+    }
+
+    // The segment under the clock always comes first
+    if (track.segments.empty() && fitBudget > 0)
+    {
+        track.firstIndex = clockIndex;
+        track.segments.push_back(fitGridSegment(track, clockIndex));
+        fitBudget--;
+        changed = true;
+    }
+
+    // Extend toward the direction of travel first, then behind the clock
+    while (fitBudget > 0 && !track.segments.empty())
+    {
+        bool canExtendBack = track.lastIndex() < hi;
+        bool canExtendFront = track.firstIndex > lo;
+        if (!canExtendBack && !canExtendFront)
+        {
+            break;
+        }
+
+        if ((forward && canExtendBack) || !canExtendFront)
+        {
+            track.segments.push_back(fitGridSegment(track, track.lastIndex() + 1));
+        }
+        else
+        {
+            track.firstIndex--;
+            track.segments.push_front(fitGridSegment(track, track.firstIndex));
+        }
+        fitBudget--;
+        changed = true;
+    }
+
+    return changed;
+}
+
+static void publishSnapshot()
+{
+    Snapshot &snapshot = g_snapshots.writeBuffer();
+    snapshot.bodies.resize(g_tracks.size());
+    for (size_t i = 0; i < g_tracks.size(); i++)
+    {
+        BodyTrack &body = snapshot.bodies[i];
+        body.naifId = g_tracks[i].naifId;
+        body.spanDays = g_tracks[i].spanDays;
+        body.firstIndex = g_tracks[i].firstIndex;
+        body.segments.assign(g_tracks[i].segments.begin(), g_tracks[i].segments.end());
+    }
+    g_snapshots.publish();
+}
+
+static void workerLoop()
+{
+    while (!g_stopRequested.load(std::memory_order_relaxed))
+    {
+        double jd = g_clockJD.load(std::memory_order_relaxed);
+        double rate = g_clockRate.load(std::memory_order_relaxed);
+
+        bool changed = false;
+        for (auto &track : g_tracks)
+        {
+            changed |= updateTrack(track, jd, rate, FITS_PER_PASS);
+        }
+
+        if (changed)
+        {
+            publishSnapshot();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(g_wakeMutex);
+        g_wake.wait_for(lock, IDLE_WAIT);
+    }
+}
+
+// ==================================
+// Control
+// ==================================
+
+void start(const std::vector<int> &naifIds, double jdTdb, double daysPerSecond)
+{
+    stop();
+
+    g_tracks.clear();
+    for (int naifId : naifIds)
+    {
+        WorkerTrack track;
+        track.naifId = naifId;
+        track.spanDays = EphemerisCache::getSegmentSpanDays(naifId);
+        g_tracks.push_back(std::move(track));
+    }
+
+    setClock(jdTdb, daysPerSecond);
+
+    // First window is fitted on the calling thread so the render loop has data on frame one
+    for (auto &track : g_tracks)
+    {
+        updateTrack(track, jdTdb, daysPerSecond, 2);
+    }
+    publishSnapshot();
+
+    g_stopRequested = false;
+    g_running = true;
+    g_worker = std::thread(workerLoop);
+
+    std::cout << "EphemerisPrefetch: Worker started for " << g_tracks.size() << " bodies\n";
+}
+
+void stop()
+{
+    if (!g_running)
+    {
+        return;
+    }
+
+    g_stopRequested = true;
+    g_wake.notify_one();
+    if (g_worker.joinable())
+    {
+        g_worker.join();
+    }
+    g_running = false;
+}
+
+bool isRunning()
+{
+    return g_running;
+}
+
+void setClock(double jdTdb, double daysPerSecond)
+{
+    g_clockJD.store(jdTdb, std::memory_order_relaxed);
+    g_clockRate.store(daysPerSecond, std::memory_order_relaxed);
+}
+
+// ==================================
+// Queries (render thread)
+// ==================================
+
+size_t queryBatch(SpiceEphemeris::EphemerisBatch &batch)
+{
+    if (!g_running)
+    {
+        return EphemerisCache::queryBatch(batch);
+    }
+
+    static const double ZERO[3] = {0.0, 0.0, 0.0};
+    static const double DEFAULT_POLE[3] = {0.0, 1.0, 0.0};
+    static const double DEFAULT_PRIME_MERIDIAN[3] = {1.0, 0.0, 0.0};
+
+    batch.prepare();
+    const Snapshot &snapshot = g_snapshots.readBuffer();
+    const size_t bodyCount = batch.bodyCount();
+
+    // Match batch bodies to published tracks once per call
+    static std::vector<const BodyTrack *> tracks;
+    tracks.assign(bodyCount, nullptr);
+    for (size_t b = 0; b < bodyCount; b++)
+    {
+        for (const auto &body : snapshot.bodies)
+        {
+            if (body.naifId == batch.naifIds[b])
+            {
+                tracks[b] = &body;
+                break;
+            }
+        }
+    }
+
+    size_t validStates = 0;
+    bool missed = false;
+
+    for (size_t e = 0; e < batch.epochs.size(); e++)
+    {
+        double jd = batch.epochs[e];
+
+        for (size_t b = 0; b < bodyCount; b++)
+        {
+            size_t i = batch.index(e, b);
+            const Segment *segment = nullptr;
+
+            if (tracks[b])
+            {
+                int64_t offset = gridIndex(jd, tracks[b]->spanDays) - tracks[b]->firstIndex;
+                if (offset >= 0 && offset < static_cast<int64_t>(tracks[b]->segments.size()))
+                {
+                    segment = &tracks[b]->segments[static_cast<size_t>(offset)];
+                }
+            }
+            missed |= (segment == nullptr);
+
+            if (segment && segment->hasState)
+            {
+                glm::dvec3 position, velocity;
+                EphemerisCache::evaluateState(*segment, jd, position, velocity);
+                double positionArr[3] = {position.x, position.y, position.z};
+                double velocityArr[3] = {velocity.x, velocity.y, velocity.z};
+                batch.setState(i, positionArr, velocityArr);
+                batch.hasState[i] = 1;
+                validStates++;
+            }
+            else
+            {
+                batch.setState(i, ZERO, ZERO);
+                batch.hasState[i] = 0;
+            }
+
+            if (segment && segment->hasFrame)
+            {
+                glm::dvec3 pole, primeMeridian;
+                EphemerisCache::evaluateFrame(*segment, jd, pole, primeMeridian);
+                double poleArr[3] = {pole.x, pole.y, pole.z};
+                double primeMeridianArr[3] = {primeMeridian.x, primeMeridian.y, primeMeridian.z};
+                batch.setFrame(i, poleArr, primeMeridianArr);
+                batch.hasFrame[i] = 1;
+            }
+            else
+            {
+                batch.setFrame(i, DEFAULT_POLE, DEFAULT_PRIME_MERIDIAN);
+                batch.hasFrame[i] = 0;
+            }
+        }
+    }
+
+    // The clock outran the prefetched span (or jumped) - don't wait for the idle timeout
+    if (missed)
+    {
+        g_wake.notify_one();
+    }
+
+    return validStates;
+}
+
+} // namespace EphemerisPrefetch
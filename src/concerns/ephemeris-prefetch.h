@@ -0,0 +1,48 @@
+#pragma once
+
+#include "spice-ephemeris.h"
+
+#include <vector>
+
+// ==================================
+// Ephemeris Prefetch Module
+// ==================================
+// Background worker that fits Chebyshev segments (see ephemeris-cache.h) ahead of the
+// simulation clock, in the direction and at the rate of time dilation, and publishes them
+// through a lock-free triple buffer. The render loop evaluates the latest published
+// segments without ever touching CSPICE.
+//
+// CSPICE is not thread-safe: while the worker is running it owns ALL SPICE calls.
+// Main-thread code must not call SpiceEphemeris or the scalar EphemerisCache queries
+// between start() and stop().
+
+namespace EphemerisPrefetch
+{
+
+// Simulated time fetched ahead of the clock, in real seconds at the current time dilation
+constexpr double LOOKAHEAD_SECONDS = 1.0;
+
+// Maximum number of segments kept per body (bounds worker memory and fitting work
+// at extreme time dilation; the clock may then briefly outrun the prefetched span)
+constexpr int MAX_SEGMENTS_PER_BODY = 32;
+
+// Start the worker for a list of bodies
+// The first snapshot around jdTdb is fitted synchronously so queries succeed immediately
+void start(const std::vector<int> &naifIds, double jdTdb, double daysPerSecond);
+
+// Stop and join the worker (SPICE may be used from the main thread again afterwards)
+void stop();
+
+bool isRunning();
+
+// Tell the worker where the simulation clock is and how fast it moves
+// daysPerSecond is signed (negative runs time backwards); pass 0 when paused
+void setClock(double jdTdb, double daysPerSecond);
+
+// Fill a batch from the latest published segments
+// Samples outside the prefetched span get hasState = hasFrame = 0 and wake the worker
+// When the worker is not running, forwards to EphemerisCache::queryBatch
+// Returns the number of samples with a valid state
+size_t queryBatch(SpiceEphemeris::EphemerisBatch &batch);
+
+} // namespace EphemerisPrefetch
@@ -0,0 +1,357 @@
+#include "ephemeris-table.h"
+#include "helpers/mapped-file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace EphemerisTable
+{
+
+using EphemerisCache::Segment;
+
+static_assert(std::is_trivially_copyable<Segment>::value, "Segments are written to and mapped from disk as raw bytes");
+static_assert(alignof(Segment) <= SEGMENT_ALIGNMENT, "Segment offsets must satisfy Segment alignment");
+
+// ==================================
+// Module State
+// ==================================
+static MappedFile g_file;
+static const TableHeader *g_header = nullptr;
+static const BodyRecord *g_bodies = nullptr;
+
+// ==================================
+// Helpers
+// ==================================
+
+// FNV-1a 64-bit
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static int64_t gridIndex(double jdTdb, double spanDays)
+{
+    return static_cast<int64_t>(std::floor(jdTdb / spanDays));
+}
+
+uint64_t kernelFingerprint(const std::string &kernelDir)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    if (!fs::exists(kernelDir) || !fs::is_directory(kernelDir))
+    {
+        return hash;
+    }
+
+    // Sort so directory iteration order doesn't change the hash
+    std::vector<fs::path> files;
+    for (const auto &entry : fs::directory_iterator(kernelDir))
+    {
+        if (entry.is_regular_file())
+        {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto &file : files)
+    {
+        std::string name = file.filename().string();
+        uint64_t size = static_cast<uint64_t>(fs::file_size(file));
+        int64_t time = static_cast<int64_t>(fs::last_write_time(file).time_since_epoch().count());
+        hash = hashBytes(hash, name.data(), name.size());
+        hash = hashBytes(hash, &size, sizeof(size));
+        hash = hashBytes(hash, &time, sizeof(time));
+    }
+    return hash;
+}
+
+double currentJulianDate()
+{
+    // Unix epoch (1970-01-01T00:00:00 UTC) is JD 2440587.5
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    double seconds = std::chrono::duration<double>(now).count();
+    return 2440587.5 + seconds / 86400.0;
+}
+
+// ==================================
+// Build
+// ==================================
+
+bool build(const std::string &path, const std::string &kernelDir, double startJD, double endJD)
+{
+    if (!SpiceEphemeris::isInitialized())
+    {
+        std::cerr << "EphemerisTable: SPICE must be initialized to build the table\n";
+        return false;
+    }
+
+    // Never fit beyond what the kernels cover
+    startJD = std::max(startJD, SpiceEphemeris::getEarliestAvailableTime());
+    endJD = std::min(endJD, SpiceEphemeris::getLatestAvailableTime());
+    if (startJD >= endJD)
+    {
+        std::cerr << "EphemerisTable: Requested span is outside kernel coverage\n";
+        return false;
+    }
+
+    std::vector<SpiceEphemeris::BodyInfo> bodies = SpiceEphemeris::getAvailableBodies();
+    std::cout << "EphemerisTable: Precomputing " << bodies.size() << " bodies over " << (endJD - startJD)
+              << " days...\n";
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Lay out body records and segment offsets up front
+    std::vector<BodyRecord> records(bodies.size());
+    size_t offset = alignUp(sizeof(TableHeader) + records.size() * sizeof(BodyRecord), SEGMENT_ALIGNMENT);
+    for (size_t b = 0; b < bodies.size(); b++)
+    {
+        BodyRecord &record = records[b];
+        std::memset(&record, 0, sizeof(BodyRecord));
+        record.naifId = bodies[b].naifId;
+        record.spanDays = EphemerisCache::getSegmentSpanDays(bodies[b].naifId);
+        record.radiusKm = bodies[b].radiusKm;
+        record.firstIndex = gridIndex(startJD, record.spanDays);
+        record.segmentCount = static_cast<uint32_t>(gridIndex(endJD, record.spanDays) - record.firstIndex + 1);
+        record.segmentOffset = offset;
+        std::strncpy(record.name, bodies[b].name.c_str(), sizeof(record.name) - 1);
+        offset = alignUp(offset + record.segmentCount * sizeof(Segment), SEGMENT_ALIGNMENT);
+    }
+
+    TableHeader header;
+    std::memset(&header, 0, sizeof(TableHeader));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.bodyCount = static_cast<uint32_t>(records.size());
+    header.coeffCount = EphemerisCache::CHEBYSHEV_COEFFS;
+    header.segmentSize = sizeof(Segment);
+    header.kernelFingerprint = kernelFingerprint(kernelDir);
+    header.startJD = startJD;
+    header.endJD = endJD;
+    header.validStartJD = SpiceEphemeris::getEarliestAvailableTime();
+    header.validEndJD = SpiceEphemeris::getLatestAvailableTime();
+
+    // Write to a temp file and rename, so an interrupted build never leaves a valid-looking table
+    fs::path finalPath(path);
+    if (finalPath.has_parent_path())
+    {
+        fs::create_directories(finalPath.parent_path());
+    }
+    std::string tempPath = path + ".tmp";
+
+    // Drop any mapping of the file we're about to replace
+    close();
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "EphemerisTable: Failed to open " << tempPath << " for writing\n";
+            return false;
+        }
+
+        auto padTo = [&out](size_t target) {
+            static const char zeros[SEGMENT_ALIGNMENT] = {};
+            size_t position = static_cast<size_t>(out.tellp());
+            if (target > position)
+            {
+                out.write(zeros, static_cast<std::streamsize>(target - position));
+            }
+        };
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(TableHeader));
+        out.write(reinterpret_cast<const char *>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(BodyRecord)));
+
+        for (const auto &record : records)
+        {
+            padTo(record.segmentOffset);
+            for (uint32_t s = 0; s < record.segmentCount; s++)
+            {
+                Segment segment;
+                double segmentStart = static_cast<double>(record.firstIndex + s) * record.spanDays;
+                EphemerisCache::fitSegment(record.naifId, segmentStart, record.spanDays, segment);
+                out.write(reinterpret_cast<const char *>(&segment), sizeof(Segment));
+            }
+            std::cout << "  " << record.name << " (NAIF " << record.naifId << "): " << record.segmentCount
+                      << " segments\n";
+        }
+        padTo(offset);
+
+        if (!out)
+        {
+            std::cerr << "EphemerisTable: Write failed for " << tempPath << "\n";
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, finalPath, ec);
+    if (ec)
+    {
+        std::cerr << "EphemerisTable: Failed to move " << tempPath << " into place: " << ec.message() << "\n";
+        return false;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    std::cout << "EphemerisTable: Wrote " << path << " (" << offset / (1024.0 * 1024.0) << " MB) in "
+              << duration.count() / 1000.0 << "s\n";
+    return true;
+}
+
+// ==================================
+// Runtime Access
+// ==================================
+
+bool open(const std::string &path, const std::string &kernelDir, double requiredStartJD, double requiredEndJD)
+{
+    close();
+
+    if (!g_file.open(path))
+    {
+        return false;
+    }
+
+    auto reject = [&path](const char *reason) {
+        std::cout << "EphemerisTable: Ignoring " << path << " (" << reason << ")\n";
+        close();
+        return false;
+    };
+
+    if (g_file.size() < sizeof(TableHeader))
+    {
+        return reject("truncated header");
+    }
+
+    const auto *header = reinterpret_cast<const TableHeader *>(g_file.data());
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION)
+    {
+        return reject("unknown format version");
+    }
+    if (header->coeffCount != EphemerisCache::CHEBYSHEV_COEFFS || header->segmentSize != sizeof(Segment))
+    {
+        return reject("segment layout changed");
+    }
+    if (header->kernelFingerprint != kernelFingerprint(kernelDir))
+    {
+        return reject("kernels changed");
+    }
+    // Kernels can't provide more than their own coverage, so never demand more than that
+    requiredStartJD = std::max(requiredStartJD, header->validStartJD);
+    requiredEndJD = std::min(requiredEndJD, header->validEndJD);
+    if (header->startJD > requiredStartJD || header->endJD < requiredEndJD)
+    {
+        return reject("does not cover the current date");
+    }
+
+    size_t recordsEnd = sizeof(TableHeader) + header->bodyCount * sizeof(BodyRecord);
+    if (g_file.size() < recordsEnd)
+    {
+        return reject("truncated body table");
+    }
+
+    const auto *records = reinterpret_cast<const BodyRecord *>(g_file.data() + sizeof(TableHeader));
+    for (uint32_t b = 0; b < header->bodyCount; b++)
+    {
+        const BodyRecord &record = records[b];
+        if (record.segmentOffset % SEGMENT_ALIGNMENT != 0 || record.spanDays <= 0.0 ||
+            record.segmentOffset + static_cast<uint64_t>(record.segmentCount) * sizeof(Segment) > g_file.size())
+        {
+            return reject("corrupt body record");
+        }
+    }
+
+    g_header = header;
+    g_bodies = records;
+
+    std::cout << "EphemerisTable: Mapped " << path << " (" << header->bodyCount << " bodies, JD " << header->startJD
+              << " to " << header->endJD << ")\n";
+    return true;
+}
+
+void close()
+{
+    g_header = nullptr;
+    g_bodies = nullptr;
+    g_file.close();
+}
+
+bool isOpen()
+{
+    return g_header != nullptr;
+}
+
+const Segment *findSegment(int naifId, double jdTdb)
+{
+    if (!g_header || jdTdb < g_header->startJD || jdTdb > g_header->endJD)
+    {
+        return nullptr;
+    }
+
+    for (uint32_t b = 0; b < g_header->bodyCount; b++)
+    {
+        const BodyRecord &record = g_bodies[b];
+        if (record.naifId != naifId)
+        {
+            continue;
+        }
+
+        int64_t offset = gridIndex(jdTdb, record.spanDays) - record.firstIndex;
+        if (offset < 0 || offset >= static_cast<int64_t>(record.segmentCount))
+        {
+            return nullptr;
+        }
+        const auto *segments = reinterpret_cast<const Segment *>(g_file.data() + record.segmentOffset);
+        return &segments[offset];
+    }
+    return nullptr;
+}
+
+std::vector<SpiceEphemeris::BodyInfo> getBodies()
+{
+    std::vector<SpiceEphemeris::BodyInfo> bodies;
+    if (!g_header)
+    {
+        return bodies;
+    }
+
+    for (uint32_t b = 0; b < g_header->bodyCount; b++)
+    {
+        SpiceEphemeris::BodyInfo info;
+        info.naifId = g_bodies[b].naifId;
+        info.name = std::string(g_bodies[b].name, strnlen(g_bodies[b].name, sizeof(g_bodies[b].name)));
+        info.radiusKm = g_bodies[b].radiusKm;
+        bodies.push_back(info);
+    }
+    return bodies;
+}
+
+double getValidStartJD()
+{
+    return g_header ? g_header->validStartJD : 0.0;
+}
+
+double getValidEndJD()
+{
+    return g_header ? g_header->validEndJD : 0.0;
+}
+
+} // namespace EphemerisTable
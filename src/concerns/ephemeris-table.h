@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ephemeris-cache.h"
+#include "spice-ephemeris.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================================
+// Precomputed Ephemeris Table
+// ==================================
+// Versioned binary file of per-body Chebyshev segments (same grid and layout as
+// EphemerisCache::Segment), built once by PreprocessAllData and memory-mapped at runtime.
+// When a valid table covers the current date, startup never touches CSPICE;
+// kernels are only loaded lazily for queries outside the precomputed span.
+//
+// File layout (all offsets from file start, little-endian, native struct layout):
+//   TableHeader
+//   BodyRecord[bodyCount]
+//   Segment[] per body, starting at BodyRecord::segmentOffset (aligned to SEGMENT_ALIGNMENT)
+
+namespace EphemerisTable
+{
+
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr char MAGIC[8] = {'V', 'N', 'T', 'E', 'P', 'H', 'E', 'M'};
+constexpr size_t SEGMENT_ALIGNMENT = 64;
+
+// Span precomputed around the current date when the table is (re)built
+constexpr double DAYS_BEFORE_NOW = 365.25;
+constexpr double DAYS_AFTER_NOW = 5.0 * 365.25;
+
+// Rebuild once the current date gets closer than this to the end of the table
+constexpr double REBUILD_MARGIN_DAYS = 365.25;
+
+// Default table location (next to the other preprocessed outputs)
+constexpr const char *DEFAULT_TABLE_PATH = "ephemeris/chebyshev-table.bin";
+
+struct TableHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t bodyCount;
+    uint32_t coeffCount;        // EphemerisCache::CHEBYSHEV_COEFFS at build time
+    uint32_t segmentSize;       // sizeof(EphemerisCache::Segment) at build time
+    uint64_t kernelFingerprint; // Hash of kernel file names, sizes and timestamps
+    double startJD;             // Precomputed span (TDB Julian Date)
+    double endJD;
+    double validStartJD; // Kernel coverage, so SPICE can stay unloaded
+    double validEndJD;
+};
+
+struct BodyRecord
+{
+    int32_t naifId;
+    uint32_t segmentCount;
+    double spanDays;        // EphemerisCache::getSegmentSpanDays at build time
+    double radiusKm;        // Mean radius from PCK (0 if unknown)
+    int64_t firstIndex;     // Grid index of the first segment (floor(jd / spanDays))
+    uint64_t segmentOffset; // File offset of the first segment
+    char name[32];
+};
+
+// Fingerprint of the kernel directory (no CSPICE calls)
+uint64_t kernelFingerprint(const std::string &kernelDir);
+
+// Current UTC time as a Julian Date (from the system clock, no CSPICE calls)
+double currentJulianDate();
+
+// Fit every available body over [startJD, endJD] and write the table atomically (temp file + rename)
+// Requires SpiceEphemeris to be initialized with kernels loaded
+bool build(const std::string &path, const std::string &kernelDir, double startJD, double endJD);
+
+// Map a table and validate version, layout, kernel fingerprint and that it covers [requiredStartJD, requiredEndJD]
+// (clamped to the kernel coverage recorded in the table)
+bool open(const std::string &path, const std::string &kernelDir, double requiredStartJD, double requiredEndJD);
+void close();
+bool isOpen();
+
+// Segment covering jdTdb for a body, or nullptr if outside the precomputed span
+// Points straight into the mapped file
+const EphemerisCache::Segment *findSegment(int naifId, double jdTdb);
+
+// Bodies stored in the table (names and radii as discovered at build time)
+std::vector<SpiceEphemeris::BodyInfo> getBodies();
+
+// Kernel coverage recorded at build time
+double getValidStartJD();
+double getValidEndJD();
+
+} // namespace EphemerisTable
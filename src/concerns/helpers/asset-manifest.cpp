@@ -0,0 +1,449 @@
+#include "asset-manifest.h"
+#include "mapped-file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+constexpr const char *MANIFEST_NAME = "asset-manifest.txt";
+constexpr const char *MANIFEST_HEADER = "vnt-asset-manifest 1";
+
+// Size and modification time of a file; size -1 if it does not exist
+struct FileStamp
+{
+    int64_t size = -1;
+    int64_t time = 0;
+
+    bool operator==(const FileStamp &other) const
+    {
+        return size == other.size && time == other.time;
+    }
+};
+
+struct SourceRecord
+{
+    std::string path;
+    FileStamp stamp;
+    uint64_t hash = 0;
+};
+
+struct ArtifactRecord
+{
+    uint64_t key = 0;
+    FileStamp stamp;
+    std::vector<SourceRecord> sources;
+};
+
+struct Manifest
+{
+    std::map<std::string, ArtifactRecord> artifacts; // By file name
+};
+
+FileStamp stampOf(const std::string &path)
+{
+    FileStamp stamp;
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec))
+    {
+        return stamp;
+    }
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        return stamp;
+    }
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+    {
+        return stamp;
+    }
+    stamp.size = static_cast<int64_t>(size);
+    stamp.time = static_cast<int64_t>(time.time_since_epoch().count());
+    return stamp;
+}
+
+// ==================================
+// XXH64 (reads ~10 GB/s, so hashing sources costs far less than decoding them)
+// ==================================
+constexpr uint64_t PRIME1 = 11400714785074694791ULL;
+constexpr uint64_t PRIME2 = 14029467366897019727ULL;
+constexpr uint64_t PRIME3 = 1609587929392839161ULL;
+constexpr uint64_t PRIME4 = 9650029242287828579ULL;
+constexpr uint64_t PRIME5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const uint8_t *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t round64(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME2;
+    return rotl(acc, 31) * PRIME1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= round64(0, value);
+    return acc * PRIME1 + PRIME4;
+}
+
+uint64_t xxh64(const uint8_t *data, size_t length, uint64_t seed = 0)
+{
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+    uint64_t h;
+
+    if (length >= 32)
+    {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const uint8_t *limit = end - 32;
+        do
+        {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + PRIME5;
+    }
+
+    h += static_cast<uint64_t>(length);
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= round64(0, read64(p));
+        h = rotl(h, 27) * PRIME1 + PRIME4;
+    }
+    if (p + 4 <= end)
+    {
+        h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+        h = rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++)
+    {
+        h ^= (*p) * PRIME5;
+        h = rotl(h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::string toHex(uint64_t value)
+{
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+    return text;
+}
+
+// Absolute, normalized directory of an output, so every spelling of a path shares one manifest
+std::string directoryOf(const std::string &outputPath)
+{
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::absolute(outputPath, ec);
+    if (ec)
+    {
+        path = outputPath;
+    }
+    return path.lexically_normal().parent_path().string();
+}
+
+std::string manifestPathFor(const std::string &directory)
+{
+    return (std::filesystem::path(directory) / MANIFEST_NAME).string();
+}
+} // namespace
+
+// Manifests by output directory, loaded on first use, and every known source hash by path
+static std::mutex g_manifestMutex;
+static std::map<std::string, Manifest> g_manifests;
+static std::map<std::string, SourceRecord> g_sourceHashes;
+
+namespace
+{
+// Parse <directory>/asset-manifest.txt (caller holds g_manifestMutex)
+Manifest &loadManifest(const std::string &directory)
+{
+    auto found = g_manifests.find(directory);
+    if (found != g_manifests.end())
+    {
+        return found->second;
+    }
+
+    Manifest &manifest = g_manifests[directory];
+    std::ifstream in(manifestPathFor(directory));
+    std::string line;
+    if (!in.is_open() || !std::getline(in, line) || line != MANIFEST_HEADER)
+    {
+        return manifest;
+    }
+
+    ArtifactRecord *current = nullptr;
+    while (std::getline(in, line))
+    {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+
+        try
+        {
+            if (fields.size() == 5 && fields[0] == "artifact")
+            {
+                ArtifactRecord &record = manifest.artifacts[fields[1]];
+                record.key = std::stoull(fields[2], nullptr, 16);
+                record.stamp.size = std::stoll(fields[3]);
+                record.stamp.time = std::stoll(fields[4]);
+                record.sources.clear();
+                current = &record;
+            }
+            else if (fields.size() == 5 && fields[0] == "source" && current)
+            {
+                SourceRecord source;
+                source.hash = std::stoull(fields[1], nullptr, 16);
+                source.stamp.size = std::stoll(fields[2]);
+                source.stamp.time = std::stoll(fields[3]);
+                source.path = fields[4];
+                current->sources.push_back(source);
+                g_sourceHashes.emplace(source.path, source);
+            }
+        }
+        catch (const std::exception &)
+        {
+            // Malformed line (hand-edited or from a newer format): the artifact will simply be rebuilt
+            current = nullptr;
+        }
+    }
+    return manifest;
+}
+
+// Write the manifest next to the artifacts, replacing the old one atomically (caller holds g_manifestMutex)
+bool saveManifest(const std::string &directory, const Manifest &manifest)
+{
+    std::string path = manifestPathFor(directory);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out.is_open())
+        {
+            return false;
+        }
+        out << MANIFEST_HEADER << '\n';
+        for (const auto &entry : manifest.artifacts)
+        {
+            const ArtifactRecord &record = entry.second;
+            out << "artifact\t" << entry.first << '\t' << toHex(record.key) << '\t' << record.stamp.size << '\t'
+                << record.stamp.time << '\n';
+            for (const SourceRecord &source : record.sources)
+            {
+                out << "source\t" << toHex(source.hash) << '\t' << source.stamp.size << '\t' << source.stamp.time
+                    << '\t' << source.path << '\n';
+            }
+        }
+        if (out.fail())
+        {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+// Content hash of a source, reusing the cached hash while its size and time are unchanged
+SourceRecord hashSource(const std::string &path)
+{
+    SourceRecord record;
+    record.path = path;
+    record.stamp = stampOf(path);
+    if (record.stamp.size < 0)
+    {
+        return record;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_manifestMutex);
+        auto cached = g_sourceHashes.find(path);
+        if (cached != g_sourceHashes.end() && cached->second.stamp == record.stamp)
+        {
+            return cached->second;
+        }
+    }
+
+    // Hash outside the lock: other stages keep going while a large source is read
+    if (record.stamp.size == 0)
+    {
+        record.hash = xxh64(nullptr, 0);
+    }
+    else
+    {
+        MappedFile file;
+        if (!file.open(path))
+        {
+            record.stamp.size = -1;
+            return record;
+        }
+        record.hash = xxh64(file.data(), file.size());
+    }
+
+    std::lock_guard<std::mutex> lock(g_manifestMutex);
+    g_sourceHashes[path] = record;
+    return record;
+}
+
+// Key over version, parameters and source contents (sources by file name, so moving the
+// source tree does not invalidate anything)
+uint64_t recipeKey(const AssetManifest::Recipe &recipe, const std::vector<SourceRecord> &sources)
+{
+    std::string text = "version=" + std::to_string(recipe.version) + "\nparameters=" + recipe.parameters + "\n";
+    for (const SourceRecord &source : sources)
+    {
+        text += std::filesystem::path(source.path).filename().string();
+        text += source.stamp.size < 0 ? "=missing\n" : "=" + toHex(source.hash) + "\n";
+    }
+    return xxh64(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+}
+
+// Hash an artifact's sources; its manifest is loaded first so the hashes cached there are reused
+std::vector<SourceRecord> hashSources(const std::string &directory, const AssetManifest::Recipe &recipe)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_manifestMutex);
+        loadManifest(directory);
+    }
+
+    std::vector<SourceRecord> sources;
+    sources.reserve(recipe.sources.size());
+    for (const std::string &path : recipe.sources)
+    {
+        sources.push_back(hashSource(path));
+    }
+    return sources;
+}
+} // namespace
+
+namespace AssetManifest
+{
+
+bool isCurrent(const std::string &outputPath, const Recipe &recipe)
+{
+    FileStamp outputStamp = stampOf(outputPath);
+    if (outputStamp.size < 0)
+    {
+        return false;
+    }
+
+    std::string directory = directoryOf(outputPath);
+    std::vector<SourceRecord> sources = hashSources(directory, recipe);
+    bool anySource = sources.empty();
+    for (const SourceRecord &source : sources)
+    {
+        anySource = anySource || source.stamp.size >= 0;
+    }
+    if (!anySource)
+    {
+        return true;
+    }
+
+    uint64_t key = recipeKey(recipe, sources);
+    std::filesystem::path path(outputPath);
+    bool current = false;
+    {
+        std::lock_guard<std::mutex> lock(g_manifestMutex);
+        Manifest &manifest = loadManifest(directory);
+        auto found = manifest.artifacts.find(path.filename().string());
+        current = found != manifest.artifacts.end() && found->second.key == key &&
+                  found->second.stamp == outputStamp;
+    }
+
+    if (!current)
+    {
+        std::cout << "Out of date (sources, parameters or code changed): " << outputPath << '\n';
+    }
+    return current;
+}
+
+std::string temporaryPath(const std::string &outputPath)
+{
+    return outputPath + ".tmp";
+}
+
+bool commit(const std::string &temporaryFile, const std::string &outputPath, const Recipe &recipe)
+{
+    std::error_code ec;
+    std::filesystem::rename(temporaryFile, outputPath, ec);
+    if (ec)
+    {
+        std::cerr << "Failed to publish " << outputPath << ": " << ec.message() << '\n';
+        std::filesystem::remove(temporaryFile, ec);
+        return false;
+    }
+
+    std::string directory = directoryOf(outputPath);
+    ArtifactRecord record;
+    record.sources = hashSources(directory, recipe);
+    record.key = recipeKey(recipe, record.sources);
+    record.stamp = stampOf(outputPath);
+
+    std::filesystem::path path(outputPath);
+    std::lock_guard<std::mutex> lock(g_manifestMutex);
+    Manifest &manifest = loadManifest(directory);
+    manifest.artifacts[path.filename().string()] = record;
+    if (!saveManifest(directory, manifest))
+    {
+        // The artifact itself is complete; it will just be rebuilt next time
+        std::cerr << "Failed to update " << manifestPathFor(directory) << '\n';
+    }
+    return true;
+}
+
+} // namespace AssetManifest
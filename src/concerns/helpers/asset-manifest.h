@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// ==================================
+// Preprocessed Asset Manifest
+// ==================================
+// Every output directory (earth-textures/<res>, celestial-skybox/<res>, ...) keeps an asset-manifest.txt
+// that records, for each artifact, how it was built: a key over the content hashes of its sources,
+// its parameters and the version of the code that produced it, plus the size and time of the file written
+// An artifact is reused only if that key still matches and the file on disk is the one recorded, so
+// changed sources, parameters or algorithms rebuild exactly the artifacts they affect
+//
+// Outputs are written under temporaryPath() and published with commit(), which renames the finished file
+// into place, so an interrupted run never leaves a half-written file under the final name
+//
+// Source hashes are cached by size and modification time, so unchanged multi-gigabyte sources are
+// only read once. All functions are thread-safe
+namespace AssetManifest
+{
+
+struct Recipe
+{
+    std::vector<std::string> sources; // Files the artifact is built from (hashed by content)
+    std::string parameters;           // Everything else that changes the output (dimensions, quality, constants)
+    int version = 1;                  // Bump when the algorithm producing the artifact changes
+};
+
+// True if outputPath exists and was committed with this recipe
+// An existing output whose sources are all missing is also kept (it cannot be rebuilt here)
+bool isCurrent(const std::string &outputPath, const Recipe &recipe);
+
+// Where to write outputPath before commit() (same directory, so the rename is atomic)
+std::string temporaryPath(const std::string &outputPath);
+
+// Rename temporaryFile over outputPath and record it with recipe in the directory's manifest
+// Returns false (and removes temporaryFile) if the rename fails
+bool commit(const std::string &temporaryFile, const std::string &outputPath, const Recipe &recipe);
+
+} // namespace AssetManifest
@@ -0,0 +1,259 @@
+#include "ktx2.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace Ktx2
+{
+
+// Level data alignment (lcm of the 8/16-byte block sizes and 4, rounded up for simple copies)
+static constexpr uint64_t LEVEL_ALIGNMENT = 16;
+
+// Data Format Descriptor values (Khronos Data Format Specification 1.3)
+static constexpr uint8_t KHR_DF_MODEL_BC4 = 131;
+static constexpr uint8_t KHR_DF_MODEL_BC5 = 132;
+static constexpr uint8_t KHR_DF_MODEL_BC6H = 133;
+static constexpr uint8_t KHR_DF_MODEL_BC7 = 134;
+static constexpr uint8_t KHR_DF_PRIMARIES_BT709 = 1;
+static constexpr uint8_t KHR_DF_TRANSFER_LINEAR = 1;
+static constexpr uint8_t KHR_DF_SAMPLE_DATATYPE_FLOAT = 0x80;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::string pathFor(const std::string &texturePath)
+{
+    return fs::path(texturePath).replace_extension(FILE_EXTENSION).string();
+}
+
+bool isUpToDate(const std::string &texturePath)
+{
+    std::error_code ec;
+    auto ktxTime = fs::last_write_time(pathFor(texturePath), ec);
+    if (ec)
+    {
+        return false;
+    }
+    auto sourceTime = fs::last_write_time(texturePath, ec);
+    return ec || ktxTime >= sourceTime;
+}
+
+// Basic descriptor block for the BC formats produced by BlockCompression
+// Returns an empty vector for formats this writer does not describe
+static std::vector<uint8_t> buildDataFormatDescriptor(uint32_t vkFormat, uint32_t blockBytes)
+{
+    struct Sample
+    {
+        uint16_t bitOffset;
+        uint8_t bitLength; // Stored as length - 1
+        uint8_t channel;   // Channel id plus qualifier bits
+        uint32_t lower;
+        uint32_t upper;
+    };
+
+    uint8_t colorModel = 0;
+    std::vector<Sample> samples;
+    switch (vkFormat)
+    {
+    case 139: // BC4_UNORM
+        colorModel = KHR_DF_MODEL_BC4;
+        samples.push_back({0, 63, 0, 0, 0xFFFFFFFFu});
+        break;
+    case 141: // BC5_UNORM
+        colorModel = KHR_DF_MODEL_BC5;
+        samples.push_back({0, 63, 0, 0, 0xFFFFFFFFu});
+        samples.push_back({64, 63, 1, 0, 0xFFFFFFFFu});
+        break;
+    case 143: // BC6H_UFLOAT
+        colorModel = KHR_DF_MODEL_BC6H;
+        samples.push_back({0, 127, KHR_DF_SAMPLE_DATATYPE_FLOAT, 0, 0x3F800000u}); // 0.0 .. 1.0
+        break;
+    case 145: // BC7_UNORM
+        colorModel = KHR_DF_MODEL_BC7;
+        samples.push_back({0, 127, 0, 0, 0xFFFFFFFFu});
+        break;
+    default:
+        return {};
+    }
+
+    uint16_t blockSize = static_cast<uint16_t>(24 + 16 * samples.size());
+    uint32_t totalSize = 4u + blockSize;
+    std::vector<uint8_t> dfd(totalSize, 0);
+
+    auto put32 = [&dfd](size_t offset, uint32_t value) { std::memcpy(dfd.data() + offset, &value, 4); };
+    auto put16 = [&dfd](size_t offset, uint16_t value) { std::memcpy(dfd.data() + offset, &value, 2); };
+
+    put32(0, totalSize);
+    put32(4, 0); // vendorId = Khronos, descriptorType = basic
+    put16(8, 2); // versionNumber (KDF 1.3)
+    put16(10, blockSize);
+    dfd[12] = colorModel;
+    dfd[13] = KHR_DF_PRIMARIES_BT709;
+    dfd[14] = KHR_DF_TRANSFER_LINEAR;
+    dfd[15] = 0; // Straight alpha
+    dfd[16] = 3; // Texel block is 4x4x1x1 (stored as dimension - 1)
+    dfd[17] = 3;
+    dfd[20] = static_cast<uint8_t>(blockBytes); // bytesPlane0
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        size_t base = 28 + 16 * i;
+        put16(base, samples[i].bitOffset);
+        dfd[base + 2] = samples[i].bitLength;
+        dfd[base + 3] = samples[i].channel;
+        put32(base + 8, samples[i].lower);
+        put32(base + 12, samples[i].upper);
+    }
+    return dfd;
+}
+
+bool writeCubemap(const std::string &path,
+                  uint32_t vkFormat,
+                  uint32_t blockBytes,
+                  uint32_t faceWidth,
+                  uint32_t faceHeight,
+                  const std::vector<std::vector<uint8_t>> &levels)
+{
+    std::vector<uint8_t> dfd = buildDataFormatDescriptor(vkFormat, blockBytes);
+    if (dfd.empty() || levels.empty())
+    {
+        std::cerr << "Ktx2: Unsupported format " << vkFormat << " for " << path << "\n";
+        return false;
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+    header.vkFormat = vkFormat;
+    header.typeSize = 1; // Block-compressed data has no endianness
+    header.pixelWidth = faceWidth;
+    header.pixelHeight = faceHeight;
+    header.faceCount = 6;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(Header) + levels.size() * sizeof(LevelIndex));
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size());
+
+    // Smallest level first, so a streaming reader gets a usable image as early as possible
+    std::vector<LevelIndex> index(levels.size());
+    uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        offset = alignUp(offset, LEVEL_ALIGNMENT);
+        index[level].byteOffset = offset;
+        index[level].byteLength = levels[level].size();
+        index[level].uncompressedByteLength = levels[level].size();
+        offset += levels[level].size();
+    }
+
+    fs::path finalPath(path);
+    if (finalPath.has_parent_path())
+    {
+        fs::create_directories(finalPath.parent_path());
+    }
+    std::string tempPath = path + ".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "Ktx2: Failed to open " << tempPath << " for writing\n";
+            return false;
+        }
+
+        auto padTo = [&out](uint64_t target) {
+            static const char zeros[LEVEL_ALIGNMENT] = {};
+            uint64_t position = static_cast<uint64_t>(out.tellp());
+            if (target > position)
+            {
+                out.write(zeros, static_cast<std::streamsize>(target - position));
+            }
+        };
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        out.write(reinterpret_cast<const char *>(index.data()),
+                  static_cast<std::streamsize>(index.size() * sizeof(LevelIndex)));
+        out.write(reinterpret_cast<const char *>(dfd.data()), static_cast<std::streamsize>(dfd.size()));
+
+        for (size_t level = levels.size(); level-- > 0;)
+        {
+            padTo(index[level].byteOffset);
+            out.write(reinterpret_cast<const char *>(levels[level].data()),
+                      static_cast<std::streamsize>(levels[level].size()));
+        }
+
+        if (!out)
+        {
+            std::cerr << "Ktx2: Write failed for " << tempPath << "\n";
+            out.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, finalPath, ec);
+    if (ec)
+    {
+        std::cerr << "Ktx2: Failed to move " << tempPath << " into place: " << ec.message() << "\n";
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool openCubemap(const std::string &path, Cubemap &cubemap)
+{
+    if (!cubemap.file.open(path))
+    {
+        return false;
+    }
+
+    size_t fileSize = cubemap.file.size();
+    if (fileSize < sizeof(Header) || std::memcmp(cubemap.file.data(), IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+    {
+        std::cerr << "Ktx2: Not a KTX2 file: " << path << "\n";
+        cubemap.file.close();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, cubemap.file.data(), sizeof(Header));
+    size_t indexOffset = sizeof(Header);
+    if (header.faceCount != 6 || header.layerCount != 0 || header.pixelDepth != 0 ||
+        header.supercompressionScheme != 0 || header.levelCount == 0 || header.pixelWidth == 0 ||
+        header.pixelHeight == 0 || indexOffset + header.levelCount * sizeof(LevelIndex) > fileSize)
+    {
+        std::cerr << "Ktx2: Unsupported layout (expected an uncompressed 6-face cubemap): " << path << "\n";
+        cubemap.file.close();
+        return false;
+    }
+
+    cubemap.levels.resize(header.levelCount);
+    std::memcpy(cubemap.levels.data(),
+                cubemap.file.data() + indexOffset,
+                header.levelCount * sizeof(LevelIndex));
+
+    for (const auto &level : cubemap.levels)
+    {
+        if (level.byteLength == 0 || level.byteLength % 6 != 0 || level.byteOffset > fileSize ||
+            level.byteLength > fileSize - level.byteOffset)
+        {
+            std::cerr << "Ktx2: Truncated or corrupt level data: " << path << "\n";
+            cubemap.file.close();
+            cubemap.levels.clear();
+            return false;
+        }
+    }
+
+    cubemap.vkFormat = header.vkFormat;
+    cubemap.width = header.pixelWidth;
+    cubemap.height = header.pixelHeight;
+    return true;
+}
+
+} // namespace Ktx2
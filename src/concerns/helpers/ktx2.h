@@ -0,0 +1,97 @@
+#pragma once
+
+#include "mapped-file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================================
+// KTX2 Cubemap Container
+// ==================================
+// Minimal reader/writer for Khronos KTX 2.0 files holding a block-compressed cubemap
+// with a full mip chain (no supercompression, no key/value data).
+//
+// File layout (all little endian):
+//   Header (starts with the 12-byte identifier)
+//   LevelIndex[levelCount]        - level 0 (largest) first
+//   Data Format Descriptor        - basic block describing the BC format
+//   level data                    - smallest level first, each 16-byte aligned;
+//                                   a level holds its 6 faces back to back (+X -X +Y -Y +Z -Z)
+//
+// The loader maps the file and hands the level ranges straight to the staging buffer,
+// so nothing is decoded on the CPU at startup.
+
+namespace Ktx2
+{
+
+constexpr uint8_t IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// Extension used next to the uncompressed grid files (e.g. earth_specular.png -> earth_specular.ktx2)
+constexpr const char *FILE_EXTENSION = ".ktx2";
+
+struct Header
+{
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Header) == 80, "KTX2 header must match the on-disk layout");
+
+struct LevelIndex
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+// A mapped cubemap; level data pointers stay valid while the file is open
+struct Cubemap
+{
+    MappedFile file;
+    uint32_t vkFormat = 0;
+    uint32_t width = 0; // Face size of level 0
+    uint32_t height = 0;
+    std::vector<LevelIndex> levels;
+
+    const uint8_t *levelData(uint32_t level) const
+    {
+        return file.data() + levels[level].byteOffset;
+    }
+};
+
+// Path of the KTX2 file that replaces an uncompressed texture ("dir/name.png" -> "dir/name.ktx2")
+std::string pathFor(const std::string &texturePath);
+
+// True if the KTX2 file for texturePath exists and is not older than texturePath
+// (a missing texturePath counts as up to date, so a KTX2-only install still loads)
+bool isUpToDate(const std::string &texturePath);
+
+// Write a cubemap atomically (temp file + rename)
+// levels[i]: the 6 faces of mip level i concatenated, level 0 = faceWidth x faceHeight
+// blockBytes: bytes per 4x4 block (8 for BC4, 16 for BC5/BC6H/BC7)
+bool writeCubemap(const std::string &path,
+                  uint32_t vkFormat,
+                  uint32_t blockBytes,
+                  uint32_t faceWidth,
+                  uint32_t faceHeight,
+                  const std::vector<std::vector<uint8_t>> &levels);
+
+// Map and validate a cubemap written by writeCubemap
+// Rejects files that are truncated, not 6-faced, supercompressed or whose levels overrun the file
+bool openCubemap(const std::string &path, Cubemap &cubemap);
+
+} // namespace Ktx2
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ==================================
+// Read-only Memory-Mapped File
+// ==================================
+// Maps a whole file into the address space (mmap / MapViewOfFile)
+// Pages are loaded by the OS on first touch, so opening is O(1) regardless of file size
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Map the file read-only; closes any previous mapping first
+    // Returns false if the file is missing, empty or cannot be mapped
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    const uint8_t *data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void *m_fileHandle = nullptr;
+    void *m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,249 @@
+#include "png-stream-writer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <miniz.h>
+
+namespace
+{
+constexpr uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+constexpr size_t IDAT_CHUNK_BYTES = 256 * 1024;
+
+void writeBigEndian32(uint8_t *out, uint32_t value)
+{
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint8_t paethPredictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+    {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// Apply PNG filter type (0-4) to a row; out receives rowBytes filtered bytes
+void filterRow(int filter, const uint8_t *row, const uint8_t *previous, size_t rowBytes, int bpp, uint8_t *out)
+{
+    for (size_t i = 0; i < rowBytes; i++)
+    {
+        int a = (i >= static_cast<size_t>(bpp)) ? row[i - bpp] : 0;
+        int b = previous[i];
+        int c = (i >= static_cast<size_t>(bpp)) ? previous[i - bpp] : 0;
+        int predicted = 0;
+        switch (filter)
+        {
+        case 1:
+            predicted = a;
+            break;
+        case 2:
+            predicted = b;
+            break;
+        case 3:
+            predicted = (a + b) / 2;
+            break;
+        case 4:
+            predicted = paethPredictor(a, b, c);
+            break;
+        default:
+            break;
+        }
+        out[i] = static_cast<uint8_t>(row[i] - predicted);
+    }
+}
+
+// Minimum sum of absolute differences heuristic (same choice as libpng / stb_image_write)
+uint64_t filterCost(const uint8_t *filtered, size_t rowBytes)
+{
+    uint64_t cost = 0;
+    for (size_t i = 0; i < rowBytes; i++)
+    {
+        cost += static_cast<uint64_t>(std::abs(static_cast<int>(static_cast<int8_t>(filtered[i]))));
+    }
+    return cost;
+}
+} // namespace
+
+PngStreamWriter::~PngStreamWriter()
+{
+    if (m_compressor)
+    {
+        tdefl_compressor_free(static_cast<tdefl_compressor *>(m_compressor));
+        m_compressor = nullptr;
+    }
+}
+
+bool PngStreamWriter::open(const std::string &path, int width, int height, int channels, int compressionLevel)
+{
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4)
+    {
+        return false;
+    }
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_channels = channels;
+    m_rowsWritten = 0;
+    m_failed = false;
+
+    size_t rowBytes = static_cast<size_t>(width) * channels;
+    m_previousRow.assign(rowBytes, 0);
+    m_filteredRow.assign(rowBytes + 1, 0);
+    m_candidateRow.assign(rowBytes, 0);
+    m_compressed.clear();
+
+    if (!m_compressor)
+    {
+        m_compressor = tdefl_compressor_alloc();
+        if (!m_compressor)
+        {
+            return false;
+        }
+    }
+
+    // Positive window bits: zlib header and adler32 trailer, as IDAT requires
+    int flags = tdefl_create_comp_flags_from_zip_params(compressionLevel, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    if (tdefl_init(static_cast<tdefl_compressor *>(m_compressor), compressorOutput, this, flags) !=
+        TDEFL_STATUS_OKAY)
+    {
+        return false;
+    }
+
+    static const uint8_t COLOR_TYPES[5] = {0, 0, 4, 2, 6};
+    uint8_t header[13];
+    writeBigEndian32(header + 0, static_cast<uint32_t>(width));
+    writeBigEndian32(header + 4, static_cast<uint32_t>(height));
+    header[8] = 8; // Bit depth
+    header[9] = COLOR_TYPES[channels];
+    header[10] = 0; // Deflate
+    header[11] = 0; // Adaptive filtering
+    header[12] = 0; // No interlace
+
+    m_file.write(reinterpret_cast<const char *>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+    return writeChunk("IHDR", header, sizeof(header));
+}
+
+bool PngStreamWriter::writeRow(const uint8_t *row)
+{
+    if (m_failed || !m_compressor || m_rowsWritten >= m_height)
+    {
+        return false;
+    }
+
+    // Pick the cheapest of the five filters for this row
+    size_t rowBytes = m_previousRow.size();
+    uint64_t bestCost = UINT64_MAX;
+    for (int filter = 0; filter < 5; filter++)
+    {
+        filterRow(filter, row, m_previousRow.data(), rowBytes, m_channels, m_candidateRow.data());
+        uint64_t cost = filterCost(m_candidateRow.data(), rowBytes);
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            m_filteredRow[0] = static_cast<uint8_t>(filter);
+            std::memcpy(m_filteredRow.data() + 1, m_candidateRow.data(), rowBytes);
+        }
+    }
+    std::memcpy(m_previousRow.data(), row, rowBytes);
+
+    m_rowsWritten++;
+    tdefl_flush flush = (m_rowsWritten == m_height) ? TDEFL_FINISH : TDEFL_NO_FLUSH;
+    tdefl_status status = tdefl_compress_buffer(static_cast<tdefl_compressor *>(m_compressor),
+                                                m_filteredRow.data(),
+                                                m_filteredRow.size(),
+                                                flush);
+    if (status < TDEFL_STATUS_OKAY)
+    {
+        m_failed = true;
+        return false;
+    }
+
+    return flushCompressed(false);
+}
+
+bool PngStreamWriter::finish()
+{
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+
+    bool complete = !m_failed && m_rowsWritten == m_height;
+    if (complete)
+    {
+        complete = flushCompressed(true) && writeChunk("IEND", nullptr, 0);
+    }
+
+    m_file.close();
+    return complete && !m_file.fail();
+}
+
+int PngStreamWriter::compressorOutput(const void *data, int length, void *user)
+{
+    PngStreamWriter *writer = static_cast<PngStreamWriter *>(user);
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    writer->m_compressed.insert(writer->m_compressed.end(), bytes, bytes + length);
+    return MZ_TRUE;
+}
+
+bool PngStreamWriter::writeChunk(const char type[4], const uint8_t *data, size_t length)
+{
+    uint8_t lengthBytes[4];
+    writeBigEndian32(lengthBytes, static_cast<uint32_t>(length));
+
+    mz_ulong crc = mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char *>(type), 4);
+    if (length > 0)
+    {
+        crc = mz_crc32(crc, data, length);
+    }
+    uint8_t crcBytes[4];
+    writeBigEndian32(crcBytes, static_cast<uint32_t>(crc));
+
+    m_file.write(reinterpret_cast<const char *>(lengthBytes), 4);
+    m_file.write(type, 4);
+    if (length > 0)
+    {
+        m_file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(length));
+    }
+    m_file.write(reinterpret_cast<const char *>(crcBytes), 4);
+
+    if (m_file.fail())
+    {
+        m_failed = true;
+        return false;
+    }
+    return true;
+}
+
+// Emit buffered compressed bytes as IDAT chunks (whole chunks only, unless forced)
+bool PngStreamWriter::flushCompressed(bool force)
+{
+    size_t offset = 0;
+    while (m_compressed.size() - offset >= IDAT_CHUNK_BYTES ||
+           (force && offset < m_compressed.size()))
+    {
+        size_t length = std::min(IDAT_CHUNK_BYTES, m_compressed.size() - offset);
+        if (!writeChunk("IDAT", m_compressed.data() + offset, length))
+        {
+            return false;
+        }
+        offset += length;
+    }
+    m_compressed.erase(m_compressed.begin(), m_compressed.begin() + static_cast<std::ptrdiff_t>(offset));
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ==================================
+// Streaming PNG Writer
+// ==================================
+// Writes an 8-bit PNG one row at a time, compressing each row as it arrives (miniz tdefl)
+// Memory use is a few rows plus the compressor state, regardless of image size, so very large
+// images can be produced without ever holding them in memory (stbi_write_png needs the whole image)
+class PngStreamWriter
+{
+public:
+    PngStreamWriter() = default;
+    ~PngStreamWriter();
+
+    PngStreamWriter(const PngStreamWriter &) = delete;
+    PngStreamWriter &operator=(const PngStreamWriter &) = delete;
+
+    // Create the file and write the header; channels: 1 (gray), 2 (gray + alpha), 3 (RGB) or 4 (RGBA)
+    // compressionLevel: 0-10 (miniz levels, 6 = zlib default)
+    bool open(const std::string &path, int width, int height, int channels, int compressionLevel = 6);
+
+    // Append the next row (width * channels bytes, top to bottom)
+    bool writeRow(const uint8_t *row);
+
+    // Flush the compressor and write the trailer
+    // Returns false if any write failed or fewer than height rows were written
+    bool finish();
+
+private:
+    static int compressorOutput(const void *data, int length, void *user);
+    bool writeChunk(const char type[4], const uint8_t *data, size_t length);
+    bool flushCompressed(bool force);
+
+    std::ofstream m_file;
+    void *m_compressor = nullptr; // tdefl_compressor
+    int m_width = 0;
+    int m_height = 0;
+    int m_channels = 0;
+    int m_rowsWritten = 0;
+    bool m_failed = false;
+
+    std::vector<uint8_t> m_previousRow;
+    std::vector<uint8_t> m_filteredRow;  // Filter type byte + filtered row
+    std::vector<uint8_t> m_candidateRow; // Scratch for filter selection
+    std::vector<uint8_t> m_compressed;   // Compressed bytes not yet written as IDAT
+};
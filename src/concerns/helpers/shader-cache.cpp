@@ -0,0 +1,480 @@
+#include "shader-cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#ifdef HAS_GLSLANG
+#include <glslang/Public/ResourceLimits.h>
+#include <glslang/Public/ShaderLang.h>
+#include <glslang/SPIRV/GlslangToSpv.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <limits.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace ShaderCache
+{
+
+// ==================================
+// Module State
+// ==================================
+static std::mutex g_mutex;
+static std::unordered_map<uint64_t, std::vector<uint32_t>> g_memory;
+static Stats g_stats;
+static std::string g_cacheDir;
+static std::atomic<uint32_t> g_tempCounter{0};
+
+// ==================================
+// Helpers
+// ==================================
+
+// FNV-1a 64-bit
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Hash a string with its length, so ("ab", "c") and ("a", "bc") produce different keys
+static uint64_t hashString(uint64_t hash, const std::string &value)
+{
+    uint64_t length = value.size();
+    hash = hashBytes(hash, &length, sizeof(length));
+    return hashBytes(hash, value.data(), value.size());
+}
+
+static std::string keyToHex(uint64_t key)
+{
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << key;
+    return ss.str();
+}
+
+std::string getCacheDirectory()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_cacheDir.empty())
+    {
+        return g_cacheDir;
+    }
+
+    fs::path exePath;
+#ifdef _WIN32
+    char exePathBuf[1024];
+    DWORD result = GetModuleFileNameA(nullptr, exePathBuf, sizeof(exePathBuf));
+    if (result != 0 && result < sizeof(exePathBuf))
+    {
+        exePath = fs::path(exePathBuf).parent_path();
+    }
+#else
+    char exePathBuf[1024];
+    ssize_t len = readlink("/proc/self/exe", exePathBuf, sizeof(exePathBuf) - 1);
+    if (len != -1 && len < static_cast<ssize_t>(sizeof(exePathBuf)))
+    {
+        exePathBuf[len] = '\0';
+        exePath = fs::path(exePathBuf).parent_path();
+    }
+#endif
+
+    fs::path cacheDir = (exePath.empty() ? fs::current_path() : exePath) / CACHE_DIRECTORY;
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    if (ec)
+    {
+        std::cerr << "ShaderCache: Failed to create " << cacheDir.string() << ": " << ec.message() << "\n";
+    }
+
+    g_cacheDir = cacheDir.string();
+    return g_cacheDir;
+}
+
+static std::string entryPath(uint64_t key)
+{
+    return (fs::path(getCacheDirectory()) / (keyToHex(key) + ".spv")).string();
+}
+
+// Load and validate a cache entry; returns an empty vector if missing or invalid
+static std::vector<uint32_t> loadEntry(uint64_t key)
+{
+    std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return {};
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    EntryHeader header;
+    if (fileSize < sizeof(EntryHeader) || !file.read(reinterpret_cast<char *>(&header), sizeof(EntryHeader)))
+    {
+        std::cout << "ShaderCache: Discarding " << path << " (truncated header)\n";
+        return {};
+    }
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+        header.key != key || header.wordCount == 0 ||
+        fileSize != sizeof(EntryHeader) + static_cast<size_t>(header.wordCount) * sizeof(uint32_t))
+    {
+        std::cout << "ShaderCache: Discarding " << path << " (invalid entry)\n";
+        return {};
+    }
+
+    std::vector<uint32_t> spirv(header.wordCount);
+    auto spirvBytes = static_cast<std::streamsize>(fileSize - sizeof(EntryHeader));
+    if (!file.read(reinterpret_cast<char *>(spirv.data()), spirvBytes) || spirv[0] != SPIRV_MAGIC)
+    {
+        std::cout << "ShaderCache: Discarding " << path << " (not SPIR-V)\n";
+        return {};
+    }
+
+    return spirv;
+}
+
+// Write an entry atomically (temp file + rename), so a crash never leaves a half-written entry
+static void storeEntry(uint64_t key, const std::vector<uint32_t> &spirv)
+{
+    std::string path = entryPath(key);
+    std::string tempPath = path + "." + std::to_string(g_tempCounter.fetch_add(1)) + ".tmp";
+
+    EntryHeader header;
+    std::memset(&header, 0, sizeof(EntryHeader));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.wordCount = static_cast<uint32_t>(spirv.size());
+    header.key = key;
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "ShaderCache: Failed to open " << tempPath << " for writing\n";
+            return;
+        }
+        out.write(reinterpret_cast<const char *>(&header), sizeof(EntryHeader));
+        out.write(reinterpret_cast<const char *>(spirv.data()),
+                  static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+        if (!out)
+        {
+            std::cerr << "ShaderCache: Write failed for " << tempPath << "\n";
+            out.close();
+            std::remove(tempPath.c_str());
+            return;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::cerr << "ShaderCache: Failed to move " << tempPath << " into place: " << ec.message() << "\n";
+        std::remove(tempPath.c_str());
+    }
+}
+
+// ==================================
+// Compilation
+// ==================================
+
+#ifdef HAS_GLSLANG
+
+// In-process compile through the glslang library (same defaults as glslangValidator -V)
+static std::vector<uint32_t> compileInProcess(const std::string &glslSource,
+                                              const std::string &shaderStage,
+                                              const std::string &entryPoint,
+                                              const std::vector<std::string> &defines)
+{
+    static std::once_flag initFlag;
+    std::call_once(initFlag, []() {
+        glslang::InitializeProcess();
+        std::atexit([]() { glslang::FinalizeProcess(); });
+    });
+
+    EShLanguage language;
+    if (shaderStage == "vertex")
+        language = EShLangVertex;
+    else if (shaderStage == "fragment")
+        language = EShLangFragment;
+    else if (shaderStage == "compute")
+        language = EShLangCompute;
+    else
+    {
+        std::cerr << "Unknown shader stage: " << shaderStage << "\n";
+        return {};
+    }
+
+    // "NAME=VALUE" -> "#define NAME VALUE"
+    std::string preamble;
+    for (const auto &define : defines)
+    {
+        std::string line = define;
+        size_t equals = line.find('=');
+        if (equals != std::string::npos)
+        {
+            line[equals] = ' ';
+        }
+        preamble += "#define " + line + "\n";
+    }
+
+    const char *source = glslSource.c_str();
+    glslang::TShader shader(language);
+    shader.setStrings(&source, 1);
+    shader.setPreamble(preamble.c_str());
+    shader.setEntryPoint(entryPoint.c_str());
+    shader.setSourceEntryPoint(entryPoint.c_str());
+    shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientVulkan, 100);
+    shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+
+    const auto messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+    if (!shader.parse(GetDefaultResources(), 100, false, messages))
+    {
+        std::cerr << "Failed to compile " << shaderStage << " shader:\n" << shader.getInfoLog() << "\n";
+        return {};
+    }
+
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if (!program.link(messages))
+    {
+        std::cerr << "Failed to link " << shaderStage << " shader:\n" << program.getInfoLog() << "\n";
+        return {};
+    }
+
+    std::vector<uint32_t> spirv;
+    glslang::GlslangToSpv(*program.getIntermediate(language), spirv);
+    return spirv;
+}
+
+#else
+
+// Get temporary directory path (with trailing separator)
+static std::string getTempDirectory()
+{
+#ifdef _WIN32
+    char tempPath[MAX_PATH];
+    DWORD result = GetTempPathA(MAX_PATH, tempPath);
+    if (result > 0 && result < MAX_PATH)
+    {
+        std::string path(tempPath);
+        // Ensure trailing backslash
+        if (!path.empty() && path.back() != '\\' && path.back() != '/')
+        {
+            path += '\\';
+        }
+        return path;
+    }
+    return std::string(".\\");
+#else
+    const char *tmpDir = std::getenv("TMPDIR");
+    if (tmpDir == nullptr)
+    {
+        tmpDir = std::getenv("TMP");
+    }
+    if (tmpDir != nullptr)
+    {
+        std::string path(tmpDir);
+        if (!path.empty() && path.back() != '/')
+            path += '/';
+        return path;
+    }
+    return std::string("/tmp/");
+#endif
+}
+
+// Compile by running glslangValidator on temp files (removed again once the SPIR-V is read)
+static std::vector<uint32_t> compileWithValidator(uint64_t key,
+                                                  const std::string &glslSource,
+                                                  const std::string &shaderStage,
+                                                  const std::string &entryPoint,
+                                                  const std::vector<std::string> &defines)
+{
+    // Map shader stage to glslangValidator stage name
+    std::string stageArg;
+    if (shaderStage == "vertex")
+        stageArg = "vert";
+    else if (shaderStage == "fragment")
+        stageArg = "frag";
+    else if (shaderStage == "compute")
+        stageArg = "comp";
+    else
+    {
+        std::cerr << "Unknown shader stage: " << shaderStage << "\n";
+        return {};
+    }
+
+    // Unique per call, so concurrent compiles of the same shader don't share files
+    std::string baseName = getTempDirectory() + "vnt_shader_" + keyToHex(key) + "_" +
+                           std::to_string(g_tempCounter.fetch_add(1)) + "_" + shaderStage;
+    std::string tempInputFile = baseName + ".glsl";
+    std::string tempOutputFile = baseName + ".spv";
+
+    std::ofstream inputFile(tempInputFile);
+    if (!inputFile.is_open())
+    {
+        std::cerr << "Failed to create temporary shader file " << tempInputFile << "\n";
+        return {};
+    }
+    inputFile << glslSource;
+    inputFile.close();
+
+    std::string command = "glslangValidator -V -S " + stageArg + " -e " + entryPoint;
+    for (const auto &define : defines)
+    {
+        command += " -D" + define;
+    }
+    command += " -o \"" + tempOutputFile + "\" \"" + tempInputFile + "\"";
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stats.processSpawns++;
+    }
+    int result = system(command.c_str());
+
+    std::vector<uint32_t> spirv;
+    if (result == 0)
+    {
+        std::ifstream outputFile(tempOutputFile, std::ios::binary | std::ios::ate);
+        if (outputFile.is_open())
+        {
+            size_t fileSize = outputFile.tellg();
+            outputFile.seekg(0, std::ios::beg);
+            spirv.resize(fileSize / sizeof(uint32_t));
+            outputFile.read(reinterpret_cast<char *>(spirv.data()), static_cast<std::streamsize>(fileSize));
+        }
+    }
+    else
+    {
+        std::cerr << "Failed to compile shader using glslangValidator. Make sure glslangValidator is in your PATH."
+                  << "\n";
+        std::cerr << "Command: " << command << "\n";
+    }
+
+    std::remove(tempInputFile.c_str());
+    std::remove(tempOutputFile.c_str());
+    return spirv;
+}
+
+#endif
+
+// ==================================
+// Public API
+// ==================================
+
+uint64_t computeKey(const std::string &glslSource,
+                    const std::string &shaderStage,
+                    const std::string &entryPoint,
+                    const std::vector<std::string> &defines)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, &FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    hash = hashString(hash, shaderStage);
+    hash = hashString(hash, entryPoint);
+    for (const auto &define : defines)
+    {
+        hash = hashString(hash, define);
+    }
+    return hashString(hash, glslSource);
+}
+
+std::vector<uint32_t> getSpirv(const std::string &glslSource,
+                               const std::string &shaderStage,
+                               const std::string &entryPoint,
+                               const std::vector<std::string> &defines)
+{
+    uint64_t key = computeKey(glslSource, shaderStage, entryPoint, defines);
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_memory.find(key);
+        if (it != g_memory.end())
+        {
+            g_stats.memoryHits++;
+            return it->second;
+        }
+    }
+
+    std::vector<uint32_t> spirv = loadEntry(key);
+    if (!spirv.empty())
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stats.diskHits++;
+        g_memory[key] = spirv;
+        return spirv;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+#ifdef HAS_GLSLANG
+    spirv = compileInProcess(glslSource, shaderStage, entryPoint, defines);
+#else
+    spirv = compileWithValidator(key, glslSource, shaderStage, entryPoint, defines);
+#endif
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (spirv.empty() || spirv[0] != SPIRV_MAGIC)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stats.failures++;
+        return {};
+    }
+
+    storeEntry(key, spirv);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_stats.compiled++;
+    g_stats.compileMs += std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    g_memory[key] = spirv;
+    return spirv;
+}
+
+Stats getStats()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_stats;
+}
+
+void printStats()
+{
+    Stats stats = getStats();
+    std::cout << "ShaderCache: " << stats.diskHits << " loaded from disk, " << stats.memoryHits << " reused, "
+              << stats.compiled << " compiled (" << stats.compileMs << " ms, " << stats.processSpawns
+              << " process spawns)";
+    if (stats.failures > 0)
+    {
+        std::cout << ", " << stats.failures << " failed";
+    }
+    std::cout << "\n";
+}
+
+void clearMemory()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_memory.clear();
+}
+
+} // namespace ShaderCache
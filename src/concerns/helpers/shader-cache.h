@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================================
+// Persistent SPIR-V Shader Cache
+// ==================================
+// Content-addressed cache of compiled shaders, stored in "shader-cache/" next to the executable.
+// The key is a hash of the GLSL source, stage, entry point and preprocessor defines, so editing a
+// shader (or changing its defines) simply produces a new entry - nothing has to be invalidated by hand.
+//
+// Misses are compiled in-process through the glslang library when built with HAS_GLSLANG,
+// otherwise by running glslangValidator. Warm launches never spawn a process.
+//
+// Entry layout ("<key>.spv"):
+//   EntryHeader
+//   uint32_t spirv[wordCount]
+// Entries with a bad magic, version, key, size or SPIR-V magic number are recompiled and overwritten.
+//
+// Thread-safe: shaders may be requested from several threads at once (e.g. parallel pipeline creation).
+
+namespace ShaderCache
+{
+
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr char MAGIC[8] = {'V', 'N', 'T', 'S', 'P', 'I', 'R', 'V'};
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+// Directory name (created next to the executable, or in the working directory as a fallback)
+constexpr const char *CACHE_DIRECTORY = "shader-cache";
+
+struct EntryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t wordCount; // SPIR-V size in 32-bit words
+    uint64_t key;       // Must match the file name (guards against renamed / truncated files)
+};
+
+struct Stats
+{
+    size_t memoryHits = 0; // Served from the in-process map
+    size_t diskHits = 0;   // Loaded from the cache directory
+    size_t compiled = 0;   // Cache misses compiled this run
+    size_t processSpawns = 0;
+    size_t failures = 0;
+    double compileMs = 0.0; // Wall time spent compiling misses
+};
+
+// Cache key for a shader (FNV-1a over the format version, stage, entry point, defines and source)
+uint64_t computeKey(const std::string &glslSource,
+                    const std::string &shaderStage,
+                    const std::string &entryPoint,
+                    const std::vector<std::string> &defines);
+
+// Get SPIR-V for a shader, compiling and storing it on a miss
+// shaderStage: "vertex", "fragment" or "compute"
+// defines: "NAME" or "NAME=VALUE" entries, applied before the source is compiled
+// Returns an empty vector if compilation fails
+std::vector<uint32_t> getSpirv(const std::string &glslSource,
+                               const std::string &shaderStage,
+                               const std::string &entryPoint,
+                               const std::vector<std::string> &defines = {});
+
+// Cache directory next to the executable (falls back to the working directory), created on first use
+// Other compiled GPU state (e.g. the Vulkan pipeline cache) is stored here too
+std::string getCacheDirectory();
+
+// Counters since startup
+Stats getStats();
+
+// Print a one-line summary of the counters
+void printStats();
+
+// Drop the in-process map (the on-disk cache is kept)
+void clearMemory();
+
+} // namespace ShaderCache
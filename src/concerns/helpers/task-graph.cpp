@@ -0,0 +1,344 @@
+#include "task-graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+void TaskGraph::addStage(Stage stage)
+{
+    Node node;
+    node.stage = std::move(stage);
+    m_nodes.push_back(std::move(node));
+}
+
+bool TaskGraph::resolveDependencies()
+{
+    std::map<std::string, int> producers;
+    for (int i = 0; i < static_cast<int>(m_nodes.size()); i++)
+    {
+        for (const std::string &output : m_nodes[i].stage.outputs)
+        {
+            if (!producers.emplace(output, i).second)
+            {
+                std::cerr << "TaskGraph: '" << output << "' is produced by both '"
+                          << m_nodes[producers[output]].stage.name << "' and '" << m_nodes[i].stage.name << "'\n";
+                return false;
+            }
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(m_nodes.size()); i++)
+    {
+        Node &node = m_nodes[i];
+        node.dependencies.clear();
+        node.dependents.clear();
+        for (const std::string &input : node.stage.inputs)
+        {
+            auto producer = producers.find(input);
+            if (producer == producers.end())
+            {
+                std::cerr << "TaskGraph: stage '" << node.stage.name << "' reads '" << input
+                          << "', which no stage produces\n";
+                return false;
+            }
+            if (std::find(node.dependencies.begin(), node.dependencies.end(), producer->second) ==
+                node.dependencies.end())
+            {
+                node.dependencies.push_back(producer->second);
+            }
+        }
+    }
+    for (int i = 0; i < static_cast<int>(m_nodes.size()); i++)
+    {
+        for (int dependency : m_nodes[i].dependencies)
+        {
+            m_nodes[dependency].dependents.push_back(i);
+        }
+    }
+
+    // Kahn's algorithm: every stage must become ready eventually
+    std::vector<int> waiting(m_nodes.size());
+    std::vector<int> order;
+    for (int i = 0; i < static_cast<int>(m_nodes.size()); i++)
+    {
+        waiting[i] = static_cast<int>(m_nodes[i].dependencies.size());
+        if (waiting[i] == 0)
+        {
+            order.push_back(i);
+        }
+    }
+    for (size_t next = 0; next < order.size(); next++)
+    {
+        for (int dependent : m_nodes[order[next]].dependents)
+        {
+            if (--waiting[dependent] == 0)
+            {
+                order.push_back(dependent);
+            }
+        }
+    }
+    if (order.size() != m_nodes.size())
+    {
+        std::cerr << "TaskGraph: stage dependencies form a cycle\n";
+        return false;
+    }
+    m_order = order;
+
+    // Transitive dependent counts (reverse topological order), used as start priority
+    std::vector<std::vector<bool>> reachable(m_nodes.size(), std::vector<bool>(m_nodes.size(), false));
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        for (int dependent : m_nodes[*it].dependents)
+        {
+            reachable[*it][dependent] = true;
+            for (size_t j = 0; j < m_nodes.size(); j++)
+            {
+                if (reachable[dependent][j])
+                {
+                    reachable[*it][j] = true;
+                }
+            }
+        }
+        m_nodes[*it].descendants = static_cast<int>(std::count(reachable[*it].begin(), reachable[*it].end(), true));
+    }
+    return true;
+}
+
+bool TaskGraph::run(int maxConcurrentStages, size_t memoryBudgetBytes)
+{
+    if (!resolveDependencies())
+    {
+        return false;
+    }
+
+    const int maxRunning = std::max(1, maxConcurrentStages);
+    const auto startTime = std::chrono::steady_clock::now();
+    auto elapsed = [startTime]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
+    std::mutex mutex;
+    std::condition_variable stageFinished;
+    std::vector<std::thread> threads;
+    int running = 0;
+    size_t runningMemory = 0;
+    bool criticalFailure = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        // Start ready stages: most dependents first, then declaration order
+        while (!criticalFailure && running < maxRunning)
+        {
+            int next = -1;
+            for (int i = 0; i < static_cast<int>(m_nodes.size()); i++)
+            {
+                const Node &node = m_nodes[i];
+                if (node.state != State::Pending)
+                {
+                    continue;
+                }
+                bool ready = std::all_of(node.dependencies.begin(), node.dependencies.end(), [&](int dependency) {
+                    return m_nodes[dependency].state == State::Succeeded || m_nodes[dependency].state == State::Failed;
+                });
+                bool fits = running == 0 || runningMemory + node.stage.peakMemoryBytes <= memoryBudgetBytes;
+                if (ready && fits && (next < 0 || node.descendants > m_nodes[next].descendants))
+                {
+                    next = i;
+                }
+            }
+            if (next < 0)
+            {
+                break;
+            }
+
+            Node &node = m_nodes[next];
+            node.state = State::Running;
+            node.startSeconds = elapsed();
+            running++;
+            runningMemory += node.stage.peakMemoryBytes;
+            std::cout << "[stage] " << node.stage.name << " started\n";
+
+            threads.emplace_back([&, next]() {
+                Node &stageNode = m_nodes[next];
+                bool ok = false;
+                try
+                {
+                    ok = stageNode.stage.run && stageNode.stage.run();
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "[stage] " << stageNode.stage.name << " threw: " << e.what() << "\n";
+                }
+
+                std::lock_guard<std::mutex> guard(mutex);
+                stageNode.endSeconds = elapsed();
+                stageNode.state = ok ? State::Succeeded : State::Failed;
+                running--;
+                runningMemory -= stageNode.stage.peakMemoryBytes;
+                if (!ok && stageNode.stage.critical)
+                {
+                    criticalFailure = true;
+                }
+                char seconds[32];
+                std::snprintf(seconds, sizeof(seconds), "%.1fs", stageNode.endSeconds - stageNode.startSeconds);
+                std::cout << "[stage] " << stageNode.stage.name << (ok ? " finished" : " FAILED") << " after "
+                          << seconds << "\n";
+                stageFinished.notify_one();
+            });
+        }
+
+        if (running == 0)
+        {
+            break;
+        }
+        stageFinished.wait(lock);
+    }
+    lock.unlock();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    for (Node &node : m_nodes)
+    {
+        if (node.state == State::Pending)
+        {
+            node.state = State::Skipped;
+        }
+    }
+    m_wallSeconds = elapsed();
+    return !criticalFailure;
+}
+
+bool TaskGraph::succeeded(const std::string &name) const
+{
+    for (const Node &node : m_nodes)
+    {
+        if (node.stage.name == name)
+        {
+            return node.state == State::Succeeded;
+        }
+    }
+    return false;
+}
+
+void TaskGraph::printReport() const
+{
+    static const char *STATE_NAMES[] = {"pending", "running", "ok", "FAILED", "skipped"};
+
+    std::cout << "\n=== Preprocessing Stage Report ===\n";
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-22s %9s %9s  %s\n", "Stage", "Start", "Time", "Status");
+    std::cout << line;
+
+    double totalStageSeconds = 0.0;
+    for (const Node &node : m_nodes)
+    {
+        bool ran = node.state == State::Succeeded || node.state == State::Failed;
+        double duration = ran ? node.endSeconds - node.startSeconds : 0.0;
+        totalStageSeconds += duration;
+        std::snprintf(line,
+                      sizeof(line),
+                      "  %-22s %8.1fs %8.1fs  %s\n",
+                      node.stage.name.c_str(),
+                      ran ? node.startSeconds : 0.0,
+                      duration,
+                      STATE_NAMES[static_cast<int>(node.state)]);
+        std::cout << line;
+    }
+
+    // Longest chain of measured durations: chain[i] = duration(i) + max(chain[dependency])
+    std::vector<double> chain(m_nodes.size(), 0.0);
+    std::vector<int> previous(m_nodes.size(), -1);
+    for (int i : m_order)
+    {
+        const Node &node = m_nodes[i];
+        double longest = 0.0;
+        for (int dependency : node.dependencies)
+        {
+            if (previous[i] < 0 || chain[dependency] > longest)
+            {
+                longest = chain[dependency];
+                previous[i] = dependency;
+            }
+        }
+        bool ran = node.state == State::Succeeded || node.state == State::Failed;
+        chain[i] = longest + (ran ? node.endSeconds - node.startSeconds : 0.0);
+    }
+
+    int last = -1;
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        if (last < 0 || chain[i] > chain[last])
+        {
+            last = static_cast<int>(i);
+        }
+    }
+    if (last < 0)
+    {
+        return;
+    }
+
+    std::vector<int> path;
+    for (int i = last; i >= 0; i = previous[i])
+    {
+        path.push_back(i);
+    }
+    std::reverse(path.begin(), path.end());
+
+    std::snprintf(line,
+                  sizeof(line),
+                  "  Wall time %.1fs, stage time %.1fs, critical path %.1fs:\n   ",
+                  m_wallSeconds,
+                  totalStageSeconds,
+                  chain[last]);
+    std::cout << line;
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        const Node &node = m_nodes[path[i]];
+        bool ran = node.state == State::Succeeded || node.state == State::Failed;
+        std::snprintf(line,
+                      sizeof(line),
+                      "%s %s (%.1fs)",
+                      i == 0 ? "" : " ->",
+                      node.stage.name.c_str(),
+                      ran ? node.endSeconds - node.startSeconds : 0.0);
+        std::cout << line;
+    }
+    std::cout << "\n==================================\n";
+}
+
+size_t TaskGraph::physicalMemoryBytes()
+{
+#ifdef _WIN32
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+    {
+        return static_cast<size_t>(status.ullTotalPhys);
+    }
+    return 0;
+#else
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || pageSize <= 0)
+    {
+        return 0;
+    }
+    return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// ==================================
+// Stage Dependency Graph
+// ==================================
+// Runs a set of named stages, each declaring the artifacts it reads (inputs) and writes (outputs)
+// A stage starts once every producer of its inputs has finished, so independent stages run side by side
+// Stages that are running at the same time must fit in a shared memory budget: a stage only starts if its
+// estimated peak fits next to the stages already running (a stage that fits nowhere runs alone)
+// After run(), printReport() lists per-stage timings and the critical path through the graph
+class TaskGraph
+{
+public:
+    struct Stage
+    {
+        std::string name;
+        std::vector<std::string> inputs;  // Artifacts produced by other stages
+        std::vector<std::string> outputs; // Artifacts this stage produces
+        size_t peakMemoryBytes = 0;       // Estimated peak working set
+        bool critical = false;            // Failure stops stages that have not started yet
+        std::function<bool()> run;        // Returns false on failure
+    };
+
+    void addStage(Stage stage);
+
+    // Run all stages, at most maxConcurrentStages at a time within memoryBudgetBytes
+    // Dependents of a failed non-critical stage still run (preprocessors check their own inputs)
+    // Returns false if the graph is invalid (unknown input, duplicate output, cycle) or a critical stage failed
+    bool run(int maxConcurrentStages, size_t memoryBudgetBytes);
+
+    // Whether a stage ran and returned true
+    bool succeeded(const std::string &name) const;
+
+    // Per-stage start / duration table and the critical path (longest chain of measured durations)
+    void printReport() const;
+
+    // Installed physical memory, or 0 if it cannot be determined
+    static size_t physicalMemoryBytes();
+
+private:
+    enum class State
+    {
+        Pending,
+        Running,
+        Succeeded,
+        Failed,
+        Skipped
+    };
+
+    struct Node
+    {
+        Stage stage;
+        std::vector<int> dependencies; // Producers of this stage's inputs
+        std::vector<int> dependents;
+        int descendants = 0; // Stages (transitively) waiting on this one: higher starts first
+        State state = State::Pending;
+        double startSeconds = 0.0;
+        double endSeconds = 0.0;
+    };
+
+    bool resolveDependencies();
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_order; // Dependency (topological) order
+    double m_wallSeconds = 0.0;
+};
@@ -0,0 +1,287 @@
+#include "task-scheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr int64_t INITIAL_DEQUE_CAPACITY = 256;
+constexpr int IDLE_SPINS = 64; // Failed searches before a worker goes to sleep
+
+// Scheduler and deque index of the current thread, if it is a worker
+thread_local TaskScheduler *t_scheduler = nullptr;
+thread_local int t_workerIndex = -1;
+} // namespace
+
+// ==================================
+// Chase-Lev Deque
+// ==================================
+
+TaskScheduler::WorkDeque::WorkDeque()
+{
+    m_rings.push_back(std::make_unique<Ring>(INITIAL_DEQUE_CAPACITY));
+    m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+}
+
+TaskScheduler::WorkDeque::~WorkDeque() = default;
+
+void TaskScheduler::WorkDeque::push(Task *task)
+{
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const int64_t top = m_top.load(std::memory_order_acquire);
+    Ring *ring = m_ring.load(std::memory_order_relaxed);
+    if (bottom - top > ring->capacity - 1)
+    {
+        // Full: copy the live range into a ring twice the size (the old one stays readable for thieves)
+        auto grown = std::make_unique<Ring>(ring->capacity * 2);
+        for (int64_t i = top; i < bottom; i++)
+        {
+            grown->put(i, ring->get(i));
+        }
+        ring = grown.get();
+        m_rings.push_back(std::move(grown));
+        m_ring.store(ring, std::memory_order_release);
+    }
+    ring->put(bottom, task);
+    m_bottom.store(bottom + 1, std::memory_order_seq_cst); // Ordered before wakeWorker() reads m_sleeping
+}
+
+TaskScheduler::Task *TaskScheduler::WorkDeque::pop()
+{
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Ring *ring = m_ring.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    if (top > bottom)
+    {
+        // Empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Task *task = ring->get(bottom);
+    if (top == bottom)
+    {
+        // Last task: race thieves for it through top
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            task = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+TaskScheduler::Task *TaskScheduler::WorkDeque::steal()
+{
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+    if (top >= bottom)
+    {
+        return nullptr;
+    }
+
+    Ring *ring = m_ring.load(std::memory_order_acquire);
+    Task *task = ring->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr; // Lost the race to the owner or another thief
+    }
+    return task;
+}
+
+bool TaskScheduler::WorkDeque::empty() const
+{
+    return m_top.load(std::memory_order_seq_cst) >= m_bottom.load(std::memory_order_seq_cst);
+}
+
+// ==================================
+// Scheduler
+// ==================================
+
+TaskScheduler &TaskScheduler::shared()
+{
+    static TaskScheduler scheduler(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler(unsigned int workerCount)
+{
+    m_deques.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_deques.push_back(std::make_unique<WorkDeque>());
+    }
+    m_workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_wakeCondition.notify_all();
+    for (auto &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void TaskScheduler::submit(TaskGroup &group, std::function<void()> task)
+{
+    group.m_pending.fetch_add(1, std::memory_order_relaxed);
+    Task *queued = new Task{std::move(task), &group};
+
+    if (t_scheduler == this)
+    {
+        m_deques[t_workerIndex]->push(queued);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_inboxMutex);
+        m_inbox.push_back(queued);
+        m_inboxSize.fetch_add(1, std::memory_order_seq_cst);
+    }
+    wakeWorker();
+}
+
+void TaskScheduler::wait(TaskGroup &group)
+{
+    uint32_t randomState = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&group)) | 1u;
+    while (group.m_pending.load(std::memory_order_acquire) != 0)
+    {
+        Task *task = findTask(t_scheduler == this ? t_workerIndex : -1, randomState);
+        if (task)
+        {
+            runTask(task);
+        }
+        else
+        {
+            // The group's remaining tasks are running elsewhere
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskScheduler::workerLoop(unsigned int index)
+{
+    t_scheduler = this;
+    t_workerIndex = static_cast<int>(index);
+    uint32_t randomState = 2654435761u * (index + 1);
+    int idleSpins = 0;
+
+    while (true)
+    {
+        Task *task = findTask(t_workerIndex, randomState);
+        if (task)
+        {
+            runTask(task);
+            idleSpins = 0;
+            continue;
+        }
+        if (++idleSpins < IDLE_SPINS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Sleep until the next submit. Announce the sleep before the final check: a submit either sees
+        // the sleeper and bumps the epoch, or pushed its task before the check below finds it
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        const uint64_t epoch = m_wakeEpoch;
+        m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        if (!m_stop && !hasQueuedTasks())
+        {
+            m_wakeCondition.wait(lock, [&]() { return m_stop || m_wakeEpoch != epoch; });
+        }
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        if (m_stop)
+        {
+            return;
+        }
+        idleSpins = 0;
+    }
+}
+
+TaskScheduler::Task *TaskScheduler::findTask(int workerIndex, uint32_t &randomState)
+{
+    // 1. Own deque, newest first
+    if (workerIndex >= 0)
+    {
+        if (Task *task = m_deques[workerIndex]->pop())
+        {
+            return task;
+        }
+    }
+
+    // 2. Tasks submitted from outside the pool
+    if (m_inboxSize.load(std::memory_order_seq_cst) != 0)
+    {
+        std::lock_guard<std::mutex> lock(m_inboxMutex);
+        if (!m_inbox.empty())
+        {
+            Task *task = m_inbox.front();
+            m_inbox.pop_front();
+            m_inboxSize.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+
+    // 3. Steal the oldest task of another worker, starting from a random victim
+    const size_t dequeCount = m_deques.size();
+    if (dequeCount == 0)
+    {
+        return nullptr;
+    }
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    const size_t first = randomState % dequeCount;
+    for (size_t i = 0; i < dequeCount; i++)
+    {
+        const size_t victim = (first + i) % dequeCount;
+        if (static_cast<int>(victim) == workerIndex)
+        {
+            continue;
+        }
+        if (Task *task = m_deques[victim]->steal())
+        {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void TaskScheduler::runTask(Task *task)
+{
+    task->work();
+    TaskGroup *group = task->group;
+    delete task;
+    group->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool TaskScheduler::hasQueuedTasks() const
+{
+    if (m_inboxSize.load(std::memory_order_seq_cst) != 0)
+    {
+        return true;
+    }
+    return std::any_of(m_deques.begin(), m_deques.end(), [](const auto &deque) { return !deque->empty(); });
+}
+
+void TaskScheduler::wakeWorker()
+{
+    if (m_sleeping.load(std::memory_order_seq_cst) == 0)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wakeEpoch++;
+    }
+    m_wakeCondition.notify_one();
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==================================
+// Work-Stealing Task Scheduler
+// ==================================
+// One shared pool of worker threads, started on first use and kept for the life of the process, so submitting
+// work never creates a thread. Every worker owns a Chase-Lev deque: it pushes and pops its own tasks at the
+// bottom (newest first, cache-warm) while idle workers steal from the top of other deques (oldest first, which
+// in recursive splitting are the largest pieces). Tasks submitted from outside the pool go to a shared inbox.
+// A thread waiting on a TaskGroup runs queued tasks until the group is done, so nested fork-join never blocks
+// a worker and the waiting thread counts as one of the cores (the pool has hardware threads - 1 workers).
+// Tasks must not throw.
+class TaskScheduler
+{
+public:
+    // Set of submitted tasks that wait() waits for
+    class TaskGroup
+    {
+    public:
+        TaskGroup() = default;
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        // True when every submitted task has finished (for polling background work without blocking)
+        bool done() const
+        {
+            return m_pending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class TaskScheduler;
+        std::atomic<size_t> m_pending{0};
+    };
+
+    // The process-wide scheduler
+    static TaskScheduler &shared();
+
+    explicit TaskScheduler(unsigned int workerCount);
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    // Queue a task; it may run on any worker or on a thread waiting in wait()
+    void submit(TaskGroup &group, std::function<void()> task);
+
+    // Run queued tasks until every task of the group (including tasks they submitted to it) has finished
+    void wait(TaskGroup &group);
+
+    // Call body(begin, end) over disjoint ranges covering [0, count), at most `grain` items each, and wait
+    // The range is split in halves, so thieves take large pieces and only log(count / grain) tasks are queued
+    // before the first items run
+    template <typename Body> void parallelFor(size_t count, size_t grain, const Body &body)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        grain = grain > 0 ? grain : 1;
+        if (count <= grain || m_workers.empty())
+        {
+            body(size_t(0), count);
+            return;
+        }
+        TaskGroup group;
+        splitRange(group, 0, count, grain, body);
+        wait(group);
+    }
+
+    // Threads that can run tasks at the same time (workers plus the waiting thread)
+    unsigned int concurrency() const
+    {
+        return static_cast<unsigned int>(m_workers.size()) + 1;
+    }
+
+private:
+    struct Task
+    {
+        std::function<void()> work;
+        TaskGroup *group;
+    };
+
+    // Chase-Lev work-stealing deque (Chase & Lev 2005, with the C11 orderings of Le et al. 2013)
+    // push() and pop() are called by the owning worker only; steal() by any thread
+    class WorkDeque
+    {
+    public:
+        WorkDeque();
+        ~WorkDeque();
+        void push(Task *task);
+        Task *pop();
+        Task *steal();
+        bool empty() const;
+
+    private:
+        struct Ring
+        {
+            explicit Ring(int64_t capacity_) : capacity(capacity_), slots(new std::atomic<Task *>[capacity_])
+            {
+            }
+            Task *get(int64_t i) const
+            {
+                return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+            }
+            void put(int64_t i, Task *task)
+            {
+                slots[i & (capacity - 1)].store(task, std::memory_order_relaxed);
+            }
+            int64_t capacity; // Power of two
+            std::unique_ptr<std::atomic<Task *>[]> slots;
+        };
+
+        alignas(64) std::atomic<int64_t> m_top{0};
+        alignas(64) std::atomic<int64_t> m_bottom{0};
+        std::atomic<Ring *> m_ring;
+        std::vector<std::unique_ptr<Ring>> m_rings; // Every ring ever used: thieves may still read a retired one
+    };
+
+    template <typename Body> void splitRange(TaskGroup &group, size_t begin, size_t end, size_t grain, const Body &body)
+    {
+        // Hand the upper halves to other threads and keep splitting the lower half here
+        while (end - begin > grain)
+        {
+            const size_t middle = begin + (end - begin) / 2;
+            submit(group, [this, &group, middle, end, grain, &body]() { splitRange(group, middle, end, grain, body); });
+            end = middle;
+        }
+        body(begin, end);
+    }
+
+    void workerLoop(unsigned int index);
+    Task *findTask(int workerIndex, uint32_t &randomState);
+    void runTask(Task *task);
+    bool hasQueuedTasks() const;
+    void wakeWorker();
+
+    std::vector<std::unique_ptr<WorkDeque>> m_deques; // One per worker
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_inboxMutex; // Tasks submitted by threads outside the pool
+    std::deque<Task *> m_inbox;
+    std::atomic<size_t> m_inboxSize{0};
+
+    std::mutex m_sleepMutex; // Idle workers sleep until a submit bumps m_wakeEpoch
+    std::condition_variable m_wakeCondition;
+    std::atomic<int> m_sleeping{0};
+    uint64_t m_wakeEpoch = 0;
+    bool m_stop = false;
+};
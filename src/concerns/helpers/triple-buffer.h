@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// ==================================
+// Lock-free Triple Buffer
+// ==================================
+// Single producer / single consumer hand-off of whole values
+// The writer fills writeBuffer() and calls publish(); the reader calls readBuffer()
+// to get the most recently published value. Neither side ever blocks or waits,
+// and the reader's buffer stays valid until its next readBuffer() call.
+template <typename T> class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Writer side: buffer to fill before publish() (owned exclusively by the writer)
+    T &writeBuffer()
+    {
+        return m_buffers[m_writeIndex];
+    }
+
+    // Writer side: make writeBuffer() visible to the reader and take the spare buffer back
+    // The returned buffer may hold stale data from an older publish
+    void publish()
+    {
+        uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_writeIndex | FRESH_BIT), std::memory_order_acq_rel);
+        m_writeIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side: latest published buffer (or the previous one if nothing new was published)
+    const T &readBuffer()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & FRESH_BIT)
+        {
+            uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+            m_readIndex = previous & INDEX_MASK;
+        }
+        return m_buffers[m_readIndex];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    T m_buffers[3];
+    uint8_t m_writeIndex = 0;       // Touched only by the writer
+    uint8_t m_readIndex = 1;        // Touched only by the reader
+    std::atomic<uint8_t> m_middle{2}; // Spare buffer index, FRESH_BIT set when it holds a new publish
+};
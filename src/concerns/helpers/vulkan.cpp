@@ -3,17 +3,22 @@
 #include "../input-controller.h"
 #include "../ui-overlay.h"
 #include "../ui-primitives.h"
+#include "ktx2.h"
+#include "shader-cache.h"
 #include "shader-loader.h"
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 // stb_image for loading skybox textures (implementation defined elsewhere)
@@ -300,8 +305,15 @@ bool createLogicalDevice(VulkanContext &context)
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // Block-compressed textures are optional; without them the uncompressed grids are loaded
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(context.physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    // The screen shader writes hover, min distance and page requests from the fragment stage
+    deviceFeatures.fragmentStoresAndAtomics = supportedFeatures.fragmentStoresAndAtomics;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -326,6 +338,7 @@ bool createLogicalDevice(VulkanContext &context)
         std::cerr << "Failed to create logical device!" << "\n";
         return false;
     }
+    context.textureCompressionBC = deviceFeatures.textureCompressionBC != VK_FALSE;
 
     vkGetDeviceQueue(context.device, context.graphicsQueueFamily, 0, &context.graphicsQueue);
     vkGetDeviceQueue(context.device, context.presentQueueFamily, 0, &context.presentQueue);
@@ -578,152 +591,14 @@ bool createRenderPass(VulkanContext &context)
     return true;
 }
 
-// Get temporary directory path (with trailing separator)
-static std::string getTempDirectory()
-{
-#ifdef _WIN32
-    char tempPath[MAX_PATH];
-    DWORD result = GetTempPathA(MAX_PATH, tempPath);
-    if (result > 0 && result < MAX_PATH)
-    {
-        std::string path(tempPath);
-        // Ensure trailing backslash
-        if (!path.empty() && path.back() != '\\' && path.back() != '/')
-        {
-            path += '\\';
-        }
-        return path;
-    }
-    return std::string(".\\");
-#else
-    const char *tmpDir = std::getenv("TMPDIR");
-    if (tmpDir != nullptr)
-    {
-        std::string path(tmpDir);
-        if (!path.empty() && path.back() != '/')
-            path += '/';
-        return path;
-    }
-    tmpDir = std::getenv("TMP");
-    if (tmpDir != nullptr)
-    {
-        std::string path(tmpDir);
-        if (!path.empty() && path.back() != '/')
-            path += '/';
-        return path;
-    }
-    return std::string("/tmp/");
-#endif
-}
-
-// Generate deterministic filename based on shader source hash
-static std::string generateShaderFilename(const std::string &glslSource, const std::string &shaderStage)
-{
-    // Create hash of shader source + stage to ensure deterministic filename
-    std::hash<std::string> hasher;
-    size_t hash = hasher(glslSource + shaderStage);
-
-    // Convert hash to hex string for filename
-    std::stringstream ss;
-    ss << std::hex << hash;
-    std::string hashStr = ss.str();
-
-    return "vnt_shader_" + hashStr + "_" + shaderStage;
-}
-
-// Compile GLSL to SPIR-V using glslangValidator (writes to temp directory, always overwrites same file)
-// context: Vulkan context to track temp files for cleanup
-std::vector<uint32_t> compileGLSLToSPIRV(VulkanContext &context,
+// Compile GLSL to SPIR-V through the persistent shader cache (compiles and stores on a miss)
+std::vector<uint32_t> compileGLSLToSPIRV(VulkanContext & /*context*/,
                                          const std::string &glslSource,
                                          const std::string &shaderStage,
-                                         const std::string &entryPoint)
-{
-    // Map shader stage to glslangValidator stage name
-    std::string stageArg;
-    if (shaderStage == "vertex")
-        stageArg = "vert";
-    else if (shaderStage == "fragment")
-        stageArg = "frag";
-    else if (shaderStage == "compute")
-        stageArg = "comp";
-    else
-    {
-        std::cerr << "Unknown shader stage: " << shaderStage << "\n";
-        return {};
-    }
-
-    // Get temp directory
-    std::string tempDir = getTempDirectory();
-
-    // Generate deterministic filename based on shader content hash
-    // This ensures the same shader always uses the same temp file (overwrites previous)
-    std::string baseName = generateShaderFilename(glslSource, shaderStage);
-    std::string tempInputFile = tempDir + baseName + ".glsl";
-    std::string tempOutputFile = tempDir + baseName + ".spv";
-
-    // Write GLSL source to temp file
-    std::ofstream inputFile(tempInputFile);
-    if (!inputFile.is_open())
-    {
-        std::cerr << "Failed to create temporary shader file in " << tempDir << "\n";
-        return {};
-    }
-    inputFile << glslSource;
-    inputFile.close();
-
-    // Compile using glslangValidator
-    std::string command = "glslangValidator -V -S " + stageArg + " -e " + entryPoint + " -o \"" + tempOutputFile +
-                          "\" \"" + tempInputFile + "\"";
-
-    int result = system(command.c_str());
-
-    // Read SPIR-V binary
-    std::vector<uint32_t> spirv;
-    if (result == 0)
-    {
-        std::ifstream outputFile(tempOutputFile, std::ios::binary | std::ios::ate);
-        if (outputFile.is_open())
-        {
-            size_t fileSize = outputFile.tellg();
-            outputFile.seekg(0, std::ios::beg);
-            spirv.resize(fileSize / sizeof(uint32_t));
-            outputFile.read(reinterpret_cast<char *>(spirv.data()), static_cast<std::streamsize>(fileSize));
-            outputFile.close();
-        }
-    }
-    else
-    {
-        std::cerr << "Failed to compile shader using glslangValidator. Make sure glslangValidator is in your PATH."
-                  << "\n";
-        std::cerr << "Command: " << command << "\n";
-    }
-
-    // Track temp files for cleanup (only if compilation succeeded)
-    if (result == 0 && !spirv.empty())
-    {
-        // Add to tracking list if not already present (same shader might be compiled multiple times)
-        bool inputFound = false;
-        bool outputFound = false;
-        for (const auto &trackedFile : context.tempShaderFiles)
-        {
-            if (trackedFile == tempInputFile)
-                inputFound = true;
-            if (trackedFile == tempOutputFile)
-                outputFound = true;
-        }
-        if (!inputFound)
-            context.tempShaderFiles.push_back(tempInputFile);
-        if (!outputFound)
-            context.tempShaderFiles.push_back(tempOutputFile);
-    }
-    else
-    {
-        // Clean up temp files immediately if compilation failed
-        std::remove(tempInputFile.c_str());
-        std::remove(tempOutputFile.c_str());
-    }
-
-    return spirv;
+                                         const std::string &entryPoint,
+                                         const std::vector<std::string> &defines)
+{
+    return ShaderCache::getSpirv(glslSource, shaderStage, entryPoint, defines);
 }
 
 // Create shader module
@@ -779,6 +654,270 @@ void destroyShaderModule(VulkanContext &context, VulkanShader &shader)
     }
 }
 
+// ==================================
+// Pipeline Cache
+// ==================================
+
+// Our own prefix in front of the driver data, so truncated or foreign files are never handed to the driver
+struct PipelineCacheFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    uint64_t dataSize;
+    uint64_t dataHash; // FNV-1a of the driver data
+};
+
+constexpr char PIPELINE_CACHE_MAGIC[8] = {'V', 'N', 'T', 'P', 'S', 'O', 'C', 'H'};
+constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+// FNV-1a 64-bit
+static uint64_t hashPipelineCacheData(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string getPipelineCachePath()
+{
+    return ShaderCache::getCacheDirectory() + "/" + PIPELINE_CACHE_FILE;
+}
+
+// Read the cache file; returns the driver data only if it was written for this exact device and driver
+static std::vector<uint8_t> loadPipelineCacheData(const VkPhysicalDeviceProperties &properties)
+{
+    std::string path = getPipelineCachePath();
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return {};
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    PipelineCacheFileHeader header;
+    if (fileSize < sizeof(PipelineCacheFileHeader) ||
+        !file.read(reinterpret_cast<char *>(&header), sizeof(PipelineCacheFileHeader)))
+    {
+        std::cout << "Ignoring pipeline cache " << path << " (truncated header)" << "\n";
+        return {};
+    }
+
+    if (std::memcmp(header.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC)) != 0 ||
+        header.version != PIPELINE_CACHE_FILE_VERSION ||
+        fileSize != sizeof(PipelineCacheFileHeader) + header.dataSize)
+    {
+        std::cout << "Ignoring pipeline cache " << path << " (invalid file)" << "\n";
+        return {};
+    }
+
+    if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID ||
+        header.driverVersion != properties.driverVersion ||
+        std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        std::cout << "Ignoring pipeline cache " << path << " (different GPU or driver)" << "\n";
+        return {};
+    }
+
+    std::vector<uint8_t> data(static_cast<size_t>(header.dataSize));
+    if (!file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size())) ||
+        hashPipelineCacheData(data.data(), data.size()) != header.dataHash)
+    {
+        std::cout << "Ignoring pipeline cache " << path << " (corrupt data)" << "\n";
+        return {};
+    }
+
+    // The driver's own header (VkPipelineCacheHeaderVersionOne) must agree as well
+    VkPipelineCacheHeaderVersionOne driverHeader{};
+    if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+    {
+        return {};
+    }
+    std::memcpy(&driverHeader, data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+    if (driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        driverHeader.vendorID != properties.vendorID || driverHeader.deviceID != properties.deviceID ||
+        std::memcmp(driverHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        std::cout << "Ignoring pipeline cache " << path << " (driver header mismatch)" << "\n";
+        return {};
+    }
+
+    return data;
+}
+
+// Create pipeline cache (seeded from disk when valid for this device)
+bool createPipelineCache(VulkanContext &context)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physicalDevice, &properties);
+
+    std::vector<uint8_t> initialData = loadPipelineCacheData(properties);
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    if (vkCreatePipelineCache(context.device, &cacheInfo, nullptr, &context.pipelineCache) != VK_SUCCESS)
+    {
+        // Retry empty in case the driver rejected the stored data
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        initialData.clear();
+        if (vkCreatePipelineCache(context.device, &cacheInfo, nullptr, &context.pipelineCache) != VK_SUCCESS)
+        {
+            std::cerr << "Failed to create pipeline cache!" << "\n";
+            return false;
+        }
+    }
+
+    context.pipelineCacheLoadedBytes = initialData.size();
+    return true;
+}
+
+// Save pipeline cache to disk and destroy it
+void savePipelineCache(VulkanContext &context)
+{
+    if (context.pipelineCache == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    size_t dataSize = 0;
+    std::vector<uint8_t> data;
+    if (vkGetPipelineCacheData(context.device, context.pipelineCache, &dataSize, nullptr) == VK_SUCCESS && dataSize > 0)
+    {
+        data.resize(dataSize);
+        if (vkGetPipelineCacheData(context.device, context.pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+        {
+            data.clear();
+        }
+        data.resize(dataSize);
+    }
+
+    vkDestroyPipelineCache(context.device, context.pipelineCache, nullptr);
+    context.pipelineCache = VK_NULL_HANDLE;
+
+    if (data.empty())
+    {
+        return;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physicalDevice, &properties);
+
+    PipelineCacheFileHeader header;
+    std::memset(&header, 0, sizeof(PipelineCacheFileHeader));
+    std::memcpy(header.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC));
+    header.version = PIPELINE_CACHE_FILE_VERSION;
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = data.size();
+    header.dataHash = hashPipelineCacheData(data.data(), data.size());
+
+    // Write to a temp file and rename, so an interrupted save never leaves a half-written cache
+    std::string path = getPipelineCachePath();
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "Failed to open " << tempPath << " for writing" << "\n";
+            return;
+        }
+        out.write(reinterpret_cast<const char *>(&header), sizeof(PipelineCacheFileHeader));
+        out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!out)
+        {
+            std::cerr << "Failed to write pipeline cache " << tempPath << "\n";
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::cerr << "Failed to move " << tempPath << " into place: " << ec.message() << "\n";
+        std::remove(tempPath.c_str());
+    }
+}
+
+// Create screen and UI pipelines concurrently (they share nothing but the thread-safe pipeline
+// cache, device and shader cache) and report cold/warm startup timing
+bool createPipelines(VulkanContext &context)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct PipelineJob
+    {
+        const char *name;
+        bool (*create)(VulkanContext &);
+        bool success = false;
+        double milliseconds = 0.0;
+    };
+
+    std::array<PipelineJob, 2> jobs = {{{"Screen (subpass 0)", createGraphicsPipeline},
+                                        {"UI overlay (subpass 1)", createUIPipeline}}};
+
+    auto startTime = Clock::now();
+
+    std::vector<std::thread> workers;
+    workers.reserve(jobs.size());
+    for (auto &job : jobs)
+    {
+        workers.emplace_back([&context, &job]() {
+            auto jobStart = Clock::now();
+            job.success = job.create(context);
+            job.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - jobStart).count();
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    double wallMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+
+    std::cout << "=== Pipeline Startup Timing ===" << "\n";
+    if (context.pipelineCacheLoadedBytes > 0)
+    {
+        std::cout << "  Pipeline cache: warm (" << context.pipelineCacheLoadedBytes << " bytes loaded)" << "\n";
+    }
+    else
+    {
+        std::cout << "  Pipeline cache: cold" << "\n";
+    }
+
+    double serialMilliseconds = 0.0;
+    bool allSucceeded = true;
+    for (const auto &job : jobs)
+    {
+        std::cout << "  " << job.name << ": " << job.milliseconds << " ms" << (job.success ? "" : " (FAILED)")
+                  << "\n";
+        serialMilliseconds += job.milliseconds;
+        allSucceeded = allSucceeded && job.success;
+    }
+    std::cout << "  Total: " << wallMilliseconds << " ms wall (" << serialMilliseconds << " ms summed over "
+              << jobs.size() << " threads)" << "\n";
+    std::cout << "  ";
+    ShaderCache::printStats();
+    std::cout << "===============================" << "\n";
+
+    return allSucceeded;
+}
+
 // Create graphics pipeline
 bool createGraphicsPipeline(VulkanContext &context)
 {
@@ -979,8 +1118,12 @@ bool createGraphicsPipeline(VulkanContext &context)
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(context.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &context.screenPipeline) !=
-        VK_SUCCESS)
+    if (vkCreateGraphicsPipelines(context.device,
+                                  context.pipelineCache,
+                                  1,
+                                  &pipelineInfo,
+                                  nullptr,
+                                  &context.screenPipeline) != VK_SUCCESS)
     {
         std::cerr << "Failed to create graphics pipeline!" << "\n";
         vkDestroyPipelineLayout(context.device, context.pipelineLayout, nullptr);
@@ -1230,8 +1373,12 @@ bool createUIPipeline(VulkanContext &context)
     pipelineInfo.subpass = 1; // UI is in subpass 1
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(context.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &context.uiPipeline) !=
-        VK_SUCCESS)
+    if (vkCreateGraphicsPipelines(context.device,
+                                  context.pipelineCache,
+                                  1,
+                                  &pipelineInfo,
+                                  nullptr,
+                                  &context.uiPipeline) != VK_SUCCESS)
     {
         std::cerr << "Failed to create UI graphics pipeline!" << "\n";
         vkDestroyPipelineLayout(context.device, context.uiPipelineLayout, nullptr);
@@ -1296,7 +1443,8 @@ bool createFramebuffers(VulkanContext &context)
 // Create command buffers
 bool createCommandBuffers(VulkanContext &context)
 {
-    context.commandBuffers.resize(context.swapchainImages.size());
+    // One command buffer per frame in flight (re-recorded every frame, independent of swapchain image count)
+    context.commandBuffers.resize(VulkanContext::MAX_FRAMES_IN_FLIGHT);
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1319,6 +1467,7 @@ bool createSyncObjects(VulkanContext &context)
     context.imageAvailableSemaphores.resize(VulkanContext::MAX_FRAMES_IN_FLIGHT);
     context.renderFinishedSemaphores.resize(VulkanContext::MAX_FRAMES_IN_FLIGHT);
     context.inFlightFences.resize(VulkanContext::MAX_FRAMES_IN_FLIGHT);
+    context.imagesInFlight.assign(context.swapchainImages.size(), VK_NULL_HANDLE);
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -1389,13 +1538,13 @@ bool initVulkan(VulkanContext &context, VkSurfaceKHR surface, uint32_t width, ui
         return false;
     }
 
-    if (!createGraphicsPipeline(context))
+    if (!createPipelineCache(context))
     {
         cleanupVulkan(context);
         return false;
     }
 
-    if (!createUIPipeline(context))
+    if (!createPipelines(context))
     {
         cleanupVulkan(context);
         return false;
@@ -1547,26 +1696,24 @@ void cleanupVulkan(VulkanContext &context)
             destroyBuffer(context, context.testUIVertexBuffer);
         }
 
-        // Cleanup UI vertex buffer
-        if (context.uiVertexBuffer.buffer != VK_NULL_HANDLE)
-        {
-            destroyBuffer(context, context.uiVertexBuffer);
-        }
-
-        // Cleanup SSBO resources
-        if (context.uiStateSSBO.buffer != VK_NULL_HANDLE)
+        // Cleanup per-frame UI vertex buffers and SSBOs
+        for (auto &frame : context.frames)
         {
-            destroyBuffer(context, context.uiStateSSBO);
-        }
-
-        if (context.hoverOutputSSBO.buffer != VK_NULL_HANDLE)
-        {
-            destroyBuffer(context, context.hoverOutputSSBO);
-        }
-
-        if (context.celestialObjectsSSBO.buffer != VK_NULL_HANDLE)
-        {
-            destroyBuffer(context, context.celestialObjectsSSBO);
+            for (VulkanBuffer *buffer : {&frame.uiVertexBuffer,
+                                         &frame.uiStateSSBO,
+                                         &frame.hoverOutputSSBO,
+                                         &frame.celestialObjectsSSBO,
+                                         &frame.minDistanceSSBO,
+                                         &frame.pageTableSSBO,
+                                         &frame.pageFeedbackSSBO,
+                                         &frame.pageStagingBuffer})
+            {
+                if (buffer->buffer != VK_NULL_HANDLE)
+                {
+                    destroyBuffer(context, *buffer);
+                }
+            }
+            frame.ssboDescriptorSet = VK_NULL_HANDLE; // Freed with the pool below
         }
 
         // Cleanup skybox texture resources
@@ -1624,6 +1771,9 @@ void cleanupVulkan(VulkanContext &context)
             vkDestroySwapchainKHR(context.device, context.swapchain, nullptr);
         }
 
+        // Persist pipeline cache for the next launch
+        savePipelineCache(context);
+
         // Cleanup device
         vkDestroyDevice(context.device, nullptr);
         context.device = VK_NULL_HANDLE;
@@ -1654,13 +1804,6 @@ void cleanupVulkan(VulkanContext &context)
         vkDestroyInstance(context.instance, nullptr);
         context.instance = VK_NULL_HANDLE;
     }
-
-    // Cleanup temp shader files
-    for (const auto &tempFile : context.tempShaderFiles)
-    {
-        std::remove(tempFile.c_str());
-    }
-    context.tempShaderFiles.clear();
 }
 
 // Cleanup swapchain and framebuffers (for resize)
@@ -1704,16 +1847,6 @@ bool recreateSwapchain(VulkanContext &context, uint32_t width, uint32_t height)
     // Cleanup old swapchain
     cleanupSwapchain(context);
 
-    // Free old command buffers (they're tied to the old swapchain)
-    if (context.commandPool != VK_NULL_HANDLE && !context.commandBuffers.empty())
-    {
-        vkFreeCommandBuffers(context.device,
-                             context.commandPool,
-                             static_cast<uint32_t>(context.commandBuffers.size()),
-                             context.commandBuffers.data());
-        context.commandBuffers.clear();
-    }
-
     // Recreate swapchain
     if (!createSwapchain(context, width, height))
     {
@@ -1728,12 +1861,9 @@ bool recreateSwapchain(VulkanContext &context, uint32_t width, uint32_t height)
         return false;
     }
 
-    // Recreate command buffers (number may have changed)
-    if (!createCommandBuffers(context))
-    {
-        std::cerr << "Failed to recreate command buffers!" << "\n";
-        return false;
-    }
+    // Image count may have changed, and no frame is in flight on the new images yet
+    // (command buffers are per frame in flight, so they survive the swapchain)
+    context.imagesInFlight.assign(context.swapchainImages.size(), VK_NULL_HANDLE);
 
     return true;
 }
@@ -1763,17 +1893,29 @@ VkCommandBuffer beginFrame(VulkanContext &context)
         return VK_NULL_HANDLE;
     }
 
+    // The image may still be the target of an older frame in another slot (when the
+    // swapchain has more images than frames in flight, or images are returned out of order)
+    VkFence &imageFence = context.imagesInFlight[context.currentSwapchainImageIndex];
+    if (imageFence != VK_NULL_HANDLE && imageFence != context.inFlightFences[context.currentFrame])
+    {
+        vkWaitForFences(context.device, 1, &imageFence, VK_TRUE, UINT64_MAX);
+    }
+    imageFence = context.inFlightFences[context.currentFrame];
+
     // Reset fence
     vkResetFences(context.device, 1, &context.inFlightFences[context.currentFrame]);
 
-    // Begin command buffer
-    VkCommandBuffer cmd = context.commandBuffers[context.currentSwapchainImageIndex];
+    // Begin command buffer (owned by this frame slot, whose previous submission has completed)
+    VkCommandBuffer cmd = context.commandBuffers[context.currentFrame];
     vkResetCommandBuffer(cmd, 0);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     vkBeginCommandBuffer(cmd, &beginInfo);
 
+    // Streamed Earth texture pages must land in their caches before the scene samples them
+    recordVirtualTextureUploads(context, cmd);
+
     // Begin render pass
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1796,7 +1938,7 @@ void endFrame(VulkanContext &context)
 {
     // This will be called after vkCmdEndRenderPass in RenderFrame
     // Get the command buffer that was used
-    VkCommandBuffer cmd = context.commandBuffers[context.currentSwapchainImageIndex];
+    VkCommandBuffer cmd = context.commandBuffers[context.currentFrame];
 
     // End command buffer recording
     if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
@@ -1830,6 +1972,9 @@ void endFrame(VulkanContext &context)
         return;
     }
 
+    // This slot's hover / min distance outputs become readable once its fence signals
+    context.currentFrameResources().pendingReadbackFrame = ++context.frameNumber;
+
     // Present
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -1941,6 +2086,79 @@ void destroyBuffer(VulkanContext &context, VulkanBuffer &buffer)
     buffer.size = 0;
 }
 
+// Copy buffer regions
+void copyBufferRegions(VulkanContext &context, VkBuffer src, VkBuffer dst, const std::vector<VkBufferCopy> &regions)
+{
+    if (regions.empty() || src == VK_NULL_HANDLE || dst == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    VkCommandBuffer commandBuffer;
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = context.commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(context.device, &cmdAllocInfo, &commandBuffer) != VK_SUCCESS)
+    {
+        std::cerr << "Failed to allocate command buffer for buffer copy!" << "\n";
+        return;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // Earlier submissions may still read or write dst: make the copy wait for them
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    vkCmdCopyBuffer(commandBuffer, src, dst, static_cast<uint32_t>(regions.size()), regions.data());
+
+    // Make the copied data visible to vertex input and later transfers
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    // Submit and wait
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkQueueSubmit(context.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(context.graphicsQueue);
+
+    vkFreeCommandBuffers(context.device, context.commandPool, 1, &commandBuffer);
+}
+
 // ==================================
 // SSBO and Push Constants Implementation
 // ==================================
@@ -1948,9 +2166,10 @@ void destroyBuffer(VulkanContext &context, VulkanBuffer &buffer)
 // Create SSBO descriptor set layout for UIState, HoverOutput, CelestialObjects, Skybox, Earth textures, and MinDistance
 bool createSSBODescriptorSetLayout(VulkanContext &context)
 {
-    // Ten bindings: UIState (0), HoverOutput (1), CelestialObjects (2), SkyboxCubemap (3),
-    // EarthColor (4), EarthNormal (5), EarthNightlights (6), EarthSpecular (7), EarthHeightmap (8), MinDistance (9)
-    std::array<VkDescriptorSetLayoutBinding, 10> bindings{};
+    // Seventeen bindings: UIState (0), HoverOutput (1), CelestialObjects (2), SkyboxCubemap (3),
+    // EarthColor (4), EarthNormal (5), EarthNightlights (6), EarthSpecular (7), EarthHeightmap (8), MinDistance (9),
+    // VirtualTexturePageTable (10), VirtualTextureFeedback (11), Earth page caches (12-16)
+    std::array<VkDescriptorSetLayoutBinding, 17> bindings{};
 
     // Binding 0: UIState SSBO (read by vertex/fragment shaders)
     bindings[0].binding = 0;
@@ -2023,6 +2242,30 @@ bool createSSBODescriptorSetLayout(VulkanContext &context)
     bindings[9].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     bindings[9].pImmutableSamplers = nullptr;
 
+    // Binding 10: Virtual texture page table SSBO (read by fragment shader)
+    bindings[10].binding = 10;
+    bindings[10].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[10].descriptorCount = 1;
+    bindings[10].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[10].pImmutableSamplers = nullptr;
+
+    // Binding 11: Virtual texture feedback SSBO (fragment shader flags the pages it wanted)
+    bindings[11].binding = 11;
+    bindings[11].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[11].descriptorCount = 1;
+    bindings[11].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[11].pImmutableSamplers = nullptr;
+
+    // Bindings 12-16: Earth page caches (2D arrays), in VirtualTexture::Texture order
+    for (uint32_t i = 12; i <= 16; i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -2054,7 +2297,7 @@ struct MinDistanceOutput
 // Large float value for initializing min distance (represents "no terrain nearby")
 constexpr float MIN_DISTANCE_RESET_VALUE = 1000000.0f;
 
-// Create SSBO buffer and descriptor set
+// Create per-frame SSBO buffers and descriptor sets
 bool createSSBOResources(VulkanContext &context)
 {
     // Create descriptor set layout first
@@ -2063,22 +2306,24 @@ bool createSSBOResources(VulkanContext &context)
         return false;
     }
 
-    // Create descriptor pool (need 4 SSBOs + 6 combined image samplers for skybox + earth textures)
+    constexpr uint32_t FRAME_COUNT = VulkanContext::MAX_FRAMES_IN_FLIGHT;
+
+    // Create descriptor pool (per frame: 6 SSBOs + 11 combined image samplers for skybox + earth textures)
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
-    // Storage buffers: UIState + HoverOutput + CelestialObjects + MinDistance
+    // Storage buffers: UIState + HoverOutput + CelestialObjects + MinDistance + PageTable + PageFeedback
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[0].descriptorCount = 4;
+    poolSizes[0].descriptorCount = 6 * FRAME_COUNT;
 
-    // Combined image samplers: SkyboxCubemap (1) + Earth textures (5)
+    // Combined image samplers: SkyboxCubemap (1) + Earth cubemaps (5) + Earth page caches (5)
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = 6;
+    poolSizes[1].descriptorCount = 11 * FRAME_COUNT;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 1;
+    poolInfo.maxSets = FRAME_COUNT;
 
     if (vkCreateDescriptorPool(context.device, &poolInfo, nullptr, &context.ssboDescriptorPool) != VK_SUCCESS)
     {
@@ -2086,34 +2331,7 @@ bool createSSBOResources(VulkanContext &context)
         return false;
     }
 
-    // Create SSBO buffer for UIState (binding 0)
-    context.uiStateSSBO = createBuffer(context,
-                                       sizeof(UIState),
-                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                       nullptr);
-
-    if (context.uiStateSSBO.buffer == VK_NULL_HANDLE)
-    {
-        std::cerr << "Failed to create UIState SSBO buffer!" << "\n";
-        return false;
-    }
-
-    // Create SSBO buffer for HoverOutput (binding 1)
-    context.hoverOutputSSBO = createBuffer(context,
-                                           sizeof(HoverOutput),
-                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                           nullptr);
-
-    if (context.hoverOutputSSBO.buffer == VK_NULL_HANDLE)
-    {
-        std::cerr << "Failed to create HoverOutput SSBO buffer!" << "\n";
-        return false;
-    }
-
-    // Create SSBO buffer for CelestialObjects (binding 2)
-    // Size: 4 bytes (count) + MAX_CELESTIAL_OBJECTS * sizeof(CelestialObject)
+    // Size: 16 bytes (count + padding) + MAX_CELESTIAL_OBJECTS * sizeof(CelestialObject)
     // CelestialObject is 64 bytes (4 vec4s):
     //   position(12) + radius(4) + color(12) + naifId(4) +
     //   poleDirection(12) + padding(4) + primeMeridianDirection(12) + padding(4)
@@ -2122,169 +2340,220 @@ bool createSSBOResources(VulkanContext &context)
     constexpr size_t CELESTIAL_SSBO_SIZE =
         16 + MAX_CELESTIAL_OBJECTS * CELESTIAL_OBJECT_SIZE; // 16 byte header for count + padding
 
-    context.celestialObjectsSSBO =
-        createBuffer(context,
-                     CELESTIAL_SSBO_SIZE,
-                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     nullptr);
-
-    if (context.celestialObjectsSSBO.buffer == VK_NULL_HANDLE)
-    {
-        std::cerr << "Failed to create CelestialObjects SSBO buffer!" << "\n";
-        return false;
-    }
+    constexpr VkMemoryPropertyFlags HOST_MEMORY =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    // Page table sized for the largest page count VirtualTexture accepts
+    constexpr VkDeviceSize PAGE_TABLE_SSBO_SIZE =
+        sizeof(VirtualTexture::GpuPageTableHeader) + VirtualTexture::MAX_TOTAL_PAGES * sizeof(uint32_t);
+    constexpr VkDeviceSize PAGE_STAGING_SIZE =
+        static_cast<VkDeviceSize>(VirtualTexture::MAX_UPLOADS_PER_FRAME) * VirtualTexture::MAX_PAGE_BYTES;
+
+    for (uint32_t i = 0; i < FRAME_COUNT; i++)
+    {
+        FrameResources &frame = context.frames[i];
+
+        // UIState (binding 0), HoverOutput (binding 1), CelestialObjects (binding 2), MinDistance (binding 9)
+        frame.uiStateSSBO =
+            createBuffer(context, sizeof(UIState), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_MEMORY, nullptr);
+        frame.hoverOutputSSBO =
+            createBuffer(context, sizeof(HoverOutput), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_MEMORY, nullptr);
+        frame.celestialObjectsSSBO =
+            createBuffer(context, CELESTIAL_SSBO_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_MEMORY, nullptr);
+        frame.minDistanceSSBO =
+            createBuffer(context, sizeof(MinDistanceOutput), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_MEMORY, nullptr);
+
+
+        // Virtual texture page table (binding 10), feedback bitset (binding 11) and page staging
+        frame.pageTableSSBO =
+            createBuffer(context, PAGE_TABLE_SSBO_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_MEMORY, nullptr);
+        frame.pageFeedbackSSBO = createBuffer(context,
+                                              VirtualTexture::FEEDBACK_BYTES,
+                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                              HOST_MEMORY,
+                                              nullptr);
+        frame.pageStagingBuffer =
+            createBuffer(context, PAGE_STAGING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, HOST_MEMORY, nullptr);
+
+        if (frame.uiStateSSBO.buffer == VK_NULL_HANDLE || frame.hoverOutputSSBO.buffer == VK_NULL_HANDLE ||
+            frame.celestialObjectsSSBO.buffer == VK_NULL_HANDLE || frame.minDistanceSSBO.buffer == VK_NULL_HANDLE ||
+            frame.pageTableSSBO.buffer == VK_NULL_HANDLE || frame.pageFeedbackSSBO.buffer == VK_NULL_HANDLE ||
+            frame.pageStagingBuffer.buffer == VK_NULL_HANDLE)
+        {
+            std::cerr << "Failed to create SSBO buffers for frame " << i << "!" << "\n";
+            return false;
+        }
 
-    // Initialize celestial objects count to 0
-    context.celestialObjectCount = 0;
-    uint32_t zeroCount = 0;
-    void *mapped;
-    vkMapMemory(context.device, context.celestialObjectsSSBO.allocation, 0, sizeof(uint32_t), 0, &mapped);
-    std::memcpy(mapped, &zeroCount, sizeof(uint32_t));
-    vkUnmapMemory(context.device, context.celestialObjectsSSBO.allocation);
+        // Initialize celestial objects count to 0
+        frame.celestialObjectCount = 0;
+        uint32_t zeroCount = 0;
+        void *mapped;
+        vkMapMemory(context.device, frame.celestialObjectsSSBO.allocation, 0, sizeof(uint32_t), 0, &mapped);
+        std::memcpy(mapped, &zeroCount, sizeof(uint32_t));
+        vkUnmapMemory(context.device, frame.celestialObjectsSSBO.allocation);
+
+        // Page table starts out disabled (the shader samples the cubemaps), no pages requested
+        vkMapMemory(context.device, frame.pageTableSSBO.allocation, 0, VirtualTexture::getPageTableBytes(), 0, &mapped);
+        VirtualTexture::writePageTable(mapped);
+        vkUnmapMemory(context.device, frame.pageTableSSBO.allocation);
+        frame.pageTableVersion = VirtualTexture::getPageTableVersion();
+
+        vkMapMemory(context.device, frame.pageFeedbackSSBO.allocation, 0, VirtualTexture::FEEDBACK_BYTES, 0, &mapped);
+        std::memset(mapped, 0, VirtualTexture::FEEDBACK_BYTES);
+        vkUnmapMemory(context.device, frame.pageFeedbackSSBO.allocation);
+
+        // Allocate this frame's descriptor set
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = context.ssboDescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &context.ssboDescriptorSetLayout;
+
+        if (vkAllocateDescriptorSets(context.device, &allocInfo, &frame.ssboDescriptorSet) != VK_SUCCESS)
+        {
+            std::cerr << "Failed to allocate SSBO descriptor set for frame " << i << "!" << "\n";
+            return false;
+        }
 
-    // Create SSBO buffer for MinDistance (binding 9)
-    context.minDistanceSSBO = createBuffer(context,
-                                           sizeof(MinDistanceOutput),
-                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                           nullptr);
+        // Update descriptor set with all six SSBO bindings
+        std::array<VkDescriptorBufferInfo, 6> bufferInfos{};
+        bufferInfos[0] = {frame.uiStateSSBO.buffer, 0, sizeof(UIState)};
+        bufferInfos[1] = {frame.hoverOutputSSBO.buffer, 0, sizeof(HoverOutput)};
+        bufferInfos[2] = {frame.celestialObjectsSSBO.buffer, 0, CELESTIAL_SSBO_SIZE};
+        bufferInfos[3] = {frame.minDistanceSSBO.buffer, 0, sizeof(MinDistanceOutput)};
+        bufferInfos[4] = {frame.pageTableSSBO.buffer, 0, PAGE_TABLE_SSBO_SIZE};
+        bufferInfos[5] = {frame.pageFeedbackSSBO.buffer, 0, VirtualTexture::FEEDBACK_BYTES};
+        const uint32_t bindings[6] = {0, 1, 2, 9, 10, 11};
+
+        std::array<VkWriteDescriptorSet, 6> descriptorWrites{};
+        for (size_t w = 0; w < descriptorWrites.size(); w++)
+        {
+            descriptorWrites[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[w].dstSet = frame.ssboDescriptorSet;
+            descriptorWrites[w].dstBinding = bindings[w];
+            descriptorWrites[w].dstArrayElement = 0;
+            descriptorWrites[w].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[w].descriptorCount = 1;
+            descriptorWrites[w].pBufferInfo = &bufferInfos[w];
+        }
 
-    if (context.minDistanceSSBO.buffer == VK_NULL_HANDLE)
-    {
-        std::cerr << "Failed to create MinDistance SSBO buffer!" << "\n";
-        return false;
+        vkUpdateDescriptorSets(context.device,
+                               static_cast<uint32_t>(descriptorWrites.size()),
+                               descriptorWrites.data(),
+                               0,
+                               nullptr);
     }
 
-    // Allocate descriptor set
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = context.ssboDescriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &context.ssboDescriptorSetLayout;
-
-    if (vkAllocateDescriptorSets(context.device, &allocInfo, &context.ssboDescriptorSet) != VK_SUCCESS)
+    // Initialize every slot: UIState from AppState, HoverOutput to 0 (no hit), MinDistance to large value
+    for (uint32_t i = 0; i < FRAME_COUNT; i++)
     {
-        std::cerr << "Failed to allocate SSBO descriptor set!" << "\n";
-        return false;
+        context.currentFrame = i;
+        updateSSBOBuffer(context, APP_STATE.uiState);
+        resetHoverOutput(context);
+        resetMinDistanceOutput(context);
     }
+    context.currentFrame = 0;
 
-    // Update descriptor set with all four SSBO bindings
-    std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
-
-    // Binding 0: UIState
-    bufferInfos[0].buffer = context.uiStateSSBO.buffer;
-    bufferInfos[0].offset = 0;
-    bufferInfos[0].range = sizeof(UIState);
-
-    // Binding 1: HoverOutput
-    bufferInfos[1].buffer = context.hoverOutputSSBO.buffer;
-    bufferInfos[1].offset = 0;
-    bufferInfos[1].range = sizeof(HoverOutput);
-
-    // Binding 2: CelestialObjects
-    bufferInfos[2].buffer = context.celestialObjectsSSBO.buffer;
-    bufferInfos[2].offset = 0;
-    bufferInfos[2].range = CELESTIAL_SSBO_SIZE;
-
-    // Binding 9: MinDistance
-    bufferInfos[3].buffer = context.minDistanceSSBO.buffer;
-    bufferInfos[3].offset = 0;
-    bufferInfos[3].range = sizeof(MinDistanceOutput);
-
-    std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
-
-    // Write for binding 0 (UIState)
-    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[0].dstSet = context.ssboDescriptorSet;
-    descriptorWrites[0].dstBinding = 0;
-    descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    descriptorWrites[0].descriptorCount = 1;
-    descriptorWrites[0].pBufferInfo = &bufferInfos[0];
-
-    // Write for binding 1 (HoverOutput)
-    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[1].dstSet = context.ssboDescriptorSet;
-    descriptorWrites[1].dstBinding = 1;
-    descriptorWrites[1].dstArrayElement = 0;
-    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    descriptorWrites[1].descriptorCount = 1;
-    descriptorWrites[1].pBufferInfo = &bufferInfos[1];
-
-    // Write for binding 2 (CelestialObjects)
-    descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[2].dstSet = context.ssboDescriptorSet;
-    descriptorWrites[2].dstBinding = 2;
-    descriptorWrites[2].dstArrayElement = 0;
-    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    descriptorWrites[2].descriptorCount = 1;
-    descriptorWrites[2].pBufferInfo = &bufferInfos[2];
-
-    // Write for binding 9 (MinDistance)
-    descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[3].dstSet = context.ssboDescriptorSet;
-    descriptorWrites[3].dstBinding = 9;
-    descriptorWrites[3].dstArrayElement = 0;
-    descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    descriptorWrites[3].descriptorCount = 1;
-    descriptorWrites[3].pBufferInfo = &bufferInfos[3];
-
-    vkUpdateDescriptorSets(context.device,
-                           static_cast<uint32_t>(descriptorWrites.size()),
-                           descriptorWrites.data(),
-                           0,
-                           nullptr);
-
-    // Initialize UIState with default from AppState
-    updateSSBOBuffer(context, APP_STATE.uiState);
-
-    // Initialize HoverOutput to 0 (no hit)
-    resetHoverOutput(context);
-
-    // Initialize MinDistance to large value (no terrain nearby)
-    resetMinDistanceOutput(context);
-
-    std::cout << "SSBO resources created successfully (UIState: " << sizeof(UIState)
-              << " bytes, HoverOutput: " << sizeof(HoverOutput) << " bytes, CelestialObjects: " << CELESTIAL_SSBO_SIZE
-              << " bytes, MinDistance: " << sizeof(MinDistanceOutput) << " bytes)" << "\n";
+    std::cout << "SSBO resources created successfully for " << FRAME_COUNT
+              << " frames in flight (UIState: " << sizeof(UIState) << " bytes, HoverOutput: " << sizeof(HoverOutput)
+              << " bytes, CelestialObjects: " << CELESTIAL_SSBO_SIZE
+              << " bytes, MinDistance: " << sizeof(MinDistanceOutput) << " bytes, PageTable: " << PAGE_TABLE_SSBO_SIZE
+              << " bytes)" << "\n";
     return true;
 }
 
 // Update SSBO buffer with current UIState
 void updateSSBOBuffer(VulkanContext &context, const UIState &state)
 {
-    if (context.uiStateSSBO.buffer == VK_NULL_HANDLE)
+    FrameResources &frame = context.currentFrameResources();
+    if (frame.uiStateSSBO.buffer == VK_NULL_HANDLE)
     {
         return;
     }
 
     void *mapped;
-    vkMapMemory(context.device, context.uiStateSSBO.allocation, 0, sizeof(UIState), 0, &mapped);
+    vkMapMemory(context.device, frame.uiStateSSBO.allocation, 0, sizeof(UIState), 0, &mapped);
     std::memcpy(mapped, &state, sizeof(UIState));
-    vkUnmapMemory(context.device, context.uiStateSSBO.allocation);
+    vkUnmapMemory(context.device, frame.uiStateSSBO.allocation);
 }
 
-// Read hover output from SSBO (returns material ID at mouse position, 0 = no hit)
-uint32_t readHoverOutput(VulkanContext &context)
+// Copy a completed slot's hover and min distance outputs into context.readback
+static void harvestReadback(VulkanContext &context, FrameResources &frame)
 {
-    if (context.hoverOutputSSBO.buffer == VK_NULL_HANDLE)
+    uint64_t frameNumber = frame.pendingReadbackFrame;
+    frame.pendingReadbackFrame = 0;
+
+    // Slots can complete out of order relative to our polling, keep the newest
+    if (frameNumber <= context.readback.frameNumber || frame.hoverOutputSSBO.buffer == VK_NULL_HANDLE ||
+        frame.minDistanceSSBO.buffer == VK_NULL_HANDLE)
     {
-        return 0;
+        return;
+    }
+
+    void *mapped;
+    vkMapMemory(context.device, frame.hoverOutputSSBO.allocation, 0, sizeof(HoverOutput), 0, &mapped);
+    uint32_t hoverMaterialID = reinterpret_cast<HoverOutput *>(mapped)->hitMaterialID;
+    vkUnmapMemory(context.device, frame.hoverOutputSSBO.allocation);
+
+    vkMapMemory(context.device, frame.minDistanceSSBO.allocation, 0, sizeof(MinDistanceOutput), 0, &mapped);
+    uint32_t bits = reinterpret_cast<MinDistanceOutput *>(mapped)->minDistanceBits;
+    vkUnmapMemory(context.device, frame.minDistanceSSBO.allocation);
+
+    // Convert bits back to float (shader stores float as bits for atomic operations)
+    float minDistance;
+    std::memcpy(&minDistance, &bits, sizeof(float));
+
+    context.readback.frameNumber = frameNumber;
+    context.readback.hoverMaterialID = hoverMaterialID;
+    context.readback.minSurfaceDistance = minDistance;
+}
+
+// Hand a completed slot's page requests to VirtualTexture and clear them for the slot's next frame
+// Unlike hover / min distance, every frame's requests are used, not just the newest
+static void harvestVirtualTextureFeedback(VulkanContext &context, FrameResources &frame)
+{
+    if (frame.pageFeedbackSSBO.buffer == VK_NULL_HANDLE)
+    {
+        return;
     }
 
     void *mapped;
-    vkMapMemory(context.device, context.hoverOutputSSBO.allocation, 0, sizeof(HoverOutput), 0, &mapped);
-    uint32_t result = reinterpret_cast<HoverOutput *>(mapped)->hitMaterialID;
-    vkUnmapMemory(context.device, context.hoverOutputSSBO.allocation);
+    vkMapMemory(context.device, frame.pageFeedbackSSBO.allocation, 0, VirtualTexture::FEEDBACK_BYTES, 0, &mapped);
+    if (VirtualTexture::isOpen())
+    {
+        VirtualTexture::processFeedback(static_cast<const uint32_t *>(mapped));
+    }
+    std::memset(mapped, 0, VirtualTexture::FEEDBACK_BYTES);
+    vkUnmapMemory(context.device, frame.pageFeedbackSSBO.allocation);
+}
+
+// Read back every slot whose fence has signalled (non-blocking)
+void pollReadbacks(VulkanContext &context)
+{
+    for (uint32_t i = 0; i < VulkanContext::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        FrameResources &frame = context.frames[i];
+        if (frame.pendingReadbackFrame != 0 &&
+            vkGetFenceStatus(context.device, context.inFlightFences[i]) == VK_SUCCESS)
+        {
+            harvestVirtualTextureFeedback(context, frame);
+            harvestReadback(context, frame);
+        }
+    }
+}
 
-    return result;
+// Hover output of the most recent completed frame (0 = no hit)
+uint32_t readHoverOutput(VulkanContext &context)
+{
+    pollReadbacks(context);
+    return context.readback.hoverMaterialID;
 }
 
 // Reset hover output SSBO to 0 (call before rendering)
 void resetHoverOutput(VulkanContext &context)
 {
-    if (context.hoverOutputSSBO.buffer == VK_NULL_HANDLE)
+    FrameResources &frame = context.currentFrameResources();
+    if (frame.hoverOutputSSBO.buffer == VK_NULL_HANDLE)
     {
         return;
     }
@@ -2293,34 +2562,23 @@ void resetHoverOutput(VulkanContext &context)
     reset.hitMaterialID = 0;
 
     void *mapped;
-    vkMapMemory(context.device, context.hoverOutputSSBO.allocation, 0, sizeof(HoverOutput), 0, &mapped);
+    vkMapMemory(context.device, frame.hoverOutputSSBO.allocation, 0, sizeof(HoverOutput), 0, &mapped);
     std::memcpy(mapped, &reset, sizeof(HoverOutput));
-    vkUnmapMemory(context.device, context.hoverOutputSSBO.allocation);
+    vkUnmapMemory(context.device, frame.hoverOutputSSBO.allocation);
 }
 
-// Read minimum surface distance from SSBO (for camera collision detection)
+// Minimum surface distance of the most recent completed frame (for camera collision detection)
 float readMinSurfaceDistance(VulkanContext &context)
 {
-    if (context.minDistanceSSBO.buffer == VK_NULL_HANDLE)
-    {
-        return MIN_DISTANCE_RESET_VALUE;
-    }
-
-    void *mapped;
-    vkMapMemory(context.device, context.minDistanceSSBO.allocation, 0, sizeof(MinDistanceOutput), 0, &mapped);
-    uint32_t bits = reinterpret_cast<MinDistanceOutput *>(mapped)->minDistanceBits;
-    vkUnmapMemory(context.device, context.minDistanceSSBO.allocation);
-
-    // Convert bits back to float (shader stores float as bits for atomic operations)
-    float result;
-    std::memcpy(&result, &bits, sizeof(float));
-    return result;
+    pollReadbacks(context);
+    return context.readback.minSurfaceDistance;
 }
 
 // Reset min distance SSBO to large value (call before rendering)
 void resetMinDistanceOutput(VulkanContext &context)
 {
-    if (context.minDistanceSSBO.buffer == VK_NULL_HANDLE)
+    FrameResources &frame = context.currentFrameResources();
+    if (frame.minDistanceSSBO.buffer == VK_NULL_HANDLE)
     {
         return;
     }
@@ -2330,9 +2588,49 @@ void resetMinDistanceOutput(VulkanContext &context)
     std::memcpy(&reset.minDistanceBits, &MIN_DISTANCE_RESET_VALUE, sizeof(float));
 
     void *mapped;
-    vkMapMemory(context.device, context.minDistanceSSBO.allocation, 0, sizeof(MinDistanceOutput), 0, &mapped);
+    vkMapMemory(context.device, frame.minDistanceSSBO.allocation, 0, sizeof(MinDistanceOutput), 0, &mapped);
     std::memcpy(mapped, &reset, sizeof(MinDistanceOutput));
-    vkUnmapMemory(context.device, context.minDistanceSSBO.allocation);
+    vkUnmapMemory(context.device, frame.minDistanceSSBO.allocation);
+}
+
+// Stage newly loaded pages in the current slot and bring its page table up to date
+// The table already points at the staged pages' layers; beginFrame copies them in before the render pass
+void updateVirtualTextures(VulkanContext &context)
+{
+    FrameResources &frame = context.currentFrameResources();
+    if (frame.pageTableSSBO.buffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // Pages still staged from a frame that never began (swapchain out of date) go first
+    if (VirtualTexture::isOpen() && context.virtualTexturesReady && frame.pageCopies.empty())
+    {
+        std::vector<VirtualTexture::PageUpload> uploads =
+            VirtualTexture::takeUploads(VirtualTexture::MAX_UPLOADS_PER_FRAME);
+        if (!uploads.empty())
+        {
+            void *mapped;
+            vkMapMemory(context.device, frame.pageStagingBuffer.allocation, 0, VK_WHOLE_SIZE, 0, &mapped);
+            for (size_t i = 0; i < uploads.size(); i++)
+            {
+                VkDeviceSize offset = static_cast<VkDeviceSize>(i) * VirtualTexture::MAX_PAGE_BYTES;
+                std::memcpy(static_cast<uint8_t *>(mapped) + offset, uploads[i].data.data(), uploads[i].data.size());
+                frame.pageCopies.push_back({uploads[i].texture, uploads[i].layer, offset});
+            }
+            vkUnmapMemory(context.device, frame.pageStagingBuffer.allocation);
+        }
+    }
+
+    uint64_t version = VirtualTexture::getPageTableVersion();
+    if (frame.pageTableVersion != version)
+    {
+        void *mapped;
+        vkMapMemory(context.device, frame.pageTableSSBO.allocation, 0, VirtualTexture::getPageTableBytes(), 0, &mapped);
+        VirtualTexture::writePageTable(mapped);
+        vkUnmapMemory(context.device, frame.pageTableSSBO.allocation);
+        frame.pageTableVersion = version;
+    }
 }
 
 // Wait for the current frame's fence (ensures previous frame's GPU work is complete)
@@ -2472,7 +2770,8 @@ void updateCelestialObjectsSSBO(VulkanContext &context,
                                 const glm::mat4 &projMatrix,
                                 int32_t selectedNaifId)
 {
-    if (context.celestialObjectsSSBO.buffer == VK_NULL_HANDLE)
+    FrameResources &frame = context.currentFrameResources();
+    if (frame.celestialObjectsSSBO.buffer == VK_NULL_HANDLE)
     {
         return;
     }
@@ -2523,7 +2822,7 @@ void updateCelestialObjectsSSBO(VulkanContext &context,
     size_t dataSize = HEADER_SIZE + objectCount * CELESTIAL_OBJECT_SIZE;
 
     void *mapped;
-    vkMapMemory(context.device, context.celestialObjectsSSBO.allocation, 0, dataSize, 0, &mapped);
+    vkMapMemory(context.device, frame.celestialObjectsSSBO.allocation, 0, dataSize, 0, &mapped);
 
     // Write header
     auto *header = reinterpret_cast<uint32_t *>(mapped);
@@ -2566,8 +2865,8 @@ void updateCelestialObjectsSSBO(VulkanContext &context,
         objectData[offset + 15] = 0.0f; // padding
     }
 
-    vkUnmapMemory(context.device, context.celestialObjectsSSBO.allocation);
-    context.celestialObjectCount = objectCount;
+    vkUnmapMemory(context.device, frame.celestialObjectsSSBO.allocation);
+    frame.celestialObjectCount = objectCount;
 }
 
 // Helper function to convert screen-space coordinates to NDC
@@ -2607,21 +2906,22 @@ void AddUIVertex(float x, float y, float r, float g, float b, float a)
 uint32_t EndUIVertexBuffer(VulkanContext &context)
 {
     g_buildingUIVertices = false;
+    FrameResources &frame = context.currentFrameResources();
 
     if (g_uiVertexBuilder.empty())
     {
-        context.uiVertexCount = 0;
+        frame.uiVertexCount = 0;
         return 0;
     }
 
     // Create or update vertex buffer
     VkDeviceSize bufferSize = g_uiVertexBuilder.size() * sizeof(UIVertex);
-    if (context.uiVertexBuffer.buffer == VK_NULL_HANDLE || context.uiVertexBufferSize < bufferSize)
+    if (frame.uiVertexBuffer.buffer == VK_NULL_HANDLE || frame.uiVertexBufferSize < bufferSize)
     {
         // Destroy old buffer if it exists
-        if (context.uiVertexBuffer.buffer != VK_NULL_HANDLE)
+        if (frame.uiVertexBuffer.buffer != VK_NULL_HANDLE)
         {
-            destroyBuffer(context, context.uiVertexBuffer);
+            destroyBuffer(context, frame.uiVertexBuffer);
         }
 
         // Create new buffer (round up to reasonable size for dynamic updates)
@@ -2629,34 +2929,34 @@ uint32_t EndUIVertexBuffer(VulkanContext &context)
         VkDeviceSize minSize = VkDeviceSize(256 * 1024); // At least 256KB for UI
         VkDeviceSize allocSize = bufferSize > minSize ? bufferSize : minSize;
         // Create buffer without data first, then copy only the actual data size
-        context.uiVertexBuffer =
+        frame.uiVertexBuffer =
             createBuffer(context,
                          allocSize,
                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                          nullptr); // Don't copy data during creation
-        context.uiVertexBufferSize = allocSize;
+        frame.uiVertexBufferSize = allocSize;
 
         // Copy only the actual vertex data
-        if (context.uiVertexBuffer.buffer != VK_NULL_HANDLE)
+        if (frame.uiVertexBuffer.buffer != VK_NULL_HANDLE)
         {
             void *mapped;
-            vkMapMemory(context.device, context.uiVertexBuffer.allocation, 0, bufferSize, 0, &mapped);
+            vkMapMemory(context.device, frame.uiVertexBuffer.allocation, 0, bufferSize, 0, &mapped);
             std::memcpy(mapped, g_uiVertexBuilder.data(), static_cast<size_t>(bufferSize));
-            vkUnmapMemory(context.device, context.uiVertexBuffer.allocation);
+            vkUnmapMemory(context.device, frame.uiVertexBuffer.allocation);
         }
     }
     else
     {
         // Update existing buffer
         void *mapped;
-        vkMapMemory(context.device, context.uiVertexBuffer.allocation, 0, bufferSize, 0, &mapped);
+        vkMapMemory(context.device, frame.uiVertexBuffer.allocation, 0, bufferSize, 0, &mapped);
         std::memcpy(mapped, g_uiVertexBuilder.data(), static_cast<size_t>(bufferSize));
-        vkUnmapMemory(context.device, context.uiVertexBuffer.allocation);
+        vkUnmapMemory(context.device, frame.uiVertexBuffer.allocation);
     }
 
-    context.uiVertexCount = static_cast<uint32_t>(g_uiVertexBuilder.size());
-    return context.uiVertexCount;
+    frame.uiVertexCount = static_cast<uint32_t>(g_uiVertexBuilder.size());
+    return frame.uiVertexCount;
 }
 
 // Build UI vertex buffer from UI rendering calls
@@ -2947,7 +3247,7 @@ bool loadSkyboxTexture(VulkanContext &context, const std::string &filepath)
 // Update skybox descriptor set binding (call after loading texture)
 void updateSkyboxDescriptorSet(VulkanContext &context)
 {
-    if (!context.skyboxTextureReady || context.ssboDescriptorSet == VK_NULL_HANDLE)
+    if (!context.skyboxTextureReady || context.frames[0].ssboDescriptorSet == VK_NULL_HANDLE)
     {
         return;
     }
@@ -2959,14 +3259,18 @@ void updateSkyboxDescriptorSet(VulkanContext &context)
 
     VkWriteDescriptorSet descriptorWrite{};
     descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrite.dstSet = context.ssboDescriptorSet;
     descriptorWrite.dstBinding = 3;
     descriptorWrite.dstArrayElement = 0;
     descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     descriptorWrite.descriptorCount = 1;
     descriptorWrite.pImageInfo = &imageInfo;
 
-    vkUpdateDescriptorSets(context.device, 1, &descriptorWrite, 0, nullptr);
+    // Same texture in every frame's descriptor set
+    for (auto &frame : context.frames)
+    {
+        descriptorWrite.dstSet = frame.ssboDescriptorSet;
+        vkUpdateDescriptorSets(context.device, 1, &descriptorWrite, 0, nullptr);
+    }
     std::cout << "Skybox descriptor set updated" << "\n";
 }
 
@@ -3236,115 +3540,122 @@ static bool loadTextureHelper(VulkanContext &context,
     return true;
 }
 
-// Helper function to load a vertical strip cubemap into native Vulkan cubemap (6 array layers)
-// The input file must be a vertical strip with height = 6 * width (6 faces stacked)
-// Face order: +X, -X, +Y, -Y, +Z, -Z (matches Vulkan VK_IMAGE_VIEW_TYPE_CUBE)
-// Returns true on success, outputs to image, imageMemory, imageView, sampler
-static bool loadCubemapTextureHelper(VulkanContext &context,
-                                     const std::string &filepath,
-                                     VkImage &image,
-                                     VkDeviceMemory &imageMemory,
-                                     VkImageView &imageView,
-                                     VkSampler &sampler,
-                                     bool isHDR = false)
+// True if images of this format can be sampled with linear filtering (optimal tiling)
+static bool supportsSampledFormat(VulkanContext &context, VkFormat format)
 {
-    // Check if file exists
-    std::ifstream file(filepath);
-    if (!file.good())
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(context.physicalDevice, format, &formatProperties);
+    VkFormatFeatureFlags requiredFeatures =
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+// Helper function to upload a mipmapped, block-compressed KTX2 cubemap (see Ktx2 / PreprocessCompressedTextures)
+// Every level of every face is copied straight from the mapped file - nothing is decoded on the CPU
+// Returns false (with no resources left behind) if the file or its format can't be used, so callers can fall back
+static bool loadCompressedCubemapHelper(VulkanContext &context,
+                                        const std::string &ktxPath,
+                                        VkImage &image,
+                                        VkDeviceMemory &imageMemory,
+                                        VkImageView &imageView,
+                                        VkSampler &sampler)
+{
+    Ktx2::Cubemap cubemap;
+    if (!Ktx2::openCubemap(ktxPath, cubemap))
     {
-        std::cerr << "Cubemap texture file not found: " << filepath << "\n";
         return false;
     }
-    file.close();
-
-    // Load image using stb_image
-    int width, height, channels;
-    void *pixelData = nullptr;
-    VkFormat format;
-    size_t bytesPerPixel;
 
-    if (isHDR)
-    {
-        float *hdrData = stbi_loadf(filepath.c_str(), &width, &height, &channels, 4);
-        if (!hdrData)
-        {
-            std::cerr << "Failed to load HDR cubemap texture: " << filepath << "\n";
-            return false;
-        }
-        pixelData = hdrData;
-        format = VK_FORMAT_R32G32B32A32_SFLOAT;
-        bytesPerPixel = 4 * sizeof(float);
-    }
-    else
+    VkFormat format = static_cast<VkFormat>(cubemap.vkFormat);
+    if (format != VK_FORMAT_BC4_UNORM_BLOCK && format != VK_FORMAT_BC5_UNORM_BLOCK &&
+        format != VK_FORMAT_BC6H_UFLOAT_BLOCK && format != VK_FORMAT_BC7_UNORM_BLOCK)
     {
-        unsigned char *imgData = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
-        if (!imgData)
-        {
-            std::cerr << "Failed to load cubemap texture: " << filepath << "\n";
-            return false;
-        }
-        pixelData = imgData;
-        format = VK_FORMAT_R8G8B8A8_UNORM;
-        bytesPerPixel = 4;
+        std::cerr << "Unsupported KTX2 format " << cubemap.vkFormat << " in: " << ktxPath << "\n";
+        return false;
     }
 
-    // Validate cubemap dimensions (3x2 grid: width = 1.5 * height, width divisible by 3)
-    if (width != height * 3 / 2 || width % 3 != 0)
+    if (!supportsSampledFormat(context, format))
     {
-        std::cerr << "Invalid cubemap dimensions: " << width << "x" << height
-                  << " (expected 3x2 grid: width = height * 1.5, width divisible by 3)\n";
-        stbi_image_free(pixelData);
+        std::cerr << "KTX2 format " << cubemap.vkFormat << " not sampleable on this device: " << ktxPath << "\n";
         return false;
     }
 
-    int faceSize = width / 3; // Each face is faceSize x faceSize
-    int gridWidth = width;
-    int gridHeight = height;
-    VkDeviceSize totalImageSize = static_cast<VkDeviceSize>(gridWidth) * gridHeight * bytesPerPixel;
+    uint32_t levelCount = static_cast<uint32_t>(cubemap.levels.size());
+    VkDeviceSize totalImageSize = 0;
+    for (const auto &level : cubemap.levels)
+    {
+        totalImageSize += level.byteLength;
+    }
 
-    std::cout << "Loading native cubemap: " << filepath << " (grid: " << gridWidth << "x" << gridHeight
-              << ", face size: " << faceSize << "x" << faceSize << ", " << (isHDR ? "HDR" : "LDR") << ")\n";
+    std::cout << "Loading compressed cubemap: " << ktxPath << " (face size: " << cubemap.width << "x"
+              << cubemap.height << ", " << levelCount << " mip levels, " << totalImageSize / (1024.0 * 1024.0)
+              << " MB)\n";
 
-    // Create staging buffer for all 6 faces
+    // Staging buffer holds all levels back to back, largest first
     VulkanBuffer stagingBuffer =
         createBuffer(context,
                      totalImageSize,
                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-    // Copy pixel data to staging buffer (3x2 grid layout)
+    std::vector<VkBufferImageCopy> copyRegions;
+    copyRegions.reserve(static_cast<size_t>(levelCount) * 6);
+
     void *mapped;
     vkMapMemory(context.device, stagingBuffer.allocation, 0, totalImageSize, 0, &mapped);
-    std::memcpy(mapped, pixelData, totalImageSize);
-    vkUnmapMemory(context.device, stagingBuffer.allocation);
+    VkDeviceSize levelOffset = 0;
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        VkDeviceSize levelBytes = cubemap.levels[level].byteLength;
+        std::memcpy(static_cast<uint8_t *>(mapped) + levelOffset, cubemap.levelData(level), levelBytes);
 
-    stbi_image_free(pixelData);
+        // Faces are stored back to back within a level (+X -X +Y -Y +Z -Z), tightly packed
+        VkDeviceSize faceBytes = levelBytes / 6;
+        uint32_t levelWidth = std::max(1u, cubemap.width >> level);
+        uint32_t levelHeight = std::max(1u, cubemap.height >> level);
+        for (uint32_t face = 0; face < 6; face++)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset = levelOffset + face * faceBytes;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = face;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {levelWidth, levelHeight, 1};
+            copyRegions.push_back(region);
+        }
+        levelOffset += levelBytes;
+    }
+    vkUnmapMemory(context.device, stagingBuffer.allocation);
 
-    // Create cubemap image with CUBE_COMPATIBLE flag and 6 array layers
+    // Create cubemap image with the full mip chain
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageInfo.extent.width = static_cast<uint32_t>(faceSize);
-    imageInfo.extent.height = static_cast<uint32_t>(faceSize);
+    imageInfo.extent.width = cubemap.width;
+    imageInfo.extent.height = cubemap.height;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 6; // 6 faces for cubemap
+    imageInfo.mipLevels = levelCount;
+    imageInfo.arrayLayers = 6;
     imageInfo.format = format;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-    imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT; // Enable cubemap
+    imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 
     if (vkCreateImage(context.device, &imageInfo, nullptr, &image) != VK_SUCCESS)
     {
-        std::cerr << "Failed to create cubemap image for: " << filepath << "\n";
+        std::cerr << "Failed to create compressed cubemap image for: " << ktxPath << "\n";
+        image = VK_NULL_HANDLE;
         destroyBuffer(context, stagingBuffer);
         return false;
     }
 
-    // Allocate memory for image
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(context.device, image, &memRequirements);
 
@@ -3357,15 +3668,16 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
     if (allocInfo.memoryTypeIndex == UINT32_MAX ||
         vkAllocateMemory(context.device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
     {
-        std::cerr << "Failed to allocate cubemap image memory for: " << filepath << "\n";
+        std::cerr << "Failed to allocate compressed cubemap memory for: " << ktxPath << "\n";
         vkDestroyImage(context.device, image, nullptr);
+        image = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
         destroyBuffer(context, stagingBuffer);
         return false;
     }
 
     vkBindImageMemory(context.device, image, imageMemory, 0);
 
-    // Transition image layout and copy data
     VkCommandBuffer commandBuffer;
     VkCommandBufferAllocateInfo cmdAllocInfo{};
     cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -3380,7 +3692,7 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-    // Transition all 6 layers to transfer dst
+    // Transition all levels of all 6 layers to transfer dst
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -3390,9 +3702,9 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = levelCount;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 6; // All 6 faces
+    barrier.subresourceRange.layerCount = 6;
     barrier.srcAccessMask = 0;
     barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
@@ -3407,33 +3719,6 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
                          1,
                          &barrier);
 
-    // Copy each face from staging buffer to its array layer
-    // Faces are stored in 3x2 grid: +X -X +Y (row 0), -Y +Z -Z (row 1)
-    // Face grid positions: 0=(0,0), 1=(1,0), 2=(2,0), 3=(0,1), 4=(1,1), 5=(2,1)
-    static const int faceCol[6] = {0, 1, 2, 0, 1, 2};
-    static const int faceRow[6] = {0, 0, 0, 1, 1, 1};
-
-    std::vector<VkBufferImageCopy> copyRegions(6);
-    for (uint32_t face = 0; face < 6; face++)
-    {
-        int col = faceCol[face];
-        int row = faceRow[face];
-        // Buffer offset to the start of this face's data in the grid
-        VkDeviceSize faceOffset =
-            (static_cast<VkDeviceSize>(row) * faceSize * gridWidth + static_cast<VkDeviceSize>(col) * faceSize) *
-            bytesPerPixel;
-
-        copyRegions[face].bufferOffset = faceOffset;
-        copyRegions[face].bufferRowLength = static_cast<uint32_t>(gridWidth); // Full grid width for row stride
-        copyRegions[face].bufferImageHeight = static_cast<uint32_t>(faceSize);
-        copyRegions[face].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copyRegions[face].imageSubresource.mipLevel = 0;
-        copyRegions[face].imageSubresource.baseArrayLayer = face;
-        copyRegions[face].imageSubresource.layerCount = 1;
-        copyRegions[face].imageOffset = {0, 0, 0};
-        copyRegions[face].imageExtent = {static_cast<uint32_t>(faceSize), static_cast<uint32_t>(faceSize), 1};
-    }
-
     vkCmdCopyBufferToImage(commandBuffer,
                            stagingBuffer.buffer,
                            image,
@@ -3441,7 +3726,6 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
                            static_cast<uint32_t>(copyRegions.size()),
                            copyRegions.data());
 
-    // Transition to shader read
     barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -3460,7 +3744,6 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
 
     vkEndCommandBuffer(commandBuffer);
 
-    // Submit and wait
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.commandBufferCount = 1;
@@ -3472,25 +3755,29 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
     vkFreeCommandBuffers(context.device, context.commandPool, 1, &commandBuffer);
     destroyBuffer(context, stagingBuffer);
 
-    // Create cubemap image view
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE; // Native cubemap view
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = levelCount;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 6; // All 6 faces
+    viewInfo.subresourceRange.layerCount = 6;
 
     if (vkCreateImageView(context.device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
     {
-        std::cerr << "Failed to create cubemap image view for: " << filepath << "\n";
+        std::cerr << "Failed to create compressed cubemap image view for: " << ktxPath << "\n";
+        vkDestroyImage(context.device, image, nullptr);
+        vkFreeMemory(context.device, imageMemory, nullptr);
+        image = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
+        imageView = VK_NULL_HANDLE;
         return false;
     }
 
-    // Create sampler with seamless cubemap filtering
+    // Same filtering as the uncompressed path, but trilinear across the whole chain
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -3507,47 +3794,538 @@ static bool loadCubemapTextureHelper(VulkanContext &context,
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(levelCount);
 
     if (vkCreateSampler(context.device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
     {
-        std::cerr << "Failed to create cubemap sampler for: " << filepath << "\n";
+        std::cerr << "Failed to create compressed cubemap sampler for: " << ktxPath << "\n";
+        vkDestroyImageView(context.device, imageView, nullptr);
+        vkDestroyImage(context.device, image, nullptr);
+        vkFreeMemory(context.device, imageMemory, nullptr);
+        image = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
+        imageView = VK_NULL_HANDLE;
+        sampler = VK_NULL_HANDLE;
         return false;
     }
 
     return true;
 }
 
-// Load Earth material textures for NAIF ID 399
-// Now uses native Vulkan cubemaps for hardware-accelerated sampling
-bool loadEarthTextures(VulkanContext &context,
-                       const std::string &basePath,
-                       const std::string &resolutionFolder,
-                       int currentMonth)
+// Helper function to load a vertical strip cubemap into native Vulkan cubemap (6 array layers)
+// Uses "<stem>.ktx2" instead when it exists and is not older than filepath
+// The input file must be a vertical strip with height = 6 * width (6 faces stacked)
+// Face order: +X, -X, +Y, -Y, +Z, -Z (matches Vulkan VK_IMAGE_VIEW_TYPE_CUBE)
+// Returns true on success, outputs to image, imageMemory, imageView, sampler
+static bool loadCubemapTextureHelper(VulkanContext &context,
+                                     const std::string &filepath,
+                                     VkImage &image,
+                                     VkDeviceMemory &imageMemory,
+                                     VkImageView &imageView,
+                                     VkSampler &sampler,
+                                     bool isHDR = false)
 {
-    // Clean up any existing Earth textures first
-    cleanupEarthTextures(context);
-
-    bool allLoaded = true;
-    std::string resFolderPath = basePath + "/" + resolutionFolder;
-
-    // Load Earth color texture (monthly Blue Marble) - Binding 4
-    // Month is 1-12, texture files are earth_month_01.png, earth_month_02.png, etc.
-    // Now loaded as native cubemap (vertical strip format)
-    char monthStr[3];
-    std::snprintf(monthStr, sizeof(monthStr), "%02d", currentMonth);
-    std::string colorPath = resFolderPath + "/earth_month_" + monthStr + ".png";
-
-    // Try PNG first, then JPG
-    if (!std::ifstream(colorPath).good())
+    // Prefer the mipmapped, block-compressed KTX2 written by preprocessing when it is current
+    if (context.textureCompressionBC && Ktx2::isUpToDate(filepath) &&
+        loadCompressedCubemapHelper(context, Ktx2::pathFor(filepath), image, imageMemory, imageView, sampler))
     {
-        colorPath = resFolderPath + "/earth_month_" + monthStr + ".jpg";
+        return true;
     }
 
-    if (!loadCubemapTextureHelper(context,
-                                  colorPath,
-                                  context.earthColorImage,
-                                  context.earthColorImageMemory,
+    // Check if file exists
+    std::ifstream file(filepath);
+    if (!file.good())
+    {
+        std::cerr << "Cubemap texture file not found: " << filepath << "\n";
+        return false;
+    }
+    file.close();
+
+    // Load image using stb_image
+    int width, height, channels;
+    void *pixelData = nullptr;
+    VkFormat format;
+    size_t bytesPerPixel;
+
+    if (isHDR)
+    {
+        float *hdrData = stbi_loadf(filepath.c_str(), &width, &height, &channels, 4);
+        if (!hdrData)
+        {
+            std::cerr << "Failed to load HDR cubemap texture: " << filepath << "\n";
+            return false;
+        }
+        pixelData = hdrData;
+        format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        bytesPerPixel = 4 * sizeof(float);
+    }
+    else
+    {
+        unsigned char *imgData = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
+        if (!imgData)
+        {
+            std::cerr << "Failed to load cubemap texture: " << filepath << "\n";
+            return false;
+        }
+        pixelData = imgData;
+        format = VK_FORMAT_R8G8B8A8_UNORM;
+        bytesPerPixel = 4;
+    }
+
+    // Validate cubemap dimensions (3x2 grid: width = 1.5 * height, width divisible by 3)
+    if (width != height * 3 / 2 || width % 3 != 0)
+    {
+        std::cerr << "Invalid cubemap dimensions: " << width << "x" << height
+                  << " (expected 3x2 grid: width = height * 1.5, width divisible by 3)\n";
+        stbi_image_free(pixelData);
+        return false;
+    }
+
+    int faceSize = width / 3; // Each face is faceSize x faceSize
+    int gridWidth = width;
+    int gridHeight = height;
+    VkDeviceSize totalImageSize = static_cast<VkDeviceSize>(gridWidth) * gridHeight * bytesPerPixel;
+
+    std::cout << "Loading native cubemap: " << filepath << " (grid: " << gridWidth << "x" << gridHeight
+              << ", face size: " << faceSize << "x" << faceSize << ", " << (isHDR ? "HDR" : "LDR") << ")\n";
+
+    // Create staging buffer for all 6 faces
+    VulkanBuffer stagingBuffer =
+        createBuffer(context,
+                     totalImageSize,
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    // Copy pixel data to staging buffer (3x2 grid layout)
+    void *mapped;
+    vkMapMemory(context.device, stagingBuffer.allocation, 0, totalImageSize, 0, &mapped);
+    std::memcpy(mapped, pixelData, totalImageSize);
+    vkUnmapMemory(context.device, stagingBuffer.allocation);
+
+    stbi_image_free(pixelData);
+
+    // Create cubemap image with CUBE_COMPATIBLE flag and 6 array layers
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = static_cast<uint32_t>(faceSize);
+    imageInfo.extent.height = static_cast<uint32_t>(faceSize);
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 6; // 6 faces for cubemap
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT; // Enable cubemap
+
+    if (vkCreateImage(context.device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        std::cerr << "Failed to create cubemap image for: " << filepath << "\n";
+        destroyBuffer(context, stagingBuffer);
+        return false;
+    }
+
+    // Allocate memory for image
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(context.device, image, &memRequirements);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex =
+        findImageMemoryType(context, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (allocInfo.memoryTypeIndex == UINT32_MAX ||
+        vkAllocateMemory(context.device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+    {
+        std::cerr << "Failed to allocate cubemap image memory for: " << filepath << "\n";
+        vkDestroyImage(context.device, image, nullptr);
+        destroyBuffer(context, stagingBuffer);
+        return false;
+    }
+
+    vkBindImageMemory(context.device, image, imageMemory, 0);
+
+    // Transition image layout and copy data
+    VkCommandBuffer commandBuffer;
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = context.commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    vkAllocateCommandBuffers(context.device, &cmdAllocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // Transition all 6 layers to transfer dst
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 6; // All 6 faces
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    // Copy each face from staging buffer to its array layer
+    // Faces are stored in 3x2 grid: +X -X +Y (row 0), -Y +Z -Z (row 1)
+    // Face grid positions: 0=(0,0), 1=(1,0), 2=(2,0), 3=(0,1), 4=(1,1), 5=(2,1)
+    static const int faceCol[6] = {0, 1, 2, 0, 1, 2};
+    static const int faceRow[6] = {0, 0, 0, 1, 1, 1};
+
+    std::vector<VkBufferImageCopy> copyRegions(6);
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        int col = faceCol[face];
+        int row = faceRow[face];
+        // Buffer offset to the start of this face's data in the grid
+        VkDeviceSize faceOffset =
+            (static_cast<VkDeviceSize>(row) * faceSize * gridWidth + static_cast<VkDeviceSize>(col) * faceSize) *
+            bytesPerPixel;
+
+        copyRegions[face].bufferOffset = faceOffset;
+        copyRegions[face].bufferRowLength = static_cast<uint32_t>(gridWidth); // Full grid width for row stride
+        copyRegions[face].bufferImageHeight = static_cast<uint32_t>(faceSize);
+        copyRegions[face].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegions[face].imageSubresource.mipLevel = 0;
+        copyRegions[face].imageSubresource.baseArrayLayer = face;
+        copyRegions[face].imageSubresource.layerCount = 1;
+        copyRegions[face].imageOffset = {0, 0, 0};
+        copyRegions[face].imageExtent = {static_cast<uint32_t>(faceSize), static_cast<uint32_t>(faceSize), 1};
+    }
+
+    vkCmdCopyBufferToImage(commandBuffer,
+                           stagingBuffer.buffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(copyRegions.size()),
+                           copyRegions.data());
+
+    // Transition to shader read
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    // Submit and wait
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkQueueSubmit(context.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(context.graphicsQueue);
+
+    vkFreeCommandBuffers(context.device, context.commandPool, 1, &commandBuffer);
+    destroyBuffer(context, stagingBuffer);
+
+    // Create cubemap image view
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE; // Native cubemap view
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 6; // All 6 faces
+
+    if (vkCreateImageView(context.device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+    {
+        std::cerr << "Failed to create cubemap image view for: " << filepath << "\n";
+        return false;
+    }
+
+    // Create sampler with seamless cubemap filtering
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = 16.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(context.device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+    {
+        std::cerr << "Failed to create cubemap sampler for: " << filepath << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Create a single-level sampled image with one or more layers, left in SHADER_READ_ONLY layout
+// Contents are undefined: used for the virtual texture page caches (filled by page uploads)
+// and for the placeholders bound to whichever Earth bindings the shader won't sample
+static bool createLayeredImageHelper(VulkanContext &context,
+                                     VkFormat format,
+                                     uint32_t size,
+                                     uint32_t layerCount,
+                                     VkImageViewType viewType,
+                                     VkImage &image,
+                                     VkDeviceMemory &imageMemory,
+                                     VkImageView &imageView,
+                                     VkSampler &sampler)
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = size;
+    imageInfo.extent.height = size;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = layerCount;
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.flags = (viewType == VK_IMAGE_VIEW_TYPE_CUBE) ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+
+    if (vkCreateImage(context.device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        image = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(context.device, image, &memRequirements);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex =
+        findImageMemoryType(context, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (allocInfo.memoryTypeIndex == UINT32_MAX ||
+        vkAllocateMemory(context.device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+    {
+        vkDestroyImage(context.device, image, nullptr);
+        image = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkBindImageMemory(context.device, image, imageMemory, 0);
+
+    VkCommandBuffer commandBuffer;
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = context.commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    vkAllocateCommandBuffers(context.device, &cmdAllocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // Page uploads expect every layer in SHADER_READ_ONLY layout between frames
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = layerCount;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkQueueSubmit(context.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(context.graphicsQueue);
+
+    vkFreeCommandBuffers(context.device, context.commandPool, 1, &commandBuffer);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = viewType;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = layerCount;
+
+    if (vkCreateImageView(context.device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+    {
+        vkDestroyImage(context.device, image, nullptr);
+        vkFreeMemory(context.device, imageMemory, nullptr);
+        image = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
+        imageView = VK_NULL_HANDLE;
+        return false;
+    }
+
+    // Pages carry their own filter border; the shader picks the level, so no mipmaps or anisotropy
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(context.device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+    {
+        vkDestroyImageView(context.device, imageView, nullptr);
+        vkDestroyImage(context.device, image, nullptr);
+        vkFreeMemory(context.device, imageMemory, nullptr);
+        image = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
+        imageView = VK_NULL_HANDLE;
+        sampler = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+// Load Earth material textures for NAIF ID 399
+// Now uses native Vulkan cubemaps for hardware-accelerated sampling
+bool loadEarthTextures(VulkanContext &context,
+                       const std::string &basePath,
+                       const std::string &resolutionFolder,
+                       int currentMonth)
+{
+    // Clean up any existing Earth textures first
+    cleanupEarthTextures(context);
+
+    bool allLoaded = true;
+    std::string resFolderPath = basePath + "/" + resolutionFolder;
+
+    char monthStr[3];
+    std::snprintf(monthStr, sizeof(monthStr), "%02d", currentMonth);
+
+    // High/Ultra preprocessing also writes page files; stream those when all five exist
+    // (page data is BC-compressed, so this needs the same device support as the KTX2 path)
+    if (context.textureCompressionBC)
+    {
+        std::array<std::string, VirtualTexture::TEXTURE_COUNT> pagePaths;
+        pagePaths[VirtualTexture::COLOR] = resFolderPath + "/earth_month_" + monthStr + VirtualTexture::FILE_EXTENSION;
+        pagePaths[VirtualTexture::NORMAL] = resFolderPath + "/earth_landmass_normal" + VirtualTexture::FILE_EXTENSION;
+        pagePaths[VirtualTexture::NIGHTLIGHTS] = resFolderPath + "/earth_nightlights" + VirtualTexture::FILE_EXTENSION;
+        pagePaths[VirtualTexture::SPECULAR] = resFolderPath + "/earth_specular" + VirtualTexture::FILE_EXTENSION;
+        pagePaths[VirtualTexture::HEIGHTMAP] = resFolderPath + "/earth_elevation" + VirtualTexture::FILE_EXTENSION;
+        if (!std::ifstream(pagePaths[VirtualTexture::HEIGHTMAP]).good())
+        {
+            pagePaths[VirtualTexture::HEIGHTMAP] =
+                resFolderPath + "/earth_landmass_heightmap" + VirtualTexture::FILE_EXTENSION;
+        }
+
+        bool allPagesPresent = true;
+        for (const auto &pagePath : pagePaths)
+        {
+            allPagesPresent = allPagesPresent && std::ifstream(pagePath).good();
+        }
+
+        if (allPagesPresent && loadEarthVirtualTextures(context, pagePaths))
+        {
+            context.earthTexturesReady = true;
+            std::cout << "Earth virtual textures loaded successfully (NAIF ID 399)\n";
+            return true;
+        }
+    }
+
+    // Load Earth color texture (monthly Blue Marble) - Binding 4
+    // Month is 1-12, texture files are earth_month_01.png, earth_month_02.png, etc.
+    // Now loaded as native cubemap (vertical strip format)
+    std::string colorPath = resFolderPath + "/earth_month_" + monthStr + ".png";
+
+    // Try PNG first, then JPG
+    if (!std::ifstream(colorPath).good())
+    {
+        colorPath = resFolderPath + "/earth_month_" + monthStr + ".jpg";
+    }
+
+    if (!loadCubemapTextureHelper(context,
+                                  colorPath,
+                                  context.earthColorImage,
+                                  context.earthColorImageMemory,
                                   context.earthColorImageView,
                                   context.earthColorSampler,
                                   false)) // LDR
@@ -3631,6 +4409,23 @@ bool loadEarthTextures(VulkanContext &context,
         std::cout << "Loaded HDR elevation cubemap: earth_elevation.hdr\n";
     }
 
+    // The page cache bindings (12-16) still need something bound; the shader never samples them
+    for (auto &cache : context.virtualTextureCaches)
+    {
+        if (!createLayeredImageHelper(context,
+                                      VK_FORMAT_R8G8B8A8_UNORM,
+                                      1,
+                                      1,
+                                      VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                                      cache.image,
+                                      cache.memory,
+                                      cache.view,
+                                      cache.sampler))
+        {
+            std::cerr << "Failed to create Earth page cache placeholder\n";
+        }
+    }
+
     // Mark as ready if at least the color texture loaded
     context.earthTexturesReady = (context.earthColorImage != VK_NULL_HANDLE);
 
@@ -3645,14 +4440,14 @@ bool loadEarthTextures(VulkanContext &context,
 // Update Earth texture descriptor set bindings (call after loading textures)
 void updateEarthDescriptorSet(VulkanContext &context)
 {
-    if (context.ssboDescriptorSet == VK_NULL_HANDLE)
+    if (context.frames[0].ssboDescriptorSet == VK_NULL_HANDLE)
     {
         return;
     }
 
     std::vector<VkWriteDescriptorSet> writes;
-    std::vector<VkDescriptorImageInfo> imageInfos(
-        5); // Store image infos to keep them alive (Color, Normal, Nightlights, Specular, Heightmap)
+    // Store image infos to keep them alive (Color, Normal, Nightlights, Specular, Heightmap, then their page caches)
+    std::vector<VkDescriptorImageInfo> imageInfos(5 + VirtualTexture::TEXTURE_COUNT);
 
     // Binding 4: Earth Color texture
     if (context.earthColorImage != VK_NULL_HANDLE)
@@ -3663,7 +4458,6 @@ void updateEarthDescriptorSet(VulkanContext &context)
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = context.ssboDescriptorSet;
         write.dstBinding = 4;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -3681,7 +4475,6 @@ void updateEarthDescriptorSet(VulkanContext &context)
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = context.ssboDescriptorSet;
         write.dstBinding = 5;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -3699,7 +4492,6 @@ void updateEarthDescriptorSet(VulkanContext &context)
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = context.ssboDescriptorSet;
         write.dstBinding = 6;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -3717,7 +4509,6 @@ void updateEarthDescriptorSet(VulkanContext &context)
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = context.ssboDescriptorSet;
         write.dstBinding = 7;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -3735,7 +4526,6 @@ void updateEarthDescriptorSet(VulkanContext &context)
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = context.ssboDescriptorSet;
         write.dstBinding = 8;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -3744,9 +4534,40 @@ void updateEarthDescriptorSet(VulkanContext &context)
         writes.push_back(write);
     }
 
+    // Bindings 12-16: Earth page caches (real caches or placeholders, see VulkanContext)
+    for (uint32_t i = 0; i < VirtualTexture::TEXTURE_COUNT; i++)
+    {
+        const VirtualTextureCache &cache = context.virtualTextureCaches[i];
+        if (cache.image == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+
+        imageInfos[5 + i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[5 + i].imageView = cache.view;
+        imageInfos[5 + i].sampler = cache.sampler;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstBinding = 12 + i;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.descriptorCount = 1;
+        write.pImageInfo = &imageInfos[5 + i];
+        writes.push_back(write);
+    }
+
     if (!writes.empty())
     {
-        vkUpdateDescriptorSets(context.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        // Same textures in every frame's descriptor set
+        for (auto &frame : context.frames)
+        {
+            for (auto &write : writes)
+            {
+                write.dstSet = frame.ssboDescriptorSet;
+            }
+            vkUpdateDescriptorSets(context.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
         std::cout << "Earth descriptor set updated (" << writes.size() << " bindings)\n";
     }
 }
@@ -3783,6 +4604,8 @@ static void cleanupTextureHelper(VulkanContext &context,
 // Cleanup Earth texture resources
 void cleanupEarthTextures(VulkanContext &context)
 {
+    cleanupVirtualTextures(context);
+
     cleanupTextureHelper(context,
                          context.earthColorImage,
                          context.earthColorImageMemory,
@@ -3815,3 +4638,229 @@ void cleanupEarthTextures(VulkanContext &context)
 
     context.earthTexturesReady = false;
 }
+
+// ==================================
+// Earth Virtual Textures
+// ==================================
+
+bool loadEarthVirtualTextures(VulkanContext &context,
+                              const std::array<std::string, VirtualTexture::TEXTURE_COUNT> &paths)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physicalDevice, &properties);
+
+    uint32_t capacity =
+        VirtualTexture::cacheCapacityForScreen(context.swapchainExtent.width, context.swapchainExtent.height);
+    capacity = std::min(capacity, properties.limits.maxImageArrayLayers);
+
+    if (!VirtualTexture::open(paths, capacity))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < VirtualTexture::TEXTURE_COUNT; i++)
+    {
+        VkFormat format = static_cast<VkFormat>(VirtualTexture::getHeader(i).vkFormat);
+        if (!supportsSampledFormat(context, format))
+        {
+            std::cerr << "Virtual texture format " << format << " not sampleable on this device: " << paths[i]
+                      << "\n";
+            cleanupVirtualTextures(context);
+            return false;
+        }
+
+        VirtualTextureCache &cache = context.virtualTextureCaches[i];
+        if (!createLayeredImageHelper(context,
+                                      format,
+                                      VirtualTexture::PAGE_SIZE,
+                                      capacity,
+                                      VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+                                      cache.image,
+                                      cache.memory,
+                                      cache.view,
+                                      cache.sampler))
+        {
+            std::cerr << "Failed to create page cache for: " << paths[i] << "\n";
+            cleanupVirtualTextures(context);
+            return false;
+        }
+    }
+
+    // The regular cubemap bindings (4-8) still need something bound; the shader never samples them
+    if (!createLayeredImageHelper(context,
+                                  VK_FORMAT_R8G8B8A8_UNORM,
+                                  1,
+                                  6,
+                                  VK_IMAGE_VIEW_TYPE_CUBE,
+                                  context.earthColorImage,
+                                  context.earthColorImageMemory,
+                                  context.earthColorImageView,
+                                  context.earthColorSampler) ||
+        !createLayeredImageHelper(context,
+                                  VK_FORMAT_R8G8B8A8_UNORM,
+                                  1,
+                                  6,
+                                  VK_IMAGE_VIEW_TYPE_CUBE,
+                                  context.earthNormalImage,
+                                  context.earthNormalImageMemory,
+                                  context.earthNormalImageView,
+                                  context.earthNormalSampler) ||
+        !createLayeredImageHelper(context,
+                                  VK_FORMAT_R8G8B8A8_UNORM,
+                                  1,
+                                  6,
+                                  VK_IMAGE_VIEW_TYPE_CUBE,
+                                  context.earthNightlightsImage,
+                                  context.earthNightlightsImageMemory,
+                                  context.earthNightlightsImageView,
+                                  context.earthNightlightsSampler) ||
+        !createLayeredImageHelper(context,
+                                  VK_FORMAT_R8G8B8A8_UNORM,
+                                  1,
+                                  6,
+                                  VK_IMAGE_VIEW_TYPE_CUBE,
+                                  context.earthSpecularImage,
+                                  context.earthSpecularImageMemory,
+                                  context.earthSpecularImageView,
+                                  context.earthSpecularSampler) ||
+        !createLayeredImageHelper(context,
+                                  VK_FORMAT_R8G8B8A8_UNORM,
+                                  1,
+                                  6,
+                                  VK_IMAGE_VIEW_TYPE_CUBE,
+                                  context.earthHeightmapImage,
+                                  context.earthHeightmapImageMemory,
+                                  context.earthHeightmapImageView,
+                                  context.earthHeightmapSampler))
+    {
+        std::cerr << "Failed to create Earth cubemap placeholders\n";
+        cleanupEarthTextures(context);
+        return false;
+    }
+
+    context.virtualTexturesReady = true;
+
+    VirtualTexture::Stats stats = VirtualTexture::getStats();
+    std::cout << "=== Earth Virtual Textures ===" << "\n";
+    std::cout << "Face size: " << VirtualTexture::getHeader(VirtualTexture::COLOR).faceSize << ", "
+              << VirtualTexture::getHeader(VirtualTexture::COLOR).levelCount << " levels" << "\n";
+    std::cout << "Page cache: " << capacity << " pages per texture, " << stats.cacheBytes / (1024.0 * 1024.0)
+              << " MB (dataset: " << stats.datasetBytes / (1024.0 * 1024.0) << " MB)" << "\n";
+    std::cout << "==============================" << "\n";
+    return true;
+}
+
+// Copy this slot's staged pages into their cache layers
+// The barriers order the copies after earlier frames' reads of the replaced layers and before this frame's reads
+void recordVirtualTextureUploads(VulkanContext &context, VkCommandBuffer cmd)
+{
+    FrameResources &frame = context.currentFrameResources();
+    if (frame.pageCopies.empty())
+    {
+        return;
+    }
+
+    if (!context.virtualTexturesReady)
+    {
+        frame.pageCopies.clear();
+        return;
+    }
+
+    for (uint32_t texture = 0; texture < VirtualTexture::TEXTURE_COUNT; texture++)
+    {
+        std::vector<VkBufferImageCopy> regions;
+        for (const VirtualTexturePageCopy &copy : frame.pageCopies)
+        {
+            if (copy.texture != texture)
+            {
+                continue;
+            }
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = copy.bufferOffset;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = copy.layer;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {VirtualTexture::PAGE_SIZE, VirtualTexture::PAGE_SIZE, 1};
+            regions.push_back(region);
+        }
+
+        if (regions.empty())
+        {
+            continue;
+        }
+
+        VkImage image = context.virtualTextureCaches[texture].image;
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+
+        vkCmdCopyBufferToImage(cmd,
+                               frame.pageStagingBuffer.buffer,
+                               image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()),
+                               regions.data());
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+    }
+
+    frame.pageCopies.clear();
+}
+
+void cleanupVirtualTextures(VulkanContext &context)
+{
+    VirtualTexture::close();
+
+    for (auto &cache : context.virtualTextureCaches)
+    {
+        cleanupTextureHelper(context, cache.image, cache.memory, cache.view, cache.sampler);
+    }
+    for (auto &frame : context.frames)
+    {
+        frame.pageCopies.clear();
+    }
+
+    context.virtualTexturesReady = false;
+}
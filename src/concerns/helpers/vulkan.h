@@ -7,6 +7,8 @@
 #define VK_USE_PLATFORM_WIN32_KHR
 #endif
 
+#include "../virtual-texture.h"
+#include <array>
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
@@ -35,6 +37,62 @@ struct VulkanBuffer
     VkDeviceSize size = 0;
 };
 
+// A streamed virtual texture page waiting in a frame's staging buffer
+struct VirtualTexturePageCopy
+{
+    uint32_t texture;          // VirtualTexture::Texture
+    uint32_t layer;            // Destination layer of the page cache
+    VkDeviceSize bufferOffset; // Offset in FrameResources::pageStagingBuffer
+};
+
+// Resources written (or read back) by the CPU every frame
+// One copy per frame in flight, so a slot can be refilled as soon as its own fence
+// has signalled while the other frames are still being rendered
+struct FrameResources
+{
+    VulkanBuffer uiStateSSBO = {};          // UIState (binding 0)
+    VulkanBuffer hoverOutputSSBO = {};      // Hover detection output (binding 1)
+    VulkanBuffer celestialObjectsSSBO = {}; // Celestial objects array (binding 2)
+    VulkanBuffer minDistanceSSBO = {};      // Min surface distance readback (binding 9)
+    VkDescriptorSet ssboDescriptorSet = VK_NULL_HANDLE; // All bindings, pointing at this slot's buffers
+    uint32_t celestialObjectCount = 0;                  // Number of celestial objects currently in buffer
+
+    // UI vertex buffer (built each frame from UI rendering calls)
+    VulkanBuffer uiVertexBuffer = {};
+    uint32_t uiVertexCount = 0;
+    VkDeviceSize uiVertexBufferSize = 0; // Current allocated size
+
+    // Frame number of this slot's last submission whose outputs haven't been read back yet (0 = none)
+    uint64_t pendingReadbackFrame = 0;
+
+    // Earth virtual texturing: page table (binding 10), page request bitset (binding 11),
+    // and the pages staged for this frame (copied into the caches before the render pass)
+    VulkanBuffer pageTableSSBO = {};
+    VulkanBuffer pageFeedbackSSBO = {};
+    uint64_t pageTableVersion = 0; // VirtualTexture::getPageTableVersion() last written to pageTableSSBO
+    VulkanBuffer pageStagingBuffer = {};
+    std::vector<VirtualTexturePageCopy> pageCopies;
+};
+
+// Physical page cache of one streamed Earth texture (2D array, one page per layer)
+struct VirtualTextureCache
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+};
+
+// GPU outputs (hover and min distance) of the most recent completed frame
+// Filled by pollReadbacks from whichever slots' fences have signalled, so it lags the
+// frame being recorded by 1..MAX_FRAMES_IN_FLIGHT frames but never stalls the CPU
+struct GpuReadback
+{
+    uint64_t frameNumber = 0;              // Frame the values came from (0 = nothing completed yet)
+    uint32_t hoverMaterialID = 0;          // 0 = no hit, >0 = material ID of hit object
+    float minSurfaceDistance = 1000000.0f; // Matches the shader-side reset value ("no terrain nearby")
+};
+
 // Main Vulkan context structure
 struct VulkanContext
 {
@@ -46,6 +104,7 @@ struct VulkanContext
     VkQueue presentQueue = VK_NULL_HANDLE;
     uint32_t graphicsQueueFamily = UINT32_MAX;
     uint32_t presentQueueFamily = UINT32_MAX;
+    bool textureCompressionBC = false; // BC1-BC7 sampling enabled (KTX2 cubemaps need it)
 
     // Surface and swapchain
     VkSurfaceKHR surface = VK_NULL_HANDLE;
@@ -72,17 +131,12 @@ struct VulkanContext
     VulkanBuffer testUIVertexBuffer = {};
     uint32_t testUIVertexCount = 0;
 
-    // Actual UI vertex buffer (built each frame from UI rendering calls)
-    VulkanBuffer uiVertexBuffer = {};
-    uint32_t uiVertexCount = 0;
-    VkDeviceSize uiVertexBufferSize = 0; // Current allocated size
-
     // Triangle count tracking (for UI display)
     uint32_t worldTriangleCount = 0; // Triangles in 3D world geometry
     uint32_t uiTriangleCount = 0;    // Triangles in UI geometry
     uint32_t totalTriangleCount = 0; // Total triangles rendered this frame
 
-    // Command buffers
+    // Command buffers (one per frame in flight)
     VkCommandPool commandPool = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> commandBuffers;
 
@@ -90,30 +144,34 @@ struct VulkanContext
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
+    std::vector<VkFence> imagesInFlight; // Fence of the frame last rendered to each swapchain image
     uint32_t currentFrame = 0;
-    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 1;
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+
+    // Per-frame copies of everything the CPU updates between frames
+    std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> frames;
+
+    FrameResources &currentFrameResources()
+    {
+        return frames[currentFrame];
+    }
+
+    // Frames submitted so far, and the newest GPU outputs read back from them
+    uint64_t frameNumber = 0;
+    GpuReadback readback;
+
+    // Pipeline cache (persisted between launches, see createPipelineCache)
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    size_t pipelineCacheLoadedBytes = 0; // Size of the driver data loaded at startup (0 = cold start)
 
     // Debug messenger (for validation layers)
     VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
 
-    // Track temp shader files for cleanup
-    std::vector<std::string> tempShaderFiles;
-
     // ==================================
-    // SSBO for UIState (shader settings)
+    // SSBO descriptors (buffers live in FrameResources)
     // ==================================
-    VulkanBuffer uiStateSSBO = {};     // SSBO buffer containing UIState (binding 0)
-    VulkanBuffer hoverOutputSSBO = {}; // SSBO buffer for hover detection output (binding 1)
-    VulkanBuffer minDistanceSSBO = {}; // SSBO buffer for min surface distance readback (binding 9)
     VkDescriptorSetLayout ssboDescriptorSetLayout = VK_NULL_HANDLE; // Descriptor set layout for SSBOs
-    VkDescriptorPool ssboDescriptorPool = VK_NULL_HANDLE;           // Descriptor pool for SSBOs
-    VkDescriptorSet ssboDescriptorSet = VK_NULL_HANDLE;             // Descriptor set for SSBO bindings
-
-    // ==================================
-    // SSBO for Celestial Objects (binding 2)
-    // ==================================
-    VulkanBuffer celestialObjectsSSBO = {}; // SSBO buffer containing celestial objects array
-    uint32_t celestialObjectCount = 0;      // Number of celestial objects currently in buffer
+    VkDescriptorPool ssboDescriptorPool = VK_NULL_HANDLE; // Descriptor pool (one set per frame in flight)
 
     // ==================================
     // Skybox Cubemap Texture (binding 3)
@@ -156,6 +214,14 @@ struct VulkanContext
     VkImageView earthHeightmapImageView = VK_NULL_HANDLE;
     VkSampler earthHeightmapSampler = VK_NULL_HANDLE;
     bool earthTexturesReady = false;
+
+    // ==================================
+    // Earth Virtual Texture Caches (bindings 12-16)
+    // ==================================
+    // Page caches in VirtualTexture::Texture order. When virtual texturing is off they hold
+    // 1x1 placeholders (and bindings 4-8 the real cubemaps); when it is on, the reverse.
+    std::array<VirtualTextureCache, VirtualTexture::TEXTURE_COUNT> virtualTextureCaches;
+    bool virtualTexturesReady = false;
 };
 
 // Global Vulkan context pointer (set during initialization)
@@ -189,6 +255,10 @@ VulkanBuffer createBuffer(VulkanContext &context,
 // Destroy buffer
 void destroyBuffer(VulkanContext &context, VulkanBuffer &buffer);
 
+// Copy regions between buffers in one submit and wait for it
+// Ordered after all work submitted earlier to the graphics queue, so dst may be a buffer that frames in flight read
+void copyBufferRegions(VulkanContext &context, VkBuffer src, VkBuffer dst, const std::vector<VkBufferCopy> &regions);
+
 // Begin frame - acquire swapchain image and begin command buffer
 VkCommandBuffer beginFrame(VulkanContext &context);
 
@@ -201,9 +271,29 @@ void cleanupSwapchain(VulkanContext &context);
 // Recreate swapchain and framebuffers (for resize)
 bool recreateSwapchain(VulkanContext &context, uint32_t width, uint32_t height);
 
+// Create graphics pipeline (for subpass 0 - 3D scene)
+bool createGraphicsPipeline(VulkanContext &context);
+
 // Create UI pipeline (for subpass 1 - 2D UI overlay)
 bool createUIPipeline(VulkanContext &context);
 
+// Create every independent pipeline on its own worker thread and print a startup timing report
+bool createPipelines(VulkanContext &context);
+
+// ==================================
+// Pipeline Cache
+// ==================================
+// Driver pipeline cache persisted in the shader cache directory, so warm launches skip most
+// pipeline compilation. Data from another GPU or driver version is detected and discarded.
+
+constexpr const char *PIPELINE_CACHE_FILE = "pipeline-cache.bin";
+
+// Create context.pipelineCache, seeded from disk when the stored header matches this device
+bool createPipelineCache(VulkanContext &context);
+
+// Write the pipeline cache to disk (temp file + rename) and destroy it
+void savePipelineCache(VulkanContext &context);
+
 // UI vertex structure (for building UI geometry)
 struct UIVertex
 {
@@ -233,12 +323,13 @@ uint32_t EndUIVertexBuffer(VulkanContext &context);
 // Returns the number of vertices added
 uint32_t buildUIVertexBuffer(VulkanContext &context, int screenWidth, int screenHeight);
 
-// Compile GLSL shader source to SPIR-V using glslangValidator
-// context: Vulkan context to track temp files for cleanup
+// Compile GLSL shader source to SPIR-V (served from the persistent ShaderCache when possible)
+// defines: "NAME" or "NAME=VALUE" entries, part of the cache key
 std::vector<uint32_t> compileGLSLToSPIRV(VulkanContext &context,
                                          const std::string &glslSource,
                                          const std::string &shaderStage,
-                                         const std::string &entryPoint = "main");
+                                         const std::string &entryPoint = "main",
+                                         const std::vector<std::string> &defines = {});
 
 // ==================================
 // SSBO and Push Constants
@@ -247,19 +338,27 @@ std::vector<uint32_t> compileGLSLToSPIRV(VulkanContext &context,
 // Create SSBO descriptor set layout for UIState
 bool createSSBODescriptorSetLayout(VulkanContext &context);
 
-// Create SSBO buffer and descriptor set
+// Create SSBO buffers and descriptor sets for every frame in flight
 bool createSSBOResources(VulkanContext &context);
 
+// The functions below operate on the current frame slot (context.currentFrameResources())
+// Call waitForCurrentFrameFence first - the slot's previous frame may still be on the GPU
+
 // Update SSBO buffer with current UIState
 void updateSSBOBuffer(VulkanContext &context, const UIState &state);
 
-// Read hover output from SSBO (returns material ID at mouse position, 0 = no hit)
+// Copy hover and min distance outputs of every slot whose fence has signalled into
+// context.readback (non-blocking; keeps the newest frame). Must run before a slot's outputs are reset
+void pollReadbacks(VulkanContext &context);
+
+// Hover output of the most recent completed frame (material ID at mouse position, 0 = no hit)
 uint32_t readHoverOutput(VulkanContext &context);
 
-// Read minimum surface distance from SSBO (for camera step limiting)
+// Minimum surface distance of the most recent completed frame (for camera step limiting)
+// Never waits on the GPU - polls for newly completed frames and returns the latest value
 float readMinSurfaceDistance(VulkanContext &context);
 
-// Wait for the current frame's fence (ensures previous frame's GPU work is complete)
+// Wait for the current frame's fence (ensures this slot's previous GPU work is complete)
 // Call this before accessing buffers written by the GPU
 void waitForCurrentFrameFence(VulkanContext &context);
 
@@ -269,6 +368,10 @@ void resetHoverOutput(VulkanContext &context);
 // Reset min distance SSBO to large value (call before rendering)
 void resetMinDistanceOutput(VulkanContext &context);
 
+// Stage streamed Earth texture pages and refresh the page table of the current slot
+// (call after pollReadbacks, which feeds the completed frames' page requests to VirtualTexture)
+void updateVirtualTextures(VulkanContext &context);
+
 // Push world state constants to command buffer
 // Takes WorldPushConstants directly (use WorldState::toPushConstants() to convert)
 void pushWorldConstants(VkCommandBuffer cmd, VkPipelineLayout layout, const WorldPushConstants &constants);
@@ -328,3 +431,20 @@ void updateEarthDescriptorSet(VulkanContext &context);
 
 // Cleanup Earth texture resources
 void cleanupEarthTextures(VulkanContext &context);
+
+// ==================================
+// Earth Virtual Texture Functions
+// ==================================
+// Used by loadEarthTextures when all five page files exist (High/Ultra preprocessing) and the
+// device can sample BC formats; the page caches are sized for the current swapchain extent.
+
+// Open the page files and create the page caches (bindings 4-8 get placeholders)
+// paths: one page file per VirtualTexture::Texture
+bool loadEarthVirtualTextures(VulkanContext &context,
+                              const std::array<std::string, VirtualTexture::TEXTURE_COUNT> &paths);
+
+// Record the copies staged by updateVirtualTextures (call outside a render pass)
+void recordVirtualTextureUploads(VulkanContext &context, VkCommandBuffer cmd);
+
+// Stop streaming and destroy the page caches
+void cleanupVirtualTextures(VulkanContext &context);
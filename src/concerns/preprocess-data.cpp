@@ -1,11 +1,16 @@
 #include "preprocess-data.h"
 #include "../materials/earth/earth-material.h"
 #include "../materials/earth/economy/earth-economy.h"
+#include "ephemeris-table.h"
+#include "helpers/task-graph.h"
+#include "preprocessing/compressed-textures.h"
 #include "spice-ephemeris.h"
 #include "stars-dynamic-skybox.h"
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <thread>
 
 
 #ifdef _WIN32
@@ -135,7 +140,28 @@ bool PreprocessAllData(TextureResolution textureRes)
     std::cout << "Looking for kernels in: " << kernelsPath << "\n";
     std::cout << "  Absolute: " << std::filesystem::absolute(kernelsPath).string() << "\n";
 
-    if (!SpiceEphemeris::initialize(kernelsPath))
+    // A valid precomputed table lets startup skip loading kernels entirely
+    double nowJD = EphemerisTable::currentJulianDate();
+    double requiredEndJD = nowJD + EphemerisTable::REBUILD_MARGIN_DAYS;
+    if (EphemerisTable::open(EphemerisTable::DEFAULT_TABLE_PATH, kernelsPath, nowJD, requiredEndJD))
+    {
+        SpiceEphemeris::initializeDeferred(kernelsPath,
+                                           EphemerisTable::getBodies(),
+                                           EphemerisTable::getValidStartJD(),
+                                           EphemerisTable::getValidEndJD());
+    }
+    else if (SpiceEphemeris::initialize(kernelsPath))
+    {
+        // Missing or stale table - rebuild it now so the next launch is instant
+        if (EphemerisTable::build(EphemerisTable::DEFAULT_TABLE_PATH,
+                                  kernelsPath,
+                                  nowJD - EphemerisTable::DAYS_BEFORE_NOW,
+                                  nowJD + EphemerisTable::DAYS_AFTER_NOW))
+        {
+            EphemerisTable::open(EphemerisTable::DEFAULT_TABLE_PATH, kernelsPath, nowJD, requiredEndJD);
+        }
+    }
+    else
     {
         std::cerr << "\n=== FATAL ERROR: SPICE Initialization Failed! ===\n";
         std::cerr << "Could not find or load SPICE kernel files.\n";
@@ -152,103 +178,174 @@ bool PreprocessAllData(TextureResolution textureRes)
     std::cout << "===================================\n\n";
 
     // ========================================================================
-    // Pre-window initialization: Process Earth textures
+    // Pre-window initialization: asset preprocessing stages
     // ========================================================================
-    // Combine Blue Marble tiles into monthly textures at the configured resolution.
-    // This runs before OpenGL is initialized, so textures are ready when needed.
-    std::cout << "\n";
-    int earthColorTexturesReady =
-        EarthMaterial::preprocessTiles("defaults",       // Source tiles in defaults/earth-surface/blue-marble/
-                                       "earth-textures", // Output combined images next to executable
-                                       textureRes        // Use configured resolution
-        );
-    std::cout << "\n";
-
-    // Process elevation data into heightmap and normal map textures.
-    // This generates bump mapping textures from ETOPO GeoTIFF elevation data.
-    bool earthElevationReady =
-        EarthMaterial::preprocessElevation("defaults",       // Source elevation in defaults/earth-surface/elevation/
-                                           "earth-textures", // Output next to color textures
-                                           textureRes        // Use same resolution as color textures
-        );
-    std::cout << "\n";
-
-    // Process MODIS reflectance data into specular/roughness texture.
-    // This extracts relative green (green - red) for surface roughness mapping.
-    int earthSpecularReady =
-        EarthMaterial::preprocessSpecular("defaults",       // Source MODIS data in defaults/earth-surface/albedo/
-                                          "earth-textures", // Output next to executable
-                                          textureRes);
-    std::cout << "\n";
-
-    // Process VIIRS Black Marble nightlights for city lights at night
-    // This converts HDF5 radiance data into grayscale emissive texture
-    bool earthNightlightsReady =
-        EarthMaterial::preprocessNightlights("defaults",       // Source in defaults/earth-surface/human-lights/
-                                             "earth-textures", // Output next to executable
-                                             textureRes);
-    std::cout << "\n";
-
-    // Generate ice masks from Blue Marble monthly textures
-    // Creates 12 masks (one per month) for ice/snow coverage
-    bool earthIceMasksReady = EarthMaterial::preprocessIceMasks("defaults", // Not used (reads from earth-textures)
-                                                                "earth-textures", // Where monthly textures are
-                                                                textureRes);
-    (void)earthIceMasksReady; // Currently unused, prepared for future feature
-    std::cout << "\n";
-
-    // Preprocess city data from Excel file into texture
-    // Loads worldcities.xlsx and generates city location texture (sinusoidal projection)
-    std::string citiesXlsxPath = getDefaultsPath() + "/economy/worldcities.xlsx";
-    bool citiesReady = EarthEconomy::preprocessCities(citiesXlsxPath, "earth-textures", textureRes);
-    (void)citiesReady; // Prepared for runtime use
-    std::cout << "\n";
-
-    // Combined result: color textures + elevation textures + specular + nightlights
-    int earthTexturesReady =
-        earthColorTexturesReady + (earthElevationReady ? 1 : 0) + earthSpecularReady + (earthNightlightsReady ? 1 : 0);
-
-    // ========================================================================
-    // Preprocess skybox textures
-    // Resizes TIF and EXR files from defaults/celestial-skybox/ to 2x the user's selected resolution
-    // MANDATORY: This MUST succeed or the application cannot continue
-    std::cout << "\n";
+    // Each stage declares what it reads and writes; independent stages (skybox, elevation, wind,
+    // cities, ...) run side by side, and the memory estimates keep concurrent stages within a
+    // budget of 3/4 of physical memory. Stages that are internally parallel keep their own threads.
 
     // For preprocessing, we need the SOURCE defaults directory (where the original files are),
     // not the runtime defaults directory (which is copied to build/Release/defaults)
     // The source directory is typically ../../defaults relative to the executable
     std::string sourceDefaultsPath = findSourceDefaultsPath();
-    std::string outputPath = "celestial-skybox";
-    std::string outputDir = outputPath + "/" + getResolutionFolderName(textureRes);
-    std::string criticalFile = outputDir + "/milkyway_combined.hdr";
-
-    std::cout << "Using source defaults path: " << sourceDefaultsPath << "\n";
-    std::cout << "  Absolute: " << std::filesystem::absolute(sourceDefaultsPath).string() << "\n";
-
-    // Check if critical file exists
-    bool needsPreprocessing = !std::filesystem::exists(criticalFile);
+    std::string skyboxOutputPath = "celestial-skybox";
+    std::string skyboxOutputDir = skyboxOutputPath + "/" + getResolutionFolderName(textureRes);
+    std::string criticalSkyboxFile = skyboxOutputDir + "/milkyway_combined.hdr";
+    std::string citiesXlsxPath = getDefaultsPath() + "/economy/worldcities.xlsx";
 
-    if (needsPreprocessing)
+    // Rough peak working sets, in bytes per output pixel (skybox sources are 2x the resolution)
+    int textureWidth, textureHeight;
+    getResolutionDimensions(textureRes, textureWidth, textureHeight);
+    const size_t pixels = static_cast<size_t>(textureWidth) * textureHeight;
+    const size_t MB = 1024 * 1024;
+
+    TaskGraph stages;
+
+    // Combine Blue Marble tiles into monthly textures at the configured resolution
+    stages.addStage({"color",
+                     {},
+                     {"earth-color"},
+                     pixels * 8,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessTiles("defaults",       // Tiles in defaults/earth-surface/
+                                                               "earth-textures", // Output next to executable
+                                                               textureRes) > 0;
+                     }});
+
+    // Heightmap and normal map textures from ETOPO GeoTIFF elevation data
+    stages.addStage({"elevation",
+                     {},
+                     {"earth-elevation"},
+                     512 * MB + pixels * 24,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessElevation("defaults", "earth-textures", textureRes);
+                     }});
+
+    // Land/water mask from the January color texture (specular and nightlights mask the ocean with it)
+    stages.addStage({"landmass-mask",
+                     {"earth-color"},
+                     {"earth-landmass-mask"},
+                     512 * MB + pixels * 24,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessLandmassMask("defaults", "earth-textures", textureRes);
+                     }});
+
+    // Relative green (green - red) from MODIS reflectance for surface specular/roughness
+    stages.addStage({"specular",
+                     {"earth-landmass-mask"},
+                     {"earth-specular"},
+                     pixels * 8,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessSpecular("defaults", "earth-textures", textureRes) > 0;
+                     }});
+
+    // VIIRS Black Marble radiance into a grayscale emissive texture
+    stages.addStage({"nightlights",
+                     {"earth-landmass-mask"},
+                     {"earth-nightlights"},
+                     pixels * 24,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessNightlights("defaults", "earth-textures", textureRes);
+                     }});
+
+    // Monthly ice/snow coverage masks from the Blue Marble monthly textures
+    // (not used by the renderer yet)
+    stages.addStage({"ice-masks",
+                     {"earth-color"},
+                     {"earth-ice-masks"},
+                     pixels * 6,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessIceMasks("defaults", "earth-textures", textureRes);
+                     }});
+
+    // City locations from worldcities.xlsx
+    stages.addStage({"cities",
+                     {},
+                     {"earth-cities"},
+                     256 * MB,
+                     false,
+                     [citiesXlsxPath, textureRes]() {
+                         return EarthEconomy::preprocessCities(citiesXlsxPath, "earth-textures", textureRes);
+                     }});
+
+    // Skybox TIF and EXR sources resized to 2x the selected resolution
+    // MANDATORY: the application cannot continue without the combined Milky Way texture
+    stages.addStage({"skybox",
+                     {},
+                     {"skybox"},
+                     pixels * 4 * 36,
+                     true,
+                     [sourceDefaultsPath, skyboxOutputPath, criticalSkyboxFile, textureRes]() {
+                         std::cout << "Using source defaults path: " << sourceDefaultsPath << "\n";
+                         std::cout << "  Absolute: " << std::filesystem::absolute(sourceDefaultsPath).string()
+                                   << "\n";
+                         if (std::filesystem::exists(criticalSkyboxFile))
+                         {
+                             std::cout << "Skybox textures found. Skipping preprocessing." << "\n";
+                         }
+                         else
+                         {
+                             std::cout << "Skybox textures not found. Running preprocessing..." << "\n";
+                         }
+                         PreprocessSkyboxTextures(sourceDefaultsPath, // Source in defaults/celestial-skybox/
+                                                  skyboxOutputPath,   // Output folder
+                                                  textureRes);
+                         return std::filesystem::exists(criticalSkyboxFile);
+                     }});
+
+    // Mipmapped BC cubemaps (KTX2) of the grids written above
+    // Optional: the loader falls back to the uncompressed grids when a KTX2 file is missing
+    stages.addStage({"compressed-textures",
+                     {"earth-color", "earth-elevation", "earth-specular", "earth-nightlights", "skybox"},
+                     {"compressed-textures"},
+                     pixels * 48,
+                     false,
+                     [skyboxOutputPath, textureRes]() {
+                         return PreprocessCompressedTextures("earth-textures", skyboxOutputPath, textureRes) > 0;
+                     }});
+
+    // 12 monthly NetCDF wind files into a static 3D LUT
+    stages.addStage({"wind",
+                     {},
+                     {"wind-lut"},
+                     1024 * MB,
+                     false,
+                     [textureRes]() {
+                         return EarthMaterial::preprocessWindData("defaults", "earth-textures", textureRes);
+                     }});
+
+    // Transmittance, scattering and irradiance lookup tables for atmosphere rendering
+    stages.addStage({"atmosphere-luts",
+                     {},
+                     {"atmosphere-luts"},
+                     128 * MB,
+                     false,
+                     []() { return EarthMaterial::preprocessAtmosphereLUTs("earth-textures"); }});
+
+    size_t memoryBudget = TaskGraph::physicalMemoryBytes() / 4 * 3;
+    if (memoryBudget == 0)
     {
-        std::cout << "Skybox textures not found. Running preprocessing..." << "\n";
-        std::cout.flush();
-    }
-    else
-    {
-        std::cout << "Skybox textures found. Skipping preprocessing." << "\n";
-        std::cout.flush();
+        memoryBudget = 8192 * MB;
     }
+    int maxConcurrentStages = static_cast<int>(std::max(2u, std::thread::hardware_concurrency() / 4));
 
-    // Always run preprocessing if critical file doesn't exist
-    bool skyboxTexturesReady = PreprocessSkyboxTextures(sourceDefaultsPath, // Source in defaults/celestial-skybox/
-                                                        outputPath,         // Output folder
-                                                        textureRes);
+    std::cout << "\n=== Preprocessing (" << maxConcurrentStages << " concurrent stages, "
+              << memoryBudget / MB << " MB budget) ===\n";
+    bool stagesSucceeded = stages.run(maxConcurrentStages, memoryBudget);
+    stages.printReport();
+    std::cout << "\n";
 
-    // Verify critical file was created
-    if (!std::filesystem::exists(criticalFile))
+    // Verify the critical skybox file was created
+    if (!stagesSucceeded || !std::filesystem::exists(criticalSkyboxFile))
     {
         std::cerr << "\n=== FATAL ERROR: Skybox preprocessing failed! ===" << "\n";
-        std::cerr << "The critical skybox texture file was not created: " << criticalFile << "\n";
+        std::cerr << "The critical skybox texture file was not created: " << criticalSkyboxFile << "\n";
         std::cerr << "Source files should be in: " << sourceDefaultsPath << "/celestial-skybox/" << "\n";
         std::cerr << "  Required files:" << "\n";
         std::cerr << "    - constellation_figures_32k.tif" << "\n";
@@ -256,32 +353,11 @@ bool PreprocessAllData(TextureResolution textureRes)
         std::cerr << "    - constellation_bounds_32k.tif" << "\n";
         std::cerr << "    - milkyway_2020_16k.exr" << "\n";
         std::cerr << "    - hiptyc_2020_16k.exr" << "\n";
-        std::cerr << "Output directory: " << std::filesystem::absolute(outputDir).string() << "\n";
+        std::cerr << "Output directory: " << std::filesystem::absolute(skyboxOutputDir).string() << "\n";
         std::cerr << "================================================" << "\n";
         std::cerr << "Cannot continue without skybox textures. Exiting." << "\n";
         return false; // Exit application - cannot continue without skybox
     }
 
-    std::cout << "Skybox preprocessing completed successfully." << "\n";
-    std::cout << "\n";
-
-    // ========================================================================
-    // Preprocess wind data from NetCDF files
-    // Processes 12 monthly NetCDF files and creates a static 3D LUT binary file
-    std::cout << "\n";
-    bool windDataReady = EarthMaterial::preprocessWindData("defaults",       // Source in defaults/wind-forces/
-                                                           "earth-textures", // Output next to other earth textures
-                                                           textureRes);
-    (void)windDataReady; // Prepared for runtime use
-    std::cout << "\n";
-
-    // ========================================================================
-    // Preprocess atmosphere LUTs
-    // Generates transmittance and scattering lookup tables for atmosphere rendering
-    std::cout << "\n";
-    bool atmosphereLUTsReady = EarthMaterial::preprocessAtmosphereLUTs("earth-textures");
-    (void)atmosphereLUTsReady; // Prepared for runtime use
-    std::cout << "\n";
-
     return true;
 }
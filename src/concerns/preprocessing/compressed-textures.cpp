@@ -0,0 +1,419 @@
+// ============================================================================
+// Compressed Cubemap Preprocessing
+// ============================================================================
+// Turns the uncompressed 3x2 grid cubemaps into KTX2 files with full mip chains.
+// At Ultra resolution this cuts Earth texture memory by 4-8x and the skybox by 8x
+// (RGBA32F -> BC6H), and gives the sampler real mip levels to minify from.
+
+#include "compressed-textures.h"
+#include "../../materials/helpers/cubemap-conversion.h"
+#include "../helpers/asset-manifest.h"
+#include "../helpers/ktx2.h"
+#include "../settings.h"
+#include "../virtual-texture.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <stb_image.h>
+
+namespace fs = std::filesystem;
+
+// Extract one face of a 3x2 grid into a tightly packed RGBA image
+template <typename T>
+static std::vector<T> extractFace(const T *grid, int gridWidth, int faceSize, int face)
+{
+    int col;
+    int row;
+    getCubemapFaceGridPosition(face, col, row);
+
+    std::vector<T> faceData(static_cast<size_t>(faceSize) * faceSize * 4);
+    for (int y = 0; y < faceSize; y++)
+    {
+        size_t srcRow = static_cast<size_t>(row) * faceSize + y;
+        const T *src = grid + (srcRow * gridWidth + static_cast<size_t>(col) * faceSize) * 4;
+        std::memcpy(faceData.data() + static_cast<size_t>(y) * faceSize * 4,
+                    src,
+                    static_cast<size_t>(faceSize) * 4 * sizeof(T));
+    }
+    return faceData;
+}
+
+// A 3x2 grid as loaded by stb: Radiance HDR as float RGBA, everything else as RGBA8
+struct GridImage
+{
+    int width = 0;
+    int height = 0;
+    float *hdrPixels = nullptr;
+    unsigned char *ldrPixels = nullptr;
+
+    ~GridImage()
+    {
+        stbi_image_free(hdrPixels);
+        stbi_image_free(ldrPixels);
+    }
+};
+
+// Load a grid and check its 3:2 shape
+static bool loadGridImage(const std::string &gridPath, GridImage &grid)
+{
+    int channels = 0;
+    if (fs::path(gridPath).extension() == ".hdr")
+    {
+        grid.hdrPixels = stbi_loadf(gridPath.c_str(), &grid.width, &grid.height, &channels, 4);
+    }
+    else
+    {
+        grid.ldrPixels = stbi_load(gridPath.c_str(), &grid.width, &grid.height, &channels, 4);
+    }
+    if (grid.hdrPixels == nullptr && grid.ldrPixels == nullptr)
+    {
+        std::cerr << "  Failed to load " << gridPath << " for compression\n";
+        return false;
+    }
+
+    if (grid.width != grid.height * 3 / 2 || grid.width % 3 != 0)
+    {
+        std::cerr << "  Invalid cubemap grid " << gridPath << ": " << grid.width << "x" << grid.height << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Bump when the block encoders or the page layout change (see AssetManifest)
+static constexpr int OUTPUT_VERSION = 1;
+
+// A compressed file depends on its grid, the block format and the mip filter
+static AssetManifest::Recipe compressionRecipe(const std::string &gridPath,
+                                               BlockCompression::Format format,
+                                               bool isNormalMap,
+                                               const char *container)
+{
+    AssetManifest::Recipe recipe;
+    recipe.sources = {gridPath};
+    recipe.parameters = std::string(container) + " " + BlockCompression::formatName(format) +
+                        (isNormalMap ? " normal-mips" : " mips");
+    recipe.version = OUTPUT_VERSION;
+    return recipe;
+}
+
+// One face as RGBA8 (BC4 from an HDR heightmap takes the 0-1 range of the red channel)
+static std::vector<uint8_t> extractFaceRGBA8(const GridImage &grid, int faceSize, int face)
+{
+    if (grid.hdrPixels == nullptr)
+    {
+        return extractFace(grid.ldrPixels, grid.width, faceSize, face);
+    }
+
+    std::vector<float> hdrFace = extractFace(grid.hdrPixels, grid.width, faceSize, face);
+    std::vector<uint8_t> image(hdrFace.size());
+    for (size_t i = 0; i < hdrFace.size(); i++)
+    {
+        image[i] = static_cast<uint8_t>(std::lround(std::clamp(hdrFace[i], 0.0f, 1.0f) * 255.0f));
+    }
+    return image;
+}
+
+bool CompressCubemapTexture(const std::string &gridPath, BlockCompression::Format format, bool isNormalMap)
+{
+    using namespace BlockCompression;
+
+    std::string ktxPath = Ktx2::pathFor(gridPath);
+    if (!fs::exists(gridPath))
+    {
+        return false;
+    }
+    AssetManifest::Recipe recipe = compressionRecipe(gridPath, format, isNormalMap, "ktx2");
+    if (AssetManifest::isCurrent(ktxPath, recipe))
+    {
+        std::cout << "  " << fs::path(ktxPath).filename().string() << " is up to date\n";
+        return true;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    GridImage grid;
+    if (!loadGridImage(gridPath, grid))
+    {
+        return false;
+    }
+    int faceSize = grid.width / 3;
+    int levelCount = mipLevelCount(faceSize, faceSize);
+    std::vector<std::vector<uint8_t>> levels(levelCount);
+
+    // Faces outer, levels inner: each level ends up with its 6 faces in +X -X +Y -Y +Z -Z order
+    for (int face = 0; face < 6; face++)
+    {
+        if (format == Format::BC6H)
+        {
+            std::vector<float> image = extractFace(grid.hdrPixels, grid.width, faceSize, face);
+            std::vector<float> next;
+            int size = faceSize;
+            for (int level = 0; level < levelCount; level++)
+            {
+                std::vector<uint8_t> blocks = compressImageHDR(image.data(), size, size);
+                levels[level].insert(levels[level].end(), blocks.begin(), blocks.end());
+                downsampleRGBA32F(image.data(), size, size, next);
+                image.swap(next);
+                size = std::max(1, size / 2);
+            }
+            continue;
+        }
+
+        std::vector<uint8_t> image = extractFaceRGBA8(grid, faceSize, face);
+
+        std::vector<uint8_t> next;
+        int size = faceSize;
+        for (int level = 0; level < levelCount; level++)
+        {
+            std::vector<uint8_t> blocks = compressImage(format, image.data(), size, size);
+            levels[level].insert(levels[level].end(), blocks.begin(), blocks.end());
+            downsampleRGBA8(image.data(), size, size, next, isNormalMap);
+            image.swap(next);
+            size = std::max(1, size / 2);
+        }
+    }
+
+    std::string tempKtxPath = AssetManifest::temporaryPath(ktxPath);
+    if (!Ktx2::writeCubemap(tempKtxPath,
+                            vkFormat(format),
+                            static_cast<uint32_t>(blockBytes(format)),
+                            static_cast<uint32_t>(faceSize),
+                            static_cast<uint32_t>(faceSize),
+                            levels) ||
+        !AssetManifest::commit(tempKtxPath, ktxPath, recipe))
+    {
+        return false;
+    }
+
+    // Compare against what the uncompressed loader uploads (RGBA8, or RGBA32F for HDR, single level)
+    size_t uncompressedBytes = static_cast<size_t>(grid.width) * grid.height * (grid.hdrPixels != nullptr ? 16 : 4);
+    size_t compressedBytes = 0;
+    for (const auto &level : levels)
+    {
+        compressedBytes += level.size();
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    std::cout << "  " << fs::path(gridPath).filename().string() << " -> " << formatName(format) << ", " << levelCount
+              << " levels, " << uncompressedBytes / (1024.0 * 1024.0) << " MB -> "
+              << compressedBytes / (1024.0 * 1024.0) << " MB (" << duration.count() << " ms)\n";
+    return true;
+}
+
+// Run task(i) for i in [0, count) on all hardware threads
+template <typename Task> static void parallelFor(int count, Task task)
+{
+    int threadCount = std::min(count, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+        {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+bool CompressVirtualTexture(const std::string &gridPath, BlockCompression::Format format, bool isNormalMap)
+{
+    using namespace BlockCompression;
+    using VirtualTexture::PAGE_BORDER;
+    using VirtualTexture::PAGE_PAYLOAD;
+    using VirtualTexture::PAGE_SIZE;
+
+    std::string pagePath = VirtualTexture::pathFor(gridPath);
+    if (!fs::exists(gridPath) || format == Format::BC6H)
+    {
+        return false;
+    }
+    AssetManifest::Recipe recipe = compressionRecipe(gridPath, format, isNormalMap, "vtex");
+    if (AssetManifest::isCurrent(pagePath, recipe))
+    {
+        std::cout << "  " << fs::path(pagePath).filename().string() << " is up to date\n";
+        return true;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    GridImage grid;
+    if (!loadGridImage(gridPath, grid))
+    {
+        return false;
+    }
+    int faceSize = grid.width / 3;
+
+    VirtualTexture::FileHeader header = {};
+    std::memcpy(header.magic, VirtualTexture::MAGIC, sizeof(header.magic));
+    header.version = VirtualTexture::FORMAT_VERSION;
+    header.vkFormat = vkFormat(format);
+    header.blockBytes = static_cast<uint32_t>(blockBytes(format));
+    VirtualTexture::computeLayout(static_cast<uint32_t>(faceSize), header);
+    header.pageBytes = static_cast<uint32_t>(compressedSize(format, PAGE_SIZE, PAGE_SIZE));
+    header.dataOffset = VirtualTexture::DATA_ALIGNMENT;
+
+    std::string tempPath = AssetManifest::temporaryPath(pagePath);
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "  Failed to open " << tempPath << " for writing\n";
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // Same face loop as the KTX2 path; pages of each level are cut (with borders) and
+    // compressed on all threads, then written to their slot in the file
+    for (int face = 0; face < 6; face++)
+    {
+        std::vector<uint8_t> image = extractFaceRGBA8(grid, faceSize, face);
+        std::vector<uint8_t> next;
+        int size = faceSize;
+        for (uint32_t level = 0; level < header.levelCount; level++)
+        {
+            int pagesPerSide = static_cast<int>(header.levelPagesPerSide[level]);
+            std::vector<std::vector<uint8_t>> pages(static_cast<size_t>(pagesPerSide) * pagesPerSide);
+
+            parallelFor(static_cast<int>(pages.size()), [&](int page) {
+                int originX = (page % pagesPerSide) * static_cast<int>(PAGE_PAYLOAD) - static_cast<int>(PAGE_BORDER);
+                int originY = (page / pagesPerSide) * static_cast<int>(PAGE_PAYLOAD) - static_cast<int>(PAGE_BORDER);
+                std::vector<uint8_t> tile(static_cast<size_t>(PAGE_SIZE) * PAGE_SIZE * 4);
+                for (int y = 0; y < static_cast<int>(PAGE_SIZE); y++)
+                {
+                    int sy = std::clamp(originY + y, 0, size - 1);
+                    for (int x = 0; x < static_cast<int>(PAGE_SIZE); x++)
+                    {
+                        int sx = std::clamp(originX + x, 0, size - 1);
+                        std::memcpy(tile.data() + (static_cast<size_t>(y) * PAGE_SIZE + x) * 4,
+                                    image.data() + (static_cast<size_t>(sy) * size + sx) * 4,
+                                    4);
+                    }
+                }
+                pages[page] = compressImage(format, tile.data(), PAGE_SIZE, PAGE_SIZE, false);
+            });
+
+            for (int page = 0; page < static_cast<int>(pages.size()); page++)
+            {
+                uint32_t index = VirtualTexture::pageIndex(header,
+                                                           level,
+                                                           static_cast<uint32_t>(face),
+                                                           static_cast<uint32_t>(page % pagesPerSide),
+                                                           static_cast<uint32_t>(page / pagesPerSide));
+                uint64_t offset = header.dataOffset + static_cast<uint64_t>(index) * header.pageBytes;
+                out.seekp(static_cast<std::streamoff>(offset));
+                out.write(reinterpret_cast<const char *>(pages[page].data()),
+                          static_cast<std::streamsize>(pages[page].size()));
+            }
+
+            downsampleRGBA8(image.data(), size, size, next, isNormalMap);
+            image.swap(next);
+            size = std::max(1, size / 2);
+        }
+    }
+
+    bool writeFailed = !out;
+    out.close();
+    if (writeFailed || !AssetManifest::commit(tempPath, pagePath, recipe))
+    {
+        std::cerr << "  Failed to write " << pagePath << "\n";
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    uint64_t fileBytes = header.dataOffset + static_cast<uint64_t>(header.pageCount) * header.pageBytes;
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    std::cout << "  " << fs::path(gridPath).filename().string() << " -> " << formatName(format) << " pages, "
+              << header.levelCount << " levels, " << header.pageCount << " pages, "
+              << fileBytes / (1024.0 * 1024.0) << " MB (" << duration.count() << " ms)\n";
+    return true;
+}
+
+int PreprocessCompressedTextures(const std::string &earthPath,
+                                 const std::string &skyboxPath,
+                                 TextureResolution resolution)
+{
+    using BlockCompression::Format;
+
+    std::string resolutionFolder = getResolutionFolderName(resolution);
+    std::string earthFolder = earthPath + "/" + resolutionFolder;
+    std::string skyboxFolder = skyboxPath + "/" + resolutionFolder;
+
+    std::cout << "=== Compressed Texture Preprocessing ===" << "\n";
+
+    struct Job
+    {
+        std::string path;
+        Format format;
+        bool isNormalMap;
+    };
+    std::vector<Job> jobs;
+
+    // All twelve months, so switching months at runtime never falls back to RGBA8
+    for (int month = 1; month <= 12; month++)
+    {
+        char monthStr[3];
+        std::snprintf(monthStr, sizeof(monthStr), "%02d", month);
+        std::string colorPath = earthFolder + "/earth_month_" + monthStr + ".png";
+        if (!fs::exists(colorPath))
+        {
+            colorPath = earthFolder + "/earth_month_" + monthStr + ".jpg";
+        }
+        jobs.push_back({colorPath, Format::BC7, false});
+    }
+    jobs.push_back({earthFolder + "/earth_landmass_normal.png", Format::BC5, true});
+    jobs.push_back({earthFolder + "/earth_specular.png", Format::BC4, false});
+    jobs.push_back({earthFolder + "/earth_nightlights.png", Format::BC4, false});
+    jobs.push_back({earthFolder + "/earth_elevation.hdr", Format::BC4, false});
+    jobs.push_back({earthFolder + "/earth_landmass_heightmap.png", Format::BC4, false});
+    jobs.push_back({skyboxFolder + "/milkyway_combined.hdr", Format::BC6H, false});
+
+    // High and Ultra Earth textures are also cut into pages for the streaming renderer
+    // (the skybox has no page path; BC6H pages are not supported)
+    bool buildPages = resolution == TextureResolution::High || resolution == TextureResolution::Ultra;
+
+    int ready = 0;
+    int pagedReady = 0;
+    for (const auto &job : jobs)
+    {
+        if (!fs::exists(job.path))
+        {
+            continue;
+        }
+        if (CompressCubemapTexture(job.path, job.format, job.isNormalMap))
+        {
+            ready++;
+        }
+        if (buildPages && job.format != Format::BC6H && CompressVirtualTexture(job.path, job.format, job.isNormalMap))
+        {
+            pagedReady++;
+        }
+    }
+
+    std::cout << ready << " compressed cubemaps ready";
+    if (buildPages)
+    {
+        std::cout << ", " << pagedReady << " virtual texture page files ready";
+    }
+    std::cout << "\n";
+    std::cout << "========================================" << "\n";
+    return ready;
+}
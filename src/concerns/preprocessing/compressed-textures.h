@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../../materials/helpers/block-compression.h"
+#include <string>
+
+// Forward declaration
+enum class TextureResolution;
+
+// ==================================
+// Compressed Cubemap Preprocessing
+// ==================================
+// Converts the 3x2 grid cubemaps written by the Earth and skybox preprocessing into
+// mipmapped, block-compressed KTX2 files next to them (same name, ".ktx2" extension):
+//   earth_month_XX          -> BC7
+//   earth_landmass_normal   -> BC5 (the shader rebuilds Z)
+//   earth_specular          -> BC4
+//   earth_nightlights       -> BC4
+//   earth_elevation / earth_landmass_heightmap -> BC4
+//   milkyway_combined.hdr   -> BC6H
+// loadCubemapTextureHelper() prefers the KTX2 file when it is newer than the grid.
+// At High and Ultra the Earth textures are additionally written as virtual texture page
+// files ("<stem>.vtex", see virtual-texture.h) that the renderer streams on demand.
+
+// Compress one 3x2 grid cubemap (PNG/JPG or Radiance HDR) to "<stem>.ktx2"
+// isNormalMap: mip levels renormalize the decoded vectors instead of averaging raw bytes
+// Returns true if the KTX2 file was written or is already newer than the grid
+bool CompressCubemapTexture(const std::string &gridPath, BlockCompression::Format format, bool isNormalMap = false);
+
+// Cut one 3x2 grid cubemap into a virtual texture page pyramid "<stem>.vtex"
+// (PAGE_SIZE pages with filter borders, one level per halving, compressed like the KTX2 levels)
+// BC6H is not supported. Returns true if the page file was written or is already newer than the grid
+bool CompressVirtualTexture(const std::string &gridPath, BlockCompression::Format format, bool isNormalMap = false);
+
+// Compress every known cubemap for the selected resolution (missing grids are skipped)
+// earthPath: Earth output folder (e.g., "earth-textures")
+// skyboxPath: skybox output folder (e.g., "celestial-skybox")
+// Returns the number of cubemaps that are compressed and up to date
+int PreprocessCompressedTextures(const std::string &earthPath,
+                                 const std::string &skyboxPath,
+                                 TextureResolution resolution);
@@ -10,11 +10,14 @@
 
 #include "../../concerns/constants.h"
 #include "../../materials/helpers/cubemap-conversion.h"
+#include "../../materials/helpers/resampling.h"
+#include "../helpers/asset-manifest.h"
 #include "../settings.h"
 #include "../stars-dynamic-skybox.h"
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <stb_image.h>
 #include <stb_image_write.h>
@@ -27,93 +30,42 @@
 #define TINYEXR_IMPLEMENTATION
 #include <tinyexr.h>
 
-// Helper function for resizing images (from stars-dynamic-skybox.cpp)
-static void resizeImage(const unsigned char *src,
-                        int srcW,
-                        int srcH,
-                        unsigned char *dst,
-                        int dstW,
-                        int dstH,
-                        int channels)
-{
-    float xRatio = static_cast<float>(srcW) / dstW;
-    float yRatio = static_cast<float>(srcH) / dstH;
-
-    for (int y = 0; y < dstH; y++)
-    {
-        float srcY = y * yRatio;
-        int y0 = static_cast<int>(srcY);
-        int y1 = std::min(y0 + 1, srcH - 1);
-        float yFrac = srcY - y0;
-
-        for (int x = 0; x < dstW; x++)
-        {
-            float srcX = x * xRatio;
-            int x0 = static_cast<int>(srcX);
-            int x1 = std::min(x0 + 1, srcW - 1);
-            float xFrac = srcX - x0;
-
-            for (int c = 0; c < channels; c++)
-            {
-                // Bilinear interpolation
-                float v00 = src[(y0 * srcW + x0) * channels + c];
-                float v10 = src[(y0 * srcW + x1) * channels + c];
-                float v01 = src[(y1 * srcW + x0) * channels + c];
-                float v11 = src[(y1 * srcW + x1) * channels + c];
+// ==================================
+// Cubemap conversion functions are now in shared utilities
+// See: src/materials/helpers/cubemap-conversion.h
+// ==================================
 
-                float v0 = v00 * (1 - xFrac) + v10 * xFrac;
-                float v1 = v01 * (1 - xFrac) + v11 * xFrac;
-                float value = v0 * (1 - yFrac) + v1 * yFrac;
+// Bump when a skybox texture's processing changes (see AssetManifest)
+static constexpr int OUTPUT_VERSION = 1;
 
-                dst[(y * dstW + x) * channels + c] = static_cast<unsigned char>(std::clamp(value, 0.0f, 255.0f));
-            }
-        }
-    }
+// Recipe of a skybox texture: its sources, target size and how it is encoded
+static AssetManifest::Recipe skyboxRecipe(const std::vector<std::string> &sources,
+                                          int targetWidth,
+                                          int targetHeight,
+                                          const std::string &encoding)
+{
+    AssetManifest::Recipe recipe;
+    recipe.sources = sources;
+    recipe.parameters = std::to_string(targetWidth) + "x" + std::to_string(targetHeight) + " " + encoding;
+    recipe.version = OUTPUT_VERSION;
+    return recipe;
 }
 
-// Helper function for resizing EXR/HDR images (float format)
-static void resizeImageFloat(const float *src, int srcW, int srcH, float *dst, int dstW, int dstH, int channels)
+// Publish a texture written to its temporary path (writeResult: the stb writer's return value)
+static bool publishTexture(int writeResult,
+                           const std::string &tempFile,
+                           const std::string &outputFile,
+                           const AssetManifest::Recipe &recipe)
 {
-    float xRatio = static_cast<float>(srcW) / dstW;
-    float yRatio = static_cast<float>(srcH) / dstH;
-
-    for (int y = 0; y < dstH; y++)
+    if (writeResult && AssetManifest::commit(tempFile, outputFile, recipe))
     {
-        float srcY = y * yRatio;
-        int y0 = static_cast<int>(srcY);
-        int y1 = std::min(y0 + 1, srcH - 1);
-        float yFrac = srcY - y0;
-
-        for (int x = 0; x < dstW; x++)
-        {
-            float srcX = x * xRatio;
-            int x0 = static_cast<int>(srcX);
-            int x1 = std::min(x0 + 1, srcW - 1);
-            float xFrac = srcX - x0;
-
-            for (int c = 0; c < channels; c++)
-            {
-                // Bilinear interpolation
-                float v00 = src[(y0 * srcW + x0) * channels + c];
-                float v10 = src[(y0 * srcW + x1) * channels + c];
-                float v01 = src[(y1 * srcW + x0) * channels + c];
-                float v11 = src[(y1 * srcW + x1) * channels + c];
-
-                float v0 = v00 * (1 - xFrac) + v10 * xFrac;
-                float v1 = v01 * (1 - xFrac) + v11 * xFrac;
-                float value = v0 * (1 - yFrac) + v1 * yFrac;
-
-                dst[(y * dstW + x) * channels + c] = value;
-            }
-        }
+        return true;
     }
+    std::error_code ec;
+    std::filesystem::remove(tempFile, ec);
+    return false;
 }
 
-// ==================================
-// Cubemap conversion functions are now in shared utilities
-// See: src/materials/helpers/cubemap-conversion.h
-// ==================================
-
 // Load TIF file using libtiff and convert to RGB unsigned char array
 static unsigned char *loadTIFAsRGB(const std::string &filepath, int &width, int &height, int &channels)
 {
@@ -241,9 +193,11 @@ static bool preprocessTIFTexture(const std::string &sourceFile,
                                  bool useTransparency = false)
 {
     // Check if already processed (check output/cache directory, not source)
-    if (std::filesystem::exists(outputFile))
+    const char *encoding = useTransparency ? "png-alpha lanczos3" : "jpg95 lanczos3";
+    AssetManifest::Recipe recipe = skyboxRecipe({sourceFile}, targetWidth, targetHeight, encoding);
+    if (AssetManifest::isCurrent(outputFile, recipe))
     {
-        std::cout << "  " << textureName << " texture already exists (cached): " << outputFile << std::endl;
+        std::cout << "  " << textureName << " texture is up to date (cached): " << outputFile << std::endl;
         return true;
     }
 
@@ -293,7 +247,15 @@ static bool preprocessTIFTexture(const std::string &sourceFile,
             return false;
         }
 
-        resizeImage(srcData, srcWidth, srcHeight, dstData, targetWidth, targetHeight, srcChannels);
+        // Lanczos keeps the thin overlay lines crisp through the large 32K reduction
+        Resampling::resize(srcData,
+                           srcWidth,
+                           srcHeight,
+                           dstData,
+                           targetWidth,
+                           targetHeight,
+                           srcChannels,
+                           Resampling::Filter::Lanczos3);
         delete[] srcData;
         processedData = dstData;
         processedWidth = targetWidth;
@@ -373,12 +335,13 @@ static bool preprocessTIFTexture(const std::string &sourceFile,
     int cubemapWidth, cubemapHeight;
     getCubemapGridDimensions(faceSize, cubemapWidth, cubemapHeight);
 
-    // Save as PNG (with alpha) or JPG (without alpha)
+    // Save as PNG (with alpha) or JPG (without alpha), under a temporary name until it is complete
+    std::string tempFile = AssetManifest::temporaryPath(outputFile);
     int result = 0;
     if (useTransparency)
     {
         // Save as PNG with alpha channel
-        result = stbi_write_png(outputFile.c_str(),
+        result = stbi_write_png(tempFile.c_str(),
                                 cubemapWidth,
                                 cubemapHeight,
                                 outputChannels,
@@ -388,12 +351,12 @@ static bool preprocessTIFTexture(const std::string &sourceFile,
     else
     {
         // Save as JPG (no alpha)
-        result = stbi_write_jpg(outputFile.c_str(), cubemapWidth, cubemapHeight, outputChannels, cubemapData, 95);
+        result = stbi_write_jpg(tempFile.c_str(), cubemapWidth, cubemapHeight, outputChannels, cubemapData, 95);
     }
 
     delete[] cubemapData;
 
-    if (result)
+    if (publishTexture(result, tempFile, outputFile, recipe))
     {
         std::cout << "    " << textureName << " cubemap saved successfully as "
                   << (useTransparency ? "PNG (with transparency)" : "JPG") << " (" << cubemapWidth << "x"
@@ -418,23 +381,13 @@ static bool combineEXRTexturesAdditive(const std::string &sourceFile1,
                                        int targetHeight,
                                        const std::string &textureName)
 {
-    // Check if already processed - but don't skip if we're being forced to regenerate
-    // Always check if file actually exists and is valid
-    if (std::filesystem::exists(outputFile))
+    // Check if already processed from the current sources (a cached file is complete: it is only
+    // ever published by renaming a finished temporary file)
+    AssetManifest::Recipe recipe = skyboxRecipe({sourceFile1, sourceFile2}, targetWidth, targetHeight, "hdr box");
+    if (AssetManifest::isCurrent(outputFile, recipe))
     {
-        // Verify file is not empty (corrupted cache)
-        auto fileSize = std::filesystem::file_size(outputFile);
-        if (fileSize > 0)
-        {
-            std::cout << "  " << textureName << " texture already exists (cached): " << outputFile << std::endl;
-            std::cout << "  Skipping regeneration. Delete this file to force regeneration." << std::endl;
-            return true;
-        }
-        else
-        {
-            std::cerr << "  WARNING: Cached file exists but is empty (corrupted). Regenerating..." << std::endl;
-            std::filesystem::remove(outputFile);
-        }
+        std::cout << "  " << textureName << " texture is up to date (cached): " << outputFile << std::endl;
+        return true;
     }
 
     std::cout << "  " << textureName << " texture not found, will generate: " << outputFile << std::endl;
@@ -550,7 +503,14 @@ static bool combineEXRTexturesAdditive(const std::string &sourceFile1,
             delete[] rgbData2;
             return false;
         }
-        resizeImageFloat(rgbData1, srcWidth1, srcHeight1, resizedData1, targetWidth, targetHeight, srcChannels);
+        Resampling::resize(rgbData1,
+                           srcWidth1,
+                           srcHeight1,
+                           resizedData1,
+                           targetWidth,
+                           targetHeight,
+                           srcChannels,
+                           Resampling::Filter::Box);
         delete[] rgbData1;
         rgbData1 = resizedData1;
     }
@@ -566,7 +526,14 @@ static bool combineEXRTexturesAdditive(const std::string &sourceFile1,
             delete[] rgbData2;
             return false;
         }
-        resizeImageFloat(rgbData2, srcWidth2, srcHeight2, resizedData2, targetWidth, targetHeight, srcChannels);
+        Resampling::resize(rgbData2,
+                           srcWidth2,
+                           srcHeight2,
+                           resizedData2,
+                           targetWidth,
+                           targetHeight,
+                           srcChannels,
+                           Resampling::Filter::Box);
         delete[] rgbData2;
         rgbData2 = resizedData2;
     }
@@ -661,10 +628,11 @@ static bool combineEXRTexturesAdditive(const std::string &sourceFile1,
     // Dimensions: (faceSize * 3) x (faceSize * 2)
     int cubemapWidth, cubemapHeight;
     getCubemapGridDimensions(faceSize, cubemapWidth, cubemapHeight);
-    int result = stbi_write_hdr(outputFile.c_str(), cubemapWidth, cubemapHeight, srcChannels, cubemapData);
+    std::string tempFile = AssetManifest::temporaryPath(outputFile);
+    int result = stbi_write_hdr(tempFile.c_str(), cubemapWidth, cubemapHeight, srcChannels, cubemapData);
     delete[] cubemapData;
 
-    if (result)
+    if (publishTexture(result, tempFile, outputFile, recipe))
     {
         std::cout << "    " << textureName << " cubemap saved successfully" << std::endl;
         std::cout << "      Output dimensions: " << cubemapWidth << "x" << cubemapHeight << " (3x2 grid)" << std::endl;
@@ -687,9 +655,10 @@ static bool preprocessEXRTexture(const std::string &sourceFile,
                                  const std::string &textureName)
 {
     // Check if already processed (check output/cache directory, not source)
-    if (std::filesystem::exists(outputFile))
+    AssetManifest::Recipe recipe = skyboxRecipe({sourceFile}, targetWidth, targetHeight, "hdr box");
+    if (AssetManifest::isCurrent(outputFile, recipe))
     {
-        std::cout << "  " << textureName << " texture already exists (cached): " << outputFile << std::endl;
+        std::cout << "  " << textureName << " texture is up to date (cached): " << outputFile << std::endl;
         return true;
     }
 
@@ -758,10 +727,11 @@ static bool preprocessEXRTexture(const std::string &sourceFile,
     if (srcWidth == targetWidth && srcHeight == targetHeight)
     {
         // Save as HDR (stb_image_write doesn't support EXR, but HDR is similar)
-        int result = stbi_write_hdr(outputFile.c_str(), targetWidth, targetHeight, srcChannels, srcData);
+        std::string tempFile = AssetManifest::temporaryPath(outputFile);
+        int result = stbi_write_hdr(tempFile.c_str(), targetWidth, targetHeight, srcChannels, srcData);
         free(srcData);
 
-        if (result)
+        if (publishTexture(result, tempFile, outputFile, recipe))
         {
             std::cout << "    " << textureName << " texture saved successfully (no resize needed)" << std::endl;
             return true;
@@ -784,17 +754,26 @@ static bool preprocessEXRTexture(const std::string &sourceFile,
         return false;
     }
 
-    resizeImageFloat(srcData, srcWidth, srcHeight, dstData, targetWidth, targetHeight, srcChannels);
+    // Box filter: HDR star fields keep their total flux, and there are no negative lobes to ring
+    Resampling::resize(srcData,
+                       srcWidth,
+                       srcHeight,
+                       dstData,
+                       targetWidth,
+                       targetHeight,
+                       srcChannels,
+                       Resampling::Filter::Box);
 
     // Free source data
     free(srcData);
 
     // Save as HDR (stb_image_write doesn't support EXR, but HDR is similar)
-    int result = stbi_write_hdr(outputFile.c_str(), targetWidth, targetHeight, srcChannels, dstData);
+    std::string tempFile = AssetManifest::temporaryPath(outputFile);
+    int result = stbi_write_hdr(tempFile.c_str(), targetWidth, targetHeight, srcChannels, dstData);
 
     delete[] dstData;
 
-    if (result)
+    if (publishTexture(result, tempFile, outputFile, recipe))
     {
         std::cout << "    " << textureName << " texture saved successfully" << std::endl;
         return true;
@@ -2,10 +2,12 @@
 #include "constants.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <vector>
 
 
@@ -25,7 +27,7 @@ namespace SpiceEphemeris
 // ==================================
 // Module State
 // ==================================
-static bool g_initialized = false;
+static std::atomic<bool> g_initialized{false}; // Set by whichever thread loads the kernels
 static std::string g_lastError;
 
 // J2000 epoch in Julian Date (TDB)
@@ -46,6 +48,13 @@ static std::map<int, bool> g_bodyHasData;
 // List of all bodies discovered with ephemeris data
 static std::vector<BodyInfo> g_availableBodies;
 
+// Deferred initialization: bodies and coverage come from the precomputed ephemeris table,
+// kernels are only loaded on the first query that actually needs CSPICE
+static bool g_deferred = false;
+static bool g_deferredLoadFailed = false;
+static std::string g_deferredKernelDir;
+static std::mutex g_deferredLoadMutex;
+
 #ifdef HAS_CSPICE
 
 // List of loaded SPK files for coverage checking
@@ -270,10 +279,17 @@ bool initialize(const std::string &kernelDir)
     }
 
     g_initialized = true;
-    g_availableBodies.clear();
     std::cout << "SPICE: Initialized with " << kernelsLoaded << " kernel(s)\n";
     std::cout << "SPICE: Loaded " << g_loadedSpkFiles.size() << " SPK file(s) for ephemeris data\n";
 
+    // Bodies and coverage were already restored from the ephemeris table
+    // (and may be read by the render thread right now), so keep them as they are
+    if (g_deferred)
+    {
+        return true;
+    }
+    g_availableBodies.clear();
+
     // ==================================
     // Discover all bodies with ephemeris data
     // ==================================
@@ -460,6 +476,34 @@ bool initialize(const std::string &kernelDir)
     return true;
 }
 
+// Load kernels on first use after initializeDeferred
+// Safe to call from the prefetch worker and the render thread
+static bool ensureKernelsLoaded()
+{
+    if (g_initialized)
+    {
+        return true;
+    }
+    if (!g_deferred)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_deferredLoadMutex);
+    if (g_initialized)
+    {
+        return true;
+    }
+    if (g_deferredLoadFailed)
+    {
+        return false;
+    }
+
+    std::cout << "SPICE: Query outside the precomputed ephemeris table, loading kernels\n";
+    g_deferredLoadFailed = !initialize(g_deferredKernelDir);
+    return !g_deferredLoadFailed;
+}
+
 void cleanup()
 {
     if (g_initialized)
@@ -467,9 +511,11 @@ void cleanup()
         kclear_c();
         g_initialized = false;
         g_loadedSpkFiles.clear();
-        g_bodyHasData.clear();
-        g_availableBodies.clear();
     }
+    g_deferred = false;
+    g_deferredLoadFailed = false;
+    g_bodyHasData.clear();
+    g_availableBodies.clear();
 }
 
 // ==================================
@@ -480,7 +526,7 @@ bool getTimeCoverage(int naifId, double &startJD, double &endJD)
 {
     startJD = g_validStartJD;
     endJD = g_validEndJD;
-    return g_initialized;
+    return g_initialized || g_deferred;
 }
 
 double getLatestAvailableTime()
@@ -531,9 +577,49 @@ double utcToTdbJulian(int year, int month, int day, int hour, int minute, double
 // Position Functions (CSPICE)
 // ==================================
 
+// Convert from km to AU
+static constexpr double KM_PER_AU = 149597870.7;
+
+// Convert velocity from km/s to AU/day
+static constexpr double KM_S_TO_AU_DAY = SECONDS_PER_DAY / KM_PER_AU;
+
+// Query the SSB-relative state of a body at an ephemeris time
+// Uses the integer-ID spkez_c so no target/observer strings are built per call
+// Outputs position in AU and velocity in AU/day; returns false on SPICE error
+static bool stateAtEt(int naifId, double et, double position[3], double velocity[3])
+{
+    // State vector: [x, y, z, vx, vy, vz] in km and km/s
+    SpiceDouble state[6];
+    SpiceDouble lt; // Light time (not used but required)
+
+    // Get state relative to Solar System Barycenter in J2000 frame
+    spkez_c(naifId,   // Target body
+            et,       // Epoch (TDB)
+            "J2000",  // Reference frame
+            "NONE",   // Aberration correction (none for geometric)
+            NAIF_SSB, // Observer: SSB (NAIF ID 0)
+            state,    // Output state
+            &lt       // Light time
+    );
+
+    if (failed_c())
+    {
+        // Don't spam errors - just return false
+        reset_c();
+        return false;
+    }
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        position[axis] = state[axis] / KM_PER_AU;
+        velocity[axis] = state[axis + 3] * KM_S_TO_AU_DAY;
+    }
+    return true;
+}
+
 bool getBodyState(int naifId, double jdTdb, glm::dvec3 &position, glm::dvec3 &velocity)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
     {
         position = glm::dvec3(0.0);
         velocity = glm::dvec3(0.0);
@@ -549,45 +635,16 @@ bool getBodyState(int naifId, double jdTdb, glm::dvec3 &position, glm::dvec3 &ve
         return false;
     }
 
-    // Convert Julian Date to ephemeris time
-    SpiceDouble et = julianToEt(jdTdb);
-
-    // State vector: [x, y, z, vx, vy, vz] in km and km/s
-    SpiceDouble state[6];
-    SpiceDouble lt; // Light time (not used but required)
-
-    // Get state relative to Solar System Barycenter in J2000 frame
-    spkezr_c(std::to_string(naifId).c_str(), // Target body
-             et,                             // Epoch (TDB)
-             "J2000",                        // Reference frame
-             "NONE",                         // Aberration correction (none for geometric)
-             "0",                            // Observer: SSB (NAIF ID 0)
-             state,                          // Output state
-             &lt                             // Light time
-    );
-
-    if (failed_c())
+    double pos[3], vel[3];
+    if (!stateAtEt(naifId, julianToEt(jdTdb), pos, vel))
     {
-        // Don't spam errors - just return false
-        reset_c();
         position = glm::dvec3(0.0);
         velocity = glm::dvec3(0.0);
         return false;
     }
 
-    // Convert from km to AU
-    constexpr double KM_PER_AU = 149597870.7;
-
-    position.x = state[0] / KM_PER_AU;
-    position.y = state[1] / KM_PER_AU;
-    position.z = state[2] / KM_PER_AU;
-
-    // Convert velocity from km/s to AU/day
-    constexpr double KM_S_TO_AU_DAY = SECONDS_PER_DAY / KM_PER_AU;
-    velocity.x = state[3] * KM_S_TO_AU_DAY;
-    velocity.y = state[4] * KM_S_TO_AU_DAY;
-    velocity.z = state[5] * KM_S_TO_AU_DAY;
-
+    position = glm::dvec3(pos[0], pos[1], pos[2]);
+    velocity = glm::dvec3(vel[0], vel[1], vel[2]);
     return true;
 }
 
@@ -603,7 +660,7 @@ bool hasBodyData(int naifId)
 
 glm::dvec3 getBodyPoleDirection(int naifId, double jdTdb)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
     {
         return glm::dvec3(0.0, 1.0, 0.0); // Default: ecliptic north
     }
@@ -765,7 +822,7 @@ static const char *getIAUFrameName(int naifId)
 
 glm::dvec3 getBodyPrimeMeridian(int naifId, double jdTdb)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
     {
         return glm::dvec3(1.0, 0.0, 0.0); // Fallback
     }
@@ -798,7 +855,7 @@ glm::dvec3 getBodyPrimeMeridian(int naifId, double jdTdb)
 
 bool getBodyFrame(int naifId, double jdTdb, glm::dvec3 &pole, glm::dvec3 &primeMeridian)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
     {
         pole = glm::dvec3(0.0, 1.0, 0.0);
         primeMeridian = glm::dvec3(1.0, 0.0, 0.0);
@@ -835,9 +892,83 @@ bool getBodyFrame(int naifId, double jdTdb, glm::dvec3 &pole, glm::dvec3 &primeM
     return true;
 }
 
+// ==================================
+// Batch Queries (CSPICE)
+// ==================================
+
+size_t queryBatch(EphemerisBatch &batch)
+{
+    batch.prepare();
+
+    static const double ZERO[3] = {0.0, 0.0, 0.0};
+    static const double DEFAULT_POLE[3] = {0.0, 1.0, 0.0};
+    static const double DEFAULT_PRIME_MERIDIAN[3] = {1.0, 0.0, 0.0};
+
+    const size_t bodyCount = batch.bodyCount();
+    size_t validStates = 0;
+
+    // Resolve per-body lookups once for the whole batch
+    // (kept across calls to avoid a per-frame allocation; CSPICE is single-threaded anyway)
+    static std::vector<uint8_t> bodyHasData;
+    static std::vector<const char *> bodyFrames;
+    const bool kernelsReady = ensureKernelsLoaded();
+    bodyHasData.resize(bodyCount);
+    bodyFrames.resize(bodyCount);
+    for (size_t b = 0; b < bodyCount; b++)
+    {
+        int naifId = batch.naifIds[b];
+        auto it = g_bodyHasData.find(naifId);
+        bodyHasData[b] = kernelsReady && (it == g_bodyHasData.end() || it->second);
+        bodyFrames[b] = kernelsReady ? getIAUFrameName(naifId) : nullptr;
+    }
+
+    for (size_t e = 0; e < batch.epochs.size(); e++)
+    {
+        double et = julianToEt(batch.epochs[e]);
+
+        for (size_t b = 0; b < bodyCount; b++)
+        {
+            size_t i = batch.index(e, b);
+
+            double position[3], velocity[3];
+            bool stateOk = bodyHasData[b] && stateAtEt(batch.naifIds[b], et, position, velocity);
+            batch.setState(i, stateOk ? position : ZERO, stateOk ? velocity : ZERO);
+            batch.hasState[i] = stateOk ? 1 : 0;
+            validStates += stateOk ? 1 : 0;
+
+            bool frameOk = false;
+            if (bodyFrames[b])
+            {
+                SpiceDouble tipm[3][3];
+                pxform_c(bodyFrames[b], "J2000", et, tipm);
+                if (failed_c())
+                {
+                    reset_c();
+                }
+                else
+                {
+                    glm::dvec3 pole = glm::normalize(glm::dvec3(tipm[0][2], tipm[1][2], tipm[2][2]));
+                    glm::dvec3 pm = glm::normalize(glm::dvec3(tipm[0][0], tipm[1][0], tipm[2][0]));
+                    double poleArr[3] = {pole.x, pole.y, pole.z};
+                    double pmArr[3] = {pm.x, pm.y, pm.z};
+                    batch.setFrame(i, poleArr, pmArr);
+                    frameOk = true;
+                }
+            }
+            if (!frameOk)
+            {
+                batch.setFrame(i, DEFAULT_POLE, DEFAULT_PRIME_MERIDIAN);
+            }
+            batch.hasFrame[i] = frameOk ? 1 : 0;
+        }
+    }
+
+    return validStates;
+}
+
 bool hasRotationData(int naifId)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
         return false;
 
     // Try to get pole data - if it succeeds, we have rotation data
@@ -985,7 +1116,7 @@ static const char *getBodyNameForId(int naifId)
 
 glm::dvec3 getBodyRadii(int naifId)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
         return glm::dvec3(0.0);
 
     const char *bodyName = getBodyNameForId(naifId);
@@ -1021,7 +1152,7 @@ double getBodyMeanRadius(int naifId)
 
 double getBodyGM(int naifId)
 {
-    if (!g_initialized)
+    if (!ensureKernelsLoaded())
         return 0.0;
 
     const char *bodyName = getBodyNameForId(naifId);
@@ -1110,6 +1241,22 @@ bool hasBodyData(int naifId)
     return false;
 }
 
+size_t queryBatch(EphemerisBatch &batch)
+{
+    batch.prepare();
+    static const double ZERO[3] = {0.0, 0.0, 0.0};
+    static const double DEFAULT_POLE[3] = {0.0, 1.0, 0.0};
+    static const double DEFAULT_PRIME_MERIDIAN[3] = {1.0, 0.0, 0.0};
+    for (size_t i = 0; i < batch.sampleCount(); i++)
+    {
+        batch.setState(i, ZERO, ZERO);
+        batch.setFrame(i, DEFAULT_POLE, DEFAULT_PRIME_MERIDIAN);
+        batch.hasState[i] = 0;
+        batch.hasFrame[i] = 0;
+    }
+    return 0;
+}
+
 glm::dvec3 getBodyPoleDirection(int naifId, double jdTdb)
 {
     return glm::dvec3(0.0, 1.0, 0.0); // Default: ecliptic north
@@ -1143,7 +1290,38 @@ double getBodyMass(int naifId)
 // Common Functions (always available)
 // ==================================
 
+bool initializeDeferred(const std::string &kernelDir, const std::vector<BodyInfo> &bodies, double validStartJD,
+                        double validEndJD)
+{
+    if (g_initialized || g_deferred)
+    {
+        return true;
+    }
+
+    g_availableBodies = bodies;
+    g_bodyHasData.clear();
+    for (const auto &body : bodies)
+    {
+        g_bodyHasData[body.naifId] = true;
+    }
+    g_validStartJD = validStartJD;
+    g_validEndJD = validEndJD;
+    g_validStartET = julianToEt(validStartJD);
+    g_validEndET = julianToEt(validEndJD);
+    g_deferredKernelDir = kernelDir;
+    g_deferredLoadFailed = false;
+    g_deferred = true;
+
+    std::cout << "SPICE: Using " << bodies.size() << " bodies from the ephemeris table, kernels load on demand\n";
+    return true;
+}
+
 bool isInitialized()
+{
+    return g_initialized || g_deferred;
+}
+
+bool kernelsLoaded()
 {
     return g_initialized;
 }
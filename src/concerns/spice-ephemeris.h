@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
@@ -51,9 +53,19 @@ constexpr int NAIF_CHARON = 901;   // Charon
 // Returns true if at least one SPK kernel was loaded successfully
 bool initialize(const std::string &kernelDir);
 
-// Check if SPICE is initialized
+struct BodyInfo;
+
+// Initialize without loading kernels, using bodies and coverage restored from a precomputed
+// ephemeris table. Kernels are loaded from kernelDir on the first query that needs CSPICE
+bool initializeDeferred(const std::string &kernelDir, const std::vector<BodyInfo> &bodies, double validStartJD,
+                        double validEndJD);
+
+// Check if SPICE is initialized (deferred initialization counts)
 bool isInitialized();
 
+// Check if kernels are actually loaded (false while initialization is deferred)
+bool kernelsLoaded();
+
 // Cleanup and unload all kernels
 void cleanup();
 
@@ -99,6 +111,81 @@ glm::dvec3 getBodyPosition(int naifId, double jdTdb);
 // Returns false if body not found or time out of range
 bool getBodyState(int naifId, double jdTdb, glm::dvec3 &position, glm::dvec3 &velocity);
 
+// ==================================
+// Batch Queries (structure-of-arrays)
+// ==================================
+
+// Positions, velocities and body frames for a list of bodies at one or many epochs
+// Caller fills naifIds and epochs, then calls prepare() to size the output arrays
+// Sample index = epochIndex * naifIds.size() + bodyIndex (see index())
+// Buffers are reused between queries, so keep one batch alive to avoid per-frame allocations
+struct EphemerisBatch
+{
+    std::vector<int> naifIds;   // Bodies to query
+    std::vector<double> epochs; // TDB Julian Dates
+
+    std::vector<double> positionX, positionY, positionZ;                // Position in AU (SSB, J2000)
+    std::vector<double> velocityX, velocityY, velocityZ;                // Velocity in AU/day
+    std::vector<double> poleX, poleY, poleZ;                            // North pole direction (unit)
+    std::vector<double> primeMeridianX, primeMeridianY, primeMeridianZ; // Prime meridian direction (unit)
+    std::vector<uint8_t> hasState; // 1 if position/velocity are valid (else zero)
+    std::vector<uint8_t> hasFrame; // 1 if pole/prime meridian are valid (else J2000 defaults)
+
+    size_t bodyCount() const
+    {
+        return naifIds.size();
+    }
+
+    size_t sampleCount() const
+    {
+        return naifIds.size() * epochs.size();
+    }
+
+    size_t index(size_t epochIndex, size_t bodyIndex) const
+    {
+        return epochIndex * naifIds.size() + bodyIndex;
+    }
+
+    // Resize output arrays to naifIds.size() * epochs.size()
+    void prepare()
+    {
+        size_t n = sampleCount();
+        for (auto *buffer : {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &poleX, &poleY,
+                             &poleZ, &primeMeridianX, &primeMeridianY, &primeMeridianZ})
+        {
+            buffer->resize(n);
+        }
+        hasState.resize(n);
+        hasFrame.resize(n);
+    }
+
+    // Write one sample (used by the query implementations)
+    void setState(size_t i, const double position[3], const double velocity[3])
+    {
+        positionX[i] = position[0];
+        positionY[i] = position[1];
+        positionZ[i] = position[2];
+        velocityX[i] = velocity[0];
+        velocityY[i] = velocity[1];
+        velocityZ[i] = velocity[2];
+    }
+
+    void setFrame(size_t i, const double pole[3], const double primeMeridian[3])
+    {
+        poleX[i] = pole[0];
+        poleY[i] = pole[1];
+        poleZ[i] = pole[2];
+        primeMeridianX[i] = primeMeridian[0];
+        primeMeridianY[i] = primeMeridian[1];
+        primeMeridianZ[i] = primeMeridian[2];
+    }
+};
+
+// Fill a batch with direct SPICE queries
+// Body lookups (data availability, IAU frame names) are resolved once per body, not per sample
+// Returns the number of samples with a valid state
+size_t queryBatch(EphemerisBatch &batch);
+
 // ==================================
 // Rotation/Orientation Functions
 // ==================================
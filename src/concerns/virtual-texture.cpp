@@ -0,0 +1,563 @@
+#include "virtual-texture.h"
+#include "helpers/mapped-file.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace VirtualTexture
+{
+
+// ==================================
+// Module State
+// ==================================
+
+static constexpr uint32_t NO_LAYER = std::numeric_limits<uint32_t>::max();
+static constexpr uint32_t NO_PAGE = std::numeric_limits<uint32_t>::max();
+
+struct TextureState
+{
+    MappedFile file;
+    FileHeader header = {};
+    uint32_t pageBase = 0;            // Offset in the shared page table / feedback bitset
+    uint32_t pinnedFirstPage = 0;     // Pages from here on (top level) are never evicted
+    std::vector<uint32_t> pageLayer;  // Per page: cache layer or NO_LAYER
+    std::vector<uint8_t> pagePending; // Per page: queued, loading or waiting in g_ready
+    std::vector<uint64_t> pageWanted; // Per page: feedback frame that last asked for it
+    std::vector<uint32_t> layerPage;  // Per layer: page or NO_PAGE
+    std::vector<uint64_t> layerUsed;  // Per layer: feedback frame that last touched it
+    std::vector<uint32_t> freeLayers;
+};
+
+struct PageRequest
+{
+    uint32_t texture;
+    uint32_t page;
+};
+
+struct LoadedPage
+{
+    uint32_t texture;
+    uint32_t page;
+    std::vector<uint8_t> data;
+};
+
+static std::vector<std::unique_ptr<TextureState>> g_textures;
+static uint32_t g_capacity = 0;
+static uint32_t g_totalPages = 0;
+static uint64_t g_pageTableVersion = 0;
+static uint64_t g_feedbackFrame = 0; // Incremented per processFeedback; 0 = never used
+static Stats g_stats;
+
+// Loader thread: pops g_queue front to back, pushes to g_ready
+static std::thread g_loader;
+static std::mutex g_loaderMutex;
+static std::condition_variable g_loaderWake;
+static std::deque<PageRequest> g_queue;
+static std::vector<LoadedPage> g_ready;
+static bool g_stopLoader = false;
+
+static const FileHeader g_emptyHeader = {};
+
+// ==================================
+// Page Layout
+// ==================================
+
+std::string pathFor(const std::string &texturePath)
+{
+    return fs::path(texturePath).replace_extension(FILE_EXTENSION).string();
+}
+
+bool isUpToDate(const std::string &texturePath)
+{
+    std::error_code ec;
+    auto pageFileTime = fs::last_write_time(pathFor(texturePath), ec);
+    if (ec)
+    {
+        return false;
+    }
+    auto sourceTime = fs::last_write_time(texturePath, ec);
+    return ec || pageFileTime >= sourceTime;
+}
+
+void computeLayout(uint32_t faceSize, FileHeader &header)
+{
+    header.faceSize = faceSize;
+    header.levelCount = 0;
+    header.pageCount = 0;
+    std::memset(header.levelFirstPage, 0, sizeof(header.levelFirstPage));
+    std::memset(header.levelPagesPerSide, 0, sizeof(header.levelPagesPerSide));
+
+    for (uint32_t level = 0; level < MAX_LEVELS; level++)
+    {
+        uint32_t size = levelSize(faceSize, level);
+        uint32_t pagesPerSide = (size + PAGE_PAYLOAD - 1) / PAGE_PAYLOAD;
+        header.levelFirstPage[level] = header.pageCount;
+        header.levelPagesPerSide[level] = pagesPerSide;
+        header.pageCount += 6 * pagesPerSide * pagesPerSide;
+        header.levelCount = level + 1;
+        if (pagesPerSide == 1)
+        {
+            break;
+        }
+    }
+}
+
+// Level of a page index (levels are stored finest first)
+static uint32_t pageLevel(const FileHeader &header, uint32_t page)
+{
+    uint32_t level = 0;
+    while (level + 1 < header.levelCount && page >= header.levelFirstPage[level + 1])
+    {
+        level++;
+    }
+    return level;
+}
+
+// Page covering the same area one level coarser (NO_PAGE for the top level)
+static uint32_t parentPage(const FileHeader &header, uint32_t page)
+{
+    uint32_t level = pageLevel(header, page);
+    if (level + 1 >= header.levelCount)
+    {
+        return NO_PAGE;
+    }
+    uint32_t pagesPerSide = header.levelPagesPerSide[level];
+    uint32_t local = page - header.levelFirstPage[level];
+    uint32_t face = local / (pagesPerSide * pagesPerSide);
+    uint32_t y = (local / pagesPerSide) % pagesPerSide;
+    uint32_t x = local % pagesPerSide;
+    return pageIndex(header, level + 1, face, x / 2, y / 2);
+}
+
+uint32_t cacheCapacityForScreen(uint32_t width, uint32_t height)
+{
+    uint64_t pagesOnScreen = (static_cast<uint64_t>(width) * height + PAGE_PAYLOAD * PAGE_PAYLOAD - 1) /
+                             (PAGE_PAYLOAD * PAGE_PAYLOAD);
+    uint64_t capacity = 4 * pagesOnScreen + 6;
+    return static_cast<uint32_t>(std::clamp<uint64_t>(capacity, MIN_CACHE_PAGES, MAX_CACHE_PAGES));
+}
+
+// ==================================
+// Loader Thread
+// ==================================
+
+static std::vector<uint8_t> readPage(const TextureState &texture, uint32_t page)
+{
+    const uint8_t *source = texture.file.data() + texture.header.dataOffset +
+                            static_cast<uint64_t>(page) * texture.header.pageBytes;
+    return std::vector<uint8_t>(source, source + texture.header.pageBytes);
+}
+
+static void loaderMain()
+{
+    std::unique_lock<std::mutex> lock(g_loaderMutex);
+    while (true)
+    {
+        g_loaderWake.wait(lock, [] { return g_stopLoader || !g_queue.empty(); });
+        if (g_stopLoader)
+        {
+            return;
+        }
+
+        PageRequest request = g_queue.front();
+        g_queue.pop_front();
+
+        // Copying out of the mapping is where the disk reads happen, so do it unlocked
+        lock.unlock();
+        std::vector<uint8_t> data = readPage(*g_textures[request.texture], request.page);
+        lock.lock();
+
+        g_ready.push_back({request.texture, request.page, std::move(data)});
+    }
+}
+
+// ==================================
+// Open / Close
+// ==================================
+
+static bool openTexture(const std::string &path, TextureState &texture)
+{
+    if (!texture.file.open(path))
+    {
+        std::cerr << "VirtualTexture: Failed to open " << path << "\n";
+        return false;
+    }
+    if (texture.file.size() < sizeof(FileHeader))
+    {
+        std::cerr << "VirtualTexture: Truncated page file " << path << "\n";
+        return false;
+    }
+
+    std::memcpy(&texture.header, texture.file.data(), sizeof(FileHeader));
+    const FileHeader &header = texture.header;
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION)
+    {
+        std::cerr << "VirtualTexture: Not a page file (or old version): " << path << "\n";
+        return false;
+    }
+
+    FileHeader expected = {};
+    computeLayout(header.faceSize, expected);
+    bool layoutMatches = header.faceSize > 0 && header.levelCount == expected.levelCount &&
+                         header.pageCount == expected.pageCount;
+    for (uint32_t level = 0; layoutMatches && level < MAX_LEVELS; level++)
+    {
+        layoutMatches = header.levelFirstPage[level] == expected.levelFirstPage[level] &&
+                        header.levelPagesPerSide[level] == expected.levelPagesPerSide[level];
+    }
+    uint64_t dataEnd = header.dataOffset + static_cast<uint64_t>(header.pageCount) * header.pageBytes;
+    if (!layoutMatches || header.pageBytes == 0 || header.pageBytes > MAX_PAGE_BYTES || dataEnd > texture.file.size())
+    {
+        std::cerr << "VirtualTexture: Corrupt or truncated page file " << path << "\n";
+        return false;
+    }
+
+    texture.pinnedFirstPage = header.levelFirstPage[header.levelCount - 1];
+    texture.pageLayer.assign(header.pageCount, NO_LAYER);
+    texture.pagePending.assign(header.pageCount, 0);
+    texture.pageWanted.assign(header.pageCount, 0);
+    texture.layerPage.assign(g_capacity, NO_PAGE);
+    texture.layerUsed.assign(g_capacity, 0);
+    texture.freeLayers.clear();
+    for (uint32_t layer = g_capacity; layer-- > 0;)
+    {
+        texture.freeLayers.push_back(layer);
+    }
+    return true;
+}
+
+bool open(const std::array<std::string, TEXTURE_COUNT> &paths, uint32_t capacity)
+{
+    close();
+
+    g_capacity = std::clamp(capacity, MIN_CACHE_PAGES, MAX_CACHE_PAGES);
+    g_totalPages = 0;
+    g_stats = Stats();
+    g_stats.capacity = g_capacity;
+
+    for (uint32_t t = 0; t < TEXTURE_COUNT; t++)
+    {
+        auto texture = std::make_unique<TextureState>();
+        if (!openTexture(paths[t], *texture))
+        {
+            g_textures.clear();
+            return false;
+        }
+        texture->pageBase = g_totalPages;
+        g_totalPages += texture->header.pageCount;
+        g_stats.cacheBytes += static_cast<uint64_t>(g_capacity) * texture->header.pageBytes;
+        g_stats.datasetBytes += static_cast<uint64_t>(texture->header.pageCount) * texture->header.pageBytes;
+        g_textures.push_back(std::move(texture));
+    }
+
+    if (g_totalPages > MAX_TOTAL_PAGES)
+    {
+        std::cerr << "VirtualTexture: " << g_totalPages << " pages exceed the page table limit of " << MAX_TOTAL_PAGES
+                  << "\n";
+        g_textures.clear();
+        return false;
+    }
+
+    // Top level pages go first and synchronously, so the first takeUploads() makes every
+    // texture fully sampleable (coarsely) before any feedback has arrived
+    for (uint32_t t = 0; t < TEXTURE_COUNT; t++)
+    {
+        TextureState &texture = *g_textures[t];
+        for (uint32_t page = texture.pinnedFirstPage; page < texture.header.pageCount; page++)
+        {
+            texture.pagePending[page] = 1;
+            g_ready.push_back({t, page, readPage(texture, page)});
+            g_stats.requestedPages++;
+        }
+    }
+
+    g_stopLoader = false;
+    g_loader = std::thread(loaderMain);
+    g_pageTableVersion++;
+    return true;
+}
+
+void close()
+{
+    if (g_loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_loaderMutex);
+            g_stopLoader = true;
+        }
+        g_loaderWake.notify_all();
+        g_loader.join();
+    }
+
+    bool wasOpen = !g_textures.empty();
+    g_queue.clear();
+    g_ready.clear();
+    g_textures.clear();
+    g_totalPages = 0;
+    g_capacity = 0;
+    g_feedbackFrame = 0;
+    if (wasOpen)
+    {
+        g_pageTableVersion++;
+    }
+}
+
+bool isOpen()
+{
+    return !g_textures.empty();
+}
+
+const FileHeader &getHeader(uint32_t texture)
+{
+    return texture < g_textures.size() ? g_textures[texture]->header : g_emptyHeader;
+}
+
+uint32_t getCapacity()
+{
+    return g_capacity;
+}
+
+// ==================================
+// Page Table
+// ==================================
+
+uint64_t getPageTableVersion()
+{
+    return g_pageTableVersion;
+}
+
+size_t getPageTableBytes()
+{
+    return sizeof(GpuPageTableHeader) + static_cast<size_t>(g_totalPages) * sizeof(uint32_t);
+}
+
+void writePageTable(void *destination)
+{
+    GpuPageTableHeader header = {};
+    header.enabled = isOpen() ? 1 : 0;
+    header.totalPages = g_totalPages;
+    for (size_t t = 0; t < g_textures.size(); t++)
+    {
+        const TextureState &texture = *g_textures[t];
+        GpuTextureInfo &info = header.textures[t];
+        info.pageBase = texture.pageBase;
+        info.levelCount = texture.header.levelCount;
+        info.faceSize = texture.header.faceSize;
+        std::memcpy(info.levelFirstPage, texture.header.levelFirstPage, sizeof(info.levelFirstPage));
+        std::memcpy(info.levelPagesPerSide, texture.header.levelPagesPerSide, sizeof(info.levelPagesPerSide));
+    }
+    std::memcpy(destination, &header, sizeof(header));
+
+    uint32_t *entries = reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(destination) + sizeof(header));
+    for (const auto &texture : g_textures)
+    {
+        for (uint32_t page = 0; page < texture->header.pageCount; page++)
+        {
+            uint32_t layer = texture->pageLayer[page];
+            entries[texture->pageBase + page] = layer == NO_LAYER ? 0 : layer + 1;
+        }
+    }
+}
+
+// ==================================
+// Feedback and Residency
+// ==================================
+
+void processFeedback(const uint32_t *requestedBits)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    g_feedbackFrame++;
+
+    // Missing pages and their missing ancestors, so a fast zoom fills in coarse to fine
+    std::vector<PageRequest> missing;
+    for (uint32_t t = 0; t < TEXTURE_COUNT; t++)
+    {
+        TextureState &texture = *g_textures[t];
+        for (uint32_t page = 0; page < texture.header.pageCount; page++)
+        {
+            uint32_t bit = texture.pageBase + page;
+            if ((requestedBits[bit / 32] & (1u << (bit % 32))) == 0)
+            {
+                continue;
+            }
+
+            // Walk up to the resident page the shader fell back to and keep it alive as well
+            for (uint32_t p = page; p != NO_PAGE; p = parentPage(texture.header, p))
+            {
+                uint32_t layer = texture.pageLayer[p];
+                if (layer != NO_LAYER)
+                {
+                    texture.layerUsed[layer] = g_feedbackFrame;
+                    break;
+                }
+                if (texture.pageWanted[p] == g_feedbackFrame)
+                {
+                    break; // Rest of the chain already visited for a sibling
+                }
+                texture.pageWanted[p] = g_feedbackFrame;
+                if (texture.pagePending[p] == 0)
+                {
+                    texture.pagePending[p] = 1;
+                    missing.push_back({t, p});
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(g_loaderMutex);
+
+    // Requests the view has moved away from are dropped instead of delaying the new ones
+    size_t keptRequests = 0;
+    for (const auto &request : g_queue)
+    {
+        TextureState &texture = *g_textures[request.texture];
+        if (texture.pageWanted[request.page] == g_feedbackFrame)
+        {
+            missing.push_back(request);
+            keptRequests++;
+        }
+        else
+        {
+            texture.pagePending[request.page] = 0;
+        }
+    }
+    g_queue.clear();
+
+    // Coarse levels first: higher page indices within a texture are coarser levels
+    std::sort(missing.begin(), missing.end(), [](const PageRequest &a, const PageRequest &b) {
+        uint32_t levelA = pageLevel(g_textures[a.texture]->header, a.page);
+        uint32_t levelB = pageLevel(g_textures[b.texture]->header, b.page);
+        if (levelA != levelB)
+        {
+            return levelA > levelB;
+        }
+        return a.texture != b.texture ? a.texture < b.texture : a.page < b.page;
+    });
+    for (const auto &request : missing)
+    {
+        g_queue.push_back(request);
+    }
+    g_stats.requestedPages += missing.size() - keptRequests;
+    if (!g_queue.empty())
+    {
+        g_loaderWake.notify_one();
+    }
+}
+
+// Layer for a new page: a free one, else the least recently used page not touched by the
+// latest feedback (pinned top level pages are never replaced)
+static uint32_t allocateLayer(TextureState &texture)
+{
+    if (!texture.freeLayers.empty())
+    {
+        uint32_t layer = texture.freeLayers.back();
+        texture.freeLayers.pop_back();
+        return layer;
+    }
+
+    uint32_t victim = NO_LAYER;
+    uint64_t oldest = g_feedbackFrame;
+    for (uint32_t layer = 0; layer < g_capacity; layer++)
+    {
+        uint32_t page = texture.layerPage[layer];
+        if (page >= texture.pinnedFirstPage || texture.layerUsed[layer] >= oldest)
+        {
+            continue;
+        }
+        oldest = texture.layerUsed[layer];
+        victim = layer;
+    }
+    if (victim == NO_LAYER)
+    {
+        return NO_LAYER;
+    }
+
+    texture.pageLayer[texture.layerPage[victim]] = NO_LAYER;
+    texture.layerPage[victim] = NO_PAGE;
+    g_stats.evictedPages++;
+    return victim;
+}
+
+std::vector<PageUpload> takeUploads(uint32_t maxPages)
+{
+    std::vector<LoadedPage> loaded;
+    {
+        std::lock_guard<std::mutex> lock(g_loaderMutex);
+        size_t count = std::min<size_t>(maxPages, g_ready.size());
+        loaded.assign(std::make_move_iterator(g_ready.begin()), std::make_move_iterator(g_ready.begin() + count));
+        g_ready.erase(g_ready.begin(), g_ready.begin() + count);
+    }
+
+    std::vector<PageUpload> uploads;
+    uploads.reserve(loaded.size());
+    for (auto &page : loaded)
+    {
+        TextureState &texture = *g_textures[page.texture];
+        texture.pagePending[page.page] = 0;
+        if (texture.pageLayer[page.page] != NO_LAYER)
+        {
+            continue;
+        }
+
+        // Cache full of pages the view still uses: drop it, feedback will ask again
+        uint32_t layer = allocateLayer(texture);
+        if (layer == NO_LAYER)
+        {
+            continue;
+        }
+
+        texture.pageLayer[page.page] = layer;
+        texture.layerPage[layer] = page.page;
+        texture.layerUsed[layer] = g_feedbackFrame;
+        uploads.push_back({page.texture, layer, std::move(page.data)});
+    }
+
+    if (!uploads.empty())
+    {
+        g_stats.uploadedPages += uploads.size();
+        g_pageTableVersion++;
+    }
+    return uploads;
+}
+
+// ==================================
+// Statistics
+// ==================================
+
+Stats getStats()
+{
+    Stats stats = g_stats;
+    stats.residentPages = 0;
+    for (const auto &texture : g_textures)
+    {
+        stats.residentPages += g_capacity - static_cast<uint32_t>(texture->freeLayers.size());
+    }
+    return stats;
+}
+
+void printStats()
+{
+    Stats stats = getStats();
+    std::cout << "=== Earth Virtual Texture Statistics ===" << "\n";
+    std::cout << "Cache: " << stats.capacity << " pages per texture, " << stats.cacheBytes / (1024.0 * 1024.0)
+              << " MB (dataset " << stats.datasetBytes / (1024.0 * 1024.0) << " MB)" << "\n";
+    std::cout << "Resident pages: " << stats.residentPages << "\n";
+    std::cout << "Requested: " << stats.requestedPages << ", uploaded: " << stats.uploadedPages
+              << ", evicted: " << stats.evictedPages << "\n";
+    std::cout << "========================================" << "\n";
+}
+
+} // namespace VirtualTexture
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================================
+// Earth Virtual Texture Module
+// ==================================
+// Streams the Earth cubemaps at High/Ultra resolution as fixed-size pages instead of
+// uploading whole textures. Preprocessing writes each texture as a tiled page pyramid
+// ("<stem>.vtex", see CompressVirtualTexture); single-pass-screen.frag marks the pages it
+// wanted in a feedback bitset; this module turns that feedback into page requests, loads
+// them on a background thread, and assigns them layers of a fixed-size physical cache.
+// GPU memory therefore scales with the screen, not with the dataset.
+//
+// Page file layout:
+//   FileHeader
+//   zero padding up to dataOffset (DATA_ALIGNMENT)
+//   pages[pageCount], pageBytes each, ordered by level, face (+X -X +Y -Y +Z -Z), row, column
+// Each page holds PAGE_PAYLOAD x PAGE_PAYLOAD texels of its level plus a PAGE_BORDER texel
+// border (clamped at face edges) for bilinear filtering, block-compressed like the KTX2 files.
+// Levels halve the face size until one page covers the whole face; those top pages are
+// pinned in the cache so every lookup has a fallback.
+//
+// Threading: open/close/processFeedback/takeUploads/writePageTable belong to the render
+// thread; the loader thread only reads page files and hands back page data.
+
+namespace VirtualTexture
+{
+
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr char MAGIC[8] = {'V', 'N', 'T', 'V', 'T', 'E', 'X', 'P'};
+constexpr const char *FILE_EXTENSION = ".vtex";
+
+constexpr uint32_t PAGE_PAYLOAD = 128;                          // Level texels covered by one page (per side)
+constexpr uint32_t PAGE_BORDER = 4;                             // Filter border per side (one BC block)
+constexpr uint32_t PAGE_SIZE = PAGE_PAYLOAD + 2 * PAGE_BORDER;  // Texels stored per side
+constexpr uint32_t MAX_LEVELS = 16;
+constexpr uint64_t DATA_ALIGNMENT = 4096;
+
+// Earth textures in shader order (VT_* constants and bindings 12-16 in single-pass-screen.frag)
+enum Texture : uint32_t
+{
+    COLOR = 0,
+    NORMAL = 1,
+    NIGHTLIGHTS = 2,
+    SPECULAR = 3,
+    HEIGHTMAP = 4,
+    TEXTURE_COUNT = 5
+};
+
+constexpr uint32_t MAX_TOTAL_PAGES = 65536;     // Page table / feedback capacity over all textures
+constexpr uint32_t MAX_UPLOADS_PER_FRAME = 32;  // Pages copied into the caches per frame
+constexpr uint32_t MAX_PAGE_BYTES = (PAGE_SIZE / 4) * (PAGE_SIZE / 4) * 16;
+constexpr uint32_t MIN_CACHE_PAGES = 128;
+constexpr uint32_t MAX_CACHE_PAGES = 2048;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t vkFormat;   // VkFormat of the page data (BC4/BC5/BC7)
+    uint32_t blockBytes; // Bytes per 4x4 block
+    uint32_t faceSize;   // Level 0 face size in texels
+    uint32_t levelCount;
+    uint32_t pageBytes; // Size of one page (PAGE_SIZE^2 texels, compressed)
+    uint32_t pageCount;
+    uint32_t padding;
+    uint64_t dataOffset; // Start of page 0
+    uint32_t levelFirstPage[MAX_LEVELS];
+    uint32_t levelPagesPerSide[MAX_LEVELS];
+};
+
+// GPU mirror of the page table header (std430, binding 10)
+// Followed by uint32_t entries[totalPages]: physical layer + 1, or 0 when not resident
+struct GpuTextureInfo
+{
+    uint32_t pageBase; // First entry of this texture in the shared table / feedback bitset
+    uint32_t levelCount;
+    uint32_t faceSize;
+    uint32_t padding;
+    uint32_t levelFirstPage[MAX_LEVELS];
+    uint32_t levelPagesPerSide[MAX_LEVELS];
+};
+
+struct GpuPageTableHeader
+{
+    uint32_t enabled; // 0 = shader samples the regular cubemaps (bindings 4-8)
+    uint32_t totalPages;
+    uint32_t padding[2];
+    GpuTextureInfo textures[TEXTURE_COUNT];
+};
+
+// A loaded page waiting to be copied into a physical cache layer
+struct PageUpload
+{
+    uint32_t texture;
+    uint32_t layer;
+    std::vector<uint8_t> data;
+};
+
+struct Stats
+{
+    uint32_t capacity = 0;          // Layers per texture cache
+    uint32_t residentPages = 0;     // Over all textures
+    uint64_t requestedPages = 0;    // Requests sent to the loader since open
+    uint64_t uploadedPages = 0;     // Pages handed to the GPU since open
+    uint64_t evictedPages = 0;      // Pages replaced in the cache since open
+    uint64_t cacheBytes = 0;        // GPU memory of all physical caches
+    uint64_t datasetBytes = 0;      // Size of every page of every texture
+};
+
+// Page file next to an uncompressed grid ("dir/earth_specular.png" -> "dir/earth_specular.vtex")
+std::string pathFor(const std::string &texturePath);
+
+// True if the page file for texturePath exists and is not older than texturePath
+// (a missing texturePath counts as up to date, like Ktx2::isUpToDate)
+bool isUpToDate(const std::string &texturePath);
+
+// Fill levelCount, levelFirstPage, levelPagesPerSide and pageCount for a face size
+void computeLayout(uint32_t faceSize, FileHeader &header);
+
+// Texel size of a level
+inline uint32_t levelSize(uint32_t faceSize, uint32_t level)
+{
+    uint32_t size = faceSize >> level;
+    return size > 0 ? size : 1;
+}
+
+// Index of a page within its file
+inline uint32_t pageIndex(const FileHeader &header, uint32_t level, uint32_t face, uint32_t x, uint32_t y)
+{
+    uint32_t pagesPerSide = header.levelPagesPerSide[level];
+    return header.levelFirstPage[level] + (face * pagesPerSide + y) * pagesPerSide + x;
+}
+
+// Cache layers per texture for a screen size (enough pages to cover every pixel a few times
+// over, for filtering neighbours, level fallbacks and fast camera moves)
+uint32_t cacheCapacityForScreen(uint32_t width, uint32_t height);
+
+// Map the page files, load the pinned top level pages and start the loader thread
+// paths: one file per Texture, in enum order
+bool open(const std::array<std::string, TEXTURE_COUNT> &paths, uint32_t capacity);
+
+// Stop the loader and unmap everything (the page table then reports enabled = 0)
+void close();
+
+bool isOpen();
+
+const FileHeader &getHeader(uint32_t texture);
+uint32_t getCapacity();
+
+// Incremented whenever the page table changes (residency, open, close)
+uint64_t getPageTableVersion();
+
+// Bytes written by writePageTable (header + entries of the open textures)
+size_t getPageTableBytes();
+void writePageTable(void *destination);
+
+// Bytes of the GPU feedback bitset (one bit per page, MAX_TOTAL_PAGES bits)
+constexpr size_t FEEDBACK_BYTES = MAX_TOTAL_PAGES / 8;
+
+// Consume one completed frame's feedback bitset: refresh LRU stamps of resident pages and
+// request missing pages (coarse levels first, replacing older requests)
+void processFeedback(const uint32_t *requestedBits);
+
+// Take up to maxPages loaded pages and assign them cache layers (evicting least recently
+// used pages that the latest feedback did not touch). The page table is updated as if the
+// uploads have happened, so they must be copied before the next draw that uses the table.
+std::vector<PageUpload> takeUploads(uint32_t maxPages);
+
+Stats getStats();
+void printStats();
+
+} // namespace VirtualTexture
@@ -113,33 +113,42 @@ void RenderFrame(VulkanRendererState &state)
         }
     }
 
-    // Wait for ALL GPU work to complete before modifying shared buffers
-    // This is necessary because SSBOs are shared across all frames-in-flight
-    // (waitForCurrentFrameFence only waits for the frame at current index,
-    // but the previous frame with a different index might still be using the SSBO)
-    vkDeviceWaitIdle(state.context.device);
+    // Wait only for the frame that last used this slot - SSBOs, UI vertices and the command buffer
+    // are per frame in flight, so the other frames keep rendering while we prepare this one
+    waitForCurrentFrameFence(state.context);
+    FrameResources &frame = state.context.currentFrameResources();
 
-    // Now safe to read hover output from the *previous* frame
-    // Use debouncing: only change confirmed state after N consistent frames
-    uint32_t hoverMaterialID = readHoverOutput(state.context);
+    // Collect GPU outputs of every completed frame before this slot's buffers are reset below
+    // (this slot's fence has signalled, the other slot is picked up if it has finished too)
+    pollReadbacks(state.context);
 
-    if (hoverMaterialID == state.pendingHoverMaterialID)
-    {
-        // Same as pending - increment counter
-        state.pendingHoverFrameCount++;
-    }
-    else
-    {
-        // Different value - start tracking new candidate
-        state.pendingHoverMaterialID = hoverMaterialID;
-        state.pendingHoverFrameCount = 1;
-    }
+    // Stage Earth texture pages requested by those frames and refresh this slot's page table
+    updateVirtualTextures(state.context);
 
-    // Only update confirmed state if pending has been consistent for enough frames
-    if (state.pendingHoverFrameCount >= VulkanRendererState::HOVER_DEBOUNCE_FRAMES &&
-        state.pendingHoverMaterialID != state.confirmedHoverMaterialID)
+    // Debounce hover over completed frames: only change confirmed state after N consistent samples
+    const GpuReadback &readback = state.context.readback;
+    if (readback.frameNumber != state.lastHoverSampleFrame)
     {
-        state.confirmedHoverMaterialID = state.pendingHoverMaterialID;
+        state.lastHoverSampleFrame = readback.frameNumber;
+
+        if (readback.hoverMaterialID == state.pendingHoverMaterialID)
+        {
+            // Same as pending - increment counter
+            state.pendingHoverFrameCount++;
+        }
+        else
+        {
+            // Different value - start tracking new candidate
+            state.pendingHoverMaterialID = readback.hoverMaterialID;
+            state.pendingHoverFrameCount = 1;
+        }
+
+        // Only update confirmed state if pending has been consistent for enough samples
+        if (state.pendingHoverFrameCount >= VulkanRendererState::HOVER_DEBOUNCE_FRAMES &&
+            state.pendingHoverMaterialID != state.confirmedHoverMaterialID)
+        {
+            state.confirmedHoverMaterialID = state.pendingHoverMaterialID;
+        }
     }
 
     // Set cursor based on confirmed hover state (do this every frame since beginFrame resets to Arrow)
@@ -226,14 +235,14 @@ void RenderFrame(VulkanRendererState &state)
         pushCameraConstants(cmd, state.context.pipelineLayout, cameraConstants);
 
         // Bind SSBO descriptor set (UIState)
-        if (state.context.ssboDescriptorSet != VK_NULL_HANDLE)
+        if (frame.ssboDescriptorSet != VK_NULL_HANDLE)
         {
             vkCmdBindDescriptorSets(cmd,
                                     VK_PIPELINE_BIND_POINT_GRAPHICS,
                                     state.context.pipelineLayout,
                                     0,
                                     1,
-                                    &state.context.ssboDescriptorSet,
+                                    &frame.ssboDescriptorSet,
                                     0,
                                     nullptr);
         }
@@ -272,25 +281,25 @@ void RenderFrame(VulkanRendererState &state)
         pushInputConstants(cmd, state.context.uiPipelineLayout, inputConstants);
 
         // Bind SSBO descriptor set (UIState)
-        if (state.context.ssboDescriptorSet != VK_NULL_HANDLE)
+        if (frame.ssboDescriptorSet != VK_NULL_HANDLE)
         {
             vkCmdBindDescriptorSets(cmd,
                                     VK_PIPELINE_BIND_POINT_GRAPHICS,
                                     state.context.uiPipelineLayout,
                                     0,
                                     1,
-                                    &state.context.ssboDescriptorSet,
+                                    &frame.ssboDescriptorSet,
                                     0,
                                     nullptr);
         }
 
         // Draw UI vertex buffer (built from actual UI rendering)
-        if (state.context.uiVertexBuffer.buffer != VK_NULL_HANDLE && state.context.uiVertexCount > 0)
+        if (frame.uiVertexBuffer.buffer != VK_NULL_HANDLE && frame.uiVertexCount > 0)
         {
-            VkBuffer vertexBuffers[] = {state.context.uiVertexBuffer.buffer};
+            VkBuffer vertexBuffers[] = {frame.uiVertexBuffer.buffer};
             VkDeviceSize offsets[] = {0};
             vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
-            vkCmdDraw(cmd, state.context.uiVertexCount, 1, 0, 0);
+            vkCmdDraw(cmd, frame.uiVertexCount, 1, 0, 0);
         }
     }
 
@@ -14,10 +14,13 @@ struct VulkanRendererState
     bool shouldExit = false; // Set to true on Ctrl+C
 
     // Hover detection state (debounced to avoid cursor jitter)
+    // Hover IDs arrive 1..MAX_FRAMES_IN_FLIGHT frames late through the readback ring, so the
+    // debounce counts completed frames (readback samples), not rendered frames
     uint32_t confirmedHoverMaterialID = 0;          // Stable hover state used for cursor
     uint32_t pendingHoverMaterialID = 0;            // Candidate value being tested
-    int pendingHoverFrameCount = 0;                 // How many frames pending value has been consistent
-    static constexpr int HOVER_DEBOUNCE_FRAMES = 2; // Frames required to confirm change
+    int pendingHoverFrameCount = 0;                 // How many samples pending value has been consistent
+    uint64_t lastHoverSampleFrame = 0;              // Frame number of the last sample counted
+    static constexpr int HOVER_DEBOUNCE_FRAMES = 2; // Completed frames required to confirm change
 };
 
 // Initialize Vulkan renderer with an existing GLFW window
@@ -6,6 +6,9 @@
 // Import modules
 #include "concerns/app-state.h"
 #include "concerns/constants.h"
+#include "concerns/ephemeris-cache.h"
+#include "concerns/ephemeris-prefetch.h"
+#include "concerns/ephemeris-table.h"
 #include "concerns/input-controller.h"
 #include "concerns/preprocess-data.h"
 #include "concerns/screen-renderer.h"
@@ -76,6 +79,19 @@ std::string getDefaultsPath()
     return "defaults";
 }
 
+// Check whether an exact flag (e.g. "--benchmark-ephemeris") was passed on the command line
+bool HasCommandLineFlag(int argc, char *argv[], const std::string &flag)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (flag == argv[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Convert UTC calendar date/time to Julian Date
 // Uses the algorithm from the Astronomical Almanac
 double CalendarToJulianDate(int year, int month, int day, int hour, int minute, int second)
@@ -236,33 +252,48 @@ void InitializeCelestialObjects()
 }
 
 // Update celestial object positions and rotations based on Julian date
+// All bodies are queried in one structure-of-arrays batch and written straight into the objects
 void UpdateCelestialObjectPositions(double julianDate)
 {
     static bool firstUpdate = true;
 
-    for (auto &obj : APP_STATE.worldState.celestialObjects)
+    // Reused every frame so the batch buffers are only allocated once
+    static SpiceEphemeris::EphemerisBatch batch;
+
+    auto &objects = APP_STATE.worldState.celestialObjects;
+    batch.naifIds.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
     {
-        // Get position from SPICE (returns AU relative to SSB)
-        glm::dvec3 posAU = SpiceEphemeris::getBodyPosition(obj.naifId, julianDate);
+        batch.naifIds[i] = objects[i].naifId;
+    }
+    batch.epochs.assign(1, julianDate);
+
+    // Positions from the prefetch worker's Chebyshev segments (AU relative to SSB)
+    // Bodies the worker hasn't covered yet keep last frame's state
+    EphemerisPrefetch::queryBatch(batch);
+
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        auto &obj = objects[i];
+        if (!batch.hasState[i])
+        {
+            continue;
+        }
+        glm::dvec3 posAU(batch.positionX[i], batch.positionY[i], batch.positionZ[i]);
 
         // Convert AU to display units
         obj.position = glm::vec3(posAU) * UNITS_PER_AU;
 
-        // Get body frame (pole and prime meridian) from SPICE
-        // Keep in J2000 coordinates (Z-up) to match positions
-        glm::dvec3 pole, primeMeridian;
-        if (SpiceEphemeris::getBodyFrame(obj.naifId, julianDate, pole, primeMeridian))
+        // Body frame (pole and prime meridian) stays in J2000 coordinates (Z-up) to match positions
+        // Bodies without frame data keep the default orientation from InitializeCelestialObjects
+        // (Z-up, X toward vernal equinox)
+        if (batch.hasFrame[i])
         {
             // Use SPICE data directly in J2000 coordinates (no transformation)
             // Positions are also in J2000, so surface normals will match
-            obj.poleDirection = glm::normalize(glm::vec3(pole));
-            obj.primeMeridianDirection = glm::normalize(glm::vec3(primeMeridian));
-        }
-        else
-        {
-            // Fallback: default orientation in J2000 (Z-up, X toward vernal equinox)
-            obj.poleDirection = glm::vec3(0.0f, 0.0f, 1.0f);
-            obj.primeMeridianDirection = glm::vec3(1.0f, 0.0f, 0.0f);
+            obj.poleDirection = glm::normalize(glm::vec3(batch.poleX[i], batch.poleY[i], batch.poleZ[i]));
+            obj.primeMeridianDirection = glm::normalize(
+                glm::vec3(batch.primeMeridianX[i], batch.primeMeridianY[i], batch.primeMeridianZ[i]));
         }
 
         if (firstUpdate)
@@ -282,7 +313,7 @@ void UpdateCelestialObjectPositions(double julianDate)
 // Get Earth's position in display units for a given Julian date
 glm::vec3 GetEarthPosition(double julianDate)
 {
-    glm::dvec3 posAU = SpiceEphemeris::getBodyPosition(SpiceEphemeris::NAIF_EARTH, julianDate);
+    glm::dvec3 posAU = EphemerisCache::getBodyPosition(SpiceEphemeris::NAIF_EARTH, julianDate);
     return glm::vec3(posAU) * UNITS_PER_AU;
 }
 
@@ -361,7 +392,10 @@ void CleanupApplication(ScreenRendererState &screenState)
     // Cleanup Screen Renderer (handles Vulkan and OpenGL cleanup)
     CleanupScreenRenderer(screenState);
 
-    // Cleanup SPICE ephemeris
+    // Cleanup SPICE ephemeris (stop the prefetch worker and drop cached segments first)
+    EphemerisPrefetch::stop();
+    EphemerisCache::clear();
+    EphemerisTable::close();
     SpiceEphemeris::cleanup();
 
     // Restore default signal handlers
@@ -377,7 +411,7 @@ void CleanupApplication(ScreenRendererState &screenState)
 // Main Program
 // ============================================================================
 
-int main()
+int main(int argc, char *argv[])
 {
     // Set up signal handler for graceful shutdown on Ctrl+C
 #ifdef _WIN32
@@ -424,12 +458,30 @@ int main()
     // ========================================================================
     InitializeCelestialObjects();
 
+    // Report cached vs direct SPICE cost and accuracy (~1 minute of sim time per frame)
+    // Opt-in with --benchmark-ephemeris: direct queries are slow and load the kernels if they were deferred
+    if (HasCommandLineFlag(argc, argv, "--benchmark-ephemeris"))
+    {
+        EphemerisCache::runBenchmark(APP_STATE.worldState.julianDate, 500, 1.0 / 1440.0);
+    }
+
     // Update celestial object positions for initial Julian date
     UpdateCelestialObjectPositions(APP_STATE.worldState.julianDate);
 
     // Initialize camera to look at Earth from 3 Earth radii away
     InitializeCameraForEarth(APP_STATE.worldState.julianDate);
 
+    // Hand all further SPICE work to the prefetch worker (CSPICE is not thread-safe,
+    // so the main thread must not call SpiceEphemeris from here until cleanup)
+    std::vector<int> bodyIds;
+    for (const auto &obj : APP_STATE.worldState.celestialObjects)
+    {
+        bodyIds.push_back(obj.naifId);
+    }
+    EphemerisPrefetch::start(bodyIds, APP_STATE.worldState.julianDate,
+                             APP_STATE.worldState.isPaused ? 0.0
+                                                           : static_cast<double>(APP_STATE.worldState.timeDilation));
+
     // Initialize time tracking for frame-rate independent simulation
     auto lastFrameTime = std::chrono::high_resolution_clock::now();
 
@@ -463,7 +515,11 @@ int main()
             APP_STATE.worldState.julianDate += deltaTime * static_cast<double>(APP_STATE.worldState.timeDilation);
         }
 
-        // Update celestial object positions for current Julian date
+        // Tell the prefetch worker where the clock is heading, then update celestial object positions
+        EphemerisPrefetch::setClock(APP_STATE.worldState.julianDate,
+                                    APP_STATE.worldState.isPaused
+                                        ? 0.0
+                                        : static_cast<double>(APP_STATE.worldState.timeDilation));
         UpdateCelestialObjectPositions(APP_STATE.worldState.julianDate);
 
         // Poll events first - beginFrame clears state, then callbacks set new input values
@@ -666,7 +722,8 @@ int main()
         RenderFrame(screenState);
 
         // Read back min distance from GPU for camera collision detection
-        // This gives us the closest distance to displaced terrain from the previous frame
+        // This is the closest distance to displaced terrain from the most recent completed frame
+        // (non-blocking - frames still in flight are picked up on a later iteration)
         float minDist = readMinSurfaceDistance(screenState.vulkanRenderer.context);
         APP_STATE.worldState.minSurfaceDistance = minDist;
 
@@ -7,7 +7,9 @@
 #include "../../concerns/helpers/vulkan.h"
 #include "../../concerns/ui-overlay.h"
 #include "earth-material.h"
+#include "voxel-octree.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef> // for offsetof
@@ -125,8 +127,80 @@ bool isTriangleOccluded(const glm::vec3 &v1,
     const float EPSILON = 0.0001f;
     return (ndcDepth1 > depth1 + EPSILON) && (ndcDepth2 > depth2 + EPSILON) && (ndcDepth3 > depth3 + EPSILON);
 }
+
+// Octree mesh buffers start with room for this many vertices / indices and double when full
+constexpr uint32_t MIN_OCTREE_MESH_VERTICES = 1u << 16;
+constexpr uint32_t MIN_OCTREE_MESH_INDICES = 1u << 17;
+
+// Smallest c with 2^c >= count
+int rangeClass(size_t count)
+{
+    int sizeClass = 0;
+    while ((size_t(1) << sizeClass) < count)
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+// Make buffer hold at least `elements` elements of elementSize bytes, keeping its contents
+void reserveOctreeMeshBuffer(VulkanContext &context,
+                             VulkanBuffer &buffer,
+                             uint32_t elements,
+                             uint32_t minElements,
+                             VkDeviceSize elementSize,
+                             VkBufferUsageFlags usage)
+{
+    const VkDeviceSize capacity = buffer.buffer != VK_NULL_HANDLE ? buffer.size / elementSize : 0;
+    if (elements <= capacity)
+    {
+        return;
+    }
+
+    VkDeviceSize grownCapacity = std::max<VkDeviceSize>(capacity * 2, minElements);
+    while (grownCapacity < elements)
+    {
+        grownCapacity *= 2;
+    }
+    VulkanBuffer grown = createBuffer(context,
+                                      grownCapacity * elementSize,
+                                      usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (capacity > 0)
+    {
+        // Regions already written move with the data, so chunk regions stay valid
+        VkBufferCopy whole{};
+        whole.size = buffer.size;
+        copyBufferRegions(context, buffer.buffer, grown.buffer, {whole});
+        destroyBuffer(context, buffer);
+    }
+    buffer = grown;
+}
 } // namespace
 
+// ============================================================================
+// Octree Mesh Buffer Ranges
+// ============================================================================
+
+uint32_t EarthMaterial::OctreeBufferRanges::allocate(int sizeClass)
+{
+    std::vector<uint32_t> &freeList = freeOffsets[sizeClass];
+    if (!freeList.empty())
+    {
+        const uint32_t offset = freeList.back();
+        freeList.pop_back();
+        return offset;
+    }
+    const uint32_t offset = used;
+    used += 1u << sizeClass;
+    return offset;
+}
+
+void EarthMaterial::OctreeBufferRanges::release(uint32_t offset, int sizeClass)
+{
+    freeOffsets[sizeClass].push_back(offset);
+}
+
 // Set camera info for geometry culling (called from entrypoint before rendering)
 void EarthMaterial::setCameraInfo(const glm::vec3 &cameraPos, const glm::vec3 &cameraDir, float fovRadians)
 {
@@ -848,21 +922,12 @@ void EarthMaterial::draw(const glm::vec3 &position,
 
         float maxSubdivisionDistance = extractionRadius;
 
-        // Extract mesh from octree for rendering
-        // This generates meshVertices_ and meshIndices_ from the voxel octree
+        // Update the octree mesh for rendering
+        // Only the chunks whose bricks changed since the last update are re-meshed (on worker threads)
+        // and patched into the GPU buffers; the rest of the mesh stays where it is
         if (octreeMesh_)
         {
-            meshVertices_.clear();
-            meshIndices_.clear();
-            octreeMesh_->extractSurfaceMesh(cameraPos, maxSubdivisionDistance, meshVertices_, meshIndices_);
-
-            static bool debugPrinted = false;
-            if (!debugPrinted && !meshVertices_.empty())
-            {
-                std::cout << "DEBUG: Extracted mesh from octree - " << meshVertices_.size() << " vertices, "
-                          << meshIndices_.size() << " indices" << "\n";
-                debugPrinted = true;
-            }
+            updateOctreeChunkMeshes(cameraPos, maxSubdivisionDistance);
         }
 
         // Render the octree mesh using Vulkan
@@ -1475,18 +1540,169 @@ void EarthMaterial::drawTexturedSphere(const glm::vec3 &position,
     glPopMatrix();
 }
 
+void EarthMaterial::updateOctreeChunkMeshes(const glm::vec3 &referencePoint, float maxSubdivisionDistance)
+{
+    TaskScheduler &scheduler = TaskScheduler::shared();
+    if (!pendingChunkMeshes_.empty())
+    {
+        if (!chunkMeshTasks_.done())
+        {
+            if (scheduler.concurrency() > 1)
+            {
+                return; // Workers are still meshing: keep drawing the current mesh
+            }
+            scheduler.wait(chunkMeshTasks_); // No workers: mesh on this thread
+        }
+        uploadOctreeChunkMeshes();
+        pendingChunkMeshes_.clear();
+    }
+
+    octreeMesh_->updateMeshChunks(referencePoint, maxSubdivisionDistance, pendingChunkMeshes_);
+
+    // pendingChunkMeshes_ is not touched again until the tasks are done, so each task owns its element
+    const EarthVoxelOctree::PlanetOctree *octree = octreeMesh_.get();
+    for (EarthVoxelOctree::MeshChunkUpdate &chunk : pendingChunkMeshes_)
+    {
+        if (!chunk.bricks.empty())
+        {
+            EarthVoxelOctree::MeshChunkUpdate *target = &chunk;
+            scheduler.submit(chunkMeshTasks_, [octree, target]() { octree->meshChunk(*target); });
+        }
+    }
+}
+
+void EarthMaterial::uploadOctreeChunkMeshes()
+{
+    extern VulkanContext *g_vulkanContext;
+    if (!g_vulkanContext)
+    {
+        return;
+    }
+
+    // Assign regions: a chunk keeps its region while the new mesh fits, otherwise it moves to a free range of
+    // the next power-of-two capacity (or a new one at the end of the buffer)
+    std::vector<const EarthVoxelOctree::MeshChunkUpdate *> uploads;
+    for (const EarthVoxelOctree::MeshChunkUpdate &chunk : pendingChunkMeshes_)
+    {
+        auto found = octreeChunkRegions_.find(chunk.key);
+        if (chunk.vertices.empty() || chunk.indices.empty())
+        {
+            // Left the mesh (or meshed to nothing)
+            if (found != octreeChunkRegions_.end())
+            {
+                vertexRanges_.release(found->second.firstVertex, found->second.vertexClass);
+                indexRanges_.release(found->second.firstIndex, found->second.indexClass);
+                octreeChunkRegions_.erase(found);
+            }
+            continue;
+        }
+
+        OctreeChunkRegion &region = octreeChunkRegions_[chunk.key];
+        const int vertexClass = rangeClass(chunk.vertices.size());
+        if (region.vertexClass < vertexClass)
+        {
+            if (region.vertexClass >= 0)
+            {
+                vertexRanges_.release(region.firstVertex, region.vertexClass);
+            }
+            region.firstVertex = vertexRanges_.allocate(vertexClass);
+            region.vertexClass = vertexClass;
+        }
+        const int indexClass = rangeClass(chunk.indices.size());
+        if (region.indexClass < indexClass)
+        {
+            if (region.indexClass >= 0)
+            {
+                indexRanges_.release(region.firstIndex, region.indexClass);
+            }
+            region.firstIndex = indexRanges_.allocate(indexClass);
+            region.indexClass = indexClass;
+        }
+        region.vertexCount = static_cast<uint32_t>(chunk.vertices.size());
+        region.indexCount = static_cast<uint32_t>(chunk.indices.size());
+        uploads.push_back(&chunk);
+    }
+    if (uploads.empty())
+    {
+        return;
+    }
+
+    reserveOctreeMeshBuffer(*g_vulkanContext,
+                            vertexBuffer_,
+                            vertexRanges_.used,
+                            MIN_OCTREE_MESH_VERTICES,
+                            sizeof(EarthVoxelOctree::MeshVertex),
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    reserveOctreeMeshBuffer(*g_vulkanContext,
+                            indexBuffer_,
+                            indexRanges_.used,
+                            MIN_OCTREE_MESH_INDICES,
+                            sizeof(unsigned int),
+                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    buffersCreated_ = vertexBuffer_.buffer != VK_NULL_HANDLE && indexBuffer_.buffer != VK_NULL_HANDLE;
+    if (!buffersCreated_)
+    {
+        std::cerr << "ERROR: uploadOctreeChunkMeshes() - Failed to create octree mesh buffers!" << "\n";
+        return;
+    }
+
+    // Pack the changed chunks into one staging buffer per kind and copy each into its region
+    std::vector<EarthVoxelOctree::MeshVertex> stagedVertices;
+    std::vector<unsigned int> stagedIndices;
+    std::vector<VkBufferCopy> vertexCopies;
+    std::vector<VkBufferCopy> indexCopies;
+    vertexCopies.reserve(uploads.size());
+    indexCopies.reserve(uploads.size());
+    for (const EarthVoxelOctree::MeshChunkUpdate *chunk : uploads)
+    {
+        const OctreeChunkRegion &region = octreeChunkRegions_[chunk->key];
+
+        VkBufferCopy vertexCopy{};
+        vertexCopy.srcOffset = stagedVertices.size() * sizeof(EarthVoxelOctree::MeshVertex);
+        vertexCopy.dstOffset = VkDeviceSize(region.firstVertex) * sizeof(EarthVoxelOctree::MeshVertex);
+        vertexCopy.size = chunk->vertices.size() * sizeof(EarthVoxelOctree::MeshVertex);
+        vertexCopies.push_back(vertexCopy);
+        stagedVertices.insert(stagedVertices.end(), chunk->vertices.begin(), chunk->vertices.end());
+
+        VkBufferCopy indexCopy{};
+        indexCopy.srcOffset = stagedIndices.size() * sizeof(unsigned int);
+        indexCopy.dstOffset = VkDeviceSize(region.firstIndex) * sizeof(unsigned int);
+        indexCopy.size = chunk->indices.size() * sizeof(unsigned int);
+        indexCopies.push_back(indexCopy);
+        stagedIndices.insert(stagedIndices.end(), chunk->indices.begin(), chunk->indices.end());
+    }
+
+    VulkanBuffer stagingVertexBuffer =
+        createBuffer(*g_vulkanContext,
+                     stagedVertices.size() * sizeof(EarthVoxelOctree::MeshVertex),
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagedVertices.data());
+    VulkanBuffer stagingIndexBuffer =
+        createBuffer(*g_vulkanContext,
+                     stagedIndices.size() * sizeof(unsigned int),
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagedIndices.data());
+
+    copyBufferRegions(*g_vulkanContext, stagingVertexBuffer.buffer, vertexBuffer_.buffer, vertexCopies);
+    copyBufferRegions(*g_vulkanContext, stagingIndexBuffer.buffer, indexBuffer_.buffer, indexCopies);
+
+    destroyBuffer(*g_vulkanContext, stagingVertexBuffer);
+    destroyBuffer(*g_vulkanContext, stagingIndexBuffer);
+}
+
 // Draw octree mesh with shader (vertices in local space, transformed to world space in shader)
+// One indexed draw per chunk region of the shared vertex/index buffers
 void EarthMaterial::drawOctreeMesh(const glm::vec3 &position)
 {
     // Check if we have mesh data
-    if (meshVertices_.empty() || meshIndices_.empty())
+    if (octreeChunkRegions_.empty())
     {
         static bool debugPrinted = false;
         if (!debugPrinted)
         {
             std::cerr << "WARNING: drawOctreeMesh() - No mesh data to render!" << "\n";
-            std::cerr << "  meshVertices_.size(): " << meshVertices_.size() << "\n";
-            std::cerr << "  meshIndices_.size(): " << meshIndices_.size() << "\n";
             std::cerr << "  The octree may not be generating mesh data (using voxels directly)." << "\n";
             debugPrinted = true;
         }
@@ -1509,86 +1725,16 @@ void EarthMaterial::drawOctreeMesh(const glm::vec3 &position)
     }
 
     // Check if we have valid data
-    if (meshIndices_.empty() || graphicsPipeline_ == VK_NULL_HANDLE)
+    if (!buffersCreated_ || graphicsPipeline_ == VK_NULL_HANDLE)
     {
         return;
     }
 
-    // Create or update Vulkan buffers
-    size_t vertexBufferSize = meshVertices_.size() * sizeof(EarthVoxelOctree::MeshVertex);
-    size_t indexBufferSize = meshIndices_.size() * sizeof(unsigned int);
-
-    if (!buffersCreated_ || vertexBuffer_.size < vertexBufferSize || indexBuffer_.size < indexBufferSize)
-    {
-        // Destroy old buffers if they exist
-        if (vertexBuffer_.buffer != VK_NULL_HANDLE)
-        {
-            destroyBuffer(*g_vulkanContext, vertexBuffer_);
-        }
-        if (indexBuffer_.buffer != VK_NULL_HANDLE)
-        {
-            destroyBuffer(*g_vulkanContext, indexBuffer_);
-        }
-
-        // Create new buffers with enough size (round up for dynamic updates)
-        size_t vertexSize = std::max(vertexBufferSize, size_t(1024 * 1024)); // At least 1MB
-        size_t indexSize = std::max(indexBufferSize, size_t(512 * 1024));    // At least 512KB
-
-        // Create device-local buffers (GPU-only, faster access)
-        // Use staging buffer for initial data upload
-        vertexBuffer_ = createBuffer(*g_vulkanContext,
-                                     vertexSize,
-                                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                     meshVertices_.data());
-
-        indexBuffer_ = createBuffer(*g_vulkanContext,
-                                    indexSize,
-                                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                    meshIndices_.data());
-
-        buffersCreated_ = true;
-    }
-    else
-    {
-        // Update buffer data (mesh changes every frame)
-        // Use staging buffer to update device-local buffers
-        VulkanBuffer stagingVertexBuffer =
-            createBuffer(*g_vulkanContext,
-                         vertexBufferSize,
-                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         meshVertices_.data());
-
-        VulkanBuffer stagingIndexBuffer =
-            createBuffer(*g_vulkanContext,
-                         indexBufferSize,
-                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         meshIndices_.data());
-
-        // Copy from staging buffers to device-local buffers
-        copyBuffer(*g_vulkanContext, stagingVertexBuffer.buffer, vertexBuffer_.buffer, vertexBufferSize);
-        copyBuffer(*g_vulkanContext, stagingIndexBuffer.buffer, indexBuffer_.buffer, indexBufferSize);
-
-        // Cleanup staging buffers
-        destroyBuffer(*g_vulkanContext, stagingVertexBuffer);
-        destroyBuffer(*g_vulkanContext, stagingIndexBuffer);
-    }
-
     // Bind pipeline and descriptor sets
     uint32_t currentFrame = g_vulkanContext->currentFrame;
     std::vector<VkDescriptorSet> sets = {descriptorSets_[currentFrame]};
     bindPipelineAndDescriptors(cmd, graphicsPipeline_, pipelineLayout_, sets);
 
-    // Validate buffers before binding
-    if (vertexBuffer_.buffer == VK_NULL_HANDLE || indexBuffer_.buffer == VK_NULL_HANDLE)
-    {
-        std::cerr << "ERROR: drawOctreeMesh() - Buffers not created!" << "\n";
-        return;
-    }
-
     // Bind vertex and index buffers
     VkBuffer vertexBuffers[] = {vertexBuffer_.buffer};
     VkDeviceSize offsets[] = {0};
@@ -1598,8 +1744,12 @@ void EarthMaterial::drawOctreeMesh(const glm::vec3 &position)
                             std::vector<VkDeviceSize>(offsets, offsets + 1));
     recordBindIndexBuffer(cmd, indexBuffer_.buffer, 0, VK_INDEX_TYPE_UINT32);
 
-    // Record draw command
-    recordDrawIndexed(cmd, static_cast<uint32_t>(meshIndices_.size()), 1, 0, 0, 0);
+    // Record one draw per chunk (chunk-local indices are offset by the region's first vertex)
+    for (const auto &entry : octreeChunkRegions_)
+    {
+        const OctreeChunkRegion &region = entry.second;
+        recordDrawIndexed(cmd, region.indexCount, 1, region.firstIndex, static_cast<int32_t>(region.firstVertex), 0);
+    }
 }
 
 // Debug: Render voxel wireframes
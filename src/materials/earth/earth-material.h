@@ -1,14 +1,17 @@
 #pragma once
 
 #include "../../concerns/constants.h"
+#include "../../concerns/helpers/task-scheduler.h"
 #include "../../concerns/helpers/vulkan.h"
 #include "../../concerns/settings.h"
 // #include "voxel-octree.h"
 #include <GLFW/glfw3.h>
 #include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
 // #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -131,10 +134,9 @@ public:
                                    TextureResolution resolution);
 
     // Preprocess Atmosphere LUTs
-    // Generates transmittance and scattering lookup tables for atmosphere rendering
-    // - Output: earth_atmosphere_transmittance_lut.hdr and earth_atmosphere_scattering_lut.hdr
+    // Precomputes transmittance, multiple scattering and ground irradiance tables for atmosphere rendering
+    // - Output: earth_atmosphere_luts.bin (float16 tables, see AtmosphereScattering::LutFileHeader)
     // - Creates directory structure if needed
-    // - Generates simple placeholder LUTs if they don't exist (can be replaced with proper ones)
     static bool preprocessAtmosphereLUTs(const std::string &outputBasePath);
 
 
@@ -235,7 +237,9 @@ private:
     // Static preprocessing helpers
     // ==================================
 
-    // Combine 8 source tiles into a single image for one month
+    // Combine 8 source tiles into a single cubemap image for one month
+    // Streams the tiles in row bands through a temporary equirectangular file next to outputPath,
+    // so memory use stays small at any resolution
     // Returns true on success, writes to outputPath
     static bool combineTilesForMonth(int month,
                                      const std::string &sourcePath,
@@ -244,30 +248,41 @@ private:
                                      int outputHeight,
                                      bool lossless);
 
-    // Load a source tile and resize it
-    // Returns pixel data (caller must free with delete[])
-    static unsigned char *loadAndResizeTile(const std::string &filepath,
-                                            int targetWidth,
-                                            int targetHeight,
-                                            int &channels);
-
-    // Simple bilinear resize
-    static void resizeImage(const unsigned char *src,
-                            int srcW,
-                            int srcH,
-                            unsigned char *dst,
-                            int dstW,
-                            int dstH,
-                            int channels);
-
     // ==================================
     // Static elevation processing helpers
     // ==================================
 
-    // Load GeoTIFF elevation data
-    // Returns float array of elevation values in meters (caller must delete[])
-    // Sets width and height to the loaded dimensions
-    static float *loadGeoTiffElevation(const std::string &filepath, int &width, int &height);
+    // Elevation written for output cells that received no valid source sample
+    static constexpr float NODATA_ELEVATION = -32768.0f;
+
+    // How loadGeoTiffElevation reduces the source samples that fall into one output cell
+    enum class ElevationAggregate
+    {
+        Mean,
+        Minimum,
+        Maximum
+    };
+
+    // Extremes over every valid source sample (not just over the aggregated cells)
+    struct ElevationRange
+    {
+        float lowest = 0.0f;
+        float highest = 0.0f;
+        size_t validSamples = 0;
+    };
+
+    // Load GeoTIFF elevation data decimated to at most maxWidth x maxHeight
+    // Tiles (or strips) are decoded in parallel, one TIFF handle per thread, and each source sample is
+    // reduced straight into the output cell containing it: the full-resolution raster is never held
+    // Returns float array of elevation values in meters (caller must delete[]), NODATA_ELEVATION where a
+    // cell had no valid sample. Sets width and height to the output dimensions (capped at the source size)
+    static float *loadGeoTiffElevation(const std::string &filepath,
+                                       int maxWidth,
+                                       int maxHeight,
+                                       ElevationAggregate aggregate,
+                                       int &width,
+                                       int &height,
+                                       ElevationRange *range = nullptr);
 
     // Generate 8-bit heightmap from elevation data (legacy)
     // Normalizes elevation values to 0-255 range
@@ -308,8 +323,9 @@ private:
 
     // Octree-based surface mesh (replaces tessellated sphere)
     // std::unique_ptr<EarthVoxelOctree::PlanetOctree> octreeMesh_;
-    // std::vector<EarthVoxelOctree::MeshVertex> meshVertices_;
-    std::vector<unsigned int> meshIndices_;
+    // Chunk meshes of the latest octree update, meshed on the task scheduler (see updateOctreeChunkMeshes)
+    // std::vector<EarthVoxelOctree::MeshChunkUpdate> pendingChunkMeshes_;
+    TaskScheduler::TaskGroup chunkMeshTasks_;
     std::vector<glm::vec3> voxelWireframeEdges_; // Voxel wireframe edges for debug rendering
     bool meshGenerated_;
     std::string textureBasePath_; // Base path for texture files (stored during initialization)
@@ -334,6 +350,13 @@ private:
                                       float displayRadius,
                                       float maxSubdivisionDistance);
 
+    // Incremental octree mesh: once the previous chunk meshes are done, upload them and start meshing the chunks
+    // whose bricks changed for this reference point (the octree is only subdivided between two such updates)
+    void updateOctreeChunkMeshes(const glm::vec3 &referencePoint, float maxSubdivisionDistance);
+
+    // Copy the finished chunk meshes into their regions of vertexBuffer_/indexBuffer_
+    void uploadOctreeChunkMeshes();
+
     // Render octree mesh with shader (normal rendering with edges visible)
     void drawOctreeMesh(const glm::vec3 &position);
 
@@ -399,6 +422,32 @@ private:
     VulkanBuffer indexBuffer_;
     bool buffersCreated_ = false;
 
+    // Sub-allocator over one octree mesh buffer, in elements (vertices or indices). Ranges have power-of-two
+    // capacities and are recycled through per-capacity free lists; new ranges are taken from the end
+    struct OctreeBufferRanges
+    {
+        uint32_t allocate(int sizeClass);
+        void release(uint32_t offset, int sizeClass);
+
+        uint32_t used = 0;
+        std::array<std::vector<uint32_t>, 32> freeOffsets; // By log2(capacity)
+    };
+    OctreeBufferRanges vertexRanges_;
+    OctreeBufferRanges indexRanges_;
+
+    // Region of vertexBuffer_/indexBuffer_ holding one octree chunk mesh (indices are chunk-local)
+    // A chunk keeps its region while its new mesh fits, so a re-mesh is patched in place
+    struct OctreeChunkRegion
+    {
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+        int vertexClass = -1; // log2 of the vertex capacity (-1: none)
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        int indexClass = -1; // log2 of the index capacity (-1: none)
+    };
+    std::unordered_map<uint32_t, OctreeChunkRegion> octreeChunkRegions_; // By chunk key
+
     // Chunked LOD processing state
     int currentLodLevel_ = -1;                         // Current LOD level being processed (-1 = not processing)
     float lastCameraDistance_ = -1.0f;                 // Last camera distance (for detecting movement)
@@ -1,5 +1,6 @@
 #include "earth-economy.h"
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
 #include "../../../concerns/helpers/gl.h"
 #include "../../../concerns/settings.h"
 #include "../helpers/coordinate-conversion.h"
@@ -73,6 +74,9 @@ EarthEconomy::~EarthEconomy()
 // Preprocessing
 // ============================================================================
 
+// Bump when the city texture or database changes (see AssetManifest)
+static constexpr int CITIES_OUTPUT_VERSION = 1;
+
 bool EarthEconomy::preprocessCities(const std::string &xlsxPath,
                                     const std::string &outputBasePath,
                                     TextureResolution resolution)
@@ -82,10 +86,18 @@ bool EarthEconomy::preprocessCities(const std::string &xlsxPath,
 
     std::string outFile = outputPath + "/earth_cities.png";
 
-    // Check if already processed
-    if (std::filesystem::exists(outFile))
+    // Get resolution dimensions
+    int width, height;
+    getResolutionDimensions(resolution, width, height);
+
+    // Check if already processed from the current spreadsheet at this resolution
+    AssetManifest::Recipe recipe;
+    recipe.sources = {xlsxPath};
+    recipe.parameters = std::to_string(width) + "x" + std::to_string(height);
+    recipe.version = CITIES_OUTPUT_VERSION;
+    if (AssetManifest::isCurrent(outFile, recipe))
     {
-        std::cout << "City texture already exists: " << outFile << "\n";
+        std::cout << "City texture is up to date: " << outFile << "\n";
         return true;
     }
 
@@ -109,10 +121,6 @@ bool EarthEconomy::preprocessCities(const std::string &xlsxPath,
         return false;
     }
 
-    // Get resolution dimensions
-    int width, height;
-    getResolutionDimensions(resolution, width, height);
-
     std::cout << "Generating city texture: " << width << "x" << height << "\n";
 
     // Create texture data in sinusoidal projection (grayscale: 0 = no city, 255 = city present)
@@ -231,8 +239,11 @@ bool EarthEconomy::preprocessCities(const std::string &xlsxPath,
 
     // Save texture to disk (sinusoidal projection)
     // Note: stbi_write_png expects data top-to-bottom, which matches our coordinate system
-    if (!stbi_write_png(outFile.c_str(), width, height, 1, sinusoidalData.data(), width))
+    std::string tempFile = AssetManifest::temporaryPath(outFile);
+    if (!stbi_write_png(tempFile.c_str(), width, height, 1, sinusoidalData.data(), width) ||
+        !AssetManifest::commit(tempFile, outFile, recipe))
     {
+        std::filesystem::remove(tempFile);
         std::cerr << "Failed to write city texture: " << outFile << "\n";
         return false;
     }
@@ -241,12 +252,14 @@ bool EarthEconomy::preprocessCities(const std::string &xlsxPath,
 
     // Save city database to protobuf file
     std::string dbFile = outputPath + "/earth_cities.pb";
-    if (saveCityDatabaseToProtobuf(dbFile, cities, xlsxPath))
+    std::string tempDbFile = AssetManifest::temporaryPath(dbFile);
+    if (saveCityDatabaseToProtobuf(tempDbFile, cities, xlsxPath) && AssetManifest::commit(tempDbFile, dbFile, recipe))
     {
         std::cout << "City database saved: " << dbFile << "\n";
     }
     else
     {
+        std::filesystem::remove(tempDbFile);
         std::cerr << "Warning: Failed to save city database to protobuf" << "\n";
     }
 
@@ -94,19 +94,20 @@ void EarthMaterial::generateOctreeMesh(float displayRadius, float maxRadius)
 
     // Check if cache exists and has the correct maxDepth
     bool cacheValid = false;
+    uint32_t cacheVersion = 0;
     if (cacheExists)
     {
         // Read the maxDepth from cache file to check if it matches
         std::ifstream cacheCheck(cachePath, std::ios::binary);
         if (cacheCheck.is_open())
         {
-            uint32_t version = 0;
             float cachedBaseRadius = 0.0f;
             float cachedMaxRadius = 0.0f;
             int cachedMaxDepth = 0;
 
-            cacheCheck.read(reinterpret_cast<char *>(&version), sizeof(uint32_t));
-            if (version == 1)
+            // Versions 1 and 2 start with the same header fields
+            cacheCheck.read(reinterpret_cast<char *>(&cacheVersion), sizeof(uint32_t));
+            if (cacheVersion == 1 || cacheVersion == 2)
             {
                 cacheCheck.read(reinterpret_cast<char *>(&cachedBaseRadius), sizeof(float));
                 cacheCheck.read(reinterpret_cast<char *>(&cachedMaxRadius), sizeof(float));
@@ -127,6 +128,13 @@ void EarthMaterial::generateOctreeMesh(float displayRadius, float maxRadius)
         }
     }
 
+    // Chunk meshes of a previous octree are dropped with it (their buffer ranges are reused from the start)
+    TaskScheduler::shared().wait(chunkMeshTasks_);
+    pendingChunkMeshes_.clear();
+    octreeChunkRegions_.clear();
+    vertexRanges_ = OctreeBufferRanges();
+    indexRanges_ = OctreeBufferRanges();
+
     octreeMesh_ = std::make_unique<EarthVoxelOctree::PlanetOctree>(baseRadiusDisplay, maxRadiusDisplay, MAX_DEPTH);
 
     if (cacheValid)
@@ -139,6 +147,16 @@ void EarthMaterial::generateOctreeMesh(float displayRadius, float maxRadius)
             std::cout << "  Octree voxels: loaded from cache (" << voxelDataSize << " bytes of voxel data)" << "\n";
             meshGenerated_ = true;
 
+            // Rewrite old caches in the mapped format, so the next start does not read every brick
+            if (cacheVersion == 1)
+            {
+                std::cout << "  Upgrading octree cache to version 2: " << cachePath << "\n";
+                if (!octreeMesh_->serializeToFile(cachePath))
+                {
+                    std::cerr << "  WARNING: Failed to upgrade cache file" << "\n";
+                }
+            }
+
             // Free loaded image data (not needed if loaded from cache)
             stbi_image_free(heightmapData);
             if (landmassMaskData)
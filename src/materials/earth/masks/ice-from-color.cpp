@@ -1,3 +1,4 @@
+#include "../../../concerns/helpers/asset-manifest.h"
 #include "../earth-material.h"
 
 #include <algorithm>
@@ -34,6 +35,8 @@ constexpr float SATURATION_THRESHOLD_LOW = 0.15F;     // Low saturation threshol
 constexpr float SATURATION_THRESHOLD_MEDIUM = 0.2F;   // Medium saturation threshold for glacial ice detection
 constexpr float SATURATION_THRESHOLD_VERY_LOW = 0.1F; // Very low saturation threshold for ice/snow detection
 constexpr float BLUE_CHANNEL_RATIO_THRESHOLD = 0.95F; // Blue channel ratio threshold for glacial ice detection
+
+constexpr int OUTPUT_VERSION = 1; // Bump when the ice masks change (see AssetManifest)
 } // namespace
 
 bool EarthMaterial::preprocessIceMasks(const std::string &defaultsPath,
@@ -63,7 +66,6 @@ bool EarthMaterial::preprocessIceMasks(const std::string &defaultsPath,
 
     for (int month = 1; month <= MONTHS_PER_YEAR; month++)
     {
-        // Check if ice mask already exists
         std::ostringstream maskFilenameStream;
         maskFilenameStream << "earth_ice_mask_" << std::setfill('0') << std::setw(2) << month << ".png";
         std::string maskFilename = maskFilenameStream.str();
@@ -71,14 +73,7 @@ bool EarthMaterial::preprocessIceMasks(const std::string &defaultsPath,
         maskPath += "/";
         maskPath += maskFilename;
 
-        if (std::filesystem::exists(maskPath))
-        {
-            std::cout << "  Month " << month << ": ice mask exists (skipping)" << '\n';
-            masksGenerated++;
-            continue;
-        }
-
-        // Load the Blue Marble monthly texture (sinusoidal projection)
+        // The Blue Marble monthly texture the mask is derived from
         std::ostringstream colorFilenameStream;
         colorFilenameStream << "earth_month_" << std::setfill('0') << std::setw(2) << month << ext;
         std::string colorFilename = colorFilenameStream.str();
@@ -86,6 +81,17 @@ bool EarthMaterial::preprocessIceMasks(const std::string &defaultsPath,
         colorPath += "/";
         colorPath += colorFilename;
 
+        // Check if the ice mask is up to date with its color texture
+        AssetManifest::Recipe recipe;
+        recipe.sources = {colorPath};
+        recipe.version = OUTPUT_VERSION;
+        if (AssetManifest::isCurrent(maskPath, recipe))
+        {
+            std::cout << "  Month " << month << ": ice mask is up to date (skipping)" << '\n';
+            masksGenerated++;
+            continue;
+        }
+
         if (!std::filesystem::exists(colorPath))
         {
             std::cout << "  Month " << month << ": color texture not found (skipping)" << '\n';
@@ -183,7 +189,9 @@ bool EarthMaterial::preprocessIceMasks(const std::string &defaultsPath,
         stbi_image_free(colorData);
 
         // Save ice mask
-        if (stbi_write_png(maskPath.c_str(), colorWidth, colorHeight, 1, iceMask.data(), colorWidth) != 0)
+        std::string tempMaskPath = AssetManifest::temporaryPath(maskPath);
+        if (stbi_write_png(tempMaskPath.c_str(), colorWidth, colorHeight, 1, iceMask.data(), colorWidth) != 0 &&
+            AssetManifest::commit(tempMaskPath, maskPath, recipe))
         {
             float icePercentage =
                 (static_cast<float>(icePixels) / static_cast<float>(colorWidth * colorHeight)) * 100.0F;
@@ -192,6 +200,7 @@ bool EarthMaterial::preprocessIceMasks(const std::string &defaultsPath,
         }
         else
         {
+            std::filesystem::remove(tempMaskPath);
             std::cerr << "    ERROR: Failed to save " << maskFilename << '\n';
         }
     }
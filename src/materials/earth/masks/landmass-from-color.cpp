@@ -1,14 +1,17 @@
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
+#include "../../helpers/connected-components.h"
 #include "../../helpers/cubemap-conversion.h"
+#include "../../helpers/parallel-rows.h"
 #include "../earth-material.h"
 
-
 #include <algorithm>
+#include <atomic>
 #include <cctype> // For std::tolower
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -231,11 +234,13 @@ bool isWaterPixel(float r, float g, float b)
 }
 
 // ============================================================================
-// Helper function: Recursively expand water mask from perimeter
+// Helper function: Expand water mask into connected water-colored pixels
 // ============================================================================
-// Uses a queue-based flood fill starting from the water perimeter to
-// recursively expand outward, collecting all water pixels until reaching
-// continent edges. Uses raw elevation data to ensure we don't expand to elevated land.
+// A land pixel becomes water if it passes the water test (MNDWI + HSV color and, when
+// available, the elevation constraint) and is 8-connected to existing water through other
+// pixels that pass it. Equivalently: every connected component of water + candidate pixels
+// that contains water becomes water. The candidates are tested in parallel and the
+// components come from one connected-component labeling pass.
 // - elevationData: Optional raw elevation data in meters (nullptr if not available)
 // - elevationWidth/Height: Dimensions of elevation data
 // - elevationMin/Max: Min/max elevation values for normalization
@@ -254,9 +259,7 @@ void expandWaterMask(std::vector<unsigned char> &waterMask,
                      float elevationMax = 0.0f,
                      float seaLevel = 0.0f)
 {
-    const int neighborOffsets[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
-
-    std::cout << "  Expanding water mask recursively from perimeter..." << '\n';
+    std::cout << "  Expanding water mask into connected water-colored pixels..." << '\n';
     if (elevationData)
     {
         std::cout << "    Using elevation data constraint (sea level = " << seaLevel << "m)" << '\n';
@@ -266,119 +269,78 @@ void expandWaterMask(std::vector<unsigned char> &waterMask,
         std::cout << "    No elevation data available, using color-only detection" << '\n';
     }
 
-    // Find all perimeter pixels (water pixels adjacent to land)
-    std::queue<std::pair<int, int>> perimeterQueue;
-    std::vector<bool> visited(width * height, false);
-
-    const float SEA_LEVEL_METERS = seaLevel;
-
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+    // 2 = water, 1 = land that passes the water test (candidate), 0 = land
+    std::vector<uint8_t> waterOrCandidate(static_cast<size_t>(width) * height);
+    ParallelRows::forEachRowBand(height, 16, true, [&](int rowBegin, int rowEnd) {
+        for (int y = rowBegin; y < rowEnd; y++)
         {
-            int idx = y * width + x;
-
-            // Skip if not water
-            if (waterMask[idx] != 0)
-                continue;
-
-            // Check if this water pixel has at least one land neighbor (perimeter)
-            bool isPerimeter = false;
-            for (int n = 0; n < 8; n++)
+            for (int x = 0; x < width; x++)
             {
-                int nx = x + neighborOffsets[n][0];
-                int ny = y + neighborOffsets[n][1];
-
-                if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+                int idx = y * width + x;
+                if (waterMask[idx] == 0)
+                {
+                    waterOrCandidate[idx] = 2;
                     continue;
+                }
+
+                // Sample color at this pixel
+                int cx = static_cast<int>(static_cast<float>(x) / (width - 1) * (colorWidth - 1));
+                int cy = static_cast<int>(static_cast<float>(y) / (height - 1) * (colorHeight - 1));
+                cx = std::min(cx, colorWidth - 1);
+                cy = std::min(cy, colorHeight - 1);
+
+                int colorIdx = cy * colorWidth + cx;
+                float r = colorData[colorIdx * colorChannels + 0] / 255.0f;
+                float g = colorData[colorIdx * colorChannels + 1] / 255.0f;
+                float b = colorData[colorIdx * colorChannels + 2] / 255.0f;
 
-                int nIdx = ny * width + nx;
-                if (waterMask[nIdx] != 0) // Neighbor is land
+                // Check elevation constraint: only expand to pixels at or below sea level
+                bool elevationOk = true;
+                if (elevationData && elevationWidth > 0 && elevationHeight > 0)
                 {
-                    isPerimeter = true;
-                    break;
+                    // Sample elevation data directly in equirectangular coordinates
+                    float elevationValue =
+                        sampleElevation(elevationData, elevationWidth, elevationHeight, x, y, width, height);
+
+                    // Allow small tolerance (up to 5 meters) to account for noise and coastal variations
+                    elevationOk = (elevationValue <= seaLevel + 5.0f);
                 }
-            }
 
-            if (isPerimeter)
-            {
-                perimeterQueue.push({x, y});
-                visited[idx] = true;
+                waterOrCandidate[idx] = elevationOk && isWaterPixel(r, g, b) ? 1 : 0;
             }
         }
-    }
-
-    std::cout << "    Found " << perimeterQueue.size() << " perimeter pixels to expand from" << '\n';
+    });
 
-    // Recursively expand from perimeter
-    int totalExpanded = 0;
-    int iteration = 0;
+    ConnectedComponents::Labels labels;
+    ConnectedComponents::label(waterOrCandidate.data(), width, height, labels);
 
-    while (!perimeterQueue.empty())
+    // Components that contain existing water absorb their candidates
+    std::vector<uint8_t> touchesWater(labels.components.size(), 0);
+    for (size_t i = 0; i < waterOrCandidate.size(); i++)
     {
-        auto [x, y] = perimeterQueue.front();
-        perimeterQueue.pop();
-
-        // Check all neighbors of this perimeter pixel
-        for (int n = 0; n < 8; n++)
+        if (waterOrCandidate[i] == 2)
         {
-            int nx = x + neighborOffsets[n][0];
-            int ny = y + neighborOffsets[n][1];
-
-            // Skip out of bounds
-            if (nx < 0 || nx >= width || ny < 0 || ny >= height)
-                continue;
-
-            int nIdx = ny * width + nx;
-
-            // Skip if already water or already visited
-            if (waterMask[nIdx] == 0 || visited[nIdx])
-                continue;
-
-            // Sample color at neighbor pixel
-            int cx = static_cast<int>(static_cast<float>(nx) / (width - 1) * (colorWidth - 1));
-            int cy = static_cast<int>(static_cast<float>(ny) / (height - 1) * (colorHeight - 1));
-            cx = std::min(cx, colorWidth - 1);
-            cy = std::min(cy, colorHeight - 1);
-
-            int colorIdx = cy * colorWidth + cx;
-            float r = colorData[colorIdx * colorChannels + 0] / 255.0f;
-            float g = colorData[colorIdx * colorChannels + 1] / 255.0f;
-            float b = colorData[colorIdx * colorChannels + 2] / 255.0f;
-
-            // Check elevation constraint: only expand to pixels at or below sea level
-            bool elevationOk = true;
-            if (elevationData && elevationWidth > 0 && elevationHeight > 0)
-            {
-                // Sample elevation data directly in equirectangular coordinates
-                float elevationValue =
-                    sampleElevation(elevationData, elevationWidth, elevationHeight, nx, ny, width, height);
-
-                // Only allow expansion to pixels at or below sea level
-                // Allow small tolerance (up to 5 meters) to account for noise and coastal variations
-                elevationOk = (elevationValue <= seaLevel + 5.0f);
-            }
+            touchesWater[labels.pixels[i] - 1] = 1;
+        }
+    }
 
-            // Check if neighbor is water using MNDWI + HSV analysis
-            if (elevationOk && isWaterPixel(r, g, b))
-            {
-                // Add to water mask and continue expanding from here
-                waterMask[nIdx] = 0; // Mark as water
-                visited[nIdx] = true;
-                perimeterQueue.push({nx, ny});
-                totalExpanded++;
+    int candidates = 0;
+    int totalExpanded = 0;
+    for (size_t i = 0; i < waterOrCandidate.size(); i++)
+    {
+        if (waterOrCandidate[i] != 1)
+            continue;
 
-                if (totalExpanded % 10000 == 0)
-                {
-                    std::cout << "    Expanded " << totalExpanded << " pixels..." << '\n';
-                }
-            }
+        candidates++;
+        if (touchesWater[labels.pixels[i] - 1])
+        {
+            waterMask[i] = 0; // Mark as water
+            totalExpanded++;
         }
-
-        iteration++;
     }
 
-    std::cout << "    Total expanded: " << totalExpanded << " pixels in " << iteration << " iterations" << '\n';
+    std::cout << "    Total expanded: " << totalExpanded << " of " << candidates << " candidate pixels ("
+              << labels.components.size() << " components)" << '\n';
 }
 
 // ============================================================================
@@ -386,85 +348,49 @@ void expandWaterMask(std::vector<unsigned char> &waterMask,
 // ============================================================================
 // Finds small isolated land regions (islands) that are only ~3 pixels in radius
 // and converts them to water (ocean). This removes noise and small false positives.
+// Land components and their bounding boxes come from one connected-component labeling pass.
 // - maxRadius: Maximum radius in pixels for an island to be removed (default: 3)
 void removeSmallLandIslands(std::vector<unsigned char> &waterMask, int width, int height, int maxRadius = 3)
 {
     std::cout << "  Removing small land islands (radius <= " << maxRadius << " pixels)..." << '\n';
 
-    const int neighborOffsets[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
-    std::vector<bool> visited(width * height, false);
-    int islandsRemoved = 0;
-    int totalPixelsRemoved = 0;
-
-    // Find all land pixels (value = 255) and check if they're part of small islands
-    for (int startY = 0; startY < height; startY++)
+    std::vector<uint8_t> land(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < land.size(); i++)
     {
-        for (int startX = 0; startX < width; startX++)
-        {
-            int startIdx = startY * width + startX;
-
-            // Skip if already visited or not land
-            if (visited[startIdx] || waterMask[startIdx] != 255)
-                continue;
-
-            // Flood fill to find connected land component
-            std::queue<std::pair<int, int>> componentQueue;
-            std::vector<std::pair<int, int>> componentPixels;
-
-            componentQueue.push({startX, startY});
-            visited[startIdx] = true;
-
-            int minX = startX, maxX = startX;
-            int minY = startY, maxY = startY;
-
-            while (!componentQueue.empty())
-            {
-                auto [x, y] = componentQueue.front();
-                componentQueue.pop();
-
-                componentPixels.push_back({x, y});
-
-                // Update bounding box
-                minX = std::min(minX, x);
-                maxX = std::max(maxX, x);
-                minY = std::min(minY, y);
-                maxY = std::max(maxY, y);
+        land[i] = waterMask[i] == 255;
+    }
 
-                // Check all neighbors
-                for (int n = 0; n < 8; n++)
-                {
-                    int nx = x + neighborOffsets[n][0];
-                    int ny = y + neighborOffsets[n][1];
+    ConnectedComponents::Labels labels;
+    ConnectedComponents::label(land.data(), width, height, labels);
 
-                    if (nx < 0 || nx >= width || ny < 0 || ny >= height)
-                        continue;
-
-                    int nIdx = ny * width + nx;
+    std::vector<uint8_t> removeComponent(labels.components.size(), 0);
+    int islandsRemoved = 0;
+    int totalPixelsRemoved = 0;
+    for (size_t c = 0; c < labels.components.size(); c++)
+    {
+        const ConnectedComponents::Component &component = labels.components[c];
 
-                    // Add unvisited land pixels to component
-                    if (!visited[nIdx] && waterMask[nIdx] == 255)
-                    {
-                        visited[nIdx] = true;
-                        componentQueue.push({nx, ny});
-                    }
-                }
-            }
+        // Calculate radius of component (half of diagonal of bounding box)
+        int widthComponent = component.maxX - component.minX + 1;
+        int heightComponent = component.maxY - component.minY + 1;
+        float radius = std::sqrt(widthComponent * widthComponent + heightComponent * heightComponent) / 2.0f;
 
-            // Calculate radius of component (half of diagonal of bounding box)
-            int widthComponent = maxX - minX + 1;
-            int heightComponent = maxY - minY + 1;
-            float radius = std::sqrt(widthComponent * widthComponent + heightComponent * heightComponent) / 2.0f;
+        // If component is small enough, convert to water
+        if (radius <= static_cast<float>(maxRadius))
+        {
+            removeComponent[c] = 1;
+            islandsRemoved++;
+            totalPixelsRemoved += static_cast<int>(component.size);
+        }
+    }
 
-            // If component is small enough, convert to water
-            if (radius <= static_cast<float>(maxRadius))
+    if (islandsRemoved > 0)
+    {
+        for (size_t i = 0; i < land.size(); i++)
+        {
+            if (labels.pixels[i] != 0 && removeComponent[labels.pixels[i] - 1])
             {
-                for (const auto &[x, y] : componentPixels)
-                {
-                    int idx = y * width + x;
-                    waterMask[idx] = 0; // Mark as water
-                }
-                islandsRemoved++;
-                totalPixelsRemoved += static_cast<int>(componentPixels.size());
+                waterMask[i] = 0; // Mark as water
             }
         }
     }
@@ -479,92 +405,113 @@ void removeSmallLandIslands(std::vector<unsigned char> &waterMask, int width, in
 // Finds white pixels (land) that have non-white (water) nearby pixels and
 // reduces their value based on the proportion of non-white neighbors.
 // This "pulls the edge" closer to shorelines before denoising.
+// The non-white count of each (2r+1)x(2r+1) window is separable: running sums along
+// each row, then running sums of those down each column, so the cost per pixel does
+// not depend on the radius.
 // - erosionRadius: Radius to check for non-white neighbors (default: 2)
 void erodeEdges(std::vector<unsigned char> &landmask, int width, int height, int erosionRadius = 2)
 {
     std::cout << "  Eroding edges to pull shorelines closer (radius: " << erosionRadius << ")..." << '\n';
 
-    std::vector<unsigned char> result(landmask);
-
-    const int neighborOffsets[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
-    int pixelsEroded = 0;
+    const int window = 2 * erosionRadius + 1;
 
-    for (int y = 0; y < height; y++)
+    // Every pixel has the full window of neighbors; out of bounds counts as non-white (edge of image)
+    const int totalNeighbors = window * window - 1;
+    if (totalNeighbors <= 0)
     {
-        for (int x = 0; x < width; x++)
-        {
-            int idx = y * width + x;
-            unsigned char pixelValue = landmask[idx];
+        std::cout << "    Eroded 0 edge pixels" << '\n';
+        return;
+    }
+
+    std::vector<unsigned char> result(landmask);
+    std::atomic<int> pixelsEroded{0};
 
-            // Only process white pixels (land)
-            if (pixelValue != 255)
+    ParallelRows::forEachRowBand(height, 16, true, [&](int rowBegin, int rowEnd) {
+        // Non-white pixels in [x - r, x + r] of row y, for every x
+        auto rowCounts = [&](int y, std::vector<int> &counts) {
+            if (y < 0 || y >= height)
             {
-                continue;
+                std::fill(counts.begin(), counts.end(), window);
+                return;
             }
+            const unsigned char *row = landmask.data() + static_cast<size_t>(y) * width;
+            auto nonWhite = [&](int x) { return x < 0 || x >= width || row[x] != 255 ? 1 : 0; };
 
-            // Count non-white neighbors within radius
-            int nonWhiteCount = 0;
-            int totalNeighbors = 0;
-
-            for (int dy = -erosionRadius; dy <= erosionRadius; dy++)
+            int count = 0;
+            for (int x = -erosionRadius; x <= erosionRadius; x++)
             {
-                for (int dx = -erosionRadius; dx <= erosionRadius; dx++)
-                {
-                    // Skip center pixel
-                    if (dx == 0 && dy == 0)
-                        continue;
-
-                    int nx = x + dx;
-                    int ny = y + dy;
+                count += nonWhite(x);
+            }
+            for (int x = 0; x < width; x++)
+            {
+                counts[x] = count;
+                count += nonWhite(x + erosionRadius + 1) - nonWhite(x - erosionRadius);
+            }
+        };
 
-                    if (nx < 0 || nx >= width || ny < 0 || ny >= height)
-                    {
-                        // Out of bounds counts as non-white (edge of image)
-                        nonWhiteCount++;
-                        totalNeighbors++;
-                        continue;
-                    }
+        // Column sums of the row counts over [y - r, y + r]: the non-white count of each window
+        std::vector<int> counts(width), windowCounts(width, 0);
+        for (int y = rowBegin - erosionRadius; y <= rowBegin + erosionRadius; y++)
+        {
+            rowCounts(y, counts);
+            for (int x = 0; x < width; x++)
+            {
+                windowCounts[x] += counts[x];
+            }
+        }
 
-                    int nIdx = ny * width + nx;
-                    totalNeighbors++;
+        int eroded = 0;
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int idx = y * width + x;
 
-                    // Check if neighbor is non-white (water or gray)
-                    if (landmask[nIdx] != 255)
-                    {
-                        nonWhiteCount++;
-                    }
+                // Only process white pixels (land); the center itself is white, so the window count
+                // is the number of non-white neighbors
+                int nonWhiteCount = windowCounts[x];
+                if (landmask[idx] != 255 || nonWhiteCount == 0)
+                {
+                    continue;
                 }
-            }
 
-            if (totalNeighbors == 0)
-            {
-                continue;
-            }
+                // Calculate proportion of non-white neighbors
+                float nonWhiteRatio = static_cast<float>(nonWhiteCount) / static_cast<float>(totalNeighbors);
 
-            // Calculate proportion of non-white neighbors
-            float nonWhiteRatio = static_cast<float>(nonWhiteCount) / static_cast<float>(totalNeighbors);
+                // Reduce pixel value based on non-white neighbor ratio
+                // More non-white neighbors = more reduction
+                // Formula: newValue = 255 * (1 - nonWhiteRatio * reductionStrength)
+                // reductionStrength controls how aggressive the erosion is (0.0 to 1.0)
+                const float reductionStrength = 0.7f; // 70% reduction for fully surrounded pixels
+                float reduction = nonWhiteRatio * reductionStrength;
+                float newValue = 255.0f * (1.0f - reduction);
 
-            // Reduce pixel value based on non-white neighbor ratio
-            // More non-white neighbors = more reduction
-            // Formula: newValue = 255 * (1 - nonWhiteRatio * reductionStrength)
-            // reductionStrength controls how aggressive the erosion is (0.0 to 1.0)
-            const float reductionStrength = 0.7f; // 70% reduction for fully surrounded pixels
-            float reduction = nonWhiteRatio * reductionStrength;
-            float newValue = 255.0f * (1.0f - reduction);
+                result[idx] = static_cast<unsigned char>(std::max(0.0f, std::min(255.0f, newValue)));
+                eroded++;
+            }
 
-            // Only reduce if there are non-white neighbors
-            if (nonWhiteCount > 0)
+            // Slide the window down one row
+            if (y + 1 < rowEnd)
             {
-                result[idx] = static_cast<unsigned char>(std::max(0.0f, std::min(255.0f, newValue)));
-                pixelsEroded++;
+                rowCounts(y + erosionRadius + 1, counts);
+                for (int x = 0; x < width; x++)
+                {
+                    windowCounts[x] += counts[x];
+                }
+                rowCounts(y - erosionRadius, counts);
+                for (int x = 0; x < width; x++)
+                {
+                    windowCounts[x] -= counts[x];
+                }
             }
         }
-    }
+        pixelsEroded += eroded;
+    });
 
     // Copy result back
-    landmask = result;
+    landmask.swap(result);
 
-    std::cout << "    Eroded " << pixelsEroded << " edge pixels" << '\n';
+    std::cout << "    Eroded " << pixelsEroded.load() << " edge pixels" << '\n';
 }
 
 // ============================================================================
@@ -777,6 +724,11 @@ void applyDenoising(std::vector<unsigned char> &landmask,
 // - Used for: Filtering ocean pixels from other textures
 // - Algorithm: MNDWI (RGB approximation) + HSV analysis + region growing
 
+namespace
+{
+constexpr int OUTPUT_VERSION = 2; // Bump when the landmass mask changes (see AssetManifest)
+}
+
 bool EarthMaterial::preprocessLandmassMask(const std::string &defaultsPath,
                                            const std::string &outputBasePath,
                                            TextureResolution resolution)
@@ -791,42 +743,59 @@ bool EarthMaterial::preprocessLandmassMask(const std::string &defaultsPath,
         colorPath = outputPath + "/earth_month_01.png";
     }
 
-    // Check cache: mask exists and is newer than or equal to the color image
-    if (std::filesystem::exists(landmaskPath))
-    {
-        bool colorExists = std::filesystem::exists(colorPath);
+    // Find elevation GeoTIFF file for raw elevation data (optional - helps filter elevated areas)
+    std::string elevationSourcePath = defaultsPath + "/earth-surface/elevation";
+    std::string elevationTiffPath;
 
-        if (colorExists)
+    try
+    {
+        if (std::filesystem::exists(elevationSourcePath))
         {
-            // Check modification times - only rebuild if color image is newer
-            auto maskTime = std::filesystem::last_write_time(landmaskPath);
-            auto colorTime = std::filesystem::last_write_time(colorPath);
-
-            // If mask is newer than or equal to color image, we're good
-            if (maskTime >= colorTime)
-            {
-                std::cout << "Landmass mask already exists and is up-to-date: " << landmaskPath << '\n';
-                return true;
-            }
-            else
+            for (const auto &entry : std::filesystem::directory_iterator(elevationSourcePath))
             {
-                std::cout << "Landmass mask exists but color image is newer, rebuilding..." << '\n';
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+                if (ext == ".tif" || ext == ".tiff")
+                {
+                    elevationTiffPath = entry.path().string();
+                    break;
+                }
             }
         }
-        else
-        {
-            // Color image missing, but mask exists - keep it
-            std::cout << "Landmass mask already exists (color image not found): " << landmaskPath << '\n';
-            return true;
-        }
     }
-    // If mask doesn't exist, proceed to generation below
-
-    std::cout << "=== Landmass Mask Generation ===" << '\n';
+    catch (const std::exception &)
+    {
+        // Elevation path doesn't exist or can't be accessed
+    }
 
     // Get output dimensions
     int outWidth, outHeight;
     getResolutionDimensions(resolution, outWidth, outHeight);
+
+    // Check cache: the mask is rebuilt when the color image, elevation source or resolution changes
+    AssetManifest::Recipe recipe;
+    recipe.sources = {colorPath};
+    if (!elevationTiffPath.empty())
+    {
+        recipe.sources.push_back(elevationTiffPath);
+    }
+    recipe.parameters = std::to_string(outWidth) + "x" + std::to_string(outHeight);
+    recipe.version = OUTPUT_VERSION;
+
+    if (std::filesystem::exists(landmaskPath) && !std::filesystem::exists(colorPath))
+    {
+        // Color image missing, but mask exists - keep it
+        std::cout << "Landmass mask already exists (color image not found): " << landmaskPath << '\n';
+        return true;
+    }
+    if (AssetManifest::isCurrent(landmaskPath, recipe))
+    {
+        std::cout << "Landmass mask is up to date: " << landmaskPath << '\n';
+        return true;
+    }
+
+    std::cout << "=== Landmass Mask Generation ===" << '\n';
     std::cout << "Output dimensions: " << outWidth << "x" << outHeight << " (will convert to cubemap)" << '\n';
 
     // Load color texture (Blue Marble) - required dependency
@@ -876,32 +845,6 @@ bool EarthMaterial::preprocessLandmassMask(const std::string &defaultsPath,
         ch = colorEquirectH;
     }
 
-    // Find elevation GeoTIFF file for raw elevation data (optional - helps filter elevated areas)
-    std::string elevationSourcePath = defaultsPath + "/earth-surface/elevation";
-    std::string elevationTiffPath;
-
-    try
-    {
-        if (std::filesystem::exists(elevationSourcePath))
-        {
-            for (const auto &entry : std::filesystem::directory_iterator(elevationSourcePath))
-            {
-                std::string ext = entry.path().extension().string();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-
-                if (ext == ".tif" || ext == ".tiff")
-                {
-                    elevationTiffPath = entry.path().string();
-                    break;
-                }
-            }
-        }
-    }
-    catch (const std::exception &)
-    {
-        // Elevation path doesn't exist or can't be accessed
-    }
-
     // Load raw elevation data from GeoTIFF if available (optional - helps filter elevated areas)
     float *elevationData = nullptr;
     int elevationW = 0, elevationH = 0;
@@ -911,22 +854,21 @@ bool EarthMaterial::preprocessLandmassMask(const std::string &defaultsPath,
     {
         std::cout << "  Loading raw elevation data from: "
                   << std::filesystem::path(elevationTiffPath).filename().string() << '\n';
-        elevationData = loadGeoTiffElevation(elevationTiffPath, elevationW, elevationH);
+        // Averaged down to the mask resolution while decoding (the mask samples it per output pixel)
+        ElevationRange elevationRange;
+        elevationData = loadGeoTiffElevation(elevationTiffPath,
+                                             outWidth,
+                                             outHeight,
+                                             ElevationAggregate::Mean,
+                                             elevationW,
+                                             elevationH,
+                                             &elevationRange);
 
         if (elevationData)
         {
-            // Find min/max elevation for reference
-            elevationMin = elevationData[0];
-            elevationMax = elevationData[0];
-            for (int i = 0; i < elevationW * elevationH; i++)
-            {
-                float v = elevationData[i];
-                if (v > -10000.0f) // Skip NODATA values
-                {
-                    elevationMin = std::min(elevationMin, v);
-                    elevationMax = std::max(elevationMax, v);
-                }
-            }
+            // Min/max elevation for reference
+            elevationMin = elevationRange.lowest;
+            elevationMax = elevationRange.highest;
 
             std::cout << "  Loaded elevation data: " << elevationW << "x" << elevationH << '\n';
             std::cout << "    Elevation range: " << elevationMin << "m to " << elevationMax << "m" << '\n';
@@ -1126,8 +1068,11 @@ bool EarthMaterial::preprocessLandmassMask(const std::string &defaultsPath,
     getCubemapStripDimensions(faceSize, cubemapWidth, cubemapHeight);
 
     // Save landmass mask as cubemap
-    if (!stbi_write_png(landmaskPath.c_str(), cubemapWidth, cubemapHeight, 1, maskCubemap, cubemapWidth))
+    std::string tempMaskPath = AssetManifest::temporaryPath(landmaskPath);
+    if (!stbi_write_png(tempMaskPath.c_str(), cubemapWidth, cubemapHeight, 1, maskCubemap, cubemapWidth) ||
+        !AssetManifest::commit(tempMaskPath, landmaskPath, recipe))
     {
+        std::filesystem::remove(tempMaskPath);
         std::cerr << "  ERROR: Failed to save landmass mask" << '\n';
         delete[] maskCubemap;
         return false;
@@ -1142,8 +1087,11 @@ bool EarthMaterial::preprocessLandmassMask(const std::string &defaultsPath,
 
     if (denoiseCubemap)
     {
-        if (!stbi_write_png(denoiseMaskPath.c_str(), cubemapWidth, cubemapHeight, 1, denoiseCubemap, cubemapWidth))
+        std::string tempDenoisePath = AssetManifest::temporaryPath(denoiseMaskPath);
+        if (!stbi_write_png(tempDenoisePath.c_str(), cubemapWidth, cubemapHeight, 1, denoiseCubemap, cubemapWidth) ||
+            !AssetManifest::commit(tempDenoisePath, denoiseMaskPath, recipe))
         {
+            std::filesystem::remove(tempDenoisePath);
             std::cerr << "  WARNING: Failed to save denoising mask" << '\n';
         }
         else
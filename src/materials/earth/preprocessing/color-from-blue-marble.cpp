@@ -1,20 +1,27 @@
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
+#include "../../../concerns/helpers/mapped-file.h"
+#include "../../../concerns/helpers/png-stream-writer.h"
 #include "../../helpers/cubemap-conversion.h"
 #include "../earth-material.h"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
-#include <stb_image.h>
 #include <stb_image_write.h>
 
+// GDAL for reading the source JPEGs in row bands
+#include <gdal_priv.h>
+
 #include <cmath>
 
 namespace
@@ -22,12 +29,169 @@ namespace
 // Tile naming constants
 constexpr std::array<const char *, 4> AREAS = {"A", "B", "C", "D"};
 constexpr std::array<const char *, 2> HEMISPHERES = {"1", "2"};
+
+constexpr int CHANNELS = 3;            // RGB
+constexpr int EQUIRECT_BAND_ROWS = 64; // Output rows read from the source tiles at a time
+constexpr int OUTPUT_VERSION = 1;      // Bump when the combined texture changes (see AssetManifest)
+
+std::string tileFilename(int month, int col, int row)
+{
+    char filename[128];
+    snprintf(filename,
+             sizeof(filename),
+             "world.topo.2004%02d.3x21600x21600.%s%s.jpg",
+             month,
+             AREAS[col],
+             HEMISPHERES[row]);
+    return filename;
+}
+
+// A month's combined texture is built from its 8 tiles at the given size and format
+AssetManifest::Recipe monthRecipe(int month, const std::string &sourcePath, int outWidth, int outHeight, bool lossless)
+{
+    AssetManifest::Recipe recipe;
+    for (int row = 0; row < 2; row++)
+    {
+        for (int col = 0; col < 4; col++)
+        {
+            recipe.sources.push_back(sourcePath + "/" + tileFilename(month, col, row));
+        }
+    }
+    recipe.parameters = std::to_string(outWidth) + "x" + std::to_string(outHeight) + (lossless ? " png" : " jpg95");
+    recipe.version = OUTPUT_VERSION;
+    return recipe;
+}
+
+// Read output rows [y0, y0 + rows) of one tile, area-averaged from the source resolution
+// dst receives tileWidth RGB pixels per row, lineSpace bytes apart (so tiles land side by side)
+bool readTileBand(GDALDataset *tile, int y0, int rows, int tileWidth, int tileHeight, unsigned char *dst,
+                  GSpacing lineSpace)
+{
+    int srcWidth = tile->GetRasterXSize();
+    int srcHeight = tile->GetRasterYSize();
+    double scaleY = static_cast<double>(srcHeight) / tileHeight;
+
+    GDALRasterIOExtraArg extraArg;
+    INIT_RASTERIO_EXTRA_ARG(extraArg);
+    extraArg.eResampleAlg = GRIORA_Average;
+    extraArg.bFloatingPointWindowValidity = TRUE;
+    extraArg.dfXOff = 0.0;
+    extraArg.dfYOff = y0 * scaleY;
+    extraArg.dfXSize = srcWidth;
+    extraArg.dfYSize = rows * scaleY;
+
+    int srcY0 = static_cast<int>(std::floor(extraArg.dfYOff));
+    int srcY1 = std::min(srcHeight, static_cast<int>(std::ceil(extraArg.dfYOff + extraArg.dfYSize)));
+
+    // Grayscale tiles replicate their first band into RGB
+    int bandMap[CHANNELS] = {1, 2, 3};
+    if (tile->GetRasterCount() < CHANNELS)
+    {
+        bandMap[1] = 1;
+        bandMap[2] = 1;
+    }
+
+    CPLErr err = tile->RasterIO(GF_Read,
+                                0,
+                                srcY0,
+                                srcWidth,
+                                srcY1 - srcY0,
+                                dst,
+                                tileWidth,
+                                rows,
+                                GDT_Byte,
+                                CHANNELS,
+                                bandMap,
+                                CHANNELS,
+                                lineSpace,
+                                1,
+                                &extraArg);
+    return err == CE_None;
+}
+
+// Write one month's equirectangular image (raw RGB rows, top to bottom) from its 8 source tiles
+// Each hemisphere's four tiles are read together, band by band, top to bottom, so every JPEG is
+// decoded sequentially once and only one band of the image is ever in memory
+bool writeEquirectangularFromTiles(int month,
+                                   const std::string &sourcePath,
+                                   const std::string &equirectPath,
+                                   int tileWidth,
+                                   int tileHeight)
+{
+    const int equirectWidth = tileWidth * 4;
+    const GSpacing lineSpace = static_cast<GSpacing>(equirectWidth) * CHANNELS;
+
+    std::ofstream out(equirectPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        std::cerr << "\n    Failed to create: " << equirectPath << '\n';
+        return false;
+    }
+
+    std::vector<unsigned char> band(static_cast<size_t>(EQUIRECT_BAND_ROWS) * lineSpace, 0);
+
+    for (int row = 0; row < 2; row++)
+    {
+        std::array<GDALDataset *, 4> tiles{};
+        bool opened = true;
+        for (int col = 0; col < 4 && opened; col++)
+        {
+            std::string filename = tileFilename(month, col, row);
+            std::string filepath = sourcePath + "/" + filename;
+
+            tiles[col] = static_cast<GDALDataset *>(GDALOpen(filepath.c_str(), GA_ReadOnly));
+            if (!tiles[col])
+            {
+                std::cerr << "\n    Failed to load tile: " << filename << '\n';
+                opened = false;
+            }
+        }
+
+        bool success = opened;
+        for (int y0 = 0; success && y0 < tileHeight; y0 += EQUIRECT_BAND_ROWS)
+        {
+            int rows = std::min(EQUIRECT_BAND_ROWS, tileHeight - y0);
+            for (int col = 0; success && col < 4; col++)
+            {
+                success = readTileBand(tiles[col],
+                                       y0,
+                                       rows,
+                                       tileWidth,
+                                       tileHeight,
+                                       &band[static_cast<size_t>(col) * tileWidth * CHANNELS],
+                                       lineSpace);
+            }
+            if (success)
+            {
+                out.write(reinterpret_cast<const char *>(band.data()), static_cast<std::streamsize>(rows * lineSpace));
+                success = !out.fail();
+            }
+        }
+
+        for (GDALDataset *tile : tiles)
+        {
+            if (tile)
+            {
+                GDALClose(tile);
+            }
+        }
+
+        if (!success)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
 } // namespace
 
 // ==================================================
 // Preprocessing Blue Marble - Combine Source Tiles
 // ==================================================
 // Uses multithreading to process all 12 months in parallel for faster startup.
+// Each month streams through a small working set (see combineTilesForMonth), so every
+// resolution can use every core.
 
 int EarthMaterial::preprocessTiles(const std::string &defaultsPath,
                                    const std::string &outputBasePath,
@@ -74,8 +238,9 @@ int EarthMaterial::preprocessTiles(const std::string &defaultsPath,
         snprintf(outputFilename, sizeof(outputFilename), "earth_month_%02d%s", month, ext);
         task.outputFilepath = outputPath + "/" + outputFilename;
 
-        // Check if combined image already exists
-        if (std::filesystem::exists(task.outputFilepath))
+        // Reuse the combined image if it was built from the current tiles with the current settings
+        AssetManifest::Recipe recipe = monthRecipe(month, sourcePath, outWidth, outHeight, lossless);
+        if (AssetManifest::isCurrent(task.outputFilepath, recipe))
         {
             task.needsProcessing = false;
             task.sourceExists = true;
@@ -110,7 +275,7 @@ int EarthMaterial::preprocessTiles(const std::string &defaultsPath,
 
     if (toProcessCount == 0)
     {
-        std::cout << "All " << skippedCount << " textures already exist, nothing to process." << '\n';
+        std::cout << "All " << skippedCount << " textures are up to date, nothing to process." << '\n';
         if (missingCount > 0)
         {
             std::cout << "(" << missingCount << " months have no source tiles)" << '\n';
@@ -119,17 +284,14 @@ int EarthMaterial::preprocessTiles(const std::string &defaultsPath,
         return skippedCount;
     }
 
+    // Initialize GDAL (must be done before threading)
+    GDALAllRegister();
+
     // Get number of hardware threads
     unsigned int numThreads = std::thread::hardware_concurrency();
     if (numThreads == 0)
         numThreads = 4; // Fallback
 
-    // For Ultra resolution, limit threads due to memory usage (~15GB per image)
-    if (resolution == TextureResolution::Ultra)
-    {
-        numThreads = std::min(numThreads, 2u);
-    }
-
     numThreads = std::min(numThreads, static_cast<unsigned int>(toProcessCount));
 
     std::cout << "Processing " << toProcessCount << " months using " << numThreads << " threads..." << '\n';
@@ -213,7 +375,7 @@ int EarthMaterial::preprocessTiles(const std::string &defaultsPath,
     }
     if (skippedCount > 0)
     {
-        std::cout << ", " << skippedCount << " already existed";
+        std::cout << ", " << skippedCount << " up to date";
     }
     std::cout << '\n';
     std::cout << "===================================" << '\n';
@@ -228,212 +390,115 @@ bool EarthMaterial::combineTilesForMonth(int month,
                                          int outHeight,
                                          bool lossless)
 {
-    const int channels = 3; // RGB
-
-    // Each tile's size in the intermediate equirectangular buffer (4 columns, 2
-    // rows)
+    // Each tile's size in the equirectangular image (4 columns, 2 rows)
     const int tileWidth = outWidth / 4;
     const int tileHeight = outHeight / 2;
+    const int equirectWidth = tileWidth * 4;
+    const int equirectHeight = tileHeight * 2;
 
     // =========================================================================
-    // Step 1: Build intermediate equirectangular buffer from source tiles
+    // Step 1: Stream source tiles into an equirectangular file on disk
     // =========================================================================
-    std::vector<unsigned char> equirect;
-    try
-    {
-        equirect.resize(static_cast<size_t>(outWidth) * outHeight * channels, 0);
-    }
-    catch (const std::bad_alloc &)
+    // The file is memory-mapped below, so the OS pages it in and out as needed instead
+    // of the whole image being held in memory
+    std::string equirectPath = outputPath + ".equirect.tmp";
+    if (!writeEquirectangularFromTiles(month, sourcePath, equirectPath, tileWidth, tileHeight))
     {
-        std::cerr << "Failed to allocate " << (static_cast<size_t>(outWidth) * outHeight * channels / 1024 / 1024)
-                  << " MB for equirectangular buffer" << '\n';
+        std::filesystem::remove(equirectPath);
         return false;
     }
 
-    // Process each of the 8 tiles into equirectangular buffer
-    for (int col = 0; col < 4; col++)
+    MappedFile equirect;
+    size_t equirectBytes = static_cast<size_t>(equirectWidth) * equirectHeight * CHANNELS;
+    if (!equirect.open(equirectPath) || equirect.size() != equirectBytes)
     {
-        for (int row = 0; row < 2; row++)
-        {
-            // Build source filename
-            char filename[128];
-            snprintf(filename,
-                     sizeof(filename),
-                     "world.topo.2004%02d.3x21600x21600.%s%s.jpg",
-                     month,
-                     AREAS[col],
-                     HEMISPHERES[row]);
-            std::string filepath = sourcePath + "/" + filename;
-
-            // Load and resize tile
-            int srcChannels;
-            unsigned char *tileData = loadAndResizeTile(filepath, tileWidth, tileHeight, srcChannels);
-
-            if (!tileData)
-            {
-                std::cerr << "\n    Failed to load tile: " << filename << '\n';
-                return false;
-            }
-
-            // Copy tile into equirectangular buffer at correct position
-            int startX = col * tileWidth;
-            int startY = row * tileHeight;
-
-            for (int y = 0; y < tileHeight; y++)
-            {
-                for (int x = 0; x < tileWidth; x++)
-                {
-                    int srcIdx = (y * tileWidth + x) * srcChannels;
-                    int dstIdx = ((startY + y) * outWidth + (startX + x)) * channels;
-
-                    if (srcChannels >= 3)
-                    {
-                        equirect[dstIdx + 0] = tileData[srcIdx + 0];
-                        equirect[dstIdx + 1] = tileData[srcIdx + 1];
-                        equirect[dstIdx + 2] = tileData[srcIdx + 2];
-                    }
-                    else
-                    {
-                        equirect[dstIdx + 0] = tileData[srcIdx];
-                        equirect[dstIdx + 1] = tileData[srcIdx];
-                        equirect[dstIdx + 2] = tileData[srcIdx];
-                    }
-                }
-            }
-
-            delete[] tileData;
-        }
-    }
-
-    // =========================================================================
-    // Step 2: Convert equirectangular to cubemap (vertical strip)
-    // =========================================================================
-    // Cubemap provides uniform sampling density and seamless rendering at all angles
-    // Format: Vertical strip with 6 faces (+X, -X, +Y, -Y, +Z, -Z)
-
-    int faceSize = calculateCubemapFaceSize(outWidth, outHeight);
-    unsigned char *cubemapData =
-        convertEquirectangularToCubemapUChar(equirect.data(), outWidth, outHeight, channels, faceSize);
-
-    if (!cubemapData)
-    {
-        std::cerr << "Failed to convert equirectangular to cubemap" << '\n';
+        std::cerr << "Failed to map equirectangular image: " << equirectPath << '\n';
+        equirect.close();
+        std::filesystem::remove(equirectPath);
         return false;
     }
 
     // =========================================================================
-    // Step 3: Save cubemap as vertical strip image
+    // Step 2: Convert equirectangular to cubemap (3x2 grid), row by row
     // =========================================================================
+    // Cubemap provides uniform sampling density and seamless rendering at all angles
+    // Format: 3x2 grid with 6 faces (+X -X +Y / -Y +Z -Z)
+    int faceSize = calculateCubemapFaceSize(equirectWidth, equirectHeight);
     int cubemapWidth, cubemapHeight;
-    getCubemapStripDimensions(faceSize, cubemapWidth, cubemapHeight);
+    getCubemapGridDimensions(faceSize, cubemapWidth, cubemapHeight);
+    const size_t rowBytes = static_cast<size_t>(cubemapWidth) * CHANNELS;
+
+    // Written under a temporary name so an interrupted run is never mistaken for a finished one
+    std::string tempOutputPath = AssetManifest::temporaryPath(outputPath);
+    bool success = false;
 
-    int result;
     if (lossless)
     {
-        result = stbi_write_png(outputPath.c_str(),
-                                cubemapWidth,
-                                cubemapHeight,
-                                channels,
-                                cubemapData,
-                                cubemapWidth * channels);
+        // PNG rows are compressed as they are produced, so the grid is never held in memory
+        PngStreamWriter png;
+        std::vector<unsigned char> row(rowBytes);
+        success = png.open(tempOutputPath, cubemapWidth, cubemapHeight, CHANNELS);
+        for (int gridY = 0; success && gridY < cubemapHeight; gridY++)
+        {
+            convertEquirectangularToCubemapGridRowUChar(equirect.data(),
+                                                        equirectWidth,
+                                                        equirectHeight,
+                                                        CHANNELS,
+                                                        faceSize,
+                                                        gridY,
+                                                        row.data());
+            success = png.writeRow(row.data());
+        }
+        success = png.finish() && success;
     }
     else
     {
-        result = stbi_write_jpg(outputPath.c_str(), cubemapWidth, cubemapHeight, channels, cubemapData, 95);
-    }
-
-    delete[] cubemapData;
-    return result != 0;
-}
-
-unsigned char *EarthMaterial::loadAndResizeTile(const std::string &filepath,
-                                                int targetWidth,
-                                                int targetHeight,
-                                                int &channels)
-{
-    // Load source image
-    int srcWidth, srcHeight;
-    stbi_set_flip_vertically_on_load(false); // Keep top-to-bottom for processing
-
-    unsigned char *srcData = stbi_load(filepath.c_str(), &srcWidth, &srcHeight, &channels, 0);
-
-    if (!srcData)
-    {
-        return nullptr;
-    }
-
-    // If source is already target size, return as-is (copy to new buffer)
-    if (srcWidth == targetWidth && srcHeight == targetHeight)
-    {
-        size_t size = static_cast<size_t>(targetWidth) * targetHeight * channels;
-        unsigned char *result = new (std::nothrow) unsigned char[size];
-        if (!result)
+        // stb's JPEG writer needs the whole grid (at most High resolution, 6144x4096)
+        std::vector<unsigned char> cubemapData;
+        try
         {
-            stbi_image_free(srcData);
-            return nullptr;
+            cubemapData.resize(rowBytes * cubemapHeight);
         }
-        memcpy(result, srcData, size);
-        stbi_image_free(srcData);
-        return result;
-    }
-
-    // Resize to target dimensions
-    size_t dstSize = static_cast<size_t>(targetWidth) * targetHeight * channels;
-    unsigned char *dstData = new (std::nothrow) unsigned char[dstSize];
-    if (!dstData)
-    {
-        stbi_image_free(srcData);
-        return nullptr;
-    }
-
-    resizeImage(srcData, srcWidth, srcHeight, dstData, targetWidth, targetHeight, channels);
-
-    // Free source
-    stbi_image_free(srcData);
-
-    return dstData;
-}
-
-void EarthMaterial::resizeImage(const unsigned char *src,
-                                int srcW,
-                                int srcH,
-                                unsigned char *dst,
-                                int dstW,
-                                int dstH,
-                                int channels)
-{
-    // Simple bilinear interpolation resize
-    float xRatio = static_cast<float>(srcW) / dstW;
-    float yRatio = static_cast<float>(srcH) / dstH;
-
-    for (int y = 0; y < dstH; y++)
-    {
-        float srcY = y * yRatio;
-        int y0 = static_cast<int>(srcY);
-        int y1 = std::min(y0 + 1, srcH - 1);
-        float yFrac = srcY - y0;
-
-        for (int x = 0; x < dstW; x++)
+        catch (const std::bad_alloc &)
         {
-            float srcX = x * xRatio;
-            int x0 = static_cast<int>(srcX);
-            int x1 = std::min(x0 + 1, srcW - 1);
-            float xFrac = srcX - x0;
+            std::cerr << "Failed to allocate " << (rowBytes * cubemapHeight / 1024 / 1024) << " MB for cubemap"
+                      << '\n';
+        }
 
-            for (int c = 0; c < channels; c++)
+        if (!cubemapData.empty())
+        {
+            for (int gridY = 0; gridY < cubemapHeight; gridY++)
             {
-                // Bilinear interpolation
-                float v00 = src[(y0 * srcW + x0) * channels + c];
-                float v10 = src[(y0 * srcW + x1) * channels + c];
-                float v01 = src[(y1 * srcW + x0) * channels + c];
-                float v11 = src[(y1 * srcW + x1) * channels + c];
-
-                float v0 = v00 * (1 - xFrac) + v10 * xFrac;
-                float v1 = v01 * (1 - xFrac) + v11 * xFrac;
-                float value = v0 * (1 - yFrac) + v1 * yFrac;
-
-                dst[(y * dstW + x) * channels + c] = static_cast<unsigned char>(std::clamp(value, 0.0f, 255.0f));
+                convertEquirectangularToCubemapGridRowUChar(equirect.data(),
+                                                            equirectWidth,
+                                                            equirectHeight,
+                                                            CHANNELS,
+                                                            faceSize,
+                                                            gridY,
+                                                            &cubemapData[static_cast<size_t>(gridY) * rowBytes]);
             }
+            success = stbi_write_jpg(tempOutputPath.c_str(),
+                                     cubemapWidth,
+                                     cubemapHeight,
+                                     CHANNELS,
+                                     cubemapData.data(),
+                                     95) != 0;
         }
     }
+
+    equirect.close();
+    std::filesystem::remove(equirectPath);
+
+    // =========================================================================
+    // Step 3: Publish the finished image
+    // =========================================================================
+    if (!success)
+    {
+        std::error_code ec;
+        std::filesystem::remove(tempOutputPath, ec);
+        return false;
+    }
+    return AssetManifest::commit(tempOutputPath,
+                                 outputPath,
+                                 monthRecipe(month, sourcePath, outWidth, outHeight, lossless));
 }
@@ -1,12 +1,17 @@
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
 #include "../../helpers/cubemap-conversion.h"
+#include "../../helpers/parallel-rows.h"
 #include "../earth-material.h"
 
-
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -20,6 +25,315 @@
 // caused by cloud cover and atmospheric Mie scattering.
 // Uses max-blend to fill gaps and averaging to reduce noise/banding.
 // Source images are assumed to be in equirectangular projection.
+// Images are decoded one at a time and folded into a per-pixel histogram for the
+// median composite, so memory stays flat as more scenes are added.
+
+namespace
+{
+constexpr int OUTPUT_VERSION = 2; // Bump when the nightlights texture changes (see AssetManifest)
+
+// Local window size for background estimation (in pixels)
+// Larger = better cloud rejection but may miss small towns
+constexpr int WINDOW_RADIUS = 15;
+
+// Threshold: how much brighter than local background to be considered a light
+constexpr float LOCAL_CONTRAST_THRESHOLD = 0.08f; // 8% above local background
+
+// Minimum absolute brightness to be considered (rejects dim noise)
+constexpr float MIN_ABSOLUTE_BRIGHTNESS = 0.05f;
+
+// Cross-track correction: horizontal gradient window, seam threshold and vignette extent
+constexpr int GRADIENT_RADIUS = 5;      // Look 5 pixels left/right for gradient
+constexpr float SEAM_THRESHOLD = 0.015f; // Gradient threshold for seam detection
+constexpr int VIGNETTE_RADIUS = 40;      // How far the darkening extends from seam
+
+// Light values below this count as "no light" in the composite
+constexpr float NON_ZERO_THRESHOLD = 0.001f;
+
+// The composite keeps a small histogram of light values per pixel instead of every
+// processed image: MEDIAN_BINS 8-bit counters, so its size does not grow with the
+// number of scenes (up to 255 scenes per bin)
+constexpr int MEDIAN_BINS = 16;
+
+// Nearest-neighbor source coordinate of every working-resolution coordinate
+std::vector<int> nearestSourceIndices(int workSize, int sourceSize)
+{
+    std::vector<int> indices(workSize, 0);
+    for (int i = 0; i < workSize && workSize > 1; i++)
+    {
+        float sourceF = static_cast<float>(i) / (workSize - 1) * (sourceSize - 1);
+        indices[i] = std::min(static_cast<int>(sourceF), sourceSize - 1);
+    }
+    return indices;
+}
+
+// ============================================================================
+// Helper function: Extract lights from one source image into the composite
+// ============================================================================
+// Runs the per-image VIIRS-style passes (cross-track correction, local background,
+// local contrast) in parallel row bands and adds every non-zero light to the per-pixel
+// histogram. Nothing image-sized is allocated: grayscale rows are resampled from the
+// decoded source on demand and the box blur slides over a ring of blurred rows.
+// - data, width, height, channels: Decoded source image
+// - histogram: MEDIAN_BINS counters per working-resolution pixel
+void extractLights(const unsigned char *data,
+                   int width,
+                   int height,
+                   int channels,
+                   int workWidth,
+                   int workHeight,
+                   std::vector<uint8_t> &histogram)
+{
+    const std::vector<int> sourceX = nearestSourceIndices(workWidth, width);
+    const std::vector<int> sourceY = nearestSourceIndices(workHeight, height);
+
+    // Grayscale row y at working resolution, optionally scaled per column
+    auto grayRow = [&](int y, float *row, const float *columnScale) {
+        const unsigned char *sourceRow = data + static_cast<size_t>(sourceY[y]) * width * channels;
+        for (int x = 0; x < workWidth; x++)
+        {
+            const unsigned char *pixel = sourceRow + static_cast<size_t>(sourceX[x]) * channels;
+            float lum;
+            if (channels >= 3)
+            {
+                float r = pixel[0] / 255.0f;
+                float g = pixel[1] / 255.0f;
+                float b = pixel[2] / 255.0f;
+                lum = 0.299f * r + 0.587f * g + 0.114f * b;
+            }
+            else
+            {
+                lum = pixel[0] / 255.0f;
+            }
+            row[x] = columnScale ? lum * columnScale[x] : lum;
+        }
+    };
+
+    // =====================================================================
+    // STEP 0: Cross-track Mie scattering correction (swath edge vignette)
+    // =====================================================================
+    // VIIRS scans in swaths as satellite orbits pole-to-pole
+    // At swath edges, viewing angle is oblique → more atmospheric path
+    // This causes Mie scattering artifacts (brighter edges)
+    //
+    // We detect swath boundaries by looking for sudden vertical brightness
+    // changes, then apply a vignette (darkening) near those edges
+
+    std::cout << "    Applying cross-track correction..." << '\n';
+
+    // Horizontal gradient (difference between the left and right neighborhoods) detects
+    // vertical seams (swath edges): swaths run roughly N-S, so edges appear as vertical
+    // brightness changes. Columns with consistently high gradient are seams, so only the
+    // per-column mean is kept. Each band sums its rows; bands are added in row order.
+    std::map<int, std::vector<double>> bandGradientSums;
+    std::mutex bandGradientMutex;
+    ParallelRows::forEachRowBand(workHeight, 64, true, [&](int rowBegin, int rowEnd) {
+        std::vector<float> row(workWidth);
+        std::vector<double> prefix(workWidth + 1, 0.0);
+        std::vector<double> sums(workWidth, 0.0);
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            grayRow(y, row.data(), nullptr);
+            for (int x = 0; x < workWidth; x++)
+            {
+                prefix[x + 1] = prefix[x] + row[x];
+            }
+            for (int x = GRADIENT_RADIUS; x < workWidth - GRADIENT_RADIUS; x++)
+            {
+                double leftAvg = (prefix[x] - prefix[x - GRADIENT_RADIUS]) / GRADIENT_RADIUS;
+                double rightAvg = (prefix[x + GRADIENT_RADIUS + 1] - prefix[x + 1]) / GRADIENT_RADIUS;
+                sums[x] += std::abs(rightAvg - leftAvg);
+            }
+        }
+        std::lock_guard<std::mutex> lock(bandGradientMutex);
+        bandGradientSums[rowBegin] = std::move(sums);
+    });
+
+    std::vector<float> columnGradient(workWidth, 0.0f);
+    for (int x = 0; x < workWidth; x++)
+    {
+        double sum = 0.0;
+        for (const auto &band : bandGradientSums)
+        {
+            sum += band.second[x];
+        }
+        columnGradient[x] = static_cast<float>(sum / workHeight);
+    }
+
+    // Find peaks in column gradient (swath boundaries)
+    // Apply gentle vignette around detected edges to suppress scatter
+    std::vector<float> vignetteMap(workWidth, 1.0f); // 1.0 = no darkening
+
+    for (int x = 0; x < workWidth; x++)
+    {
+        // Check if this column is near a seam
+        float nearestSeamDistance = static_cast<float>(workWidth); // Far away
+
+        // Look for seams within vignette radius
+        for (int sx = std::max(0, x - VIGNETTE_RADIUS); sx < std::min(workWidth, x + VIGNETTE_RADIUS); sx++)
+        {
+            if (columnGradient[sx] > SEAM_THRESHOLD)
+            {
+                float dist = static_cast<float>(std::abs(x - sx));
+                nearestSeamDistance = std::min(nearestSeamDistance, dist);
+            }
+        }
+
+        // Apply gentle vignette based on distance to nearest seam
+        // Only suppress (not erase) - preserve city lights at edges
+        if (nearestSeamDistance < VIGNETTE_RADIUS)
+        {
+            // Smooth falloff: mild darkening at seam, none at vignette edge
+            float t = nearestSeamDistance / VIGNETTE_RADIUS;
+            // Cosine falloff for smooth transition
+            // 0.65 at seam (35% reduction) → 1.0 at edge (no effect)
+            float darken = 0.65f + 0.35f * (0.5f - 0.5f * std::cos(t * 3.14159f));
+            vignetteMap[x] = darken;
+        }
+    }
+
+    // NOTE: Removed periodic swath vignette - it assumed fixed swath positions
+    // but satellite passes occur at different times, so swaths shift between
+    // images. The gradient-based vignette above detects actual edges per-image.
+
+    ParallelRows::forEachRowBand(workHeight, 64, true, [&](int rowBegin, int rowEnd) {
+        // =====================================================================
+        // STEP 1: Compute local background using box blur (approximates median)
+        // =====================================================================
+        // This estimates the "background" level around each pixel
+        // Clouds create elevated backgrounds; clear sky is dark
+        //
+        // Separable box blur: each row is blurred horizontally into a ring of the rows
+        // the vertical window needs, and per-column sums slide down over that ring.
+        // Windows are clipped at the image edges (averaged over the pixels inside).
+        const int ringRows = 2 * WINDOW_RADIUS + 2;
+        std::vector<float> ring(static_cast<size_t>(ringRows) * workWidth);
+        std::vector<float> gray(workWidth);
+        std::vector<double> columnSums(workWidth, 0.0);
+
+        // Horizontal pass of row y into its ring slot
+        auto blurRow = [&](int y) {
+            grayRow(y, gray.data(), vignetteMap.data());
+            float *blurred = ring.data() + static_cast<size_t>(y % ringRows) * workWidth;
+
+            double sum = 0.0;
+            int count = 0;
+            for (int x = 0; x <= WINDOW_RADIUS && x < workWidth; x++)
+            {
+                sum += gray[x];
+                count++;
+            }
+            for (int x = 0; x < workWidth; x++)
+            {
+                blurred[x] = static_cast<float>(sum / count);
+
+                // Slide window
+                int removeX = x - WINDOW_RADIUS;
+                int addX = x + WINDOW_RADIUS + 1;
+                if (removeX >= 0)
+                {
+                    sum -= gray[removeX];
+                    count--;
+                }
+                if (addX < workWidth)
+                {
+                    sum += gray[addX];
+                    count++;
+                }
+            }
+            return blurred;
+        };
+        auto addToColumns = [&](const float *blurred, double sign) {
+            for (int x = 0; x < workWidth; x++)
+            {
+                columnSums[x] += sign * blurred[x];
+            }
+        };
+
+        // Vertical window of the first row
+        int windowRows = 0;
+        for (int y = std::max(0, rowBegin - WINDOW_RADIUS); y <= rowBegin + WINDOW_RADIUS && y < workHeight; y++)
+        {
+            addToColumns(blurRow(y), 1.0);
+            windowRows++;
+        }
+
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            // =================================================================
+            // STEP 2: Extract lights using local contrast
+            // =================================================================
+            // A pixel is a "light" if it's significantly brighter than its local
+            // background This naturally rejects clouds (which raise the whole local
+            // area)
+            grayRow(y, gray.data(), vignetteMap.data());
+            uint8_t *rowHistogram = histogram.data() + static_cast<size_t>(y) * workWidth * MEDIAN_BINS;
+            for (int x = 0; x < workWidth; x++)
+            {
+                float pixel = gray[x];
+                float bg = static_cast<float>(columnSums[x] / windowRows);
+
+                // Local contrast: how much brighter is this pixel vs background?
+                float contrast = pixel - bg;
+
+                // Must exceed local background by threshold AND meet minimum brightness
+                if (contrast <= LOCAL_CONTRAST_THRESHOLD || pixel <= MIN_ABSOLUTE_BRIGHTNESS)
+                {
+                    continue;
+                }
+
+                // Normalize the excess brightness
+                // Brighter lights get higher values
+                float intensity = (contrast - LOCAL_CONTRAST_THRESHOLD) / (1.0f - LOCAL_CONTRAST_THRESHOLD);
+                intensity = std::max(0.0f, std::min(1.0f, intensity));
+
+                // Apply gamma to boost dim lights
+                float light = std::pow(intensity, 0.5f);
+                if (light > NON_ZERO_THRESHOLD)
+                {
+                    int bin = std::min(MEDIAN_BINS - 1, static_cast<int>(light * MEDIAN_BINS));
+                    uint8_t &count = rowHistogram[x * MEDIAN_BINS + bin];
+                    if (count < 255)
+                    {
+                        count++;
+                    }
+                }
+            }
+
+            // Slide the vertical window down one row
+            int removeY = y - WINDOW_RADIUS;
+            int addY = y + WINDOW_RADIUS + 1;
+            if (removeY >= 0)
+            {
+                addToColumns(ring.data() + static_cast<size_t>(removeY % ringRows) * workWidth, -1.0);
+                windowRows--;
+            }
+            if (addY < workHeight && y + 1 < rowEnd)
+            {
+                addToColumns(blurRow(addY), 1.0);
+                windowRows++;
+            }
+        }
+    });
+}
+
+// Value of the rank-th smallest sample (0-based) of a pixel histogram, assuming the
+// samples of a bin are spread evenly across it
+float histogramRankValue(const uint8_t *bins, int rank)
+{
+    int below = 0;
+    for (int bin = 0; bin < MEDIAN_BINS; bin++)
+    {
+        if (rank < below + bins[bin])
+        {
+            float withinBin = (rank - below + 0.5f) / bins[bin];
+            return (bin + withinBin) / MEDIAN_BINS;
+        }
+        below += bins[bin];
+    }
+    return 1.0f;
+}
+} // namespace
 
 bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
                                           const std::string &outputBasePath,
@@ -42,15 +356,7 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
     std::filesystem::create_directories(outputPath);
     std::string outFile = outputPath + "/earth_nightlights.png";
 
-    // Check if already processed
-    if (std::filesystem::exists(outFile))
-    {
-        std::cout << "Nightlights texture already exists: " << outFile << '\n';
-        std::cout << "==============================" << '\n';
-        return true;
-    }
-
-    // Collect all image files
+    // Collect all image files (sorted, so the composite and its recipe do not depend on directory order)
     std::vector<std::string> sourceFiles;
     for (const auto &entry : std::filesystem::directory_iterator(sourcePath))
     {
@@ -60,9 +366,29 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
         if (ext == ".jpg" || ext == ".jpeg" || ext == ".png")
         {
             sourceFiles.push_back(std::filesystem::absolute(entry.path()).string());
-            std::cout << "Found: " << entry.path().filename().string() << '\n';
         }
     }
+    std::sort(sourceFiles.begin(), sourceFiles.end());
+
+    // Output size follows the sources; the landmass mask decides which pixels are ocean
+    std::string landmaskPath = outputPath + "/earth_landmass_mask.png";
+    AssetManifest::Recipe recipe;
+    recipe.sources = sourceFiles;
+    recipe.sources.push_back(landmaskPath);
+    recipe.version = OUTPUT_VERSION;
+
+    // Check if already processed
+    if (AssetManifest::isCurrent(outFile, recipe))
+    {
+        std::cout << "Nightlights texture is up to date: " << outFile << '\n';
+        std::cout << "==============================" << '\n';
+        return true;
+    }
+
+    for (const std::string &file : sourceFiles)
+    {
+        std::cout << "Found: " << std::filesystem::path(file).filename().string() << '\n';
+    }
 
     if (sourceFiles.empty())
     {
@@ -99,7 +425,7 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
         int w, h, channels;
         if (stbi_info(sourceFile.c_str(), &w, &h, &channels))
         {
-            if (w * h > workWidth * workHeight)
+            if (static_cast<int64_t>(w) * h > static_cast<int64_t>(workWidth) * workHeight)
             {
                 workWidth = w;
                 workHeight = h;
@@ -114,20 +440,13 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
         return false;
     }
 
+    const size_t workPixels = static_cast<size_t>(workWidth) * workHeight;
     std::cout << "Working resolution: " << workWidth << "x" << workHeight << '\n';
 
-    // Store all processed images for median compositing
-    std::vector<std::vector<float>> processedImages;
-
-    // Local window size for background estimation (in pixels)
-    // Larger = better cloud rejection but may miss small towns
-    const int WINDOW_RADIUS = 15;
-
-    // Threshold: how much brighter than local background to be considered a light
-    const float LOCAL_CONTRAST_THRESHOLD = 0.08f; // 8% above local background
-
-    // Minimum absolute brightness to be considered (rejects dim noise)
-    const float MIN_ABSOLUTE_BRIGHTNESS = 0.05f;
+    // Per-pixel histogram of light values for median compositing; only one decoded source
+    // image is resident at a time, so memory does not grow with the number of scenes
+    std::vector<uint8_t> histogram(workPixels * MEDIAN_BINS, 0);
+    std::cout << "Median histogram: " << (histogram.size() / (1024 * 1024)) << " MB" << '\n';
 
     int imagesProcessed = 0;
 
@@ -145,247 +464,9 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
             continue;
         }
 
-        // Convert to grayscale at working resolution
-        std::vector<float> gray(workWidth * workHeight);
-
-        for (int y = 0; y < workHeight; y++)
-        {
-            for (int x = 0; x < workWidth; x++)
-            {
-                float srcXf = static_cast<float>(x) / (workWidth - 1) * (w - 1);
-                float srcYf = static_cast<float>(y) / (workHeight - 1) * (h - 1);
-
-                int sx = std::min(static_cast<int>(srcXf), w - 1);
-                int sy = std::min(static_cast<int>(srcYf), h - 1);
-                int srcIdx = sy * w + sx;
-
-                float lum;
-                if (channels >= 3)
-                {
-                    float r = data[srcIdx * channels + 0] / 255.0f;
-                    float g = data[srcIdx * channels + 1] / 255.0f;
-                    float b = data[srcIdx * channels + 2] / 255.0f;
-                    lum = 0.299f * r + 0.587f * g + 0.114f * b;
-                }
-                else
-                {
-                    lum = data[srcIdx * channels] / 255.0f;
-                }
-
-                gray[y * workWidth + x] = lum;
-            }
-        }
-
+        extractLights(data, w, h, channels, workWidth, workHeight, histogram);
         stbi_image_free(data);
 
-        // =====================================================================
-        // STEP 0: Cross-track Mie scattering correction (swath edge vignette)
-        // =====================================================================
-        // VIIRS scans in swaths as satellite orbits pole-to-pole
-        // At swath edges, viewing angle is oblique → more atmospheric path
-        // This causes Mie scattering artifacts (brighter edges)
-        //
-        // We detect swath boundaries by looking for sudden vertical brightness
-        // changes, then apply a vignette (darkening) near those edges
-
-        std::cout << "    Applying cross-track correction..." << '\n';
-
-        // Compute horizontal gradient to detect vertical seams (swath edges)
-        // Swaths run roughly N-S, so edges appear as vertical brightness changes
-        std::vector<float> hGradient(workWidth * workHeight, 0.0f);
-
-        const int GRADIENT_RADIUS = 5; // Look 5 pixels left/right for gradient
-
-        for (int y = 0; y < workHeight; y++)
-        {
-            for (int x = GRADIENT_RADIUS; x < workWidth - GRADIENT_RADIUS; x++)
-            {
-                // Compute difference between left and right neighborhoods
-                float leftSum = 0.0f, rightSum = 0.0f;
-                for (int dx = 1; dx <= GRADIENT_RADIUS; dx++)
-                {
-                    leftSum += gray[y * workWidth + (x - dx)];
-                    rightSum += gray[y * workWidth + (x + dx)];
-                }
-                float leftAvg = leftSum / GRADIENT_RADIUS;
-                float rightAvg = rightSum / GRADIENT_RADIUS;
-
-                // Gradient magnitude (absolute difference)
-                hGradient[y * workWidth + x] = std::abs(rightAvg - leftAvg);
-            }
-        }
-
-        // Find swath edges: columns with consistently high gradient (vertical
-        // lines) Sum gradient vertically to find "seam" columns
-        std::vector<float> columnGradient(workWidth, 0.0f);
-        for (int x = 0; x < workWidth; x++)
-        {
-            float sum = 0.0f;
-            for (int y = 0; y < workHeight; y++)
-            {
-                sum += hGradient[y * workWidth + x];
-            }
-            columnGradient[x] = sum / workHeight;
-        }
-
-        // Find peaks in column gradient (swath boundaries)
-        // Apply gentle vignette around detected edges to suppress scatter
-        const float SEAM_THRESHOLD = 0.015f; // Gradient threshold for seam detection
-        const int VIGNETTE_RADIUS = 40;      // How far the darkening extends from seam
-
-        std::vector<float> vignetteMap(workWidth, 1.0f); // 1.0 = no darkening
-
-        for (int x = 0; x < workWidth; x++)
-        {
-            // Check if this column is near a seam
-            float nearestSeamDistance = static_cast<float>(workWidth); // Far away
-
-            // Look for seams within vignette radius
-            for (int sx = std::max(0, x - VIGNETTE_RADIUS); sx < std::min(workWidth, x + VIGNETTE_RADIUS); sx++)
-            {
-                if (columnGradient[sx] > SEAM_THRESHOLD)
-                {
-                    float dist = static_cast<float>(std::abs(x - sx));
-                    nearestSeamDistance = std::min(nearestSeamDistance, dist);
-                }
-            }
-
-            // Apply gentle vignette based on distance to nearest seam
-            // Only suppress (not erase) - preserve city lights at edges
-            if (nearestSeamDistance < VIGNETTE_RADIUS)
-            {
-                // Smooth falloff: mild darkening at seam, none at vignette edge
-                float t = nearestSeamDistance / VIGNETTE_RADIUS;
-                // Cosine falloff for smooth transition
-                // 0.65 at seam (35% reduction) → 1.0 at edge (no effect)
-                float darken = 0.65f + 0.35f * (0.5f - 0.5f * std::cos(t * 3.14159f));
-                vignetteMap[x] = darken;
-            }
-        }
-
-        // Apply vignette to the grayscale image
-        for (int y = 0; y < workHeight; y++)
-        {
-            for (int x = 0; x < workWidth; x++)
-            {
-                gray[y * workWidth + x] *= vignetteMap[x];
-            }
-        }
-
-        // NOTE: Removed periodic swath vignette - it assumed fixed swath positions
-        // but satellite passes occur at different times, so swaths shift between
-        // images. The gradient-based vignette above detects actual edges per-image.
-
-        // =====================================================================
-        // STEP 1: Compute local background using box blur (approximates median)
-        // =====================================================================
-        // This estimates the "background" level around each pixel
-        // Clouds create elevated backgrounds; clear sky is dark
-
-        std::vector<float> background(workWidth * workHeight, 0.0f);
-
-        // Horizontal pass of box blur
-        std::vector<float> tempBlur(workWidth * workHeight, 0.0f);
-        for (int y = 0; y < workHeight; y++)
-        {
-            float sum = 0.0f;
-            int count = 0;
-
-            // Initialize window
-            for (int x = 0; x <= WINDOW_RADIUS && x < workWidth; x++)
-            {
-                sum += gray[y * workWidth + x];
-                count++;
-            }
-
-            for (int x = 0; x < workWidth; x++)
-            {
-                tempBlur[y * workWidth + x] = sum / count;
-
-                // Slide window
-                int removeX = x - WINDOW_RADIUS;
-                int addX = x + WINDOW_RADIUS + 1;
-
-                if (removeX >= 0)
-                {
-                    sum -= gray[y * workWidth + removeX];
-                    count--;
-                }
-                if (addX < workWidth)
-                {
-                    sum += gray[y * workWidth + addX];
-                    count++;
-                }
-            }
-        }
-
-        // Vertical pass of box blur
-        for (int x = 0; x < workWidth; x++)
-        {
-            float sum = 0.0f;
-            int count = 0;
-
-            for (int y = 0; y <= WINDOW_RADIUS && y < workHeight; y++)
-            {
-                sum += tempBlur[y * workWidth + x];
-                count++;
-            }
-
-            for (int y = 0; y < workHeight; y++)
-            {
-                background[y * workWidth + x] = sum / count;
-
-                int removeY = y - WINDOW_RADIUS;
-                int addY = y + WINDOW_RADIUS + 1;
-
-                if (removeY >= 0)
-                {
-                    sum -= tempBlur[removeY * workWidth + x];
-                    count--;
-                }
-                if (addY < workHeight)
-                {
-                    sum += tempBlur[addY * workWidth + x];
-                    count++;
-                }
-            }
-        }
-
-        // =====================================================================
-        // STEP 2: Extract lights using local contrast
-        // =====================================================================
-        // A pixel is a "light" if it's significantly brighter than its local
-        // background This naturally rejects clouds (which raise the whole local
-        // area)
-
-        std::vector<float> lights(workWidth * workHeight, 0.0f);
-
-        for (int i = 0; i < workWidth * workHeight; i++)
-        {
-            float pixel = gray[i];
-            float bg = background[i];
-
-            // Local contrast: how much brighter is this pixel vs background?
-            float contrast = pixel - bg;
-
-            // Must exceed local background by threshold AND meet minimum brightness
-            if (contrast > LOCAL_CONTRAST_THRESHOLD && pixel > MIN_ABSOLUTE_BRIGHTNESS)
-            {
-                // Normalize the excess brightness
-                // Brighter lights get higher values
-                float intensity = (contrast - LOCAL_CONTRAST_THRESHOLD) / (1.0f - LOCAL_CONTRAST_THRESHOLD);
-                intensity = std::max(0.0f, std::min(1.0f, intensity));
-
-                // Apply gamma to boost dim lights
-                lights[i] = std::pow(intensity, 0.5f);
-            }
-            else
-            {
-                lights[i] = 0.0f;
-            }
-        }
-
-        processedImages.push_back(std::move(lights));
         imagesProcessed++;
         std::cout << "    Extracted lights (" << imagesProcessed << "/" << sourceFiles.size() << ")" << '\n';
     }
@@ -408,7 +489,8 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
     // 1. Count how many images have non-zero data for each pixel
     // 2. Require pixel to appear in at least (n-1) images (allow 1 gap for
     // clouds)
-    // 3. For qualifying pixels, use median of non-zero values
+    // 3. For qualifying pixels, use median of non-zero values (estimated from the
+    // per-pixel histogram: bins span 16 of the 256 output levels)
 
     std::cout << "Creating consistency-filtered composite from " << imagesProcessed << " images..." << '\n';
 
@@ -419,86 +501,55 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
     // For 4 images: require at least 2 (allows 2 gaps)
     // For 5 images: require at least 3 (allows 2 gaps)
     // For 6 images: require at least 3 (allows 3 gaps)
-    size_t minOccurrences = std::max(size_t(1), static_cast<size_t>(std::floor(imagesProcessed * 0.5 + 0.5)));
+    int minOccurrences = std::max(1, static_cast<int>(std::floor(imagesProcessed * 0.5 + 0.5)));
     std::cout << "  Requiring data in at least " << minOccurrences << " of " << imagesProcessed << " images (~50%)"
               << '\n';
 
-    std::vector<float> combined(workWidth * workHeight, 0.0f);
-    std::vector<float> nonZeroValues;
-    nonZeroValues.reserve(processedImages.size());
-
-    size_t keptPixels = 0;
-    size_t rejectedPixels = 0;
-
-    for (int i = 0; i < workWidth * workHeight; i++)
-    {
-        nonZeroValues.clear();
-
-        // Collect only non-zero values and count occurrences
-        for (const auto &img : processedImages)
-        {
-            if (img[i] > 0.001f)
-            { // Non-zero threshold
-                nonZeroValues.push_back(img[i]);
-            }
-        }
+    std::cout << "Preparing equirectangular buffer (" << workWidth << "x" << workHeight << ")..." << '\n';
 
-        size_t occurrences = nonZeroValues.size();
+    std::vector<unsigned char> equirect(workPixels, 0);
+    std::atomic<size_t> keptPixels{0};
+    std::atomic<size_t> rejectedPixels{0};
 
-        // Only keep pixel if it appears in enough images
-        if (occurrences >= minOccurrences)
+    ParallelRows::forEachRowBand(workHeight, 64, true, [&](int rowBegin, int rowEnd) {
+        size_t kept = 0;
+        size_t rejected = 0;
+        for (size_t i = static_cast<size_t>(rowBegin) * workWidth; i < static_cast<size_t>(rowEnd) * workWidth; i++)
         {
-            // Sort non-zero values to find median
-            std::sort(nonZeroValues.begin(), nonZeroValues.end());
-
-            // Use median of non-zero values
-            size_t n = nonZeroValues.size();
-            float median;
-            if (n == 1)
+            const uint8_t *bins = histogram.data() + i * MEDIAN_BINS;
+            int occurrences = 0;
+            for (int bin = 0; bin < MEDIAN_BINS; bin++)
             {
-                median = nonZeroValues[0];
+                occurrences += bins[bin];
             }
-            else if (n % 2 == 0)
+
+            // Only keep pixel if it appears in enough images
+            if (occurrences >= minOccurrences)
             {
-                median = (nonZeroValues[n / 2 - 1] + nonZeroValues[n / 2]) / 2.0f;
+                // Median of non-zero values (mean of the two middle ones for an even count)
+                float median =
+                    (histogramRankValue(bins, (occurrences - 1) / 2) + histogramRankValue(bins, occurrences / 2)) /
+                    2.0f;
+                equirect[i] = static_cast<unsigned char>(median * 255.0f);
+                kept++;
             }
-            else
+            else if (occurrences > 0)
             {
-                median = nonZeroValues[n / 2];
+                // Pixel doesn't appear consistently - reject it
+                rejected++;
             }
-
-            combined[i] = median;
-            keptPixels++;
-        }
-        else
-        {
-            // Pixel doesn't appear consistently - reject it
-            combined[i] = 0.0f;
-            if (occurrences > 0)
-                rejectedPixels++;
         }
-    }
+        keptPixels += kept;
+        rejectedPixels += rejected;
+    });
 
-    processedImages.clear(); // Free memory
+    histogram.clear();
+    histogram.shrink_to_fit(); // Free memory
 
-    std::cout << "  Kept " << keptPixels << " consistent pixels" << '\n';
-    std::cout << "  Rejected " << rejectedPixels << " inconsistent pixels (edge artifacts)" << '\n';
+    std::cout << "  Kept " << keptPixels.load() << " consistent pixels" << '\n';
+    std::cout << "  Rejected " << rejectedPixels.load() << " inconsistent pixels (edge artifacts)" << '\n';
     std::cout << "Consistency-filtered composite complete" << '\n';
 
-    // Get output dimensions
-    int outWidth, outHeight;
-    getResolutionDimensions(resolution, outWidth, outHeight);
-
-    std::cout << "Preparing equirectangular buffer (" << workWidth << "x" << workHeight << ")..." << '\n';
-
-    // Convert combined float data to unsigned char equirectangular
-    std::vector<unsigned char> equirect(workWidth * workHeight, 0);
-    for (int i = 0; i < workWidth * workHeight; i++)
-    {
-        equirect[i] = static_cast<unsigned char>(combined[i] * 255.0f);
-    }
-    combined.clear(); // Free float data
-
     // =========================================================================
     // STEP 4: Apply landmass mask to filter ocean artifacts
     // =========================================================================
@@ -507,7 +558,6 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
     std::cout << "Applying landmass mask from Blue Marble color..." << '\n';
 
     // Generate landmass mask if it doesn't exist
-    std::string landmaskPath = outputPath + "/earth_landmass_mask.png";
     if (!std::filesystem::exists(landmaskPath))
     {
         if (!preprocessLandmassMask(defaultsPath, outputBasePath, resolution))
@@ -602,10 +652,13 @@ bool EarthMaterial::preprocessNightlights(const std::string &defaultsPath,
     int cubemapWidth, cubemapHeight;
     getCubemapStripDimensions(faceSize, cubemapWidth, cubemapHeight);
 
-    // Save cubemap as grayscale PNG
+    // Save cubemap as grayscale PNG (under a temporary name until it is complete)
     std::cout << "Saving cubemap: " << outFile << " (" << cubemapWidth << "x" << cubemapHeight << ")" << '\n';
-    if (!stbi_write_png(outFile.c_str(), cubemapWidth, cubemapHeight, 1, cubemapData, cubemapWidth))
+    std::string tempFile = AssetManifest::temporaryPath(outFile);
+    if (!stbi_write_png(tempFile.c_str(), cubemapWidth, cubemapHeight, 1, cubemapData, cubemapWidth) ||
+        !AssetManifest::commit(tempFile, outFile, recipe))
     {
+        std::filesystem::remove(tempFile);
         std::cerr << "ERROR: Failed to save nightlights texture" << '\n';
         delete[] cubemapData;
         std::cout << "==============================" << '\n';
@@ -1,14 +1,21 @@
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
 #include "../../helpers/cubemap-conversion.h"
+#include "../../helpers/parallel-rows.h"
 #include "../earth-material.h"
 
-
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <stb_image.h>
@@ -16,11 +23,160 @@
 
 #include <tiffio.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NORMALS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NORMALS_NEON 1
+#include <arm_neon.h>
+#endif
+
 // ============================================================================
 // Elevation Data Processing (Heightmap and Normal Map Generation)
 // ============================================================================
 
-float *EarthMaterial::loadGeoTiffElevation(const std::string &filepath, int &width, int &height)
+namespace
+{
+constexpr int OUTPUT_VERSION = 2; // Bump when the elevation textures change (see AssetManifest)
+
+// Source samples outside this range (meters) are NODATA (ETOPO marks them with -99999 / -32768)
+constexpr float VALID_ELEVATION_MIN = -12000.0f;
+constexpr float VALID_ELEVATION_MAX = 10000.0f;
+
+// Stripped files are read in bands of at least this many rows, so bands rarely share an output row
+constexpr uint32_t MIN_BAND_ROWS = 64;
+
+// Strips larger than this are not decoded whole: they are read scanline by scanline on a single thread
+constexpr size_t MAX_STRIP_BYTES = 256ull * 1024 * 1024;
+
+// Converts count samples, starting at sample index first and taking every stride-th one, to float
+using SampleConverter = void (*)(const void *buffer, size_t first, uint32_t count, uint32_t stride, float *out);
+
+template <typename T>
+void convertSamples(const void *buffer, size_t first, uint32_t count, uint32_t stride, float *out)
+{
+    const T *samples = static_cast<const T *>(buffer) + first;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        out[i] = static_cast<float>(samples[static_cast<size_t>(i) * stride]);
+    }
+}
+
+SampleConverter sampleConverter(uint16_t bitsPerSample, uint16_t sampleFormat)
+{
+    switch (bitsPerSample)
+    {
+    case 8:
+        return sampleFormat == SAMPLEFORMAT_INT ? convertSamples<int8_t> : convertSamples<uint8_t>;
+    case 16:
+        return sampleFormat == SAMPLEFORMAT_INT ? convertSamples<int16_t> : convertSamples<uint16_t>;
+    case 32:
+        if (sampleFormat == SAMPLEFORMAT_IEEEFP)
+        {
+            return convertSamples<float>;
+        }
+        return sampleFormat == SAMPLEFORMAT_INT ? convertSamples<int32_t> : convertSamples<uint32_t>;
+    case 64:
+        return sampleFormat == SAMPLEFORMAT_IEEEFP ? convertSamples<double> : nullptr;
+    default:
+        return nullptr;
+    }
+}
+
+// Valid source samples that fell into one output cell
+struct CellAccumulator
+{
+    double sum = 0.0;
+    uint32_t count = 0;
+    float minimum = std::numeric_limits<float>::max();
+    float maximum = std::numeric_limits<float>::lowest();
+
+    void add(float value)
+    {
+        sum += value;
+        count++;
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+    }
+
+    void merge(const CellAccumulator &other)
+    {
+        sum += other.sum;
+        count += other.count;
+        minimum = std::min(minimum, other.minimum);
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    float resolve(EarthMaterial::ElevationAggregate aggregate) const
+    {
+        if (count == 0)
+        {
+            return EarthMaterial::NODATA_ELEVATION;
+        }
+        switch (aggregate)
+        {
+        case EarthMaterial::ElevationAggregate::Minimum:
+            return minimum;
+        case EarthMaterial::ElevationAggregate::Maximum:
+            return maximum;
+        default:
+            return static_cast<float>(sum / count);
+        }
+    }
+};
+
+// Output row (or column) of each source row (or column): the cell containing the sample's center
+// Every output cell receives at least one source sample as long as outputSize <= sourceSize
+std::vector<int> cellOfSample(uint32_t sourceSize, int outputSize)
+{
+    std::vector<int> cells(sourceSize);
+    for (uint32_t i = 0; i < sourceSize; i++)
+    {
+        double center = (static_cast<double>(i) + 0.5) * outputSize / sourceSize;
+        cells[i] = std::min(static_cast<int>(center), outputSize - 1);
+    }
+    return cells;
+}
+
+// libtiff's warning handler is process-wide and several stages can load GeoTIFFs at once,
+// so the first silencer saves the handler and the last one restores it, under a lock
+std::mutex tiffWarningMutex;
+int tiffWarningSilencers = 0;
+TIFFErrorHandler savedTiffWarningHandler = nullptr;
+
+// Silences libtiff warnings while alive
+struct TiffWarningSilencer
+{
+    TiffWarningSilencer()
+    {
+        std::lock_guard<std::mutex> lock(tiffWarningMutex);
+        if (tiffWarningSilencers++ == 0)
+        {
+            savedTiffWarningHandler = TIFFSetWarningHandler(nullptr);
+        }
+    }
+
+    ~TiffWarningSilencer()
+    {
+        std::lock_guard<std::mutex> lock(tiffWarningMutex);
+        if (--tiffWarningSilencers == 0)
+        {
+            TIFFSetWarningHandler(savedTiffWarningHandler);
+        }
+    }
+
+    TiffWarningSilencer(const TiffWarningSilencer &) = delete;
+    TiffWarningSilencer &operator=(const TiffWarningSilencer &) = delete;
+};
+} // namespace
+
+float *EarthMaterial::loadGeoTiffElevation(const std::string &filepath,
+                                           int maxWidth,
+                                           int maxHeight,
+                                           ElevationAggregate aggregate,
+                                           int &width,
+                                           int &height,
+                                           ElevationRange *range)
 {
     std::cout << "Opening GeoTIFF: " << filepath << '\n';
 
@@ -34,39 +190,77 @@ float *EarthMaterial::loadGeoTiffElevation(const std::string &filepath, int &wid
 
     std::cout << "  GeoTIFF opened successfully" << '\n';
 
-    uint32_t w, h;
+    uint32_t w = 0, h = 0;
     TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
     TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
 
-    width = static_cast<int>(w);
-    height = static_cast<int>(h);
-
     // Get bits per sample and sample format
     uint16_t bitsPerSample = 8;
     uint16_t sampleFormat = SAMPLEFORMAT_UINT;
     uint16_t samplesPerPixel = 1;
+    uint16_t planarConfig = PLANARCONFIG_CONTIG;
 
     TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
     TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
     TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
 
-    // Check if tiled
-    uint32_t tileWidth = 0, tileHeight = 0;
+    // Tiles are read whole; strips are grouped into bands of at least MIN_BAND_ROWS rows
+    uint32_t tileWidth = 0, tileHeight = 0, rowsPerStrip = 0;
     int isTiled = TIFFIsTiled(tif);
     if (isTiled)
     {
         TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tileWidth);
         TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileHeight);
     }
+    else
+    {
+        TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+        rowsPerStrip = std::clamp(rowsPerStrip, 1u, std::max(h, 1u));
+    }
 
-    std::cout << "  GeoTIFF: " << width << "x" << height << ", " << bitsPerSample << " bits, " << samplesPerPixel
+    std::cout << "  GeoTIFF: " << w << "x" << h << ", " << bitsPerSample << " bits, " << samplesPerPixel
               << " samples"
               << (isTiled ? ", TILED (" + std::to_string(tileWidth) + "x" + std::to_string(tileHeight) + ")"
-                          : ", SCANLINE")
+                          : ", STRIPS (" + std::to_string(rowsPerStrip) + " rows)")
               << '\n';
 
-    // Allocate output buffer
-    float *elevation = new (std::nothrow) float[static_cast<size_t>(width) * height];
+    // Only the first sample of each pixel is elevation; separate planes keep it in plane 0
+    const uint32_t sampleStride = planarConfig == PLANARCONFIG_SEPARATE ? 1 : std::max<uint16_t>(samplesPerPixel, 1);
+    const SampleConverter convert = sampleConverter(bitsPerSample, sampleFormat);
+    const bool scanlineOnly = !isTiled && static_cast<size_t>(TIFFStripSize(tif)) > MAX_STRIP_BYTES;
+    if (!convert || w == 0 || h == 0 || (isTiled && (tileWidth == 0 || tileHeight == 0)))
+    {
+        std::cerr << "ERROR: Unsupported GeoTIFF layout (" << bitsPerSample << "-bit samples, format " << sampleFormat
+                  << ")" << '\n';
+        TIFFClose(tif);
+        return nullptr;
+    }
+
+    // Output grid: the requested size, but never finer than the source
+    width = std::min(maxWidth, static_cast<int>(w));
+    height = std::min(maxHeight, static_cast<int>(h));
+    if (width <= 0 || height <= 0)
+    {
+        std::cerr << "ERROR: Invalid elevation output size " << maxWidth << "x" << maxHeight << '\n';
+        TIFFClose(tif);
+        return nullptr;
+    }
+    const int outWidth = width;
+    const int outHeight = height;
+
+    const std::vector<int> cellColumn = cellOfSample(w, outWidth);
+    const std::vector<int> cellRow = cellOfSample(h, outHeight);
+
+    // Source rows [rowBegin[r], rowEnd[r]) all land in output row r
+    std::vector<uint32_t> rowBegin(outHeight, h), rowEnd(outHeight, 0);
+    for (uint32_t y = 0; y < h; y++)
+    {
+        rowBegin[cellRow[y]] = std::min(rowBegin[cellRow[y]], y);
+        rowEnd[cellRow[y]] = std::max(rowEnd[cellRow[y]], y + 1);
+    }
+
+    float *elevation = new (std::nothrow) float[static_cast<size_t>(outWidth) * outHeight];
     if (!elevation)
     {
         std::cerr << "Failed to allocate elevation buffer" << '\n';
@@ -74,198 +268,274 @@ float *EarthMaterial::loadGeoTiffElevation(const std::string &filepath, int &wid
         return nullptr;
     }
 
-    // Initialize to zero
-    std::fill(elevation, elevation + static_cast<size_t>(width) * height, 0.0f);
+    // Bands of whole tile rows (or strips) are the unit of work
+    uint32_t bandRows = tileHeight;
+    if (!isTiled)
+    {
+        bandRows = scanlineOnly ? MIN_BAND_ROWS : (MIN_BAND_ROWS + rowsPerStrip - 1) / rowsPerStrip * rowsPerStrip;
+    }
+    const int bandCount = static_cast<int>((h + bandRows - 1) / bandRows);
+
+    // Scanline access must be sequential, so oversized strips are read by one thread through one handle
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4; // Fallback
+    numThreads = scanlineOnly ? 1u : std::min(numThreads, static_cast<unsigned int>(bandCount));
+
+    std::cout << "  Decimating to " << outWidth << "x" << outHeight << " ("
+              << (aggregate == ElevationAggregate::Mean      ? "mean"
+                  : aggregate == ElevationAggregate::Minimum ? "minimum"
+                                                             : "maximum")
+              << ") from " << bandCount << " bands using " << numThreads << " threads..." << '\n';
+    std::cout.flush();
 
-    if (isTiled)
+    // Output rows split between two bands are completed here by whichever band finishes last
+    struct PendingRow
     {
-        // Read tiled image
-        tsize_t tileSize = TIFFTileSize(tif);
-        void *tileBuffer = _TIFFmalloc(tileSize);
-        if (!tileBuffer)
+        std::vector<CellAccumulator> cells;
+        uint32_t rowsSeen = 0;
+    };
+    std::map<int, PendingRow> pendingRows;
+    std::mutex pendingMutex;
+
+    std::atomic<int> nextBand{0};
+    std::atomic<int> bandsDone{0};
+    std::atomic<bool> failed{false};
+    std::mutex coutMutex;
+    int lastPercent = -1;
+
+    float lowest = std::numeric_limits<float>::max();
+    float highest = std::numeric_limits<float>::lowest();
+    size_t validSamples = 0;
+
+    auto worker = [&](TIFF *handle) {
+        tsize_t blockSize = isTiled ? TIFFTileSize(handle) : TIFFStripSize(handle);
+        if (scanlineOnly)
         {
-            std::cerr << "Failed to allocate tile buffer" << '\n';
-            delete[] elevation;
-            TIFFClose(tif);
-            return nullptr;
+            blockSize = TIFFScanlineSize(handle);
         }
-
-        int tilesX = (width + tileWidth - 1) / tileWidth;
-        int tilesY = (height + tileHeight - 1) / tileHeight;
-        int totalTiles = tilesX * tilesY;
-        int tilesRead = 0;
-
-        std::cout << "  Reading " << totalTiles << " tiles..." << '\n';
-        std::cout.flush();
-
-        for (uint32_t ty = 0; ty < static_cast<uint32_t>(height); ty += tileHeight)
+        void *block = _TIFFmalloc(blockSize);
+        std::vector<float> values(isTiled ? tileWidth : w);
+        std::vector<CellAccumulator> band;
+        float threadLowest = std::numeric_limits<float>::max();
+        float threadHighest = std::numeric_limits<float>::lowest();
+        size_t threadValid = 0;
+
+        if (!block)
         {
-            for (uint32_t tx = 0; tx < static_cast<uint32_t>(width); tx += tileWidth)
-            {
-                if (TIFFReadTile(tif, tileBuffer, tx, ty, 0, 0) < 0)
-                {
-                    std::cerr << "Failed to read tile at (" << tx << ", " << ty << ")" << '\n';
-                    _TIFFfree(tileBuffer);
-                    delete[] elevation;
-                    TIFFClose(tif);
-                    return nullptr;
-                }
+            std::cerr << "Failed to allocate GeoTIFF read buffer" << '\n';
+            failed = true;
+        }
 
-                // Copy tile data to elevation buffer
-                uint32_t copyWidth = std::min(tileWidth, w - tx);
-                uint32_t copyHeight = std::min(tileHeight, h - ty);
+        while (!failed)
+        {
+            int bandIndex = nextBand.fetch_add(1);
+            if (bandIndex >= bandCount)
+                break;
 
-                for (uint32_t py = 0; py < copyHeight; py++)
+            const uint32_t y0 = static_cast<uint32_t>(bandIndex) * bandRows;
+            const uint32_t y1 = std::min(y0 + bandRows, h);
+            const int firstRow = cellRow[y0];
+            const int lastRow = cellRow[y1 - 1];
+            band.assign(static_cast<size_t>(lastRow - firstRow + 1) * outWidth, CellAccumulator());
+
+            // Reduce count converted samples of source row y, starting at source column x0, into the band
+            auto accumulate = [&](uint32_t y, uint32_t x0, uint32_t count) {
+                CellAccumulator *cells = band.data() + static_cast<size_t>(cellRow[y] - firstRow) * outWidth;
+                const int *columns = cellColumn.data() + x0;
+                for (uint32_t i = 0; i < count; i++)
                 {
-                    for (uint32_t px = 0; px < copyWidth; px++)
+                    float value = values[i];
+                    if (value >= VALID_ELEVATION_MIN && value <= VALID_ELEVATION_MAX)
                     {
-                        uint32_t tileIdx = py * tileWidth + px;
-                        uint32_t imgX = tx + px;
-                        uint32_t imgY = ty + py;
-                        uint32_t imgIdx = imgY * width + imgX;
-
-                        float value = 0.0f;
-
-                        if (bitsPerSample == 32)
-                        {
-                            if (sampleFormat == SAMPLEFORMAT_IEEEFP)
-                            {
-                                float *ptr = reinterpret_cast<float *>(tileBuffer);
-                                value = ptr[tileIdx];
-                            }
-                            else if (sampleFormat == SAMPLEFORMAT_INT)
-                            {
-                                int32_t *ptr = reinterpret_cast<int32_t *>(tileBuffer);
-                                value = static_cast<float>(ptr[tileIdx]);
-                            }
-                            else
-                            {
-                                uint32_t *ptr = reinterpret_cast<uint32_t *>(tileBuffer);
-                                value = static_cast<float>(ptr[tileIdx]);
-                            }
-                        }
-                        else if (bitsPerSample == 16)
-                        {
-                            if (sampleFormat == SAMPLEFORMAT_INT)
-                            {
-                                int16_t *ptr = reinterpret_cast<int16_t *>(tileBuffer);
-                                value = static_cast<float>(ptr[tileIdx]);
-                            }
-                            else
-                            {
-                                uint16_t *ptr = reinterpret_cast<uint16_t *>(tileBuffer);
-                                value = static_cast<float>(ptr[tileIdx]);
-                            }
-                        }
-                        else if (bitsPerSample == 8)
-                        {
-                            uint8_t *ptr = reinterpret_cast<uint8_t *>(tileBuffer);
-                            value = static_cast<float>(ptr[tileIdx]);
-                        }
-
-                        elevation[imgIdx] = value;
+                        cells[columns[i]].add(value);
+                        threadLowest = std::min(threadLowest, value);
+                        threadHighest = std::max(threadHighest, value);
+                        threadValid++;
                     }
                 }
+            };
 
-                tilesRead++;
-                if (tilesRead % 100 == 0)
+            bool ok = true;
+            if (isTiled)
+            {
+                for (uint32_t tx = 0; tx < w && ok; tx += tileWidth)
                 {
-                    std::cout << "\r  Reading tiles: " << tilesRead << "/" << totalTiles << " ("
-                              << (tilesRead * 100 / totalTiles) << "%)" << std::flush;
+                    if (TIFFReadTile(handle, block, tx, y0, 0, 0) < 0)
+                    {
+                        std::cerr << "Failed to read tile at (" << tx << ", " << y0 << ")" << '\n';
+                        ok = false;
+                        break;
+                    }
+                    const uint32_t copyWidth = std::min(tileWidth, w - tx);
+                    for (uint32_t py = 0; py < y1 - y0; py++)
+                    {
+                        convert(block,
+                                static_cast<size_t>(py) * tileWidth * sampleStride,
+                                copyWidth,
+                                sampleStride,
+                                values.data());
+                        accumulate(y0 + py, tx, copyWidth);
+                    }
                 }
             }
-        }
-
-        std::cout << "\r  Reading tiles: " << totalTiles << "/" << totalTiles << " (100%)" << '\n';
-        _TIFFfree(tileBuffer);
-    }
-    else
-    {
-        // Read scanline-based image
-        tsize_t scanlineSize = TIFFScanlineSize(tif);
-        void *scanlineBuffer = _TIFFmalloc(scanlineSize);
-        if (!scanlineBuffer)
-        {
-            std::cerr << "Failed to allocate scanline buffer" << '\n';
-            delete[] elevation;
-            TIFFClose(tif);
-            return nullptr;
-        }
-
-        std::cout << "  Reading " << height << " scanlines..." << '\n';
-
-        for (int y = 0; y < height; y++)
-        {
-            if (TIFFReadScanline(tif, scanlineBuffer, y, 0) < 0)
+            else if (scanlineOnly)
             {
-                std::cerr << "Failed to read scanline " << y << '\n';
-                _TIFFfree(scanlineBuffer);
-                delete[] elevation;
-                TIFFClose(tif);
-                return nullptr;
-            }
-
-            for (int x = 0; x < width; x++)
-            {
-                float value = 0.0f;
-
-                if (bitsPerSample == 32)
+                for (uint32_t y = y0; y < y1 && ok; y++)
                 {
-                    if (sampleFormat == SAMPLEFORMAT_IEEEFP)
+                    if (TIFFReadScanline(handle, block, y, 0) < 0)
                     {
-                        float *ptr = reinterpret_cast<float *>(scanlineBuffer);
-                        value = ptr[x];
+                        std::cerr << "Failed to read scanline " << y << '\n';
+                        ok = false;
+                        break;
                     }
-                    else if (sampleFormat == SAMPLEFORMAT_INT)
+                    convert(block, 0, w, sampleStride, values.data());
+                    accumulate(y, 0, w);
+                }
+            }
+            else
+            {
+                for (uint32_t sy = y0; sy < y1 && ok; sy += rowsPerStrip)
+                {
+                    if (TIFFReadEncodedStrip(handle, TIFFComputeStrip(handle, sy, 0), block, -1) < 0)
                     {
-                        int32_t *ptr = reinterpret_cast<int32_t *>(scanlineBuffer);
-                        value = static_cast<float>(ptr[x]);
+                        std::cerr << "Failed to read strip at row " << sy << '\n';
+                        ok = false;
+                        break;
                     }
-                    else
+                    const uint32_t stripRows = std::min(rowsPerStrip, y1 - sy);
+                    for (uint32_t py = 0; py < stripRows; py++)
                     {
-                        uint32_t *ptr = reinterpret_cast<uint32_t *>(scanlineBuffer);
-                        value = static_cast<float>(ptr[x]);
+                        convert(block, static_cast<size_t>(py) * w * sampleStride, w, sampleStride, values.data());
+                        accumulate(sy + py, 0, w);
                     }
                 }
-                else if (bitsPerSample == 16)
+            }
+            if (!ok)
+            {
+                failed = true;
+                break;
+            }
+
+            // Rows entirely inside the band are final; rows shared with a neighbouring band are merged
+            for (int row = firstRow; row <= lastRow; row++)
+            {
+                const CellAccumulator *cells = band.data() + static_cast<size_t>(row - firstRow) * outWidth;
+                float *out = elevation + static_cast<size_t>(row) * outWidth;
+                if (rowBegin[row] >= y0 && rowEnd[row] <= y1)
                 {
-                    if (sampleFormat == SAMPLEFORMAT_INT)
+                    for (int x = 0; x < outWidth; x++)
                     {
-                        int16_t *ptr = reinterpret_cast<int16_t *>(scanlineBuffer);
-                        value = static_cast<float>(ptr[x]);
+                        out[x] = cells[x].resolve(aggregate);
                     }
-                    else
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                PendingRow &pending = pendingRows[row];
+                if (pending.cells.empty())
+                {
+                    pending.cells.assign(cells, cells + outWidth);
+                }
+                else
+                {
+                    for (int x = 0; x < outWidth; x++)
                     {
-                        uint16_t *ptr = reinterpret_cast<uint16_t *>(scanlineBuffer);
-                        value = static_cast<float>(ptr[x]);
+                        pending.cells[x].merge(cells[x]);
                     }
                 }
-                else if (bitsPerSample == 8)
+                pending.rowsSeen += std::min(rowEnd[row], y1) - std::max(rowBegin[row], y0);
+                if (pending.rowsSeen == rowEnd[row] - rowBegin[row])
                 {
-                    uint8_t *ptr = reinterpret_cast<uint8_t *>(scanlineBuffer);
-                    value = static_cast<float>(ptr[x]);
+                    for (int x = 0; x < outWidth; x++)
+                    {
+                        out[x] = pending.cells[x].resolve(aggregate);
+                    }
+                    pendingRows.erase(row);
                 }
-
-                elevation[y * width + x] = value;
             }
 
-            if (y % 1000 == 0)
+            int done = ++bandsDone;
+            int percent = done * 100 / bandCount;
+            std::lock_guard<std::mutex> lock(coutMutex);
+            if (percent != lastPercent)
             {
-                std::cout << "\r  Reading scanlines: " << y << "/" << height << " (" << (y * 100 / height) << "%)"
-                          << std::flush;
+                lastPercent = percent;
+                std::cout << "\r  Reading bands: " << done << "/" << bandCount << " (" << percent << "%)" << std::flush;
             }
         }
 
-        std::cout << "\r  Reading scanlines: " << height << "/" << height << " (100%)" << '\n';
-        _TIFFfree(scanlineBuffer);
-    }
+        if (block)
+        {
+            _TIFFfree(block);
+        }
+        std::lock_guard<std::mutex> lock(coutMutex);
+        lowest = std::min(lowest, threadLowest);
+        highest = std::max(highest, threadHighest);
+        validSamples += threadValid;
+    };
 
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Every worker decodes through its own handle; the extra handles would repeat the
+    // unknown-GeoTIFF-tag warnings the first one already printed
+    {
+        TiffWarningSilencer silencer;
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+        for (unsigned int i = 1; i < numThreads; i++)
+        {
+            threads.emplace_back([&]() {
+                TIFF *handle = TIFFOpen(filepath.c_str(), "r");
+                if (!handle)
+                {
+                    std::cerr << "ERROR: Failed to reopen GeoTIFF: " << filepath << '\n';
+                    failed = true;
+                    return;
+                }
+                worker(handle);
+                TIFFClose(handle);
+            });
+        }
+        worker(tif);
+
+        // Wait for all threads to complete
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
     TIFFClose(tif);
-    std::cout << "  GeoTIFF loaded successfully" << '\n';
+
+    if (failed)
+    {
+        std::cout << '\n';
+        delete[] elevation;
+        return nullptr;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+
+    if (validSamples == 0)
+    {
+        lowest = highest = 0.0f;
+    }
+    if (range)
+    {
+        range->lowest = lowest;
+        range->highest = highest;
+        range->validSamples = validSamples;
+    }
+
+    std::cout << "\r  Reading bands: " << bandCount << "/" << bandCount << " (100%)" << '\n';
+    std::cout << "  GeoTIFF loaded in " << (duration.count() / 1000.0) << "s: " << validSamples
+              << " valid samples, " << lowest << "m to " << highest << "m" << '\n';
 
     return elevation;
 }
 
+
 // Generate 8-bit heightmap (legacy - kept for normal map generation)
 unsigned char *EarthMaterial::generateHeightmap(const float *elevation,
                                                 int srcWidth,
@@ -447,6 +717,151 @@ float *EarthMaterial::generateHeightmapHDR(const float *elevation,
     return heightmap;
 }
 
+// ============================================================================
+// Normal Map Generation
+// ============================================================================
+// Both projections share one kernel: the heights left, right, above and below each pixel are laid out
+// as rows, and the central-difference gradient, normalization and 8-bit encoding run 4 pixels at a time
+// Scalar and vector paths perform the same sequence of single-precision operations (no fused
+// multiply-add, exact sqrt and division), so the output matches the per-pixel formulation bit for bit
+
+namespace
+{
+// Normal (-dU, -dV, 1) from the neighbour heights, encoded as R=X (east), G=Y (north, flipped to match
+// the shader convention), B=Z (up). nZ = 1 keeps the length >= 1, so no degenerate-length case exists
+inline void encodeNormal(float hL, float hR, float hU, float hD, float uScale, unsigned char *out)
+{
+    float dU = (hR - hL) * 0.5f * uScale;
+    float dV = (hD - hU) * 0.5f;
+
+    float nU = -dU;
+    float nV = -dV;
+    float nZ = 1.0f;
+
+    float len = std::sqrt(nU * nU + nV * nV + nZ * nZ);
+    nU /= len;
+    nV /= len;
+    nZ /= len;
+
+    out[0] = static_cast<unsigned char>((nU * 0.5f + 0.5f) * 255.0f);
+    out[1] = static_cast<unsigned char>((-nV * 0.5f + 0.5f) * 255.0f); // Flip Y
+    out[2] = static_cast<unsigned char>((nZ * 0.5f + 0.5f) * 255.0f);
+}
+
+// encodeNormal for count pixels; out receives count RGB triplets
+void encodeNormalRow(const float *left,
+                     const float *right,
+                     const float *up,
+                     const float *down,
+                     float uScale,
+                     int count,
+                     unsigned char *out)
+{
+    int x = 0;
+#if defined(NORMALS_SSE2)
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale255 = _mm_set1_ps(255.0f);
+    const __m128 scale = _mm_set1_ps(uScale);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    alignas(16) int32_t r[4], g[4], b[4];
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128 dU = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(right + x), _mm_loadu_ps(left + x)), half), scale);
+        __m128 dV = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(down + x), _mm_loadu_ps(up + x)), half);
+
+        __m128 nU = _mm_xor_ps(dU, sign);
+        __m128 nV = _mm_xor_ps(dV, sign);
+
+        __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nU, nU), _mm_mul_ps(nV, nV)), one));
+        nU = _mm_div_ps(nU, len);
+        nV = _mm_div_ps(nV, len);
+        __m128 nZ = _mm_div_ps(one, len);
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(r),
+                        _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(nU, half), half), scale255)));
+        _mm_store_si128(reinterpret_cast<__m128i *>(g),
+                        _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_xor_ps(nV, sign), half), half),
+                                                    scale255)));
+        _mm_store_si128(reinterpret_cast<__m128i *>(b),
+                        _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(nZ, half), half), scale255)));
+        for (int i = 0; i < 4; i++)
+        {
+            out[(x + i) * 3 + 0] = static_cast<unsigned char>(r[i]);
+            out[(x + i) * 3 + 1] = static_cast<unsigned char>(g[i]);
+            out[(x + i) * 3 + 2] = static_cast<unsigned char>(b[i]);
+        }
+    }
+#elif defined(NORMALS_NEON)
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t scale255 = vdupq_n_f32(255.0f);
+    const float32x4_t scale = vdupq_n_f32(uScale);
+    int32_t r[4], g[4], b[4];
+    for (; x + 4 <= count; x += 4)
+    {
+        float32x4_t dU = vmulq_f32(vmulq_f32(vsubq_f32(vld1q_f32(right + x), vld1q_f32(left + x)), half), scale);
+        float32x4_t dV = vmulq_f32(vsubq_f32(vld1q_f32(down + x), vld1q_f32(up + x)), half);
+
+        float32x4_t nU = vnegq_f32(dU);
+        float32x4_t nV = vnegq_f32(dV);
+
+        // Separate multiplies and adds: vmlaq/vfmaq would round differently from the scalar path
+        float32x4_t len = vsqrtq_f32(vaddq_f32(vaddq_f32(vmulq_f32(nU, nU), vmulq_f32(nV, nV)), one));
+        nU = vdivq_f32(nU, len);
+        nV = vdivq_f32(nV, len);
+        float32x4_t nZ = vdivq_f32(one, len);
+
+        vst1q_s32(r, vcvtq_s32_f32(vmulq_f32(vaddq_f32(vmulq_f32(nU, half), half), scale255)));
+        vst1q_s32(g, vcvtq_s32_f32(vmulq_f32(vaddq_f32(vmulq_f32(vnegq_f32(nV), half), half), scale255)));
+        vst1q_s32(b, vcvtq_s32_f32(vmulq_f32(vaddq_f32(vmulq_f32(nZ, half), half), scale255)));
+        for (int i = 0; i < 4; i++)
+        {
+            out[(x + i) * 3 + 0] = static_cast<unsigned char>(r[i]);
+            out[(x + i) * 3 + 1] = static_cast<unsigned char>(g[i]);
+            out[(x + i) * 3 + 2] = static_cast<unsigned char>(b[i]);
+        }
+    }
+#endif
+    for (; x < count; x++)
+    {
+        encodeNormal(left[x], right[x], up[x], down[x], uScale, out + x * 3);
+    }
+}
+
+// Height of each 8-bit level: the same expression the per-sample lookup used, evaluated once
+std::vector<float> heightLevels(float heightScale)
+{
+    std::vector<float> levels(256);
+    for (int i = 0; i < 256; i++)
+    {
+        levels[i] = static_cast<float>(i) / 255.0f * heightScale;
+    }
+    return levels;
+}
+
+// First column in [0, width) for which before(x) is false; before must be true for a prefix of columns
+template <typename Predicate>
+int partitionColumn(int width, Predicate before)
+{
+    int lo = 0;
+    int hi = width;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (before(mid))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+} // namespace
+
 // Generate normal map from equirectangular heightmap (legacy function, kept for compatibility)
 unsigned char *EarthMaterial::generateNormalMap(const unsigned char *heightmap,
                                                 int width,
@@ -461,83 +876,53 @@ unsigned char *EarthMaterial::generateNormalMap(const unsigned char *heightmap,
         return nullptr;
     }
 
-    // Generate normals using Sobel operator
+    const std::vector<float> levels = heightLevels(heightScale);
+
+    // Generate normals from central differences
     // Must account for equirectangular projection: pixels near poles represent
     // much smaller surface areas than at equator (meridians converge at poles)
-
-    for (int y = 0; y < height; y++)
-    {
-        // Calculate latitude for this row
-        // Row 0 = North Pole (90°N), Row height-1 = South Pole (90°S)
-        float latitude =
-            static_cast<float>(PI) / 2.0f - (static_cast<float>(y) / (height - 1)) * static_cast<float>(PI);
-
-        // Scale factor for horizontal gradient to account for meridian convergence
-        // At the poles, cos(lat) approaches 0, so we clamp to prevent extreme
-        // values
-        float cosLat = std::cos(latitude);
-        float latitudeScale = 1.0f / std::max(cosLat, 0.1f); // Clamp to avoid infinity at poles
-
-        for (int x = 0; x < width; x++)
-        {
-            // Sample neighboring heights (with wrapping for longitude, clamping for
-            // latitude)
-            auto getHeight = [&](int px, int py) -> float {
-                // Wrap horizontally (longitude)
-                if (px < 0)
-                    px += width;
-                if (px >= width)
-                    px -= width;
-                // Clamp vertically (latitude)
-                py = std::clamp(py, 0, height - 1);
-                return static_cast<float>(heightmap[py * width + px]) / 255.0f * heightScale;
-            };
-
-            // Sobel operator for gradient
-            float hL = getHeight(x - 1, y);
-            float hR = getHeight(x + 1, y);
-            float hU = getHeight(x, y - 1);
-            float hD = getHeight(x, y + 1);
-
-            // Gradient in X and Y
-            // dX needs to be scaled by latitude because 1 pixel of longitude
-            // represents less surface distance near the poles
-            float dX = (hR - hL) * 0.5f * latitudeScale;
-            float dY = (hD - hU) * 0.5f;
-
-            // Construct normal from gradient
-            // Normal direction is (-df/dx, -df/dy, 1)
-            // In tangent space: +X = east, +Y = north
-            // A north-facing slope has dY < 0, and ny = -dY > 0 (tilts north)
-            // An east-facing slope has dX < 0, and nx = -dX > 0 (tilts east)
-            float nx = -dX; // Negate X for normal direction
-            float ny = -dY; // Negate Y for normal direction
-            float nz = 1.0f;
-
-            // Normalize
-            float len = std::sqrt(nx * nx + ny * ny + nz * nz);
-            if (len > 0.0001f)
-            {
-                nx /= len;
-                ny /= len;
-                nz /= len;
-            }
-            else
+    ParallelRows::forEachRowBand(height, 16, true, [&](int rowBegin, int rowEnd) {
+        // Rows of heights padded with the wrapped column on each side (longitude wraps):
+        // [h(width - 1), h(0) ... h(width - 1), h(0)], so left/right neighbours are plain offsets
+        std::vector<float> above(width + 2), center(width + 2), below(width + 2);
+        auto loadRow = [&](int py, std::vector<float> &row) {
+            // Clamp vertically (latitude)
+            const unsigned char *src = heightmap + static_cast<size_t>(std::clamp(py, 0, height - 1)) * width;
+            for (int x = 0; x < width; x++)
             {
-                nx = 0.0f;
-                ny = 0.0f;
-                nz = 1.0f;
+                row[x + 1] = levels[src[x]];
             }
+            row[0] = row[width];
+            row[width + 1] = row[1];
+        };
 
-            // Convert from [-1,1] to [0,255]
-            // Standard normal map encoding: R=X, G=Y, B=Z
-            // CRITICAL: Flip Y component (north/south direction) to match shader convention
-            int idx = (y * width + x) * 3;
-            normalMap[idx + 0] = static_cast<unsigned char>((nx * 0.5f + 0.5f) * 255.0f);
-            normalMap[idx + 1] = static_cast<unsigned char>((-ny * 0.5f + 0.5f) * 255.0f); // Flip Y
-            normalMap[idx + 2] = static_cast<unsigned char>((nz * 0.5f + 0.5f) * 255.0f);
+        loadRow(rowBegin - 1, above);
+        loadRow(rowBegin, center);
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            loadRow(y + 1, below);
+
+            // Row 0 = North Pole (90°N), Row height-1 = South Pole (90°S)
+            float latitude =
+                static_cast<float>(PI) / 2.0f - (static_cast<float>(y) / (height - 1)) * static_cast<float>(PI);
+
+            // dX is scaled by latitude because 1 pixel of longitude represents less surface distance
+            // near the poles; cos(lat) approaches 0 there, so it is clamped to prevent extreme values
+            float cosLat = std::cos(latitude);
+            float latitudeScale = 1.0f / std::max(cosLat, 0.1f);
+
+            encodeNormalRow(center.data(),
+                            center.data() + 2,
+                            above.data() + 1,
+                            below.data() + 1,
+                            latitudeScale,
+                            width,
+                            normalMap + static_cast<size_t>(y) * width * 3);
+
+            std::swap(above, center);
+            std::swap(center, below);
         }
-    }
+    });
 
     return normalMap;
 }
@@ -552,111 +937,77 @@ void EarthMaterial::generateNormalMapSinusoidal(const unsigned char *heightmapSi
                                                 int height,
                                                 float heightScale)
 {
+    const std::vector<float> levels = heightLevels(heightScale);
+
+    // Per-row constants: the valid columns [validBegin, validEnd) where u = x / (width - 1) lies within
+    // [0.5 - 0.5 * |cos(lat)|, 0.5 + 0.5 * |cos(lat)|], and the U gradient scale
+    // The bounds are found by binary search on the same float comparisons a per-pixel test makes
+    std::vector<int> validBegin(height), validEnd(height);
+    std::vector<float> uScales(height);
     for (int y = 0; y < height; y++)
     {
-        // Calculate latitude for this row in sinusoidal space
         // v = y / (height - 1), lat = (0.5 - v) * π
         float v = static_cast<float>(y) / (height - 1);
         float lat = (0.5f - v) * static_cast<float>(PI);
         float cosLat = std::cos(lat);
 
-        // Valid U range at this latitude
         float uMin = 0.5f - 0.5f * std::abs(cosLat);
         float uMax = 0.5f + 0.5f * std::abs(cosLat);
+        auto u = [width](int x) { return static_cast<float>(x) / (width - 1); };
+        validBegin[y] = partitionColumn(width, [&](int x) { return u(x) < uMin; });
+        validEnd[y] = std::max(validBegin[y], partitionColumn(width, [&](int x) { return !(u(x) > uMax); }));
 
-        for (int x = 0; x < width; x++)
+        // In sinusoidal: x = lon * cos(lat), so 1 pixel in U represents cos(lat) * (2π/width) radians of
+        // longitude: the U gradient is scaled by 1/cos(lat), clamped to avoid infinity at the poles
+        uScales[y] = 1.0f / std::max(std::abs(cosLat), 0.1f);
+    }
+
+    ParallelRows::forEachRowBand(height, 16, true, [&](int rowBegin, int rowEnd) {
+        std::vector<float> hL(width), hR(width), hU(width), hD(width);
+        for (int y = rowBegin; y < rowEnd; y++)
         {
-            float u_sinu = static_cast<float>(x) / (width - 1);
-            int dstIdx = y * width + x;
+            unsigned char *out = normalMapSinu + static_cast<size_t>(y) * width * 3;
+            const int begin = validBegin[y];
+            const int end = validEnd[y];
 
-            // Check if within valid sinusoidal bounds
-            if (u_sinu < uMin || u_sinu > uMax)
+            // Outside valid region - flat normal (X = 0, Y = 0, Z = 1)
+            for (int x = 0; x < width; x++)
             {
-                // Outside valid region - flat normal
-                normalMapSinu[dstIdx * 3 + 0] = 128; // X = 0
-                normalMapSinu[dstIdx * 3 + 1] = 128; // Y = 0
-                normalMapSinu[dstIdx * 3 + 2] = 255; // Z = 1 (up)
-                continue;
+                if (x >= begin && x < end)
+                {
+                    continue;
+                }
+                out[x * 3 + 0] = 128;
+                out[x * 3 + 1] = 128;
+                out[x * 3 + 2] = 255;
             }
 
-            // Sample neighboring heights in sinusoidal space
-            // CRITICAL: Must account for sinusoidal distortion when computing gradients
-            auto getHeight = [&](int px, int py) -> float {
-                // Wrap horizontally (longitude wraps around)
-                if (px < 0)
-                    px += width;
-                if (px >= width)
-                    px -= width;
-                // Clamp vertically (latitude)
-                py = std::clamp(py, 0, height - 1);
-
-                // Check if neighbor is within valid sinusoidal bounds
-                float u_neighbor = static_cast<float>(px) / (width - 1);
-                float v_neighbor = static_cast<float>(py) / (height - 1);
-                float lat_neighbor = (0.5f - v_neighbor) * static_cast<float>(PI);
-                float cosLat_neighbor = std::cos(lat_neighbor);
-                float uMin_neighbor = 0.5f - 0.5f * std::abs(cosLat_neighbor);
-                float uMax_neighbor = 0.5f + 0.5f * std::abs(cosLat_neighbor);
-
-                if (u_neighbor < uMin_neighbor || u_neighbor > uMax_neighbor)
+            // Neighbours wrap horizontally, clamp vertically, and fall back to the pixel's own height
+            // when they lie outside the valid region of their row
+            const unsigned char *row = heightmapSinu + static_cast<size_t>(y) * width;
+            const int yUp = std::max(y - 1, 0);
+            const int yDown = std::min(y + 1, height - 1);
+            auto sample = [&](int px, int py, float fallback) {
+                if (px < validBegin[py] || px >= validEnd[py])
                 {
-                    // Neighbor is outside valid region - use current height
-                    return static_cast<float>(heightmapSinu[dstIdx]) / 255.0f * heightScale;
+                    return fallback;
                 }
-
-                int idx = py * width + px;
-                return static_cast<float>(heightmapSinu[idx]) / 255.0f * heightScale;
+                return levels[heightmapSinu[static_cast<size_t>(py) * width + px]];
             };
-
-            // Sobel operator for gradient
-            float hL = getHeight(x - 1, y);
-            float hR = getHeight(x + 1, y);
-            float hU = getHeight(x, y - 1);
-            float hD = getHeight(x, y + 1);
-
-            // Account for sinusoidal projection distortion
-            // In sinusoidal: x = lon * cos(lat), so dU/dlon = cos(lat)
-            // This means 1 pixel in U represents cos(lat) * (2π/width) radians of longitude
-            // At equator (cos(lat)=1): U is stretched, so gradient needs to be scaled DOWN
-            // At poles (cos(lat)≈0): U is compressed, so gradient needs to be scaled UP
-            // Scale factor: 1/cos(lat) to account for the stretching
-            float uScale = 1.0f / std::max(std::abs(cosLat), 0.1f); // Clamp to avoid infinity at poles
-
-            // Gradient in U and V directions (sinusoidal space)
-            // Treat U and V normally: U = east-west, V = north-south (with sides being poles)
-            float dU = (hR - hL) * 0.5f * uScale;
-            float dV = (hD - hU) * 0.5f;
-
-            // Construct normal from gradient
-            // Normal direction is (-df/dU, -df/dV, 1) in tangent space
-            // In sinusoidal tangent space: +U = east, +V = north (sides are poles)
-            float nU = -dU; // Negate U for normal direction (east-west)
-            float nV = -dV; // Negate V for normal direction (north-south)
-            float nZ = 1.0f;
-
-            // Normalize
-            float len = std::sqrt(nU * nU + nV * nV + nZ * nZ);
-            if (len > 0.0001f)
+            for (int x = begin; x < end; x++)
             {
-                nU /= len;
-                nV /= len;
-                nZ /= len;
-            }
-            else
-            {
-                nU = 0.0f;
-                nV = 0.0f;
-                nZ = 1.0f;
+                const float h = levels[row[x]];
+                const int xLeft = x == 0 ? width - 1 : x - 1;
+                const int xRight = x == width - 1 ? 0 : x + 1;
+                hL[x - begin] = sample(xLeft, y, h);
+                hR[x - begin] = sample(xRight, y, h);
+                hU[x - begin] = sample(x, yUp, h);
+                hD[x - begin] = sample(x, yDown, h);
             }
 
-            // Convert from [-1,1] to [0,255]
-            // Standard normal map encoding: R=X (U/east), G=Y (V/north), B=Z (up)
-            // Flip V component (north/south direction) to match shader convention
-            normalMapSinu[dstIdx * 3 + 0] = static_cast<unsigned char>((nU * 0.5f + 0.5f) * 255.0f);
-            normalMapSinu[dstIdx * 3 + 1] = static_cast<unsigned char>((-nV * 0.5f + 0.5f) * 255.0f); // Flip V
-            normalMapSinu[dstIdx * 3 + 2] = static_cast<unsigned char>((nZ * 0.5f + 0.5f) * 255.0f);
+            encodeNormalRow(hL.data(), hR.data(), hU.data(), hD.data(), uScales[y], end - begin, out + begin * 3);
         }
-    }
+    });
 }
 
 bool EarthMaterial::preprocessElevation(const std::string &defaultsPath,
@@ -706,13 +1057,6 @@ bool EarthMaterial::preprocessElevation(const std::string &defaultsPath,
     std::cout << "Combined HDR heightmap: " << std::filesystem::absolute(combinedHeightmapPath).string() << " (cubemap)" << '\n';
     std::cout << "Normal map: " << std::filesystem::absolute(normalMapPath).string() << " (cubemap)" << '\n';
 
-    if (std::filesystem::exists(combinedHeightmapPath) && std::filesystem::exists(normalMapPath))
-    {
-        std::cout << "Elevation textures already exist, skipping." << '\n';
-        std::cout << "===================================" << '\n';
-        return true;
-    }
-
     // Find the ETOPO GeoTIFF file
     std::string tiffPath;
     std::cout << "Searching for GeoTIFF files..." << '\n';
@@ -747,18 +1091,37 @@ bool EarthMaterial::preprocessElevation(const std::string &defaultsPath,
 
     if (tiffPath.empty())
     {
+        if (std::filesystem::exists(combinedHeightmapPath) && std::filesystem::exists(normalMapPath))
+        {
+            std::cout << "No GeoTIFF source to rebuild from, keeping existing elevation textures." << '\n';
+            std::cout << "===================================" << '\n';
+            return true;
+        }
         std::cout << "No GeoTIFF elevation file found in " << sourcePath << '\n';
         std::cout << "===================================" << '\n';
         return false;
     }
 
+    AssetManifest::Recipe recipe;
+    recipe.sources = {tiffPath};
+    recipe.parameters = std::to_string(outWidth) + "x" + std::to_string(outHeight);
+    recipe.version = OUTPUT_VERSION;
+
+    if (AssetManifest::isCurrent(combinedHeightmapPath, recipe) && AssetManifest::isCurrent(normalMapPath, recipe))
+    {
+        std::cout << "Elevation textures are up to date, skipping." << '\n';
+        std::cout << "===================================" << '\n';
+        return true;
+    }
+
     std::cout << "Loading: " << std::filesystem::path(tiffPath).filename().string() << '\n';
 
     auto startTime = std::chrono::high_resolution_clock::now();
 
-    // Load elevation data
+    // Load elevation data, averaged down to the output resolution while decoding
     int srcWidth, srcHeight;
-    float *elevation = loadGeoTiffElevation(tiffPath, srcWidth, srcHeight);
+    float *elevation =
+        loadGeoTiffElevation(tiffPath, outWidth, outHeight, ElevationAggregate::Mean, srcWidth, srcHeight);
     if (!elevation)
     {
         std::cout << "Failed to load elevation data" << '\n';
@@ -860,8 +1223,11 @@ bool EarthMaterial::preprocessElevation(const std::string &defaultsPath,
             heightmapRGB[i * 3 + 2] = heightmapHDRCubemap[i];
         }
         
-        if (!stbi_write_hdr(combinedHeightmapPath.c_str(), cubemapWidth, cubemapHeight, 3, heightmapRGB))
+        std::string tempHeightmapPath = AssetManifest::temporaryPath(combinedHeightmapPath);
+        if (!stbi_write_hdr(tempHeightmapPath.c_str(), cubemapWidth, cubemapHeight, 3, heightmapRGB) ||
+            !AssetManifest::commit(tempHeightmapPath, combinedHeightmapPath, recipe))
         {
+            std::filesystem::remove(tempHeightmapPath);
             std::cerr << "Failed to save HDR heightmap" << '\n';
             delete[] heightmapRGB;
             delete[] heightmapHDRCubemap;
@@ -878,8 +1244,16 @@ bool EarthMaterial::preprocessElevation(const std::string &defaultsPath,
     if (heightmap8bitCubemap)
     {
         std::cout << "Saving legacy 8-bit heightmap: " << legacyHeightmapPath << '\n';
-        if (!stbi_write_png(legacyHeightmapPath.c_str(), cubemapWidth, cubemapHeight, 1, heightmap8bitCubemap, cubemapWidth))
+        std::string tempLegacyPath = AssetManifest::temporaryPath(legacyHeightmapPath);
+        if (!stbi_write_png(tempLegacyPath.c_str(),
+                            cubemapWidth,
+                            cubemapHeight,
+                            1,
+                            heightmap8bitCubemap,
+                            cubemapWidth) ||
+            !AssetManifest::commit(tempLegacyPath, legacyHeightmapPath, recipe))
         {
+            std::filesystem::remove(tempLegacyPath);
             std::cerr << "  WARNING: Failed to save legacy heightmap" << '\n';
         }
         delete[] heightmap8bitCubemap;
@@ -889,8 +1263,16 @@ bool EarthMaterial::preprocessElevation(const std::string &defaultsPath,
     if (normalMapCubemap)
     {
         std::cout << "Saving normal map cubemap: " << normalMapPath << '\n';
-        if (!stbi_write_png(normalMapPath.c_str(), cubemapWidth, cubemapHeight, 3, normalMapCubemap, cubemapWidth * 3))
+        std::string tempNormalPath = AssetManifest::temporaryPath(normalMapPath);
+        if (!stbi_write_png(tempNormalPath.c_str(),
+                            cubemapWidth,
+                            cubemapHeight,
+                            3,
+                            normalMapCubemap,
+                            cubemapWidth * 3) ||
+            !AssetManifest::commit(tempNormalPath, normalMapPath, recipe))
         {
+            std::filesystem::remove(tempNormalPath);
             std::cerr << "Failed to save normal map" << '\n';
             delete[] normalMapCubemap;
             std::cout << "===================================" << '\n';
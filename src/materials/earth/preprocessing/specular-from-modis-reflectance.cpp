@@ -1,7 +1,10 @@
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
 #include "../../helpers/cubemap-conversion.h"
+#include "../../helpers/resampling.h"
 #include "../earth-material.h"
 
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 #include <iostream>
@@ -11,6 +14,10 @@
 #include <stb_image.h>
 #include <stb_image_write.h>
 
+namespace
+{
+constexpr int OUTPUT_VERSION = 1; // Bump when the specular texture changes (see AssetManifest)
+}
 
 int EarthMaterial::preprocessSpecular(const std::string &defaultsPath,
                                       const std::string &outputBasePath,
@@ -32,20 +39,40 @@ int EarthMaterial::preprocessSpecular(const std::string &defaultsPath,
         return 0;
     }
 
-    // Check if output already exists
+    // Source images: Terra MODIS satellite imagery (JPG/PNG/TIFF), sorted so the recipe is stable
+    std::vector<std::string> sourceFiles;
+    for (const auto &entry : std::filesystem::directory_iterator(sourcePath))
+    {
+        std::string ext = entry.path().extension().string();
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".tif" || ext == ".tiff")
+        {
+            sourceFiles.push_back(entry.path().string());
+        }
+    }
+    std::sort(sourceFiles.begin(), sourceFiles.end());
+
+    // Get output dimensions
+    int outWidth, outHeight;
+    getResolutionDimensions(resolution, outWidth, outHeight);
+
+    // Reuse the output if the sources, landmass mask and resolution are unchanged
     std::filesystem::create_directories(outputPath);
     std::string outFile = outputPath + "/earth_specular.png";
+    std::string landmaskPath = outputPath + "/earth_landmass_mask.png";
+
+    AssetManifest::Recipe recipe;
+    recipe.sources = sourceFiles;
+    recipe.sources.push_back(landmaskPath);
+    recipe.parameters = std::to_string(outWidth) + "x" + std::to_string(outHeight);
+    recipe.version = OUTPUT_VERSION;
 
-    if (std::filesystem::exists(outFile))
+    if (AssetManifest::isCurrent(outFile, recipe))
     {
-        std::cout << "Specular texture already exists: " << outFile << '\n';
+        std::cout << "Specular texture is up to date: " << outFile << '\n';
         std::cout << "===============================" << '\n';
         return 1;
     }
 
-    // Get output dimensions
-    int outWidth, outHeight;
-    getResolutionDimensions(resolution, outWidth, outHeight);
     std::cout << "Output dimensions: " << outWidth << "x" << outHeight << " (will convert to cubemap)" << '\n';
 
     // =========================================================================
@@ -54,7 +81,6 @@ int EarthMaterial::preprocessSpecular(const std::string &defaultsPath,
     // The landmass mask tells us which pixels are land vs ocean
     // We only want specular data for land pixels; ocean will be black
 
-    std::string landmaskPath = outputPath + "/earth_landmass_mask.png";
     std::vector<unsigned char> landmask;
     int maskW = 0, maskH = 0;
 
@@ -77,22 +103,11 @@ int EarthMaterial::preprocessSpecular(const std::string &defaultsPath,
     }
 
     // =========================================================================
-    // Step 2: Find all source files (Terra MODIS satellite imagery)
+    // Step 2: List the source files (Terra MODIS satellite imagery)
     // =========================================================================
-    // Look for JPG/PNG files that contain satellite reflectance data
-
-    std::vector<std::string> sourceFiles;
-    for (const auto &entry : std::filesystem::directory_iterator(sourcePath))
+    for (const std::string &file : sourceFiles)
     {
-        std::string ext = entry.path().extension().string();
-        std::string filename = entry.path().filename().string();
-
-        // Accept common image formats
-        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".tif" || ext == ".tiff")
-        {
-            sourceFiles.push_back(entry.path().string());
-            std::cout << "  Found: " << filename << '\n';
-        }
+        std::cout << "  Found: " << std::filesystem::path(file).filename().string() << '\n';
     }
 
     if (sourceFiles.empty())
@@ -143,9 +158,17 @@ int EarthMaterial::preprocessSpecular(const std::string &defaultsPath,
 
         std::cout << "    Source: " << srcW << "x" << srcH << " (" << srcC << " channels)" << '\n';
 
-        // Resize equirectangular source to working resolution
-        std::vector<unsigned char> resizedData(workWidth * workHeight * srcC);
-        resizeImage(srcData, srcW, srcH, resizedData.data(), workWidth, workHeight, srcC);
+        // Resize equirectangular source to working resolution (area average keeps the green-red
+        // difference unbiased when the reflectance mosaic is reduced)
+        std::vector<unsigned char> resizedData(static_cast<size_t>(workWidth) * workHeight * srcC);
+        Resampling::resize(srcData,
+                           srcW,
+                           srcH,
+                           resizedData.data(),
+                           workWidth,
+                           workHeight,
+                           srcC,
+                           Resampling::Filter::Box);
         stbi_image_free(srcData);
 
         // Extract relative green (green - red, clamped to 0) as float [0, 1]
@@ -309,10 +332,13 @@ int EarthMaterial::preprocessSpecular(const std::string &defaultsPath,
     int cubemapWidth, cubemapHeight;
     getCubemapStripDimensions(faceSize, cubemapWidth, cubemapHeight);
 
-    // Save cubemap PNG
+    // Save cubemap PNG (under a temporary name until it is complete)
     std::cout << "Saving cubemap: " << outFile << " (" << cubemapWidth << "x" << cubemapHeight << ")" << '\n';
-    if (!stbi_write_png(outFile.c_str(), cubemapWidth, cubemapHeight, 1, cubemapData, cubemapWidth))
+    std::string tempFile = AssetManifest::temporaryPath(outFile);
+    if (!stbi_write_png(tempFile.c_str(), cubemapWidth, cubemapHeight, 1, cubemapData, cubemapWidth) ||
+        !AssetManifest::commit(tempFile, outFile, recipe))
     {
+        std::filesystem::remove(tempFile);
         std::cerr << "ERROR: Failed to save specular texture" << '\n';
         delete[] cubemapData;
         std::cout << "===============================" << '\n';
@@ -1,4 +1,5 @@
 #include "../../../concerns/constants.h"
+#include "../../../concerns/helpers/asset-manifest.h"
 #include "../earth-material.h"
 
 #include <algorithm>
@@ -32,6 +33,21 @@ namespace
 constexpr float NO_DATA_VALUE = -9999.0f;
 constexpr float MAX_VALID_WIND = 100.0f;
 constexpr float MAX_WIND_SPEED = 50.0f; // Maximum expected wind speed (m/s) for normalization
+constexpr int JPG_QUALITY = 95;
+constexpr int OUTPUT_VERSION = 1; // Bump when the wind textures change (see AssetManifest)
+
+// A month's wind texture depends on its NetCDF file, the output size and the normalization constants
+AssetManifest::Recipe windRecipe(const std::string &ncFilePath, int outWidth, int outHeight)
+{
+    AssetManifest::Recipe recipe;
+    recipe.sources = {ncFilePath};
+    recipe.parameters = std::to_string(outWidth) + "x" + std::to_string(outHeight) +
+                        " maxWindSpeed=" + std::to_string(MAX_WIND_SPEED) +
+                        " maxValidWind=" + std::to_string(MAX_VALID_WIND) +
+                        " noData=" + std::to_string(NO_DATA_VALUE) + " jpg" + std::to_string(JPG_QUALITY);
+    recipe.version = OUTPUT_VERSION;
+    return recipe;
+}
 
 // Process a single month's wind data
 bool processWindMonth(int month,
@@ -292,9 +308,12 @@ bool processWindMonth(int month,
         jpgData[i * 3 + 2] = 0;                                         // B = 0 (unused)
     }
 
-    // Save as JPG with quality 95 (high quality)
-    if (!stbi_write_jpg(outputFilePath.c_str(), outWidth, outHeight, 3, jpgData.data(), 95))
+    // Save as JPG with quality 95 (high quality), under a temporary name until it is complete
+    std::string tempFilePath = AssetManifest::temporaryPath(outputFilePath);
+    if (!stbi_write_jpg(tempFilePath.c_str(), outWidth, outHeight, 3, jpgData.data(), JPG_QUALITY) ||
+        !AssetManifest::commit(tempFilePath, outputFilePath, windRecipe(ncFilePath, outWidth, outHeight)))
     {
+        std::filesystem::remove(tempFilePath);
         std::cerr << "ERROR: Failed to save wind texture file: " << outputFilePath << "\n";
         return false;
     }
@@ -327,20 +346,18 @@ bool EarthMaterial::preprocessWindData(const std::string &defaultsPath,
         }
     }
 
-    // Check if already processed
-    if (allFilesExist)
-    {
-        std::cout << "Wind textures already exist (12 files)" << "\n";
-        return true;
-    }
-
     std::cout << "=== Wind Data Preprocessing ===" << "\n";
     std::cout << "Source: " << windSourcePath << "\n";
     std::cout << "Output: " << outputPath << " (12 separate JPG files)" << "\n";
 
-    // Find NetCDF files
+    // Find NetCDF files (without them, existing textures are kept as they are)
     if (!std::filesystem::exists(windSourcePath) || !std::filesystem::is_directory(windSourcePath))
     {
+        if (allFilesExist)
+        {
+            std::cout << "Wind textures already exist (12 files, no NetCDF sources to rebuild from)" << "\n";
+            return true;
+        }
         std::cerr << "ERROR: Wind source directory does not exist: " << windSourcePath << "\n";
         return false;
     }
@@ -397,7 +414,8 @@ bool EarthMaterial::preprocessWindData(const std::string &defaultsPath,
         task.month = month;
         task.ncFilePath = ncFiles[monthIdx];
         task.outputFilePath = outputFiles[monthIdx];
-        task.needsProcessing = !std::filesystem::exists(task.outputFilePath);
+        task.needsProcessing =
+            !AssetManifest::isCurrent(task.outputFilePath, windRecipe(task.ncFilePath, outWidth, outHeight));
         if (!task.needsProcessing)
             skippedCount++;
         tasks.push_back(task);
@@ -413,7 +431,7 @@ bool EarthMaterial::preprocessWindData(const std::string &defaultsPath,
 
     if (toProcessCount == 0)
     {
-        std::cout << "All " << skippedCount << " wind textures already exist, nothing to process." << "\n";
+        std::cout << "All " << skippedCount << " wind textures are up to date, nothing to process." << "\n";
         std::cout << "===================================" << "\n";
         return true;
     }
@@ -507,7 +525,7 @@ bool EarthMaterial::preprocessWindData(const std::string &defaultsPath,
     }
     if (skippedCount > 0)
     {
-        std::cout << ", " << skippedCount << " already existed";
+        std::cout << ", " << skippedCount << " up to date";
     }
     std::cout << "\n";
     std::cout << "\n=== Wind Data Preprocessing Complete ===" << "\n";
@@ -129,6 +129,9 @@ bool EarthMaterial::initializeShaders()
 
 void EarthMaterial::cleanup()
 {
+    // Octree chunk meshing tasks may still be running
+    TaskScheduler::shared().wait(chunkMeshTasks_);
+
     for (int i = 0; i < MONTHS_PER_YEAR; i++)
     {
         if (monthlyTextures_[i] != 0)
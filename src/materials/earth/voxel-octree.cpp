@@ -4,31 +4,475 @@
 
 #include "voxel-octree.h"
 #include "../../concerns/constants.h"
+#include "../../concerns/helpers/mapped-file.h"
+#include "../../concerns/helpers/task-scheduler.h"
 #include "helpers/coordinate-conversion.h"
 #include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <mutex>
 #include <string>
-#include <thread>
 #include <unordered_map>
 
 
 namespace EarthVoxelOctree
 {
 
+namespace
+{
+// Center of child `child` (bits x=1 y=2 z=4) of the node centered at `center`
+glm::vec3 childCenterOf(const glm::vec3 &center, float childSize, int child)
+{
+    glm::vec3 offset;
+    offset.x = (child & 1) ? childSize : -childSize;
+    offset.y = (child & 2) ? childSize : -childSize;
+    offset.z = (child & 4) ? childSize : -childSize;
+    return center + offset;
+}
+
+// Distance range from the origin of the cube centered at `center` with half-extent `size`
+void nodeDistanceRange(const glm::vec3 &center, float size, float &minDist, float &maxDist)
+{
+    // Closest point on the cube to the origin
+    glm::vec3 closestPoint;
+    closestPoint.x = glm::clamp(0.0f, center.x - size, center.x + size);
+    closestPoint.y = glm::clamp(0.0f, center.y - size, center.y + size);
+    closestPoint.z = glm::clamp(0.0f, center.z - size, center.z + size);
+    minDist = glm::length(closestPoint);
+
+    // Farthest point on the cube from the origin
+    glm::vec3 farthestPoint;
+    farthestPoint.x = (std::abs(center.x + size) > std::abs(center.x - size)) ? center.x + size : center.x - size;
+    farthestPoint.y = (std::abs(center.y + size) > std::abs(center.y - size)) ? center.y + size : center.y - size;
+    farthestPoint.z = (std::abs(center.z + size) > std::abs(center.z - size)) ? center.z + size : center.z - size;
+    maxDist = glm::length(farthestPoint);
+}
+
+const double PI_D = 3.14159265358979323846;
+
+// First level of PlanetOctree::heightRanges_ (8x8 texel cells): smaller footprints read the heightmap directly
+constexpr int HEIGHT_RANGE_FIRST_LEVEL = 3;
+
+// Voxels per edge of the blocks a brick is voxelized in, each with its own bounds of the surface radius
+constexpr int VOXEL_BLOCK_SIZE = 8;
+
+// Levels between mesh chunk roots and max-depth leaves: a chunk covers up to 8 bricks. Proximity selections are
+// a few dozen bricks, so larger chunks would re-mesh most of the selection whenever its edge moves
+constexpr int MESH_CHUNK_LEVELS = 1;
+
+// Bits first..last (clamped to 0..31) of a brick row
+uint32_t voxelRangeBits(int first, int last)
+{
+    first = std::max(first, 0);
+    last = std::min(last, BRICK_SIZE - 1);
+    if (first > last)
+    {
+        return 0;
+    }
+    const int width = last - first + 1;
+    return (width >= 32 ? 0xFFFFFFFFu : ((1u << width) - 1u)) << first;
+}
+
+// Margin added around surface radius bounds so that the analytic tests in storeVoxelBits() agree with the
+// float per-voxel test (rounding of voxel positions, lengths and bilinear samples)
+double surfaceRadiusPadding(double radius)
+{
+    return 4e-6 * std::abs(radius) + 1.0;
+}
+
+// Side of the surface a block of voxel centers (distance of its center, reach to its farthest voxel) is on,
+// given bounds of the surface radius: -1 wholly solid, 1 wholly empty, 0 crossed by the surface
+int classifyVoxelBlock(double blockDist, double blockReach, float minRadius, float maxRadius)
+{
+    if (blockDist + blockReach < minRadius - surfaceRadiusPadding(minRadius))
+    {
+        return -1;
+    }
+    if (blockDist - blockReach >= maxRadius + surfaceRadiusPadding(maxRadius))
+    {
+        return 1;
+    }
+    return 0;
+}
+
+// Largest range one scheduler task takes from a parallel loop over `count` items. Aim for about eight ranges
+// per thread so stealing can even out uneven items, but never below `minGrain` items of the loop's work
+size_t parallelGrain(size_t count, size_t minGrain)
+{
+    const size_t ranges = static_cast<size_t>(TaskScheduler::shared().concurrency()) * 8;
+    return std::max(minGrain, count / ranges);
+}
+
+// Convert a heightmap value [0,255] to elevation in meters (monotonic)
+// Heightmap encoding: 128 (0.5) = sea level (0m), 255 (1.0) = Mt. Everest (~8848m)
+float elevationFromHeightValue(float heightValue)
+{
+    float normalizedHeight = heightValue / 255.0f;
+    float elevationMeters = 0.0f;
+    if (normalizedHeight >= 0.5f)
+    {
+        // Above sea level: map 0.5 -> 0m, 1.0 -> 8848m
+        elevationMeters = (normalizedHeight - 0.5f) / 0.5f * 8848.0f;
+    }
+    else
+    {
+        // Below sea level: map 0.0 -> -11000m (deepest trench), 0.5 -> 0m
+        elevationMeters = (normalizedHeight - 0.5f) / 0.5f * 11000.0f;
+    }
+    return elevationMeters;
+}
+
+// ==================================
+// Octree File, Version 2
+// ==================================
+// [FileHeader] [node table] [brick table] [brick data], all little-endian
+// The node table is the node array as is (OctreeNode records, root first, child blocks contiguous), so loading
+// it is one copy. The brick table has one BrickRecord per brick of the pool; uniform bricks (all empty or all
+// solid, most of them) store no data, the others a run-length stream of brick words (see encodeBrick)
+constexpr uint32_t FILE_VERSION = 2;
+
+struct FileHeader
+{
+    uint32_t version;
+    float baseRadius;
+    float maxRadius;
+    int32_t maxDepth; // The first 16 bytes are laid out as in version 1
+    uint32_t nodeCount;
+    uint32_t brickCount;
+    uint32_t nodeRecordSize; // sizeof(OctreeNode)
+    uint32_t reserved;
+    uint64_t nodeTableOffset;
+    uint64_t brickTableOffset;
+    uint64_t brickDataOffset;
+    uint64_t fileSize;
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader is part of the file format");
+static_assert(sizeof(OctreeNode) == 32, "OctreeNode records are part of the file format");
+
+enum BrickEncoding : uint32_t
+{
+    BRICK_EMPTY = 0, // All words 0, no data
+    BRICK_SOLID = 1, // All words 0xFFFFFFFF, no data
+    BRICK_RUNS = 2,  // Run-length stream
+    BRICK_RAW = 3    // BRICK_WORDS words as is
+};
+
+struct BrickRecord
+{
+    uint64_t offset;    // Byte offset of the brick's data within the brick data
+    uint32_t wordCount; // Words of data
+    uint32_t encoding;  // BrickEncoding
+};
+static_assert(sizeof(BrickRecord) == 16, "BrickRecord is part of the file format");
+
+constexpr uint32_t LITERAL_RUN = 0x80000000u;
+
+// Append the encoding of a brick to `stream`, returning its BrickEncoding. The run-length stream is a sequence of
+// tokens: `count` followed by one word repeated count times, or LITERAL_RUN | count followed by count words.
+// Rows of a surface brick are mostly 0 or all ones, so the stream is usually a small fraction of the 4 KB
+uint32_t encodeBrick(const uint32_t *brick, std::vector<uint32_t> &stream)
+{
+    bool empty = true;
+    bool solid = true;
+    for (size_t i = 0; i < BRICK_WORDS; i++)
+    {
+        empty = empty && brick[i] == 0u;
+        solid = solid && brick[i] == 0xFFFFFFFFu;
+    }
+    if (empty || solid)
+    {
+        return empty ? BRICK_EMPTY : BRICK_SOLID;
+    }
+
+    const size_t start = stream.size();
+    size_t i = 0;
+    while (i < BRICK_WORDS)
+    {
+        size_t run = 1;
+        while (i + run < BRICK_WORDS && brick[i + run] == brick[i])
+        {
+            run++;
+        }
+        if (run >= 2)
+        {
+            stream.push_back(static_cast<uint32_t>(run));
+            stream.push_back(brick[i]);
+            i += run;
+            continue;
+        }
+
+        // Literal words up to the start of the next run
+        size_t end = i + 1;
+        while (end < BRICK_WORDS && !(end + 1 < BRICK_WORDS && brick[end] == brick[end + 1]))
+        {
+            end++;
+        }
+        stream.push_back(LITERAL_RUN | static_cast<uint32_t>(end - i));
+        stream.insert(stream.end(), brick + i, brick + end);
+        i = end;
+    }
+
+    if (stream.size() - start >= BRICK_WORDS)
+    {
+        stream.resize(start);
+        stream.insert(stream.end(), brick, brick + BRICK_WORDS);
+        return BRICK_RAW;
+    }
+    return BRICK_RUNS;
+}
+
+// Word `index` of a (possibly unaligned) mapped word array
+uint32_t mappedWord(const uint8_t *words, size_t index)
+{
+    uint32_t word = 0;
+    std::memcpy(&word, words + index * sizeof(uint32_t), sizeof(uint32_t));
+    return word;
+}
+
+// Decode a BRICK_RUNS or BRICK_RAW brick; returns false if the stream does not describe exactly one brick
+bool decodeBrick(const uint8_t *words, size_t wordCount, uint32_t encoding, uint32_t *brick)
+{
+    if (encoding == BRICK_RAW)
+    {
+        if (wordCount != BRICK_WORDS)
+        {
+            return false;
+        }
+        std::memcpy(brick, words, BRICK_WORDS * sizeof(uint32_t));
+        return true;
+    }
+
+    size_t read = 0;
+    size_t written = 0;
+    while (read < wordCount)
+    {
+        const uint32_t token = mappedWord(words, read++);
+        const size_t count = token & ~LITERAL_RUN;
+        const size_t dataWords = (token & LITERAL_RUN) ? count : 1;
+        if (count > BRICK_WORDS - written || dataWords > wordCount - read)
+        {
+            return false;
+        }
+        if (token & LITERAL_RUN)
+        {
+            std::memcpy(brick + written, words + read * sizeof(uint32_t), count * sizeof(uint32_t));
+        }
+        else
+        {
+            std::fill(brick + written, brick + written + count, mappedWord(words, read));
+        }
+        read += dataWords;
+        written += count;
+    }
+    return written == BRICK_WORDS;
+}
+
+// Shared contents of uniform bricks
+const uint32_t *uniformBrick(bool solid)
+{
+    static const std::vector<uint32_t> emptyBrick(BRICK_WORDS, 0u);
+    static const std::vector<uint32_t> solidBrick(BRICK_WORDS, 0xFFFFFFFFu);
+    return solid ? solidBrick.data() : emptyBrick.data();
+}
+
+// Node of a version 1 octree file while it is read. The file lists the nodes depth-first, but the node
+// array keeps every child block contiguous, so the nodes are collected first and laid out afterwards
+struct FileNode
+{
+    OctreeNode node;
+    std::array<uint32_t, 8> children; // Index in the file node list (NO_INDEX if absent)
+};
+
+// Read one node record and its subtree; returns false on a truncated or malformed file
+bool readFileNode(std::istream &in, std::vector<FileNode> &fileNodes, BrickPool &bricks, int level)
+{
+    if (level > MAX_OCTREE_DEPTH)
+    {
+        return false;
+    }
+
+    OctreeNode node(glm::vec3(0.0f), 0.0f, 0, 0u);
+    int depth = 0;
+    in.read(reinterpret_cast<char *>(&node.center), sizeof(glm::vec3));
+    in.read(reinterpret_cast<char *>(&node.size), sizeof(float));
+    in.read(reinterpret_cast<char *>(&depth), sizeof(int));
+    in.read(reinterpret_cast<char *>(&node.isLeaf), sizeof(bool));
+    in.read(reinterpret_cast<char *>(&node.isSolid), sizeof(bool));
+    node.depth = static_cast<uint8_t>(depth);
+
+    // Voxel grid: either no rows or 32 rows of 32 uint32_t (4 KB), read straight into the brick pool
+    size_t gridRows = 0;
+    in.read(reinterpret_cast<char *>(&gridRows), sizeof(size_t));
+    if (!in || (gridRows != 0 && gridRows != static_cast<size_t>(BRICK_SIZE)))
+    {
+        return false;
+    }
+    if (gridRows != 0)
+    {
+        node.brick = bricks.allocate();
+        uint32_t *brick = bricks.brick(node.brick);
+        for (int y = 0; y < BRICK_SIZE; y++)
+        {
+            size_t rowSize = 0;
+            in.read(reinterpret_cast<char *>(&rowSize), sizeof(size_t));
+            if (!in || rowSize != static_cast<size_t>(BRICK_SIZE))
+            {
+                return false;
+            }
+            in.read(reinterpret_cast<char *>(brick + y * BRICK_SIZE), BRICK_SIZE * sizeof(uint32_t));
+        }
+    }
+
+    const size_t index = fileNodes.size();
+    fileNodes.push_back({node, {}});
+    fileNodes[index].children.fill(NO_INDEX);
+
+    // Children follow their existence flags, each as a complete record
+    for (int i = 0; i < 8; i++)
+    {
+        bool childExists = false;
+        in.read(reinterpret_cast<char *>(&childExists), sizeof(bool));
+        if (!in)
+        {
+            return false;
+        }
+        if (childExists)
+        {
+            const uint32_t childIndex = static_cast<uint32_t>(fileNodes.size());
+            if (!readFileNode(in, fileNodes, bricks, level + 1))
+            {
+                return false;
+            }
+            fileNodes[index].children[i] = childIndex;
+        }
+    }
+    return true;
+}
+} // namespace
+
+// ==================================
+// Brick Pool
+// ==================================
+
+BrickPool::BrickPool() = default;
+
+BrickPool::~BrickPool()
+{
+    clear();
+}
+
+BrickPool::BrickPool(BrickPool &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+BrickPool &BrickPool::operator=(BrickPool &&other) noexcept
+{
+    if (this != &other)
+    {
+        clear();
+        words_ = std::move(other.words_);
+        file_ = std::move(other.file_);
+        table_ = other.table_;
+        data_ = other.data_;
+        mappedCount_ = other.mappedCount_;
+        resident_ = std::move(other.resident_);
+        residentBytes_.store(other.residentBytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        other.table_ = nullptr;
+        other.data_ = nullptr;
+        other.mappedCount_ = 0;
+        other.residentBytes_.store(0, std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+void BrickPool::clear()
+{
+    for (size_t i = 0; resident_ && i < mappedCount_; i++)
+    {
+        const uint32_t *words = resident_[i].load(std::memory_order_relaxed);
+        if (words && words != uniformBrick(false) && words != uniformBrick(true))
+        {
+            delete[] words;
+        }
+    }
+    resident_.reset();
+    file_.reset();
+    table_ = nullptr;
+    data_ = nullptr;
+    mappedCount_ = 0;
+    residentBytes_.store(0, std::memory_order_relaxed);
+
+    words_.clear();
+    words_.shrink_to_fit();
+}
+
+void BrickPool::attachFile(std::unique_ptr<MappedFile> file, const uint8_t *table, const uint8_t *data, uint32_t count)
+{
+    clear();
+    file_ = std::move(file);
+    table_ = table;
+    data_ = data;
+    mappedCount_ = count;
+    resident_.reset(new std::atomic<const uint32_t *>[count]);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        resident_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+const uint32_t *BrickPool::loadBrick(uint32_t index) const
+{
+    BrickRecord record;
+    std::memcpy(&record, table_ + static_cast<size_t>(index) * sizeof(BrickRecord), sizeof(BrickRecord));
+    if (record.encoding == BRICK_EMPTY || record.encoding == BRICK_SOLID)
+    {
+        const uint32_t *words = uniformBrick(record.encoding == BRICK_SOLID);
+        resident_[index].store(words, std::memory_order_release);
+        return words;
+    }
+
+    // The records were validated when the file was mapped, so only a changed file fails here
+    std::unique_ptr<uint32_t[]> words(new uint32_t[BRICK_WORDS]);
+    if (!decodeBrick(data_ + record.offset, record.wordCount, record.encoding, words.get()))
+    {
+        std::cerr << "ERROR: Corrupt brick " << index << " in mapped octree file, treating it as empty" << "\n";
+        std::fill(words.get(), words.get() + BRICK_WORDS, 0u);
+    }
+
+    // Threads decoding the same brick at once race to publish it; the losers use the winner's copy
+    const uint32_t *expected = nullptr;
+    if (resident_[index].compare_exchange_strong(expected,
+                                                 words.get(),
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire))
+    {
+        residentBytes_.fetch_add(BRICK_WORDS * sizeof(uint32_t), std::memory_order_relaxed);
+        return words.release();
+    }
+    return expected;
+}
+
 PlanetOctree::PlanetOctree(float baseRadius, float maxRadius, int maxDepth)
     : baseRadius_(baseRadius), maxRadius_(maxRadius), maxDepth_(maxDepth), heightmapData_(nullptr), heightmapWidth_(0),
       heightmapHeight_(0), landmassMask_(nullptr), averageRadius_(baseRadius)
 {
+    if (maxDepth_ > MAX_OCTREE_DEPTH)
+    {
+        std::cerr << "WARNING: PlanetOctree max depth " << maxDepth_ << " clamped to " << MAX_OCTREE_DEPTH << "\n";
+        maxDepth_ = MAX_OCTREE_DEPTH;
+    }
+
     // Create root node centered at origin with size = maxRadius (half-extent)
     // This creates a cubic bounding box from -maxRadius to +maxRadius in each axis
     // The spherical bounding volume (radius = maxRadius) fits inside this cube
     // Base size is 4, max depth is 4, giving us 4^4 = 256 leaf nodes maximum per branch
-    root_ = std::make_unique<OctreeNode>(glm::vec3(0.0f), maxRadius, 0);
+    nodes_.emplace_back(glm::vec3(0.0f), maxRadius, 0, 1u);
 }
 
 PlanetOctree::~PlanetOctree() = default;
@@ -44,12 +488,19 @@ void PlanetOctree::buildFromHeightmap(const unsigned char *heightmapData,
     heightmapHeight_ = heightmapHeight;
     landmassMask_ = landmassMask;
     averageRadius_ = averageRadius;
+    buildHeightRanges();
 
-    // Build octree recursively with parallelization
-    // The root level and first few levels will be built in parallel for speed
+    // Start from a bare root node
+    nodes_.assign(1, OctreeNode(glm::vec3(0.0f), maxRadius_, 0, 1u));
+    bricks_.clear();
+    invalidateMeshChunks();
+
+    // Build octree level by level with parallelization
+    // Every level is classified in parallel, then the next level is appended in key order
     std::cout << "  Building octree in parallel (max depth: " << maxDepth_ << ")..." << "\n";
-    buildOctreeRecursive(root_.get());
-    std::cout << "  Octree build complete." << "\n";
+    buildOctreeLevels();
+    std::cout << "  Octree build complete (" << nodes_.size() << " nodes, " << bricks_.brickCount() << " bricks)."
+              << "\n";
 }
 
 float PlanetOctree::sampleHeightmap(const glm::vec3 &worldPos) const
@@ -127,22 +578,7 @@ float PlanetOctree::sampleHeightmap(const glm::vec3 &worldPos) const
     float heightValue =
         h00 * (1.0f - fx) * (1.0f - fy) + h10 * fx * (1.0f - fy) + h01 * (1.0f - fx) * fy + h11 * fx * fy;
 
-    // Convert heightmap value [0,255] to elevation in meters
-    // Heightmap encoding: 128 (0.5) = sea level (0m), 255 (1.0) = Mt. Everest (~8848m)
-    float normalizedHeight = heightValue / 255.0f;
-    float elevationMeters = 0.0f;
-    if (normalizedHeight >= 0.5f)
-    {
-        // Above sea level: map 0.5 -> 0m, 1.0 -> 8848m
-        elevationMeters = (normalizedHeight - 0.5f) / 0.5f * 8848.0f;
-    }
-    else
-    {
-        // Below sea level: map 0.0 -> -11000m (deepest trench), 0.5 -> 0m
-        elevationMeters = (normalizedHeight - 0.5f) / 0.5f * 11000.0f;
-    }
-
-    return elevationMeters;
+    return elevationFromHeightValue(heightValue);
 }
 
 float PlanetOctree::getSurfaceRadius(const glm::vec3 &worldPos) const
@@ -159,6 +595,175 @@ float PlanetOctree::getSurfaceRadius(const glm::vec3 &worldPos) const
     return averageRadius_ + heightOffsetDisplay;
 }
 
+void PlanetOctree::buildHeightRanges()
+{
+    heightRanges_.clear();
+    if (!heightmapData_ || heightmapWidth_ == 0 || heightmapHeight_ == 0)
+    {
+        return;
+    }
+
+    // Level HEIGHT_RANGE_FIRST_LEVEL straight from the heightmap, every further level from the one below
+    const int cell = 1 << HEIGHT_RANGE_FIRST_LEVEL;
+    HeightRangeLevel first;
+    first.width = (heightmapWidth_ + cell - 1) / cell;
+    first.height = (heightmapHeight_ + cell - 1) / cell;
+    first.minValues.assign(static_cast<size_t>(first.width) * first.height, 255);
+    first.maxValues.assign(static_cast<size_t>(first.width) * first.height, 0);
+    for (int y = 0; y < heightmapHeight_; y++)
+    {
+        const unsigned char *row = heightmapData_ + static_cast<size_t>(y) * heightmapWidth_;
+        uint8_t *minRow = first.minValues.data() + static_cast<size_t>(y / cell) * first.width;
+        uint8_t *maxRow = first.maxValues.data() + static_cast<size_t>(y / cell) * first.width;
+        for (int x = 0; x < heightmapWidth_; x++)
+        {
+            minRow[x / cell] = std::min(minRow[x / cell], row[x]);
+            maxRow[x / cell] = std::max(maxRow[x / cell], row[x]);
+        }
+    }
+    heightRanges_.push_back(std::move(first));
+
+    while (heightRanges_.back().width > 1 || heightRanges_.back().height > 1)
+    {
+        const HeightRangeLevel &below = heightRanges_.back();
+        HeightRangeLevel level;
+        level.width = (below.width + 1) / 2;
+        level.height = (below.height + 1) / 2;
+        level.minValues.assign(static_cast<size_t>(level.width) * level.height, 255);
+        level.maxValues.assign(static_cast<size_t>(level.width) * level.height, 0);
+        for (int y = 0; y < below.height; y++)
+        {
+            for (int x = 0; x < below.width; x++)
+            {
+                const size_t from = static_cast<size_t>(y) * below.width + x;
+                const size_t to = static_cast<size_t>(y / 2) * level.width + x / 2;
+                level.minValues[to] = std::min(level.minValues[to], below.minValues[from]);
+                level.maxValues[to] = std::max(level.maxValues[to], below.maxValues[from]);
+            }
+        }
+        heightRanges_.push_back(std::move(level));
+    }
+}
+
+void PlanetOctree::getSurfaceRadiusBounds(const glm::vec3 &center,
+                                          float halfExtent,
+                                          float &minRadius,
+                                          float &maxRadius) const
+{
+    const float RADIUS_EARTH_M = 6371000.0f; // Same conversion as getSurfaceRadius()
+    const float metersToDisplay = averageRadius_ / RADIUS_EARTH_M;
+    if (heightRanges_.empty())
+    {
+        // No heightmap: the surface is the average sphere
+        minRadius = averageRadius_;
+        maxRadius = averageRadius_;
+        return;
+    }
+
+    // Texel rectangle read by sampleHeightmap() for any direction through the cube. The directions fill a cone
+    // around the center direction; bound its latitude and longitude, then follow the sinusoidal mapping
+    int x0 = 0;
+    int x1 = heightmapWidth_ - 1;
+    int y0 = 0;
+    int y1 = heightmapHeight_ - 1;
+    bool includesCenter = true; // sampleHeightmap() returns sea level right at the planet center
+
+    const double dist = std::sqrt(static_cast<double>(center.x) * center.x + static_cast<double>(center.y) * center.y +
+                                  static_cast<double>(center.z) * center.z);
+    const double reach = halfExtent * 1.7321 + 1.0; // Bounding sphere of the cube, a little oversized
+    if (dist > 2.0 * reach)
+    {
+        includesCenter = false;
+        const double coneAngle = std::asin(reach / dist) + 1e-5;
+        const double latitude = std::asin(std::max(-1.0, std::min(1.0, center.y / dist)));
+        const double longitude = std::atan2(static_cast<double>(center.z), static_cast<double>(center.x));
+        const double latMin = std::max(-PI_D / 2.0, latitude - coneAngle);
+        const double latMax = std::min(PI_D / 2.0, latitude + coneAngle);
+
+        // Longitude half-width of the cone; all longitudes around a pole or across the +-180 seam
+        double lonMin = -PI_D;
+        double lonMax = PI_D;
+        const double lonSine = std::sin(coneAngle) / std::cos(latitude);
+        if (latMin > -PI_D / 2.0 && latMax < PI_D / 2.0 && lonSine < 1.0)
+        {
+            const double lonHalfWidth = std::asin(lonSine) + 1e-5;
+            if (longitude - lonHalfWidth > -PI_D && longitude + lonHalfWidth < PI_D)
+            {
+                lonMin = longitude - lonHalfWidth;
+                lonMax = longitude + lonHalfWidth;
+            }
+        }
+
+        // Sinusoidal u = lon * cos(lat) / 2pi + 0.5, clamped to the row's valid span, or 0.5 at the poles
+        const double cosMax = (latMin <= 0.0 && latMax >= 0.0) ? 1.0 : std::max(std::cos(latMin), std::cos(latMax));
+        const double cosMin = std::min(std::cos(latMin), std::cos(latMax));
+        const double products[4] = {lonMin * cosMin, lonMin * cosMax, lonMax * cosMin, lonMax * cosMax};
+        double uMin = (*std::min_element(products, products + 4)) / (2.0 * PI_D) + 0.5;
+        double uMax = (*std::max_element(products, products + 4)) / (2.0 * PI_D) + 0.5;
+        uMin = std::max(0.5 - 0.5 * cosMax, std::min(uMin, 0.5 + 0.5 * cosMin));
+        uMax = std::max(0.5 - 0.5 * cosMin, std::min(uMax, 0.5 + 0.5 * cosMax));
+        if (cosMin < 0.011)
+        {
+            uMin = std::min(uMin, 0.5);
+            uMax = std::max(uMax, 0.5);
+        }
+        const double vMin = std::max(0.0, 0.5 + latMin / PI_D);
+        const double vMax = std::min(1.0, 0.5 + latMax / PI_D);
+
+        // Bilinear filtering reads the texel after floor() too
+        x0 = std::max(0, static_cast<int>(std::floor(uMin * (heightmapWidth_ - 1) - 0.01)));
+        x1 = std::min(heightmapWidth_ - 1, static_cast<int>(std::floor(uMax * (heightmapWidth_ - 1) + 0.01)) + 1);
+        y0 = std::max(0, static_cast<int>(std::floor(vMin * (heightmapHeight_ - 1) - 0.01)));
+        y1 = std::min(heightmapHeight_ - 1, static_cast<int>(std::floor(vMax * (heightmapHeight_ - 1) + 0.01)) + 1);
+    }
+
+    // Min/max over the rectangle: small ones straight from the heightmap, larger ones from the coarsest
+    // range level that still covers them with a few cells
+    uint8_t lowest = 255;
+    uint8_t highest = 0;
+    const int span = std::max(x1 - x0, y1 - y0);
+    if (span < (2 << HEIGHT_RANGE_FIRST_LEVEL))
+    {
+        for (int y = y0; y <= y1; y++)
+        {
+            const unsigned char *row = heightmapData_ + static_cast<size_t>(y) * heightmapWidth_;
+            for (int x = x0; x <= x1; x++)
+            {
+                lowest = std::min(lowest, row[x]);
+                highest = std::max(highest, row[x]);
+            }
+        }
+    }
+    else
+    {
+        size_t level = 0;
+        while (level + 1 < heightRanges_.size() && (span >> (HEIGHT_RANGE_FIRST_LEVEL + level + 1)) >= 2)
+        {
+            level++;
+        }
+        const HeightRangeLevel &ranges = heightRanges_[level];
+        const int shift = HEIGHT_RANGE_FIRST_LEVEL + static_cast<int>(level);
+        for (int y = y0 >> shift; y <= (y1 >> shift); y++)
+        {
+            for (int x = x0 >> shift; x <= (x1 >> shift); x++)
+            {
+                const size_t cell = static_cast<size_t>(y) * ranges.width + x;
+                lowest = std::min(lowest, ranges.minValues[cell]);
+                highest = std::max(highest, ranges.maxValues[cell]);
+            }
+        }
+    }
+
+    // Bilinear samples lie within the texel range and the elevation mapping is monotonic
+    minRadius = averageRadius_ + elevationFromHeightValue(lowest) * metersToDisplay;
+    maxRadius = averageRadius_ + elevationFromHeightValue(highest) * metersToDisplay;
+    if (includesCenter)
+    {
+        minRadius = std::min(minRadius, averageRadius_);
+        maxRadius = std::max(maxRadius, averageRadius_);
+    }
+}
+
 bool PlanetOctree::isVoxelSolid(const glm::vec3 &voxelCenter, float voxelSize) const
 {
     // Sample heightmap at voxel center
@@ -201,40 +806,24 @@ bool PlanetOctree::nodeIntersectsSphere(const glm::vec3 &nodeCenter, float nodeS
     return (distToClosest <= maxRadius_) && (distToFarthest >= minSurfaceRadius);
 }
 
-void PlanetOctree::buildOctreeRecursive(OctreeNode *node)
+uint8_t PlanetOctree::classifyBuildNode(OctreeNode &node, bool &needsBrick) const
 {
+    needsBrick = false;
+
     // Check if node intersects the spherical bounding volume
-    if (!nodeIntersectsSphere(node->center, node->size))
+    if (!nodeIntersectsSphere(node.center, node.size))
     {
         // Node is completely outside spherical bounds - mark as empty and don't subdivide
-        node->isSolid = false;
-        return;
+        node.isSolid = false;
+        return 0;
     }
 
     // Check if node is near the surface (needs subdivision)
-    // Sample surface radius at node corners to determine if subdivision is needed
-    float distFromCenter = glm::length(node->center);
-    float surfaceRadius = getSurfaceRadius(node->center);
-
-    // Calculate node's actual distance range from origin
-    // Find closest and farthest points on the cube from origin
-    glm::vec3 closestPoint;
-    closestPoint.x = glm::clamp(0.0f, node->center.x - node->size, node->center.x + node->size);
-    closestPoint.y = glm::clamp(0.0f, node->center.y - node->size, node->center.y + node->size);
-    closestPoint.z = glm::clamp(0.0f, node->center.z - node->size, node->center.z + node->size);
-    float nodeMinDist = glm::length(closestPoint);
-
-    glm::vec3 farthestPoint;
-    farthestPoint.x = (std::abs(node->center.x + node->size) > std::abs(node->center.x - node->size))
-                          ? node->center.x + node->size
-                          : node->center.x - node->size;
-    farthestPoint.y = (std::abs(node->center.y + node->size) > std::abs(node->center.y - node->size))
-                          ? node->center.y + node->size
-                          : node->center.y - node->size;
-    farthestPoint.z = (std::abs(node->center.z + node->size) > std::abs(node->center.z - node->size))
-                          ? node->center.z + node->size
-                          : node->center.z - node->size;
-    float nodeMaxDist = glm::length(farthestPoint);
+    // Compare the node's distance range from the origin with the surface radius at its center
+    float surfaceRadius = getSurfaceRadius(node.center);
+    float nodeMinDist = 0.0f;
+    float nodeMaxDist = 0.0f;
+    nodeDistanceRange(node.center, node.size, nodeMinDist, nodeMaxDist);
 
     // Margin for height variations (20km)
     const float HEIGHT_MARGIN = 20000.0f;
@@ -242,104 +831,126 @@ void PlanetOctree::buildOctreeRecursive(OctreeNode *node)
     // If node is completely outside surface region, mark as empty leaf
     if (nodeMinDist > surfaceRadius + HEIGHT_MARGIN)
     {
-        node->isSolid = false;
-        node->isLeaf = true; // Explicitly mark as leaf
-        return;
+        node.isSolid = false;
+        node.isLeaf = true; // Explicitly mark as leaf
+        return 0;
     }
 
     // If node is completely inside planet (well below surface), mark as solid leaf
     if (nodeMaxDist < surfaceRadius - HEIGHT_MARGIN)
     {
-        node->isSolid = true;
-        node->isLeaf = true; // Explicitly mark as leaf
-        return;
+        node.isSolid = true;
+        node.isLeaf = true; // Explicitly mark as leaf
+        return 0;
     }
 
-    // Check if we've reached max depth - if so, make this a leaf and store voxel bits
-    if (node->depth >= maxDepth_)
+    // Check if we've reached max depth - if so, make this a leaf that stores voxel bits
+    if (node.depth >= maxDepth_)
     {
-        // Max depth reached - store voxel bits for this node
-        // For now, we'll store a simple 2x2x2 grid (8 voxels = 1 byte)
-        // This can be expanded to higher resolution grids later
-        storeVoxelBits(node);
-        node->isLeaf = true; // Explicitly mark as leaf
-        return;
+        needsBrick = true;
+        node.isLeaf = true; // Explicitly mark as leaf
+        return 0;
     }
 
     // Node intersects surface region - subdivide for better detail
-    node->isLeaf = false;
-    float childSize = node->size * 0.5f;
-    int childDepth = node->depth + 1;
-
-    // Parallelize child node construction for better performance
-    // Only parallelize up to a certain depth to avoid thread explosion
-    // After depth 3, use sequential building to reduce overhead
-    const int MAX_PARALLEL_DEPTH = 3;
-    bool useParallel = (node->depth < MAX_PARALLEL_DEPTH);
-
-    if (useParallel)
+    // Only create children that intersect the sphere
+    node.isLeaf = false;
+    const float childSize = node.size * 0.5f;
+    uint8_t childMask = 0;
+    for (int i = 0; i < 8; i++)
     {
-        // Build children in parallel using threads
-        std::vector<std::thread> threads;
-        std::vector<int> childIndices;
-
-        // First pass: create child nodes and collect indices for parallel building
-        for (int i = 0; i < 8; i++)
+        if (nodeIntersectsSphere(childCenterOf(node.center, childSize, i), childSize))
         {
-            glm::vec3 offset;
-            offset.x = (i & 1) ? childSize : -childSize;
-            offset.y = (i & 2) ? childSize : -childSize;
-            offset.z = (i & 4) ? childSize : -childSize;
-
-            glm::vec3 childCenter = node->center + offset;
+            childMask |= static_cast<uint8_t>(1u << i);
+        }
+    }
+    return childMask;
+}
 
-            // Only create child if it intersects the sphere
-            if (nodeIntersectsSphere(childCenter, childSize))
+void PlanetOctree::buildOctreeLevels()
+{
+    // Nodes of the current level are [levelBegin, levelEnd) of the node array
+    size_t levelBegin = 0;
+    size_t levelEnd = nodes_.size();
+    std::vector<uint8_t> childMasks;
+    std::vector<uint8_t> needsBrick;
+    std::vector<uint32_t> brickNodes;
+
+    while (levelBegin < levelEnd)
+    {
+        // Classify the whole level in parallel (the heightmap sampling)
+        const size_t levelSize = levelEnd - levelBegin;
+        childMasks.assign(levelSize, 0);
+        needsBrick.assign(levelSize, 0);
+        // Levels grow eightfold with depth: the top levels split down to single nodes, deep levels into
+        // batches of at least 16 nodes so the per-task cost stays small next to the sampling
+        TaskScheduler::shared().parallelFor(levelSize, parallelGrain(levelSize, 16), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
             {
-                node->children[i] = std::make_unique<OctreeNode>(childCenter, childSize, childDepth);
-                childIndices.push_back(i);
+                bool brick = false;
+                childMasks[i] = classifyBuildNode(nodes_[levelBegin + i], brick);
+                needsBrick[i] = brick ? 1 : 0;
             }
-        }
+        });
 
-        // Second pass: build children in parallel
-        for (int childIdx : childIndices)
+        // Append the next level and allocate this level's bricks, both in key order
+        size_t childCount = 0;
+        size_t brickCount = 0;
+        for (size_t i = 0; i < levelSize; i++)
         {
-            threads.emplace_back([this, childIdx, node]() {
-                buildOctreeRecursive(node->children[childIdx].get());
-            });
+            childCount += childSlot(childMasks[i], 8);
+            brickCount += needsBrick[i];
         }
+        nodes_.reserve(levelEnd + childCount);
+        uint32_t nextBrick = bricks_.allocate(static_cast<uint32_t>(brickCount));
+        brickNodes.clear();
 
-        // Wait for all threads to complete
-        for (auto &thread : threads)
-        {
-            thread.join();
-        }
-    }
-    else
-    {
-        // Sequential building for deeper nodes (reduces thread overhead)
-        for (int i = 0; i < 8; i++)
+        for (size_t i = 0; i < levelSize; i++)
         {
-            glm::vec3 offset;
-            offset.x = (i & 1) ? childSize : -childSize;
-            offset.y = (i & 2) ? childSize : -childSize;
-            offset.z = (i & 4) ? childSize : -childSize;
-
-            glm::vec3 childCenter = node->center + offset;
+            const uint32_t nodeIndex = static_cast<uint32_t>(levelBegin + i);
+            if (needsBrick[i])
+            {
+                nodes_[nodeIndex].brick = nextBrick++;
+                brickNodes.push_back(nodeIndex);
+            }
+            if (childMasks[i] == 0)
+            {
+                continue;
+            }
 
-            // Only create child if it intersects the sphere
-            if (nodeIntersectsSphere(childCenter, childSize))
+            const OctreeNode parent = nodes_[nodeIndex];
+            const float childSize = parent.size * 0.5f;
+            nodes_[nodeIndex].childMask = childMasks[i];
+            nodes_[nodeIndex].firstChild = static_cast<uint32_t>(nodes_.size());
+            for (int child = 0; child < 8; child++)
             {
-                node->children[i] = std::make_unique<OctreeNode>(childCenter, childSize, childDepth);
-                buildOctreeRecursive(node->children[i].get());
+                if (childMasks[i] & (1u << child))
+                {
+                    nodes_.emplace_back(childCenterOf(parent.center, childSize, child),
+                                        childSize,
+                                        parent.depth + 1,
+                                        childMortonKey(parent.mortonKey, child));
+                }
             }
         }
+
+        // Fill the bricks in parallel (each writes only its own node and brick). A brick samples 32^3 voxels,
+        // so one brick is already a task worth stealing
+        TaskScheduler::shared().parallelFor(brickNodes.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                storeVoxelBits(nodes_[brickNodes[i]]);
+            }
+        });
+
+        levelBegin = levelEnd;
+        levelEnd = nodes_.size();
     }
 }
 
 void PlanetOctree::subdivideForProximity(const glm::vec3 &referencePoint, float maxSubdivisionDistance, int maxNodesToProcess)
 {
-    if (!root_)
+    if (nodes_.empty())
     {
         return;
     }
@@ -354,81 +965,63 @@ void PlanetOctree::subdivideForProximity(const glm::vec3 &referencePoint, float
     }
 
     // Collect nodes that need subdivision first (for parallel processing)
-    std::vector<OctreeNode*> nodesToSubdivide;
-    collectNodesForSubdivision(root_.get(), referencePoint, maxSubdivisionDistance, nodesToSubdivide, maxNodesToProcess);
+    std::vector<uint32_t> nodesToSubdivide;
+    collectNodesForSubdivision(0, referencePoint, maxSubdivisionDistance, nodesToSubdivide, maxNodesToProcess);
 
-    // Parallelize subdivision of collected nodes
     if (!nodesToSubdivide.empty())
     {
-        const unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
-        const size_t nodesPerThread = std::max(size_t(1), nodesToSubdivide.size() / numThreads);
-        
-        std::vector<std::thread> threads;
-        std::atomic<size_t> processedCount(0);
-
-        for (unsigned int t = 0; t < numThreads && t * nodesPerThread < nodesToSubdivide.size(); ++t)
+        // Plan the children of the collected nodes in parallel (the heightmap sampling),
+        // then append them to the node array in collection order
+        std::vector<ChildBlock> blocks(nodesToSubdivide.size());
+        TaskScheduler::shared().parallelFor(nodesToSubdivide.size(),
+                                            parallelGrain(nodesToSubdivide.size(), 4),
+                                            [&](size_t begin, size_t end) {
+                                                for (size_t i = begin; i < end; i++)
+                                                {
+                                                    blocks[i] = planChildren(nodes_[nodesToSubdivide[i]]);
+                                                }
+                                            });
+        for (size_t i = 0; i < nodesToSubdivide.size(); i++)
         {
-            threads.emplace_back([&, t]() {
-                size_t startIdx = t * nodesPerThread;
-                size_t endIdx = std::min(startIdx + nodesPerThread, nodesToSubdivide.size());
-                
-                for (size_t i = startIdx; i < endIdx; ++i)
-                {
-                    OctreeNode* node = nodesToSubdivide[i];
-                    if (node)
-                    {
-                        subdivideNode(node, referencePoint, maxSubdivisionDistance);
-                        processedCount++;
-                    }
-                }
-            });
-        }
-
-        // Wait for all threads
-        for (auto& thread : threads)
-        {
-            thread.join();
+            attachChildren(nodesToSubdivide[i], blocks[i]);
         }
 
         // Now recursively process children of subdivided nodes
-        for (OctreeNode* node : nodesToSubdivide)
+        for (uint32_t nodeIndex : nodesToSubdivide)
         {
-            if (node && !node->isLeaf)
+            // The recursion appends to the node array, so keep indices rather than references
+            const uint32_t firstChild = nodes_[nodeIndex].firstChild;
+            const uint32_t childCount = nodes_[nodeIndex].childCount();
+            for (uint32_t i = 0; i < childCount; i++)
             {
-                for (int i = 0; i < 8; i++)
-                {
-                    if (node->children[i])
-                    {
-                        subdivideForProximityRecursive(node->children[i].get(), referencePoint, maxSubdivisionDistance);
-                    }
-                }
+                subdivideForProximityRecursive(firstChild + i, referencePoint, maxSubdivisionDistance);
             }
         }
     }
     else
     {
         // Fallback: use recursive approach if no nodes collected
-        subdivideForProximityRecursive(root_.get(), referencePoint, maxSubdivisionDistance);
+        subdivideForProximityRecursive(0, referencePoint, maxSubdivisionDistance);
     }
 }
 
-void PlanetOctree::subdivideForProximityRecursive(OctreeNode *node,
+void PlanetOctree::subdivideForProximityRecursive(uint32_t nodeIndex,
                                                   const glm::vec3 &referencePoint,
                                                   float maxSubdivisionDistance)
 {
-    if (!node)
+    if (nodeIndex >= nodes_.size())
     {
         return;
     }
 
-    // Calculate distance from reference point to node center
-    float distToNode = glm::length(node->center - referencePoint);
+    // Copy: subdividing appends to the node array
+    const OctreeNode node = nodes_[nodeIndex];
 
     // Calculate the closest point on the node's bounding box to the reference point
     glm::vec3 closestPointOnNode;
-    closestPointOnNode.x = glm::clamp(referencePoint.x, node->center.x - node->size, node->center.x + node->size);
-    closestPointOnNode.y = glm::clamp(referencePoint.y, node->center.y - node->size, node->center.y + node->size);
-    closestPointOnNode.z = glm::clamp(referencePoint.z, node->center.z - node->size, node->center.z + node->size);
+    closestPointOnNode.x = glm::clamp(referencePoint.x, node.center.x - node.size, node.center.x + node.size);
+    closestPointOnNode.y = glm::clamp(referencePoint.y, node.center.y - node.size, node.center.y + node.size);
+    closestPointOnNode.z = glm::clamp(referencePoint.z, node.center.z - node.size, node.center.z + node.size);
     float minDistToNode = glm::length(closestPointOnNode - referencePoint);
 
     // If node is too far away, don't subdivide (and don't recurse into children)
@@ -438,44 +1031,27 @@ void PlanetOctree::subdivideForProximityRecursive(OctreeNode *node,
     }
 
     // If node is a leaf and close enough, subdivide it (if not at max depth)
-    if (node->isLeaf)
+    if (node.isLeaf)
     {
         // Check if we can subdivide further
-        if (node->depth >= maxDepth_)
+        if (node.depth >= maxDepth_)
         {
             // Already at max depth, can't subdivide more
             return;
         }
 
         // Check if node intersects the surface (only subdivide surface nodes)
-        if (!nodeIntersectsSphere(node->center, node->size))
+        if (!nodeIntersectsSphere(node.center, node.size))
         {
             // Node is outside sphere, don't subdivide
             return;
         }
 
-        // Check if node is near surface (similar to buildOctreeRecursive logic)
-        float distFromCenter = glm::length(node->center);
-        float surfaceRadius = getSurfaceRadius(node->center);
-
-        // Calculate node's distance range from origin
-        glm::vec3 closestPoint;
-        closestPoint.x = glm::clamp(0.0f, node->center.x - node->size, node->center.x + node->size);
-        closestPoint.y = glm::clamp(0.0f, node->center.y - node->size, node->center.y + node->size);
-        closestPoint.z = glm::clamp(0.0f, node->center.z - node->size, node->center.z + node->size);
-        float nodeMinDist = glm::length(closestPoint);
-
-        glm::vec3 farthestPoint;
-        farthestPoint.x = (std::abs(node->center.x + node->size) > std::abs(node->center.x - node->size))
-                              ? node->center.x + node->size
-                              : node->center.x - node->size;
-        farthestPoint.y = (std::abs(node->center.y + node->size) > std::abs(node->center.y - node->size))
-                              ? node->center.y + node->size
-                              : node->center.y - node->size;
-        farthestPoint.z = (std::abs(node->center.z + node->size) > std::abs(node->center.z - node->size))
-                              ? node->center.z + node->size
-                              : node->center.z - node->size;
-        float nodeMaxDist = glm::length(farthestPoint);
+        // Check if node is near surface (similar to the build classification)
+        float surfaceRadius = getSurfaceRadius(node.center);
+        float nodeMinDist = 0.0f;
+        float nodeMaxDist = 0.0f;
+        nodeDistanceRange(node.center, node.size, nodeMinDist, nodeMaxDist);
 
         const float HEIGHT_MARGIN = 20000.0f;
 
@@ -491,98 +1067,42 @@ void PlanetOctree::subdivideForProximityRecursive(OctreeNode *node,
         subdivisionCount++;
         if (subdivisionCount % 100 == 0) // Print every 100 subdivisions to avoid spam
         {
-            std::cout << "DEBUG: Subdividing node at depth " << node->depth << ", center=(" << node->center.x << ","
-                      << node->center.y << "," << node->center.z << "), distance=" << minDistToNode << "\n";
+            std::cout << "DEBUG: Subdividing node at depth " << static_cast<int>(node.depth) << ", center=("
+                      << node.center.x << "," << node.center.y << "," << node.center.z
+                      << "), distance=" << minDistToNode << "\n";
         }
 
-        node->isLeaf = false;
-        float childSize = node->size * 0.5f;
-        int childDepth = node->depth + 1;
-
-        // Create 8 child nodes
-        for (int i = 0; i < 8; i++)
-        {
-            glm::vec3 offset;
-            offset.x = (i & 1) ? childSize : -childSize;
-            offset.y = (i & 2) ? childSize : -childSize;
-            offset.z = (i & 4) ? childSize : -childSize;
-
-            glm::vec3 childCenter = node->center + offset;
-
-            // Only create child if it intersects the sphere
-            if (nodeIntersectsSphere(childCenter, childSize))
-            {
-                node->children[i] = std::make_unique<OctreeNode>(childCenter, childSize, childDepth);
-
-                // Determine child's solidity (similar to buildOctreeRecursive)
-                float childDistFromCenter = glm::length(childCenter);
-                float childSurfaceRadius = getSurfaceRadius(childCenter);
-
-                // Calculate child's distance range
-                glm::vec3 childClosestPoint;
-                childClosestPoint.x = glm::clamp(0.0f, childCenter.x - childSize, childCenter.x + childSize);
-                childClosestPoint.y = glm::clamp(0.0f, childCenter.y - childSize, childCenter.y + childSize);
-                childClosestPoint.z = glm::clamp(0.0f, childCenter.z - childSize, childCenter.z + childSize);
-                float childMinDist = glm::length(childClosestPoint);
-
-                glm::vec3 childFarthestPoint;
-                childFarthestPoint.x = (std::abs(childCenter.x + childSize) > std::abs(childCenter.x - childSize))
-                                           ? childCenter.x + childSize
-                                           : childCenter.x - childSize;
-                childFarthestPoint.y = (std::abs(childCenter.y + childSize) > std::abs(childCenter.y - childSize))
-                                           ? childCenter.y + childSize
-                                           : childCenter.y - childSize;
-                childFarthestPoint.z = (std::abs(childCenter.z + childSize) > std::abs(childCenter.z - childSize))
-                                           ? childCenter.z + childSize
-                                           : childCenter.z - childSize;
-                float childMaxDist = glm::length(childFarthestPoint);
-
-                // Mark child as leaf initially (will be subdivided further if needed)
-                node->children[i]->isLeaf = true;
-
-                if (childMinDist > childSurfaceRadius + HEIGHT_MARGIN)
-                {
-                    node->children[i]->isSolid = false;
-                }
-                else if (childMaxDist < childSurfaceRadius - HEIGHT_MARGIN)
-                {
-                    node->children[i]->isSolid = true;
-                }
-                else
-                {
-                    // Child intersects surface - will be processed recursively
-                    node->children[i]->isSolid = isVoxelSolid(childCenter, childSize);
-                }
-            }
-        }
+        attachChildren(nodeIndex, planChildren(node));
     }
 
     // Recursively process children (whether they existed before or were just created)
-    for (int i = 0; i < 8; i++)
+    const uint32_t firstChild = nodes_[nodeIndex].firstChild;
+    const uint32_t childCount = nodes_[nodeIndex].childCount();
+    for (uint32_t i = 0; i < childCount; i++)
     {
-        if (node->children[i])
-        {
-            subdivideForProximityRecursive(node->children[i].get(), referencePoint, maxSubdivisionDistance);
-        }
+        subdivideForProximityRecursive(firstChild + i, referencePoint, maxSubdivisionDistance);
     }
 }
 
-void PlanetOctree::collectNodesForSubdivision(OctreeNode *node,
+void PlanetOctree::collectNodesForSubdivision(uint32_t nodeIndex,
                                               const glm::vec3 &referencePoint,
                                               float maxSubdivisionDistance,
-                                              std::vector<OctreeNode*> &nodesToSubdivide,
-                                              int maxNodesToProcess)
+                                              std::vector<uint32_t> &nodesToSubdivide,
+                                              int maxNodesToProcess) const
 {
-    if (!node || (maxNodesToProcess >= 0 && static_cast<int>(nodesToSubdivide.size()) >= maxNodesToProcess))
+    if (nodeIndex >= nodes_.size() ||
+        (maxNodesToProcess >= 0 && static_cast<int>(nodesToSubdivide.size()) >= maxNodesToProcess))
     {
         return;
     }
 
+    const OctreeNode &node = nodes_[nodeIndex];
+
     // Calculate the closest point on the node's bounding box to the reference point
     glm::vec3 closestPointOnNode;
-    closestPointOnNode.x = glm::clamp(referencePoint.x, node->center.x - node->size, node->center.x + node->size);
-    closestPointOnNode.y = glm::clamp(referencePoint.y, node->center.y - node->size, node->center.y + node->size);
-    closestPointOnNode.z = glm::clamp(referencePoint.z, node->center.z - node->size, node->center.z + node->size);
+    closestPointOnNode.x = glm::clamp(referencePoint.x, node.center.x - node.size, node.center.x + node.size);
+    closestPointOnNode.y = glm::clamp(referencePoint.y, node.center.y - node.size, node.center.y + node.size);
+    closestPointOnNode.z = glm::clamp(referencePoint.z, node.center.z - node.size, node.center.z + node.size);
     float minDistToNode = glm::length(closestPointOnNode - referencePoint);
 
     // If node is too far away, don't collect (and don't recurse into children)
@@ -592,130 +1112,129 @@ void PlanetOctree::collectNodesForSubdivision(OctreeNode *node,
     }
 
     // If node is a leaf and close enough, collect it for subdivision
-    if (node->isLeaf)
+    if (node.isLeaf)
     {
         // Check if we can subdivide further
-        if (node->depth >= maxDepth_)
+        if (node.depth >= maxDepth_)
         {
             // Already at max depth, can't subdivide more
             return;
         }
 
         // Check if node intersects the surface (only subdivide surface nodes)
-        if (!nodeIntersectsSphere(node->center, node->size))
+        if (!nodeIntersectsSphere(node.center, node.size))
         {
             // Node is outside sphere, don't subdivide
             return;
         }
 
         // Check if node is near surface
-        float distFromCenter = glm::length(node->center);
-        float surfaceRadius = getSurfaceRadius(node->center);
-
-        glm::vec3 closestPoint;
-        closestPoint.x = glm::clamp(0.0f, node->center.x - node->size, node->center.x + node->size);
-        closestPoint.y = glm::clamp(0.0f, node->center.y - node->size, node->center.y + node->size);
-        closestPoint.z = glm::clamp(0.0f, node->center.z - node->size, node->center.z + node->size);
-        float nodeMinDist = glm::length(closestPoint);
-
-        glm::vec3 farthestPoint;
-        farthestPoint.x = (std::abs(node->center.x + node->size) > std::abs(node->center.x - node->size))
-                              ? node->center.x + node->size
-                              : node->center.x - node->size;
-        farthestPoint.y = (std::abs(node->center.y + node->size) > std::abs(node->center.y - node->size))
-                              ? node->center.y + node->size
-                              : node->center.y - node->size;
-        farthestPoint.z = (std::abs(node->center.z + node->size) > std::abs(node->center.z - node->size))
-                              ? node->center.z + node->size
-                              : node->center.z - node->size;
-        float nodeMaxDist = glm::length(farthestPoint);
+        float surfaceRadius = getSurfaceRadius(node.center);
+        float nodeMinDist = 0.0f;
+        float nodeMaxDist = 0.0f;
+        nodeDistanceRange(node.center, node.size, nodeMinDist, nodeMaxDist);
 
         const float HEIGHT_MARGIN = 20000.0f;
 
         // Only collect if node intersects surface region
         if (nodeMinDist <= surfaceRadius + HEIGHT_MARGIN && nodeMaxDist >= surfaceRadius - HEIGHT_MARGIN)
         {
-            nodesToSubdivide.push_back(node);
+            nodesToSubdivide.push_back(nodeIndex);
         }
     }
     else
     {
         // Recurse into children
-        for (int i = 0; i < 8; i++)
+        for (uint32_t i = 0; i < node.childCount(); i++)
         {
-            if (node->children[i] && (maxNodesToProcess < 0 || static_cast<int>(nodesToSubdivide.size()) < maxNodesToProcess))
+            if (maxNodesToProcess < 0 || static_cast<int>(nodesToSubdivide.size()) < maxNodesToProcess)
             {
-                collectNodesForSubdivision(node->children[i].get(), referencePoint, maxSubdivisionDistance, nodesToSubdivide, maxNodesToProcess);
+                collectNodesForSubdivision(node.firstChild + i,
+                                           referencePoint,
+                                           maxSubdivisionDistance,
+                                           nodesToSubdivide,
+                                           maxNodesToProcess);
             }
         }
     }
 }
 
-void PlanetOctree::subdivideNode(OctreeNode *node, const glm::vec3 &referencePoint, float maxSubdivisionDistance)
+void PlanetOctree::subdivideNode(uint32_t nodeIndex)
 {
-    if (!node || !node->isLeaf || node->depth >= maxDepth_)
+    if (nodeIndex >= nodes_.size() || !nodes_[nodeIndex].isLeaf || nodes_[nodeIndex].depth >= maxDepth_)
     {
         return;
     }
 
-    // Subdivide this leaf node (same logic as in subdivideForProximityRecursive)
-    node->isLeaf = false;
-    float childSize = node->size * 0.5f;
-    int childDepth = node->depth + 1;
+    attachChildren(nodeIndex, planChildren(nodes_[nodeIndex]));
+}
+
+PlanetOctree::ChildBlock PlanetOctree::planChildren(const OctreeNode &node) const
+{
+    ChildBlock block;
+    const float childSize = node.size * 0.5f;
+    const int childDepth = node.depth + 1;
+    const float HEIGHT_MARGIN = 20000.0f;
+    int childCount = 0;
 
-    // Create 8 child nodes
     for (int i = 0; i < 8; i++)
     {
-        glm::vec3 offset;
-        offset.x = (i & 1) ? childSize : -childSize;
-        offset.y = (i & 2) ? childSize : -childSize;
-        offset.z = (i & 4) ? childSize : -childSize;
-
-        glm::vec3 childCenter = node->center + offset;
+        glm::vec3 childCenter = childCenterOf(node.center, childSize, i);
 
         // Only create child if it intersects the sphere
-        if (nodeIntersectsSphere(childCenter, childSize))
+        if (!nodeIntersectsSphere(childCenter, childSize))
         {
-            node->children[i] = std::make_unique<OctreeNode>(childCenter, childSize, childDepth);
-
-            // Determine child's solidity
-            float childDistFromCenter = glm::length(childCenter);
-            float childSurfaceRadius = getSurfaceRadius(childCenter);
-
-            glm::vec3 childClosestPoint;
-            childClosestPoint.x = glm::clamp(0.0f, childCenter.x - childSize, childCenter.x + childSize);
-            childClosestPoint.y = glm::clamp(0.0f, childCenter.y - childSize, childCenter.y + childSize);
-            childClosestPoint.z = glm::clamp(0.0f, childCenter.z - childSize, childCenter.z + childSize);
-            float childMinDist = glm::length(childClosestPoint);
+            continue;
+        }
 
-            glm::vec3 childFarthestPoint;
-            childFarthestPoint.x = (std::abs(childCenter.x + childSize) > std::abs(childCenter.x - childSize))
-                                       ? childCenter.x + childSize
-                                       : childCenter.x - childSize;
-            childFarthestPoint.y = (std::abs(childCenter.y + childSize) > std::abs(childCenter.y - childSize))
-                                       ? childCenter.y + childSize
-                                       : childCenter.y - childSize;
-            childFarthestPoint.z = (std::abs(childCenter.z + childSize) > std::abs(childCenter.z - childSize))
-                                       ? childCenter.z + childSize
-                                       : childCenter.z - childSize;
-            float childMaxDist = glm::length(childFarthestPoint);
+        // Mark child as leaf initially (will be subdivided further if needed)
+        OctreeNode child(childCenter, childSize, childDepth, childMortonKey(node.mortonKey, i));
 
-            const float HEIGHT_MARGIN = 20000.0f;
+        // Determine child's solidity (similar to the build classification)
+        float childSurfaceRadius = getSurfaceRadius(childCenter);
+        float childMinDist = 0.0f;
+        float childMaxDist = 0.0f;
+        nodeDistanceRange(childCenter, childSize, childMinDist, childMaxDist);
 
-            node->children[i]->isLeaf = true;
+        if (childMinDist > childSurfaceRadius + HEIGHT_MARGIN)
+        {
+            child.isSolid = false;
+        }
+        else if (childMaxDist < childSurfaceRadius - HEIGHT_MARGIN)
+        {
+            child.isSolid = true;
+        }
+        else
+        {
+            // Child intersects surface - will be processed recursively
+            child.isSolid = isVoxelSolid(childCenter, childSize);
+        }
 
-            if (childMinDist > childSurfaceRadius + HEIGHT_MARGIN)
-            {
-                node->children[i]->isSolid = false;
-            }
-            else if (childMaxDist < childSurfaceRadius - HEIGHT_MARGIN)
-            {
-                node->children[i]->isSolid = true;
-            }
-            else
-            {
-                node->children[i]->isSolid = isVoxelSolid(childCenter, childSize);
-            }
+        block.children[childCount++] = child;
+        block.childMask |= static_cast<uint8_t>(1u << i);
+    }
+    return block;
+}
+
+void PlanetOctree::attachChildren(uint32_t nodeIndex, const ChildBlock &block)
+{
+    const uint32_t firstChild = static_cast<uint32_t>(nodes_.size());
+    nodes_.insert(nodes_.end(), block.children.begin(), block.children.begin() + childSlot(block.childMask, 8));
+
+    OctreeNode &node = nodes_[nodeIndex];
+    node.isLeaf = false;
+    node.childMask = block.childMask;
+    node.firstChild = block.childMask != 0 ? firstChild : NO_INDEX;
+
+    // A brick leaf that gains children leaves the mesh: its chunk can no longer skip the comparison
+    // (a subdivided chunk root above the chunk depth simply stops being reached, see updateMeshChunks)
+    const int chunkDepth = meshChunkDepth();
+    if (node.brick != NO_INDEX && node.depth >= chunkDepth)
+    {
+        auto chunk = meshChunks_.find(node.mortonKey >> (3 * (node.depth - chunkDepth)));
+        if (chunk != meshChunks_.end())
+        {
+            chunk->second.dirty = true;
         }
     }
 }
@@ -739,14 +1258,14 @@ void PlanetOctree::extractSurfaceMesh(const glm::vec3 &referencePoint,
     vertices.clear();
     indices.clear();
 
-    if (!root_)
+    if (nodes_.empty())
     {
         std::cerr << "WARNING: PlanetOctree::extractSurfaceMesh() - Root node is null!" << "\n";
         return;
     }
 
     // Collect voxel data with distance filtering
-    std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> voxelNodes;
+    std::vector<VoxelBrickRef> voxelNodes;
     collectVoxelDataWithDistance(voxelNodes, referencePoint, maxSubdivisionDistance);
 
     if (voxelNodes.empty())
@@ -766,12 +1285,152 @@ void PlanetOctree::extractSurfaceMesh(const glm::vec3 &referencePoint,
 
     // Greedy mesh along each axis (X, Y, Z)
     // This generates faces only on exposed surfaces
+    const float voxelSize = brickVoxelSize();
+    for (int axis = 0; axis < 3; axis++)
+    {
+        greedyMeshAxis(voxelNodes, voxelSize, axis, vertices, indices, baseIndex);
+    }
+}
+
+void PlanetOctree::updateMeshChunks(const glm::vec3 &referencePoint,
+                                    float maxSubdivisionDistance,
+                                    std::vector<MeshChunkUpdate> &changed)
+{
+    // Subdivide based on proximity first (marks the chunks whose brick leaves were split)
+    subdivideForProximity(referencePoint, maxSubdivisionDistance);
+
+    meshChunkUpdate_++;
+    if (!nodes_.empty())
+    {
+        updateMeshChunksRecursive(0, referencePoint, maxSubdivisionDistance, meshChunkDepth(), changed);
+    }
+
+    // Chunks in the mesh that were not reached this time are now out of range (or were subdivided above the
+    // chunk depth, or belong to a replaced node array)
+    for (auto chunk = meshChunks_.begin(); chunk != meshChunks_.end();)
+    {
+        if (chunk->second.visited == meshChunkUpdate_)
+        {
+            ++chunk;
+            continue;
+        }
+        MeshChunkUpdate removed;
+        removed.key = chunk->first;
+        changed.push_back(std::move(removed));
+        chunk = meshChunks_.erase(chunk);
+    }
+}
+
+void PlanetOctree::updateMeshChunksRecursive(uint32_t nodeIndex,
+                                             const glm::vec3 &referencePoint,
+                                             float maxDistance,
+                                             int chunkDepth,
+                                             std::vector<MeshChunkUpdate> &changed)
+{
+    const OctreeNode &node = nodes_[nodeIndex];
+    const float distanceToNode = glm::length(node.center - referencePoint);
+    const float nodeRadius = node.size * 0.866f; // Same bound as collectVoxelDataWithDistanceRecursive
+    const bool rootLeaf = nodeIndex == 0 && node.isLeaf;
+
+    // Outside the distance: nothing below is selected. A lone root leaf is always kept, as the fallback of
+    // extractSurfaceMesh() would
+    if (distanceToNode - nodeRadius > maxDistance && !rootLeaf)
+    {
+        return;
+    }
+
+    if (node.depth < chunkDepth && !node.isLeaf)
+    {
+        for (uint32_t i = 0; i < node.childCount(); i++)
+        {
+            updateMeshChunksRecursive(node.firstChild + i, referencePoint, maxDistance, chunkDepth, changed);
+        }
+        return;
+    }
+
+    // Chunk root. Every node of the subtree has its center within sqrt(3) * size of this one, so the whole
+    // subtree passes the distance test when this bound does
+    auto existing = meshChunks_.find(node.mortonKey);
+    const bool known = existing != meshChunks_.end();
+    const bool complete = rootLeaf || distanceToNode + node.size * 1.733f <= maxDistance;
+    if (known && complete && existing->second.complete && !existing->second.dirty)
+    {
+        existing->second.visited = meshChunkUpdate_;
+        return;
+    }
+
+    std::vector<uint32_t> brickNodes;
+    if (rootLeaf)
+    {
+        if (node.brick != NO_INDEX)
+        {
+            brickNodes.push_back(0);
+        }
+    }
+    else
+    {
+        collectBrickNodesWithDistance(nodeIndex, brickNodes, referencePoint, maxDistance);
+    }
+    if (brickNodes.empty())
+    {
+        // Not in the mesh (if it was, the sweep in updateMeshChunks removes it)
+        return;
+    }
+
+    MeshChunkState &state = meshChunks_[node.mortonKey];
+    const bool same = known && !state.dirty && state.brickNodes == brickNodes;
+    state.complete = complete;
+    state.dirty = false;
+    state.visited = meshChunkUpdate_;
+    if (same)
+    {
+        return;
+    }
+
+    // Read through the const pool: the writable overload does not decode bricks of mapped files
+    const BrickPool &bricks = bricks_;
+    MeshChunkUpdate update;
+    update.key = node.mortonKey;
+    update.voxelSize = brickVoxelSize();
+    update.bricks.reserve(brickNodes.size());
+    for (uint32_t brickNode : brickNodes)
+    {
+        update.bricks.push_back({nodes_[brickNode].center, bricks.brick(nodes_[brickNode].brick)});
+    }
+    state.brickNodes = std::move(brickNodes);
+    changed.push_back(std::move(update));
+}
+
+void PlanetOctree::meshChunk(MeshChunkUpdate &chunk) const
+{
+    chunk.vertices.clear();
+    chunk.indices.clear();
+    unsigned int baseIndex = 0;
     for (int axis = 0; axis < 3; axis++)
     {
-        greedyMeshAxis(voxelNodes, axis, vertices, indices, baseIndex);
+        greedyMeshAxis(chunk.bricks, chunk.voxelSize, axis, chunk.vertices, chunk.indices, baseIndex);
+    }
+}
+
+int PlanetOctree::meshChunkDepth() const
+{
+    return std::max(0, maxDepth_ - MESH_CHUNK_LEVELS);
+}
+
+void PlanetOctree::invalidateMeshChunks()
+{
+    for (auto &chunk : meshChunks_)
+    {
+        chunk.second.dirty = true;
     }
 }
 
+float PlanetOctree::brickVoxelSize() const
+{
+    // Each max-depth node holds 32x32x32 voxels
+    return nodes_.empty() ? 0.0f : nodes_[0].size / static_cast<float>(1 << maxDepth_) / 32.0f;
+}
+
 float PlanetOctree::sampleDensity(const glm::vec3 &pos) const
 {
     // Returns: < 0 if inside planet, > 0 if outside, 0 at surface
@@ -1465,12 +2124,9 @@ void PlanetOctree::extractMeshFromNode(const OctreeNode *node,
     else
     {
         // Recurse into children
-        for (const auto &child : node->children)
+        for (uint32_t i = 0; i < node->childCount(); i++)
         {
-            if (child)
-            {
-                extractMeshFromNode(child.get(), vertices, indices, baseIndex);
-            }
+            extractMeshFromNode(&nodes_[node->firstChild + i], vertices, indices, baseIndex);
         }
     }
 }
@@ -1507,57 +2163,25 @@ void PlanetOctree::extractChunkedSurfaceMesh(std::vector<MeshVertex> &vertices,
     vertices.clear();
     indices.clear();
 
-    if (!root_)
+    if (nodes_.empty())
     {
         std::cerr << "WARNING: PlanetOctree::extractChunkedSurfaceMesh() - Root node is null!" << "\n";
         return;
     }
 
-    // Generate chunks in parallel
-    std::vector<ChunkMesh> chunks(numChunksX * numChunksY);
-    std::vector<std::thread> threads;
-    std::mutex chunksMutex;
+    // Generate chunks in parallel, one task per chunk (chunks differ a lot in cost, so stealing balances them)
+    const int totalChunks = numChunksX * numChunksY;
+    std::vector<ChunkMesh> chunks(totalChunks);
     std::atomic<int> completedChunks(0);
-
-    // Launch threads to generate chunks
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0)
-    {
-        numThreads = 4; // Fallback to 4 threads
-    }
-
-    std::atomic<int> nextChunkIndex(0);
-    int totalChunks = numChunksX * numChunksY;
-
-    // Worker function for parallel chunk generation
-    auto worker = [&]() {
-        while (true)
+    TaskScheduler::shared().parallelFor(static_cast<size_t>(totalChunks), 1, [&](size_t begin, size_t end) {
+        for (size_t chunkIdx = begin; chunkIdx < end; chunkIdx++)
         {
-            int chunkIdx = nextChunkIndex.fetch_add(1);
-            if (chunkIdx >= totalChunks)
-            {
-                break;
-            }
-
-            int chunkX = chunkIdx % numChunksX;
-            int chunkY = chunkIdx / numChunksX;
-
+            const int chunkX = static_cast<int>(chunkIdx) % numChunksX;
+            const int chunkY = static_cast<int>(chunkIdx) / numChunksX;
             chunks[chunkIdx] = generateChunkMesh(chunkX, chunkY, numChunksX, numChunksY);
             completedChunks.fetch_add(1);
         }
-    };
-
-    // Launch worker threads
-    for (unsigned int i = 0; i < numThreads; i++)
-    {
-        threads.emplace_back(worker);
-    }
-
-    // Wait for all threads to complete
-    for (auto &thread : threads)
-    {
-        thread.join();
-    }
+    });
 
     std::cout << "  Generated " << completedChunks.load() << " chunks in parallel" << "\n";
 
@@ -1588,7 +2212,7 @@ ChunkMesh PlanetOctree::generateChunkMesh(int chunkX, int chunkY, int numChunksX
     chunk.chunkY = chunkY;
     chunk.isValid = false;
 
-    if (!root_)
+    if (nodes_.empty())
     {
         return chunk;
     }
@@ -1617,7 +2241,7 @@ ChunkMesh PlanetOctree::generateChunkMesh(int chunkX, int chunkY, int numChunksX
     // For now, use full sphere bounds and let surface detection handle it
 
     unsigned int baseIndex = 0;
-    extractMeshFromNodeChunked(root_.get(),
+    extractMeshFromNodeChunked(getRoot(),
                                chunkMin,
                                chunkMax,
                                chunk.vertices,
@@ -1713,20 +2337,17 @@ void PlanetOctree::extractMeshFromNodeChunked(const OctreeNode *node,
     else
     {
         // Recurse into children
-        for (const auto &child : node->children)
+        for (uint32_t i = 0; i < node->childCount(); i++)
         {
-            if (child)
-            {
-                extractMeshFromNodeChunked(child.get(),
-                                           chunkMin,
-                                           chunkMax,
-                                           vertices,
-                                           indices,
-                                           edgeVertices,
-                                           chunkX,
-                                           chunkY,
-                                           baseIndex);
-            }
+            extractMeshFromNodeChunked(&nodes_[node->firstChild + i],
+                                       chunkMin,
+                                       chunkMax,
+                                       vertices,
+                                       indices,
+                                       edgeVertices,
+                                       chunkX,
+                                       chunkY,
+                                       baseIndex);
         }
     }
 }
@@ -1870,7 +2491,10 @@ void PlanetOctree::stitchChunks(const std::vector<ChunkMesh> &chunks,
 void PlanetOctree::extractVoxelWireframes(std::vector<glm::vec3> &edgeVertices) const
 {
     edgeVertices.clear();
-    extractVoxelWireframesFromNode(root_.get(), edgeVertices);
+    if (!nodes_.empty())
+    {
+        extractVoxelWireframesFromNode(getRoot(), edgeVertices);
+    }
 }
 
 void PlanetOctree::extractVoxelWireframesFromNode(const OctreeNode *node, std::vector<glm::vec3> &edgeVertices) const
@@ -1948,306 +2572,413 @@ void PlanetOctree::extractVoxelWireframesFromNode(const OctreeNode *node, std::v
     else
     {
         // Recurse into children
-        for (const auto &child : node->children)
+        for (uint32_t i = 0; i < node->childCount(); i++)
         {
-            if (child)
-            {
-                extractVoxelWireframesFromNode(child.get(), edgeVertices);
-            }
+            extractVoxelWireframesFromNode(&nodes_[node->firstChild + i], edgeVertices);
         }
     }
 }
 
-void PlanetOctree::storeVoxelBits(OctreeNode *node)
+void PlanetOctree::storeVoxelBits(OctreeNode &node)
 {
-    if (!node)
+    if (node.brick == NO_INDEX)
     {
         return;
     }
 
-    // For a leaf node at max depth, store voxel bits for a 32x32x32 grid
+    // For a leaf node at max depth, store voxel bits for a 32x32x32 grid in its brick
     // Storage: 32 rows (y) × 32 uint32_t per row (z), each uint32_t has 32 bits (x)
     // Total: 32 × 32 × 4 bytes = 4 KB per leaf node
-    const int gridSize = 32; // 32x32x32 grid
-    const float voxelSize = node->size / static_cast<float>(gridSize);
-    const float halfVoxelSize = voxelSize * 0.5f;
-
-    // Initialize 2D array: 32 rows × 32 uint32_t per row
-    node->voxelGrid.clear();
-    node->voxelGrid.resize(gridSize);
-    for (int y = 0; y < gridSize; y++)
-    {
-        node->voxelGrid[y].resize(gridSize, 0);
-    }
-
+    const int gridSize = BRICK_SIZE; // 32x32x32 grid
+    const float voxelSize = node.size / static_cast<float>(gridSize);
+    uint32_t *brick = bricks_.brick(node.brick);
+
+    // Voxel center coordinates, computed exactly as the per-voxel test sees them
+    float centerX[BRICK_SIZE];
+    float centerY[BRICK_SIZE];
+    float centerZ[BRICK_SIZE];
+    for (int i = 0; i < gridSize; i++)
+    {
+        centerX[i] = node.center.x + ((i + 0.5f) * voxelSize - node.size);
+        centerY[i] = node.center.y + ((i + 0.5f) * voxelSize - node.size);
+        centerZ[i] = node.center.z + ((i + 0.5f) * voxelSize - node.size);
+    }
+
+    // A voxel is solid when |center| < surface radius. Within a block of 8^3 voxels the surface radius lies in
+    // [minRadius, maxRadius], so along a row (fixed y, z) the voxels with |center| < minRadius are solid and
+    // those with |center| >= maxRadius are empty. Both are x-intervals, found by solving
+    // x^2 + y^2 + z^2 = r^2 for the row; only the voxels in between are sampled one by one. The padding
+    // covers float rounding of the per-voxel test, so the result matches sampling every voxel.
+    std::fill(brick, brick + BRICK_WORDS, 0u);
+    const double firstX = centerX[0];
+    const double stepX = voxelSize;
+    const double blockReach = (VOXEL_BLOCK_SIZE - 1) * 0.5 * 1.7321 * voxelSize + 1.0; // Center to corner voxel
+    float planetMinRadius = 0.0f;
+    float planetMaxRadius = 0.0f;
+    getSurfaceRadiusBounds(glm::vec3(0.0f), maxRadius_, planetMinRadius, planetMaxRadius);
     bool hasSolidVoxel = false;
-    
-    // Sample 32x32x32 voxels, storing row by row
-    // Each row (y) contains 32 uint32_t (z), each uint32_t has 32 bits (x)
-    for (int y = 0; y < gridSize; y++)
+
+    for (int blockY = 0; blockY < gridSize; blockY += VOXEL_BLOCK_SIZE)
     {
-        for (int z = 0; z < gridSize; z++)
+        for (int blockZ = 0; blockZ < gridSize; blockZ += VOXEL_BLOCK_SIZE)
         {
-            uint32_t rowBits = 0;
-            
-            for (int x = 0; x < gridSize; x++)
+            for (int blockX = 0; blockX < gridSize; blockX += VOXEL_BLOCK_SIZE)
             {
-                // Calculate voxel center position
-                glm::vec3 offset;
-                offset.x = (x + 0.5f) * voxelSize - node->size;
-                offset.y = (y + 0.5f) * voxelSize - node->size;
-                offset.z = (z + 0.5f) * voxelSize - node->size;
-
-                glm::vec3 voxelCenter = node->center + offset;
-                
-                // Check if this voxel is solid
-                bool solid = isVoxelSolid(voxelCenter, voxelSize);
-                
-                // Set bit at x position (0-31) in the uint32_t
-                if (solid)
+                const int lastX = blockX + VOXEL_BLOCK_SIZE - 1;
+                const glm::vec3 blockCenter(0.5f * (centerX[blockX] + centerX[lastX]),
+                                            0.5f * (centerY[blockY] + centerY[blockY + VOXEL_BLOCK_SIZE - 1]),
+                                            0.5f * (centerZ[blockZ] + centerZ[blockZ + VOXEL_BLOCK_SIZE - 1]));
+                const uint32_t blockBits = 0xFFu << blockX;
+
+                // Most blocks lie wholly below or above the terrain: first against the planet-wide range,
+                // then against the range under the block
+                const double blockDist = glm::length(blockCenter);
+                float minRadius = planetMinRadius;
+                float maxRadius = planetMaxRadius;
+                int side = classifyVoxelBlock(blockDist, blockReach, minRadius, maxRadius);
+                if (side == 0)
+                {
+                    getSurfaceRadiusBounds(blockCenter, VOXEL_BLOCK_SIZE * 0.5f * voxelSize, minRadius, maxRadius);
+                    side = classifyVoxelBlock(blockDist, blockReach, minRadius, maxRadius);
+                }
+                if (side < 0)
                 {
-                    rowBits |= (1U << x);
+                    for (int y = blockY; y < blockY + VOXEL_BLOCK_SIZE; y++)
+                    {
+                        for (int z = blockZ; z < blockZ + VOXEL_BLOCK_SIZE; z++)
+                        {
+                            brick[y * gridSize + z] |= blockBits;
+                        }
+                    }
                     hasSolidVoxel = true;
+                    continue;
+                }
+                if (side > 0)
+                {
+                    continue;
+                }
+
+                const double padding = surfaceRadiusPadding(maxRadius);
+                const double solidRadius = minRadius - padding;
+                const double emptyRadius = maxRadius + padding;
+
+                for (int y = blockY; y < blockY + VOXEL_BLOCK_SIZE; y++)
+                {
+                    for (int z = blockZ; z < blockZ + VOXEL_BLOCK_SIZE; z++)
+                    {
+                        const double rowDistSq = static_cast<double>(centerY[y]) * centerY[y] +
+                                                 static_cast<double>(centerZ[z]) * centerZ[z];
+
+                        // Voxels strictly inside the solid interval, and every voxel touching the other one
+                        uint32_t solidBits = 0;
+                        uint32_t candidateBits = 0;
+                        if (solidRadius > 0.0 && solidRadius * solidRadius > rowDistSq)
+                        {
+                            const double halfChord = std::sqrt(solidRadius * solidRadius - rowDistSq);
+                            solidBits = voxelRangeBits(static_cast<int>(std::floor((-halfChord - firstX) / stepX)) + 1,
+                                                       static_cast<int>(std::ceil((halfChord - firstX) / stepX)) - 1);
+                        }
+                        if (emptyRadius * emptyRadius > rowDistSq)
+                        {
+                            const double halfChord = std::sqrt(emptyRadius * emptyRadius - rowDistSq);
+                            candidateBits = voxelRangeBits(static_cast<int>(std::floor((-halfChord - firstX) / stepX)),
+                                                           static_cast<int>(std::ceil((halfChord - firstX) / stepX)));
+                        }
+                        solidBits &= blockBits;
+                        candidateBits &= blockBits;
+
+                        // Sample the voxels near the surface
+                        const uint32_t uncertainBits = candidateBits & ~solidBits;
+                        for (int x = blockX; uncertainBits != 0 && x <= lastX; x++)
+                        {
+                            if (((uncertainBits >> x) & 1u) &&
+                                isVoxelSolid(glm::vec3(centerX[x], centerY[y], centerZ[z]), voxelSize))
+                            {
+                                solidBits |= 1u << x;
+                            }
+                        }
+
+                        brick[y * gridSize + z] |= solidBits;
+                        hasSolidVoxel = hasSolidVoxel || solidBits != 0;
+                    }
                 }
             }
-            
-            // Store the uint32_t for this (y, z) position
-            node->voxelGrid[y][z] = rowBits;
         }
     }
-    
+
     // Set isSolid based on whether any voxels are solid
-    node->isSolid = hasSolidVoxel;
+    node.isSolid = hasSolidVoxel;
 }
 
-bool PlanetOctree::queryVoxelBits(const OctreeNode *node, const glm::vec3 &localPos) const
+bool PlanetOctree::queryVoxelBits(const OctreeNode &node, const glm::vec3 &localPos) const
 {
-    if (!node || node->voxelGrid.empty())
+    if (node.brick == NO_INDEX)
     {
         // Fallback to isSolid if no grid stored
-        return node ? node->isSolid : false;
+        return node.isSolid;
     }
 
     // For 32x32x32 grid, determine which voxel this position falls into
-    const int gridSize = 32;
-    const float halfSize = node->size;
+    const int gridSize = BRICK_SIZE;
+    const float halfSize = node.size;
 
     // Convert local position to grid coordinates (0-31 range)
     // Position relative to node center, normalized to [0, 1] then scaled to [0, gridSize-1]
-    glm::vec3 normalizedPos = (localPos + glm::vec3(halfSize)) / (node->size * 2.0f);
-    
+    glm::vec3 normalizedPos = (localPos + glm::vec3(halfSize)) / (node.size * 2.0f);
+
     // Clamp to [0, 1] range and convert to integer grid coordinates
     normalizedPos.x = glm::clamp(normalizedPos.x, 0.0f, 1.0f);
     normalizedPos.y = glm::clamp(normalizedPos.y, 0.0f, 1.0f);
     normalizedPos.z = glm::clamp(normalizedPos.z, 0.0f, 1.0f);
-    
+
     // Convert to grid coordinates (0-31 for each axis)
     int gridX = static_cast<int>(normalizedPos.x * gridSize);
     int gridY = static_cast<int>(normalizedPos.y * gridSize);
     int gridZ = static_cast<int>(normalizedPos.z * gridSize);
-    
+
     // Clamp to valid grid range
     gridX = std::max(0, std::min(gridX, gridSize - 1));
     gridY = std::max(0, std::min(gridY, gridSize - 1));
     gridZ = std::max(0, std::min(gridZ, gridSize - 1));
 
     // Check the bit at (x, y, z) position
-    // voxelGrid[y][z] contains uint32_t with bits for x=0..31
-    return isVoxelSolidBitwise(node->voxelGrid, gridX, gridY, gridZ);
+    // brick[y * 32 + z] contains uint32_t with bits for x=0..31
+    return isVoxelSolidBitwise(bricks_.brick(node.brick), gridX, gridY, gridZ);
 }
 
-bool PlanetOctree::queryVoxelRecursive(const OctreeNode *node, const glm::vec3 &pos) const
+bool PlanetOctree::queryVoxel(const glm::vec3 &pos) const
 {
-    if (!node)
+    if (nodes_.empty())
     {
         return false;
     }
 
-    // Check if position is within this node's bounds
-    const float halfSize = node->size;
-    glm::vec3 nodeMin = node->center - glm::vec3(halfSize);
-    glm::vec3 nodeMax = node->center + glm::vec3(halfSize);
-
-    if (pos.x < nodeMin.x || pos.x > nodeMax.x ||
-        pos.y < nodeMin.y || pos.y > nodeMax.y ||
-        pos.z < nodeMin.z || pos.z > nodeMax.z)
+    // Check if position is within the root's bounds
+    const OctreeNode &root = nodes_[0];
+    const glm::vec3 rootMin = root.center - glm::vec3(root.size);
+    const glm::vec3 rootMax = root.center + glm::vec3(root.size);
+    if (pos.x < rootMin.x || pos.x > rootMax.x || pos.y < rootMin.y || pos.y > rootMax.y || pos.z < rootMin.z ||
+        pos.z > rootMax.z)
     {
-        return false; // Position outside this node
+        return false; // Position outside the octree
     }
 
-    if (node->isLeaf)
-    {
-        // Leaf node - query voxel bits
-        glm::vec3 localPos = pos - node->center;
-        return queryVoxelBits(node, localPos);
-    }
-    else
-    {
-        // Internal node - recurse into appropriate child
-        const float childSize = node->size * 0.5f;
-        glm::vec3 localPos = pos - node->center;
-        
-        // Determine which child contains this position
-        int childIndex = 0;
-        if (localPos.x >= 0.0f) childIndex |= 1;
-        if (localPos.y >= 0.0f) childIndex |= 2;
-        if (localPos.z >= 0.0f) childIndex |= 4;
+    // Locate the position on the grid of max-depth cells once; its Morton code then holds the
+    // child index for every level (one zyx digit per level, root level first)
+    const int cells = 1 << maxDepth_;
+    const float cellsPerUnit = static_cast<float>(cells) / (root.size * 2.0f);
+    auto cell = [&](float offset) {
+        return static_cast<uint32_t>(std::max(0, std::min(static_cast<int>(offset * cellsPerUnit), cells - 1)));
+    };
+    const uint32_t morton = mortonEncode3D(cell(pos.x - rootMin.x), cell(pos.y - rootMin.y), cell(pos.z - rootMin.z));
 
-        if (node->children[childIndex])
+    uint32_t nodeIndex = 0;
+    while (true)
+    {
+        const OctreeNode &node = nodes_[nodeIndex];
+        if (node.isLeaf || node.depth >= maxDepth_)
         {
-            return queryVoxelRecursive(node->children[childIndex].get(), pos);
+            // Leaf node - query voxel bits
+            return queryVoxelBits(node, pos - node.center);
         }
-        else
+
+        // Internal node - descend into the child containing this position
+        const int child = static_cast<int>((morton >> (3 * (maxDepth_ - 1 - node.depth))) & 7u);
+        if (!node.hasChild(child))
         {
             // Child doesn't exist - return false (empty)
             return false;
         }
+        nodeIndex = node.childIndex(child);
     }
 }
 
-bool PlanetOctree::queryVoxel(const glm::vec3 &pos) const
+size_t PlanetOctree::getVoxelDataSize() const
+{
+    // Every brick in the pool belongs to one leaf: 32 rows × 32 uint32_t × 4 bytes = 4 KB per leaf node
+    // (for a mapped file, only the bricks decoded so far)
+    return bricks_.byteSize();
+}
+
+bool PlanetOctree::deserializeNodes(std::istream &in)
 {
-    if (!root_)
+    // Read every record (bricks go straight into a new pool, in file order)
+    std::vector<FileNode> fileNodes;
+    BrickPool bricks;
+    if (!readFileNode(in, fileNodes, bricks, 0))
     {
         return false;
     }
-    return queryVoxelRecursive(root_.get(), pos);
-}
 
-size_t PlanetOctree::getVoxelDataSize() const
-{
-    size_t totalSize = 0;
-    std::function<void(const OctreeNode *)> countSize = [&](const OctreeNode *node) {
-        if (!node)
-        {
-            return;
-        }
-        // Count size of voxel grid: 32 rows × 32 uint32_t × 4 bytes = 4 KB per leaf node
-        if (!node->voxelGrid.empty())
-        {
-            totalSize += node->voxelGrid.size() * node->voxelGrid[0].size() * sizeof(uint32_t);
-        }
-        if (!node->isLeaf)
+    // Lay the nodes out level by level, each child block contiguous and in child order
+    std::vector<OctreeNode> nodes;
+    std::vector<uint32_t> source; // File node of each laid-out node
+    nodes.reserve(fileNodes.size());
+    source.reserve(fileNodes.size());
+    nodes.push_back(fileNodes[0].node);
+    nodes[0].mortonKey = 1u;
+    source.push_back(0);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const FileNode &fileNode = fileNodes[source[i]];
+        const uint32_t parentKey = nodes[i].mortonKey;
+        const uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+        uint8_t childMask = 0;
+        for (int child = 0; child < 8; child++)
         {
-            for (const auto &child : node->children)
+            if (fileNode.children[child] == NO_INDEX)
             {
-                if (child)
-                {
-                    countSize(child.get());
-                }
+                continue;
             }
+            nodes.push_back(fileNodes[fileNode.children[child]].node);
+            nodes.back().mortonKey = childMortonKey(parentKey, child);
+            source.push_back(fileNode.children[child]);
+            childMask |= static_cast<uint8_t>(1u << child);
         }
-    };
-    countSize(root_.get());
-    return totalSize;
+        nodes[i].childMask = childMask;
+        nodes[i].firstChild = childMask != 0 ? firstChild : NO_INDEX;
+    }
+
+    nodes_.swap(nodes);
+    bricks_ = std::move(bricks);
+    invalidateMeshChunks();
+    return true;
 }
 
-void PlanetOctree::serializeNode(std::ostream &out, const OctreeNode *node) const
+bool PlanetOctree::mapFile(std::unique_ptr<MappedFile> file, const std::string &filepath)
 {
-    // Write node data
-    out.write(reinterpret_cast<const char *>(&node->center), sizeof(glm::vec3));
-    out.write(reinterpret_cast<const char *>(&node->size), sizeof(float));
-    out.write(reinterpret_cast<const char *>(&node->depth), sizeof(int));
-    out.write(reinterpret_cast<const char *>(&node->isLeaf), sizeof(bool));
-    out.write(reinterpret_cast<const char *>(&node->isSolid), sizeof(bool));
-
-    // Write voxel grid (32x32 array of uint32_t = 4 KB)
-    size_t gridRows = node->voxelGrid.size();
-    out.write(reinterpret_cast<const char *>(&gridRows), sizeof(size_t));
-    for (size_t y = 0; y < gridRows; y++)
+    const uint8_t *bytes = file->data();
+    const uint64_t size = file->size();
+    FileHeader header;
+    if (size < sizeof(FileHeader))
     {
-        size_t rowSize = node->voxelGrid[y].size();
-        out.write(reinterpret_cast<const char *>(&rowSize), sizeof(size_t));
-        if (!node->voxelGrid[y].empty())
-        {
-            out.write(reinterpret_cast<const char *>(node->voxelGrid[y].data()), rowSize * sizeof(uint32_t));
-        }
+        std::cerr << "ERROR: Invalid octree file header: " << filepath << "\n";
+        return false;
     }
+    std::memcpy(&header, bytes, sizeof(FileHeader));
 
-    // Write children recursively
-    for (int i = 0; i < 8; i++)
+    // Tables must lie within the file; 64-bit sums cannot overflow for 32-bit counts
+    const uint64_t nodeTableEnd = header.nodeTableOffset + static_cast<uint64_t>(header.nodeCount) * sizeof(OctreeNode);
+    const uint64_t brickTableEnd =
+        header.brickTableOffset + static_cast<uint64_t>(header.brickCount) * sizeof(BrickRecord);
+    if (header.fileSize != size || header.nodeRecordSize != sizeof(OctreeNode) || header.maxDepth < 0 ||
+        header.maxDepth > MAX_OCTREE_DEPTH || header.nodeCount == 0 || header.nodeTableOffset > size ||
+        nodeTableEnd > size || header.brickTableOffset > size || brickTableEnd > size ||
+        header.brickDataOffset > size)
     {
-        bool childExists = (node->children[i] != nullptr);
-        out.write(reinterpret_cast<const char *>(&childExists), sizeof(bool));
-        if (childExists)
-        {
-            serializeNode(out, node->children[i].get());
-        }
+        std::cerr << "ERROR: Invalid octree file header: " << filepath << "\n";
+        return false;
     }
-}
-
-void PlanetOctree::deserializeNode(std::istream &in, OctreeNode *node)
-{
-    // Read node data
-    in.read(reinterpret_cast<char *>(&node->center), sizeof(glm::vec3));
-    in.read(reinterpret_cast<char *>(&node->size), sizeof(float));
-    in.read(reinterpret_cast<char *>(&node->depth), sizeof(int));
-    in.read(reinterpret_cast<char *>(&node->isLeaf), sizeof(bool));
-    in.read(reinterpret_cast<char *>(&node->isSolid), sizeof(bool));
 
-    // Read voxel grid (32x32 array of uint32_t = 4 KB)
-    size_t gridRows = 0;
-    in.read(reinterpret_cast<char *>(&gridRows), sizeof(size_t));
-    node->voxelGrid.clear();
-    node->voxelGrid.resize(gridRows);
-    for (size_t y = 0; y < gridRows; y++)
+    // Node table: check the flags and links before anything walks them
+    std::vector<OctreeNode> nodes(header.nodeCount);
+    for (uint32_t i = 0; i < header.nodeCount; i++)
     {
-        size_t rowSize = 0;
-        in.read(reinterpret_cast<char *>(&rowSize), sizeof(size_t));
-        node->voxelGrid[y].resize(rowSize);
-        if (!node->voxelGrid[y].empty())
+        const uint8_t *record = bytes + header.nodeTableOffset + static_cast<uint64_t>(i) * sizeof(OctreeNode);
+        if (record[offsetof(OctreeNode, isLeaf)] > 1 || record[offsetof(OctreeNode, isSolid)] > 1)
+        {
+            std::cerr << "ERROR: Truncated or corrupt octree file: " << filepath << "\n";
+            return false;
+        }
+        std::memcpy(&nodes[i], record, sizeof(OctreeNode));
+
+        const OctreeNode &node = nodes[i];
+        const bool linksValid = node.childMask != 0
+                                    ? node.firstChild > i && node.firstChild < header.nodeCount &&
+                                          node.childCount() <= header.nodeCount - node.firstChild
+                                    : node.firstChild == NO_INDEX;
+        if (!linksValid || node.depth > header.maxDepth ||
+            (node.brick != NO_INDEX && node.brick >= header.brickCount))
         {
-            in.read(reinterpret_cast<char *>(node->voxelGrid[y].data()), rowSize * sizeof(uint32_t));
+            std::cerr << "ERROR: Truncated or corrupt octree file: " << filepath << "\n";
+            return false;
         }
     }
 
-    // Read children recursively
-    for (int i = 0; i < 8; i++)
+    // Brick table: every record's data within the brick data (the data itself is decoded on demand)
+    const uint8_t *brickTable = bytes + header.brickTableOffset;
+    const uint64_t brickDataSize = size - header.brickDataOffset;
+    for (uint32_t i = 0; i < header.brickCount; i++)
     {
-        // Check if child exists
-        bool childExists = false;
-        in.read(reinterpret_cast<char *>(&childExists), sizeof(bool));
-        if (childExists)
+        BrickRecord record;
+        std::memcpy(&record, brickTable + static_cast<size_t>(i) * sizeof(BrickRecord), sizeof(BrickRecord));
+        const bool uniform = record.encoding == BRICK_EMPTY || record.encoding == BRICK_SOLID;
+        const uint64_t dataBytes = static_cast<uint64_t>(record.wordCount) * sizeof(uint32_t);
+        if (record.encoding > BRICK_RAW || (uniform && record.wordCount != 0) || record.offset > brickDataSize ||
+            dataBytes > brickDataSize - record.offset)
         {
-            // Create child node (we'll read its data in the recursive call)
-            glm::vec3 childCenter;
-            float childSize;
-            int childDepth;
-            in.read(reinterpret_cast<char *>(&childCenter), sizeof(glm::vec3));
-            in.read(reinterpret_cast<char *>(&childSize), sizeof(float));
-            in.read(reinterpret_cast<char *>(&childDepth), sizeof(int));
-
-            node->children[i] = std::make_unique<OctreeNode>(childCenter, childSize, childDepth);
-            deserializeNode(in, node->children[i].get());
+            std::cerr << "ERROR: Truncated or corrupt octree file: " << filepath << "\n";
+            return false;
         }
     }
+
+    nodes_.swap(nodes);
+    bricks_.attachFile(std::move(file), brickTable, bytes + header.brickDataOffset, header.brickCount);
+    baseRadius_ = header.baseRadius;
+    maxRadius_ = header.maxRadius;
+    maxDepth_ = header.maxDepth;
+    invalidateMeshChunks();
+    return true;
 }
 
 bool PlanetOctree::serializeToFile(const std::string &filepath) const
 {
     try
     {
-        std::ofstream out(filepath, std::ios::binary);
+        // Encode the bricks first: the brick table needs every record's offset
+        const uint32_t brickCount = static_cast<uint32_t>(bricks_.brickCount());
+        std::vector<BrickRecord> brickTable(brickCount);
+        std::vector<uint32_t> brickData;
+        for (uint32_t i = 0; i < brickCount; i++)
+        {
+            const size_t start = brickData.size();
+            brickTable[i].encoding = encodeBrick(bricks_.brick(i), brickData);
+            brickTable[i].offset = start * sizeof(uint32_t);
+            brickTable[i].wordCount = static_cast<uint32_t>(brickData.size() - start);
+        }
+
+        FileHeader header{};
+        header.version = FILE_VERSION;
+        header.baseRadius = baseRadius_;
+        header.maxRadius = maxRadius_;
+        header.maxDepth = maxDepth_;
+        header.nodeCount = static_cast<uint32_t>(nodes_.size());
+        header.brickCount = brickCount;
+        header.nodeRecordSize = sizeof(OctreeNode);
+        header.nodeTableOffset = sizeof(FileHeader);
+        header.brickTableOffset = header.nodeTableOffset + nodes_.size() * sizeof(OctreeNode);
+        header.brickDataOffset = header.brickTableOffset + brickTable.size() * sizeof(BrickRecord);
+        header.fileSize = header.brickDataOffset + brickData.size() * sizeof(uint32_t);
+
+        // Write next to the target and rename over it, so a reader (or this octree's own mapping of the
+        // file) never sees a partial file
+        const std::string tempPath = filepath + ".tmp";
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
         if (!out.is_open())
         {
-            std::cerr << "ERROR: Failed to open file for writing: " << filepath << "\n";
+            std::cerr << "ERROR: Failed to open file for writing: " << tempPath << "\n";
             return false;
         }
+        out.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader));
+        out.write(reinterpret_cast<const char *>(nodes_.data()), nodes_.size() * sizeof(OctreeNode));
+        out.write(reinterpret_cast<const char *>(brickTable.data()), brickTable.size() * sizeof(BrickRecord));
+        out.write(reinterpret_cast<const char *>(brickData.data()), brickData.size() * sizeof(uint32_t));
+        out.close();
 
-        // Write header: version, baseRadius, maxRadius, maxDepth
-        const uint32_t VERSION = 1;
-        out.write(reinterpret_cast<const char *>(&VERSION), sizeof(uint32_t));
-        out.write(reinterpret_cast<const char *>(&baseRadius_), sizeof(float));
-        out.write(reinterpret_cast<const char *>(&maxRadius_), sizeof(float));
-        out.write(reinterpret_cast<const char *>(&maxDepth_), sizeof(int));
-
-        // Serialize root node (includes center, size, depth, isLeaf, isSolid, voxelBits, children)
-        if (root_)
+        std::error_code error;
+        if (out.fail())
         {
-            serializeNode(out, root_.get());
+            std::cerr << "ERROR: Failed to write octree file: " << tempPath << "\n";
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        std::filesystem::rename(tempPath, filepath, error);
+        if (error)
+        {
+            std::cerr << "ERROR: Failed to replace " << filepath << ": " << error.message() << "\n";
+            std::filesystem::remove(tempPath, error);
+            return false;
         }
-
-        out.close();
         return true;
     }
     catch (const std::exception &e)
@@ -2261,6 +2992,19 @@ bool PlanetOctree::deserializeFromFile(const std::string &filepath)
 {
     try
     {
+        // Version 2 files are used in place through a mapping
+        auto file = std::make_unique<MappedFile>();
+        if (file->open(filepath) && file->size() >= sizeof(uint32_t))
+        {
+            uint32_t version = 0;
+            std::memcpy(&version, file->data(), sizeof(uint32_t));
+            if (version == FILE_VERSION)
+            {
+                return mapFile(std::move(file), filepath);
+            }
+        }
+        file.reset();
+
         std::ifstream in(filepath, std::ios::binary);
         if (!in.is_open())
         {
@@ -2277,25 +3021,27 @@ bool PlanetOctree::deserializeFromFile(const std::string &filepath)
             return false;
         }
 
-        in.read(reinterpret_cast<char *>(&baseRadius_), sizeof(float));
-        in.read(reinterpret_cast<char *>(&maxRadius_), sizeof(float));
-        in.read(reinterpret_cast<char *>(&maxDepth_), sizeof(int));
-
-        // Deserialize root node
-        if (!root_)
+        float baseRadius = 0.0f;
+        float maxRadius = 0.0f;
+        int maxDepth = 0;
+        in.read(reinterpret_cast<char *>(&baseRadius), sizeof(float));
+        in.read(reinterpret_cast<char *>(&maxRadius), sizeof(float));
+        in.read(reinterpret_cast<char *>(&maxDepth), sizeof(int));
+        if (!in || maxDepth < 0 || maxDepth > MAX_OCTREE_DEPTH)
         {
-            // Read root node center, size, depth first
-            glm::vec3 rootCenter;
-            float rootSize;
-            int rootDepth;
-            in.read(reinterpret_cast<char *>(&rootCenter), sizeof(glm::vec3));
-            in.read(reinterpret_cast<char *>(&rootSize), sizeof(float));
-            in.read(reinterpret_cast<char *>(&rootDepth), sizeof(int));
+            std::cerr << "ERROR: Invalid octree file header: " << filepath << "\n";
+            return false;
+        }
 
-            root_ = std::make_unique<OctreeNode>(rootCenter, rootSize, rootDepth);
+        // Deserialize all nodes, starting with the root record
+        if (!deserializeNodes(in))
+        {
+            std::cerr << "ERROR: Truncated or corrupt octree file: " << filepath << "\n";
+            return false;
         }
-        // Now deserialize the rest of the root node (isLeaf, isSolid, voxelBits, children)
-        deserializeNode(in, root_.get());
+        baseRadius_ = baseRadius;
+        maxRadius_ = maxRadius;
+        maxDepth_ = maxDepth;
 
         in.close();
         return true;
@@ -2312,14 +3058,14 @@ void PlanetOctree::extractGreedyMesh(std::vector<MeshVertex> &vertices, std::vec
     vertices.clear();
     indices.clear();
 
-    if (!root_)
+    if (nodes_.empty())
     {
         std::cerr << "WARNING: PlanetOctree::extractGreedyMesh() - Root node is null!" << "\n";
         return;
     }
 
     // Collect all leaf nodes with voxel data
-    std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> voxelNodes;
+    std::vector<VoxelBrickRef> voxelNodes;
     collectVoxelData(voxelNodes);
 
     if (voxelNodes.empty())
@@ -2334,22 +3080,17 @@ void PlanetOctree::extractGreedyMesh(std::vector<MeshVertex> &vertices, std::vec
     std::vector<std::vector<unsigned int>> axisIndices(3);
     std::vector<unsigned int> axisBaseIndices(3, 0);
 
-    // Process each axis in parallel
-    const unsigned int numThreads = std::min(3u, std::thread::hardware_concurrency());
-    std::vector<std::thread> threads;
-    
+    // Process each axis as its own task
+    TaskScheduler &scheduler = TaskScheduler::shared();
+    TaskScheduler::TaskGroup axisGroup;
+    const float voxelSize = brickVoxelSize();
     for (int axis = 0; axis < 3; axis++)
     {
-        threads.emplace_back([&, axis]() {
-            greedyMeshAxis(voxelNodes, axis, axisVertices[axis], axisIndices[axis], axisBaseIndices[axis]);
+        scheduler.submit(axisGroup, [&, axis]() {
+            greedyMeshAxis(voxelNodes, voxelSize, axis, axisVertices[axis], axisIndices[axis], axisBaseIndices[axis]);
         });
     }
-
-    // Wait for all threads
-    for (auto& thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait(axisGroup);
 
     // Combine results from all axes
     for (int axis = 0; axis < 3; axis++)
@@ -2365,52 +3106,52 @@ void PlanetOctree::extractGreedyMesh(std::vector<MeshVertex> &vertices, std::vec
     }
 }
 
-void PlanetOctree::collectVoxelData(std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes) const
+void PlanetOctree::collectVoxelData(std::vector<VoxelBrickRef> &voxelNodes) const
 {
     voxelNodes.clear();
-    collectVoxelDataRecursive(root_.get(), voxelNodes);
+    if (!nodes_.empty())
+    {
+        collectVoxelDataRecursive(getRoot(), voxelNodes);
+    }
 }
 
 void PlanetOctree::collectVoxelDataRecursive(const OctreeNode *node,
-                                             std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes) const
+                                             std::vector<VoxelBrickRef> &voxelNodes) const
 {
     if (!node)
     {
         return;
     }
 
-    if (node->isLeaf && node->depth == maxDepth_ && !node->voxelGrid.empty())
+    if (node->isLeaf && node->depth == maxDepth_ && node->brick != NO_INDEX)
     {
         // This is a leaf node at max depth with voxel grid
-        // Store the node center and pointer to voxel grid for greedy meshing
-        voxelNodes.push_back({node->center, &node->voxelGrid});
+        // Store the node center and pointer to its brick for greedy meshing
+        voxelNodes.push_back({node->center, bricks_.brick(node->brick)});
     }
     else if (!node->isLeaf)
     {
         // Recurse into children
-        for (const auto &child : node->children)
+        for (uint32_t i = 0; i < node->childCount(); i++)
         {
-            if (child)
-            {
-                collectVoxelDataRecursive(child.get(), voxelNodes);
-            }
+            collectVoxelDataRecursive(&nodes_[node->firstChild + i], voxelNodes);
         }
     }
 }
 
-void PlanetOctree::collectVoxelDataWithDistance(std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+void PlanetOctree::collectVoxelDataWithDistance(std::vector<VoxelBrickRef> &voxelNodes,
                                                 const glm::vec3 &referencePoint,
                                                 float maxDistance) const
 {
     voxelNodes.clear();
-    if (root_)
+    if (!nodes_.empty())
     {
-        collectVoxelDataWithDistanceRecursive(root_.get(), voxelNodes, referencePoint, maxDistance);
+        collectVoxelDataWithDistanceRecursive(getRoot(), voxelNodes, referencePoint, maxDistance);
     }
 }
 
 void PlanetOctree::collectVoxelDataWithDistanceRecursive(const OctreeNode *node,
-                                                         std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+                                                         std::vector<VoxelBrickRef> &voxelNodes,
                                                          const glm::vec3 &referencePoint,
                                                          float maxDistance) const
 {
@@ -2432,40 +3173,66 @@ void PlanetOctree::collectVoxelDataWithDistanceRecursive(const OctreeNode *node,
         return;
     }
 
-    if (node->isLeaf && !node->voxelGrid.empty())
+    if (node->isLeaf && node->brick != NO_INDEX)
     {
         // This is a leaf node with voxel grid
         // Only include if within distance
         if (distanceToNode <= maxDistance + nodeRadius)
         {
-            voxelNodes.push_back({node->center, &node->voxelGrid});
+            voxelNodes.push_back({node->center, bricks_.brick(node->brick)});
         }
     }
     else if (!node->isLeaf)
     {
         // Recurse into children
-        for (const auto &child : node->children)
+        for (uint32_t i = 0; i < node->childCount(); i++)
         {
-            if (child)
-            {
-                collectVoxelDataWithDistanceRecursive(child.get(), voxelNodes, referencePoint, maxDistance);
-            }
+            collectVoxelDataWithDistanceRecursive(&nodes_[node->firstChild + i],
+                                                  voxelNodes,
+                                                  referencePoint,
+                                                  maxDistance);
+        }
+    }
+}
+
+void PlanetOctree::collectBrickNodesWithDistance(uint32_t nodeIndex,
+                                                 std::vector<uint32_t> &brickNodes,
+                                                 const glm::vec3 &referencePoint,
+                                                 float maxDistance) const
+{
+    const OctreeNode &node = nodes_[nodeIndex];
+    const float distanceToNode = glm::length(node.center - referencePoint);
+    const float nodeRadius = node.size * 0.866f;
+    if (distanceToNode - nodeRadius > maxDistance)
+    {
+        return;
+    }
+
+    if (node.isLeaf && node.brick != NO_INDEX)
+    {
+        brickNodes.push_back(nodeIndex);
+    }
+    else if (!node.isLeaf)
+    {
+        for (uint32_t i = 0; i < node.childCount(); i++)
+        {
+            collectBrickNodesWithDistance(node.firstChild + i, brickNodes, referencePoint, maxDistance);
         }
     }
 }
 
-void PlanetOctree::collectVoxelDataAtDepth(std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+void PlanetOctree::collectVoxelDataAtDepth(std::vector<VoxelBrickRef> &voxelNodes,
                                            int targetDepth) const
 {
     voxelNodes.clear();
-    if (root_)
+    if (!nodes_.empty())
     {
-        collectVoxelDataAtDepthRecursive(root_.get(), voxelNodes, targetDepth);
+        collectVoxelDataAtDepthRecursive(getRoot(), voxelNodes, targetDepth);
     }
 }
 
 void PlanetOctree::collectVoxelDataAtDepthRecursive(const OctreeNode *node,
-                                                    std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+                                                    std::vector<VoxelBrickRef> &voxelNodes,
                                                     int targetDepth) const
 {
     if (!node)
@@ -2473,47 +3240,36 @@ void PlanetOctree::collectVoxelDataAtDepthRecursive(const OctreeNode *node,
         return;
     }
 
-    if (node->depth == targetDepth && node->isLeaf && !node->voxelGrid.empty())
+    if (node->depth == targetDepth && node->isLeaf && node->brick != NO_INDEX)
     {
         // This is a node at target depth with voxel grid
-        voxelNodes.push_back({node->center, &node->voxelGrid});
+        voxelNodes.push_back({node->center, bricks_.brick(node->brick)});
     }
     else if (!node->isLeaf)
     {
         // Recurse into children
-        for (const auto &child : node->children)
+        for (uint32_t i = 0; i < node->childCount(); i++)
         {
-            if (child)
-            {
-                collectVoxelDataAtDepthRecursive(child.get(), voxelNodes, targetDepth);
-            }
+            collectVoxelDataAtDepthRecursive(&nodes_[node->firstChild + i], voxelNodes, targetDepth);
         }
     }
 }
 
-bool PlanetOctree::isVoxelSolidBitwise(const std::vector<std::vector<uint32_t>> &voxelGrid, int x, int y, int z) const
+bool PlanetOctree::isVoxelSolidBitwise(const uint32_t *brick, int x, int y, int z) const
 {
     // Check bit at (x, y, z) position
-    // voxelGrid[y][z] contains uint32_t with bits for x=0..31
+    // brick[y * 32 + z] contains uint32_t with bits for x=0..31
     // Clamp coordinates to valid range
-    if (y < 0 || y >= static_cast<int>(voxelGrid.size()))
-    {
-        return false;
-    }
-    if (z < 0 || z >= static_cast<int>(voxelGrid[y].size()))
+    if (x < 0 || x >= BRICK_SIZE || y < 0 || y >= BRICK_SIZE || z < 0 || z >= BRICK_SIZE)
     {
         return false;
     }
-    if (x < 0 || x >= 32)
-    {
-        return false;
-    }
-    
-    uint32_t rowBits = voxelGrid[y][z];
+
+    uint32_t rowBits = brick[y * BRICK_SIZE + z];
     return (rowBits & (1U << x)) != 0;
 }
 
-bool PlanetOctree::getNeighborVoxel(const std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+bool PlanetOctree::getNeighborVoxel(const std::vector<VoxelBrickRef> &voxelNodes,
                                      const glm::vec3 &pos,
                                      int axis,
                                      int direction,
@@ -2548,7 +3304,7 @@ bool PlanetOctree::getNeighborVoxel(const std::vector<std::pair<glm::vec3, const
             gridY = std::max(0, std::min(gridY, 31));
             gridZ = std::max(0, std::min(gridZ, 31));
             
-            return isVoxelSolidBitwise(*voxelNode.second, gridX, gridY, gridZ);
+            return isVoxelSolidBitwise(voxelNode.second, gridX, gridY, gridZ);
         }
     }
     
@@ -2556,7 +3312,8 @@ bool PlanetOctree::getNeighborVoxel(const std::vector<std::pair<glm::vec3, const
     return false;
 }
 
-void PlanetOctree::greedyMeshAxis(const std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+void PlanetOctree::greedyMeshAxis(const std::vector<VoxelBrickRef> &voxelNodes,
+                                  float voxelSize,
                                   int axis,
                                   std::vector<MeshVertex> &vertices,
                                   std::vector<unsigned int> &indices,
@@ -2567,21 +3324,11 @@ void PlanetOctree::greedyMeshAxis(const std::vector<std::pair<glm::vec3, const s
         return;
     }
 
-    // Calculate voxel size from first node (assuming uniform size)
-    float voxelSize = 0.0f;
-    if (!voxelNodes.empty())
-    {
-        // Estimate voxel size from node spacing or use a fixed size based on depth
-        // For now, use a heuristic: size decreases with depth
-        // Each node contains 32x32x32 voxels
-        voxelSize = root_->size / static_cast<float>(1 << maxDepth_) / 32.0f;
-    }
-
     // For each voxel node, check each voxel in its 32x32x32 grid
     for (const auto &voxelNode : voxelNodes)
     {
         const glm::vec3 &nodeCenter = voxelNode.first;
-        const std::vector<std::vector<uint32_t>> &voxelGrid = *voxelNode.second;
+        const uint32_t *brick = voxelNode.second;
         const float nodeSize = voxelSize * 32.0f; // Node contains 32x32x32 voxels
 
         // Check each voxel in the 32x32x32 grid
@@ -2592,7 +3339,7 @@ void PlanetOctree::greedyMeshAxis(const std::vector<std::pair<glm::vec3, const s
                 for (int x = 0; x < 32; x++)
                 {
                     // Check if this voxel is solid using bitwise operation
-                    if (!isVoxelSolidBitwise(voxelGrid, x, y, z))
+                    if (!isVoxelSolidBitwise(brick, x, y, z))
                     {
                         continue; // Skip empty voxels
                     }
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // ============================================================================
@@ -15,6 +17,8 @@
 // heightmap, determining voxel occupancy based on whether points are above or
 // below the average radius (with heightmap offsets).
 
+class MappedFile;
+
 namespace EarthVoxelOctree
 {
 
@@ -112,34 +116,159 @@ inline void mortonToGrid(uint32_t morton, int &x, int &y, int &z)
     z = static_cast<int>(zu);
 }
 
-// Octree node structure
+// ============================================================================
+// Linear Octree Storage
+// ============================================================================
+// The octree is stored without pointers: every node lives in one array, and the
+// existing children of a node sit next to each other in child (Morton digit) order
+// starting at firstChild. Child i exists if bit i of childMask is set; its index is
+// firstChild + the number of lower set bits. Each node is keyed by its locational
+// code: a leading 1 bit followed by one Morton digit (zyx) per level, so the key of
+// a node at depth d with integer coordinates (x, y, z) in [0, 2^d) is
+// (1 << 3d) | mortonEncode3D(x, y, z). Built trees list the nodes level by level,
+// in key order within each level.
+//
+// The 32x32x32 voxel bricks of max-depth leaves are not owned by the nodes: they
+// are slices of one pooled arena (BrickPool), referenced by brick index.
+
+constexpr uint32_t NO_INDEX = 0xFFFFFFFFu; // No child block / no brick
+constexpr int MAX_OCTREE_DEPTH = 10;       // Locational codes are 1 + 3 bits per level in 32 bits
+
+// Brick layout: BRICK_SIZE^2 words, word [y * BRICK_SIZE + z] holds the bits for x = 0..31
+constexpr int BRICK_SIZE = 32;
+constexpr size_t BRICK_WORDS = static_cast<size_t>(BRICK_SIZE) * BRICK_SIZE; // 4 KB per brick
+
+// Locational code of child `child` (0-7, bits x=1 y=2 z=4) of the node with key `parentKey`
+inline uint32_t childMortonKey(uint32_t parentKey, int child)
+{
+    return (parentKey << 3) | static_cast<uint32_t>(child);
+}
+
+// Position of child `child` within its parent's child block (number of existing lower children)
+inline uint32_t childSlot(uint8_t childMask, int child)
+{
+    uint32_t v = childMask & ((1u << child) - 1u);
+    v = v - ((v >> 1) & 0x55u);
+    v = (v & 0x33u) + ((v >> 2) & 0x33u);
+    return (v + (v >> 4)) & 0x0Fu;
+}
+
+// Octree node structure (32 bytes, one entry of the node array)
 struct OctreeNode
 {
-    glm::vec3 center;                                    // Center of this node's bounding box
-    float size;                                          // Size of this node's bounding box (half-extent)
-    int depth;                                           // Depth in the octree (0 = root)
-    bool isLeaf;                                         // True if this is a leaf node
-    bool isSolid;                                        // True if this voxel is solid (inside planet)
-    std::array<std::unique_ptr<OctreeNode>, 8> children; // 8 child nodes
-    
-    // Bit-packed voxel storage for leaf nodes at max depth
-    // 32x32x32 voxel grid stored as 2D array: 32 rows × 32 uint32_t per row
-    // Each uint32_t represents 32 voxels in a row (1 bit per voxel)
-    // Total: 32 × 32 × 4 bytes = 4 KB per leaf node
-    // Voxels are stored row by row: row[y][z] contains 32 bits for x=0..31
-    std::vector<std::vector<uint32_t>> voxelGrid; // 2D array: [32 rows][32 uint32_t] = 4 KB
-
-    OctreeNode(const glm::vec3 &center_, float size_, int depth_)
-        : center(center_), size(size_), depth(depth_), isLeaf(true), isSolid(false)
+    glm::vec3 center;    // Center of this node's bounding box
+    float size;          // Size of this node's bounding box (half-extent)
+    uint32_t mortonKey;  // Locational code (see above)
+    uint32_t firstChild; // Index of the first existing child in the node array (NO_INDEX if none)
+    uint32_t brick;      // Index of the 32x32x32 voxel brick in the brick pool (NO_INDEX if none)
+    uint8_t depth;       // Depth in the octree (0 = root)
+    uint8_t childMask;   // Bit i set if child i exists
+    bool isLeaf;         // True if this is a leaf node
+    bool isSolid;        // True if this voxel is solid (inside planet)
+
+    OctreeNode() = default;
+    OctreeNode(const glm::vec3 &center_, float size_, int depth_, uint32_t mortonKey_)
+        : center(center_), size(size_), mortonKey(mortonKey_), firstChild(NO_INDEX), brick(NO_INDEX),
+          depth(static_cast<uint8_t>(depth_)), childMask(0), isLeaf(true), isSolid(false)
+    {
+    }
+
+    uint32_t childCount() const
+    {
+        return childSlot(childMask, 8);
+    }
+
+    bool hasChild(int child) const
+    {
+        return (childMask >> child) & 1u;
+    }
+
+    // Array index of child `child` (which must exist)
+    uint32_t childIndex(int child) const
+    {
+        return firstChild + childSlot(childMask, child);
+    }
+};
+
+// Pooled storage for voxel bricks: one contiguous arena of BRICK_WORDS words per brick
+// instead of separately allocated rows per node.
+// A pool loaded from a version 2 octree file instead keeps the file mapped and decodes each
+// brick on its first const access, so only visited bricks take memory (uniform bricks none).
+class BrickPool
+{
+public:
+    BrickPool();
+    ~BrickPool();
+    BrickPool(BrickPool &&other) noexcept;
+    BrickPool &operator=(BrickPool &&other) noexcept;
+    BrickPool(const BrickPool &) = delete;
+    BrickPool &operator=(const BrickPool &) = delete;
+
+    // Append `count` zeroed bricks, returning the index of the first (in-memory pools only)
+    uint32_t allocate(uint32_t count = 1)
+    {
+        uint32_t first = static_cast<uint32_t>(brickCount());
+        words_.resize(words_.size() + count * BRICK_WORDS, 0);
+        return first;
+    }
+
+    void reserve(size_t bricks)
+    {
+        words_.reserve(bricks * BRICK_WORDS);
+    }
+
+    // Drop every brick (and the file mapping, if any)
+    void clear();
+
+    // Writable brick (in-memory pools only)
+    uint32_t *brick(uint32_t index)
+    {
+        return words_.data() + index * BRICK_WORDS;
+    }
+
+    // Brick contents; decoded from the file on first access for mapped pools (thread-safe)
+    const uint32_t *brick(uint32_t index) const
     {
-        // Initialize all children to nullptr (unique_ptr is move-only, can't use fill())
-        for (int i = 0; i < 8; i++)
+        if (!file_)
         {
-            children[i] = nullptr;
+            return words_.data() + index * BRICK_WORDS;
         }
+        const uint32_t *words = resident_[index].load(std::memory_order_acquire);
+        return words ? words : loadBrick(index);
+    }
+
+    size_t brickCount() const
+    {
+        return file_ ? mappedCount_ : words_.size() / BRICK_WORDS;
+    }
+
+    // Bytes of brick data held in memory (for mapped pools, the bricks decoded so far)
+    size_t byteSize() const
+    {
+        return words_.size() * sizeof(uint32_t) + residentBytes_.load(std::memory_order_relaxed);
     }
+
+    // Serve `count` bricks from a mapped version 2 octree file. `table` is the file's brick table
+    // and `data` the start of its brick data (see voxel-octree.cpp)
+    void attachFile(std::unique_ptr<MappedFile> file, const uint8_t *table, const uint8_t *data, uint32_t count);
+
+private:
+    const uint32_t *loadBrick(uint32_t index) const;
+
+    std::vector<uint32_t> words_;
+
+    // Mapped pools
+    std::unique_ptr<MappedFile> file_;
+    const uint8_t *table_ = nullptr;
+    const uint8_t *data_ = nullptr;
+    size_t mappedCount_ = 0;
+    std::unique_ptr<std::atomic<const uint32_t *>[]> resident_; // Decoded brick per index (null until visited)
+    mutable std::atomic<size_t> residentBytes_{0};
 };
 
+// Voxel brick of a leaf for greedy meshing: node center and pointer into the brick pool
+using VoxelBrickRef = std::pair<glm::vec3, const uint32_t *>;
+
 // Surface mesh vertex
 struct MeshVertex
 {
@@ -174,6 +303,18 @@ struct ChunkMesh
     bool isValid;
 };
 
+// Mesh chunk whose brick selection changed (see PlanetOctree::updateMeshChunks)
+// A mesh chunk is the subtree of a node at the chunk depth (or of a shallower leaf); its mesh depends only on
+// which of its bricks are within the extraction distance
+struct MeshChunkUpdate
+{
+    uint32_t key = 0;                  // Morton key of the chunk's root node (unique across depths)
+    float voxelSize = 0.0f;            // Edge length of a brick voxel
+    std::vector<VoxelBrickRef> bricks; // Selected bricks; empty when the chunk left the mesh
+    std::vector<MeshVertex> vertices;  // Output of PlanetOctree::meshChunk (indices are chunk-local)
+    std::vector<unsigned int> indices;
+};
+
 // Octree for planet voxelization
 // Uses spherical bounding volume optimized for planet surface mesh generation
 class PlanetOctree
@@ -215,6 +356,20 @@ public:
                             std::vector<MeshVertex> &vertices,
                             std::vector<unsigned int> &indices);
 
+    // Incremental proximity mesh: the same surface as extractSurfaceMesh(referencePoint, ...), kept as one
+    // mesh per chunk. Subdivides around referencePoint, then appends to `changed` every chunk whose set of
+    // bricks within maxSubdivisionDistance differs from the previous call (bricks empty = remove the chunk).
+    // Chunks well inside or outside the distance are skipped without visiting their bricks, so the cost follows
+    // the chunks near the distance boundary rather than the whole mesh
+    void updateMeshChunks(const glm::vec3 &referencePoint,
+                          float maxSubdivisionDistance,
+                          std::vector<MeshChunkUpdate> &changed);
+
+    // Greedy mesh of one changed chunk into chunk.vertices/indices
+    // Reads only the chunk's bricks, so it may run on worker threads while the octree is subdivided
+    // (but not rebuilt or reloaded)
+    void meshChunk(MeshChunkUpdate &chunk) const;
+
     // Chunked mesh generation with parallel processing
     // Divides planet surface into chunks, processes in parallel, and stitches together
     // numChunksX, numChunksY: Number of chunks in each direction (e.g., 8x4 = 32 chunks)
@@ -235,7 +390,17 @@ public:
     // Get the root node (for debugging/inspection)
     const OctreeNode *getRoot() const
     {
-        return root_.get();
+        return nodes_.empty() ? nullptr : &nodes_[0];
+    }
+
+    // Get the node array (root first; see OctreeNode for the layout) and the brick pool
+    const std::vector<OctreeNode> &getNodes() const
+    {
+        return nodes_;
+    }
+    const BrickPool &getBricks() const
+    {
+        return bricks_;
     }
 
     // Debug: Extract voxel wireframe edges (for visualization)
@@ -250,15 +415,15 @@ public:
     // maxNodesToProcess: Maximum number of nodes to process this frame (for chunked processing, -1 = unlimited)
     void subdivideForProximity(const glm::vec3 &referencePoint, float maxSubdivisionDistance, int maxNodesToProcess = -1);
     
-    // Helper: Collect nodes that need subdivision (for parallel processing)
-    void collectNodesForSubdivision(OctreeNode *node,
+    // Helper: Collect indices of nodes that need subdivision (for parallel processing)
+    void collectNodesForSubdivision(uint32_t nodeIndex,
                                     const glm::vec3 &referencePoint,
                                     float maxSubdivisionDistance,
-                                    std::vector<OctreeNode*> &nodesToSubdivide,
-                                    int maxNodesToProcess);
-    
-    // Helper: Subdivide a single node (thread-safe, called in parallel)
-    void subdivideNode(OctreeNode *node, const glm::vec3 &referencePoint, float maxSubdivisionDistance);
+                                    std::vector<uint32_t> &nodesToSubdivide,
+                                    int maxNodesToProcess) const;
+
+    // Helper: Subdivide a single leaf node (appends its children to the node array)
+    void subdivideNode(uint32_t nodeIndex);
 
     // Query voxel at a specific position
     // Returns true if voxel is solid (inside planet), false if empty
@@ -268,18 +433,28 @@ public:
     // Get voxel data size (for debugging/monitoring)
     size_t getVoxelDataSize() const;
 
-    // Serialize octree to binary file for fast loading
-    // filepath: Path to save the octree file
+    // Serialize octree to binary file for fast loading (version 2: node table plus compressed brick table)
+    // filepath: Path to save the octree file (written to a temporary file, then renamed over it)
     // Returns true on success
     bool serializeToFile(const std::string &filepath) const;
 
     // Deserialize octree from binary file
+    // Version 2 files are memory-mapped: the node table is copied, bricks are decoded when first visited
+    // Version 1 files are read completely
     // filepath: Path to load the octree file from
     // Returns true on success
     bool deserializeFromFile(const std::string &filepath);
 
 private:
-    std::unique_ptr<OctreeNode> root_;
+    // Children of a leaf, planned before they are appended to the node array
+    struct ChildBlock
+    {
+        uint8_t childMask = 0;
+        std::array<OctreeNode, 8> children; // The first popcount(childMask) entries, in child order
+    };
+
+    std::vector<OctreeNode> nodes_; // Linear octree, root at index 0
+    BrickPool bricks_;              // Voxel bricks of max-depth leaves
     float baseRadius_; // Earth's average radius
     float maxRadius_;  // Spherical bounding volume radius (exosphere)
     int maxDepth_;
@@ -291,6 +466,44 @@ private:
     const unsigned char *landmassMask_;
     float averageRadius_;
 
+    // Min/max of the heightmap over square cells of 2^level texels, for levels HEIGHT_RANGE_FIRST_LEVEL and up
+    // (smaller footprints read the heightmap itself). Bounds the surface under a whole brick region at once
+    struct HeightRangeLevel
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> minValues;
+        std::vector<uint8_t> maxValues;
+    };
+    std::vector<HeightRangeLevel> heightRanges_;
+
+    // Brick selection of each mesh chunk that is in the mesh, by chunk key (see updateMeshChunks)
+    struct MeshChunkState
+    {
+        std::vector<uint32_t> brickNodes; // Selected brick leaves, in traversal order
+        bool complete = false;            // Whole subtree was within the distance (brickNodes are all its bricks)
+        bool dirty = false;               // Structure changed since brickNodes was taken: compare again
+        uint64_t visited = 0;             // Last update that reached the chunk
+    };
+    std::unordered_map<uint32_t, MeshChunkState> meshChunks_;
+    uint64_t meshChunkUpdate_ = 0;
+
+    // Depth of mesh chunk roots (shallower leaves are chunks of their own)
+    int meshChunkDepth() const;
+
+    // Walk down to the mesh chunk roots for updateMeshChunks()
+    void updateMeshChunksRecursive(uint32_t nodeIndex,
+                                   const glm::vec3 &referencePoint,
+                                   float maxDistance,
+                                   int chunkDepth,
+                                   std::vector<MeshChunkUpdate> &changed);
+
+    // Mark every chunk for a new comparison (after the node array was replaced)
+    void invalidateMeshChunks();
+
+    // Edge length of a brick voxel
+    float brickVoxelSize() const;
+
     // Check if a node intersects the spherical bounding volume
     // Returns true if the node's bounding box intersects the sphere
     bool nodeIntersectsSphere(const glm::vec3 &nodeCenter, float nodeSize) const;
@@ -306,12 +519,28 @@ private:
     // Get surface radius at a given position (baseRadius + heightmap offset)
     float getSurfaceRadius(const glm::vec3 &worldPos) const;
 
-    // Recursively build octree (spherical bounds optimization)
-    void buildOctreeRecursive(OctreeNode *node);
+    // Build heightRanges_ from the current heightmap
+    void buildHeightRanges();
+
+    // Conservative bounds of getSurfaceRadius() over every point of the cube (center, half-extent)
+    void getSurfaceRadiusBounds(const glm::vec3 &center, float halfExtent, float &minRadius, float &maxRadius) const;
+
+    // Build octree level by level (spherical bounds optimization)
+    void buildOctreeLevels();
+
+    // Decide whether a node being built is a leaf (setting isLeaf/isSolid) or is subdivided
+    // Returns the mask of children to create (0 for leaves); needsBrick is set for max-depth surface leaves
+    uint8_t classifyBuildNode(OctreeNode &node, bool &needsBrick) const;
+
+    // Plan the children of a leaf for proximity subdivision (thread-safe, read-only)
+    ChildBlock planChildren(const OctreeNode &node) const;
+
+    // Append planned children to the node array and link them to their parent
+    void attachChildren(uint32_t nodeIndex, const ChildBlock &block);
 
     // Recursively subdivide nodes based on proximity to reference point
     // Subdivides nodes that are close to referencePoint and not at max depth
-    void subdivideForProximityRecursive(OctreeNode *node,
+    void subdivideForProximityRecursive(uint32_t nodeIndex,
                                         const glm::vec3 &referencePoint,
                                         float maxSubdivisionDistance);
 
@@ -365,41 +594,45 @@ private:
     // Helper to extract wireframes from a node
     void extractVoxelWireframesFromNode(const OctreeNode *node, std::vector<glm::vec3> &edgeVertices) const;
 
-    // Store voxel bits for a leaf node at max depth
-    // For a 2x2x2 subgrid, stores 8 bits (1 byte) representing voxel occupancy
-    void storeVoxelBits(OctreeNode *node);
+    // Store voxel bits for a leaf node at max depth into its (already allocated) brick
+    // Rows are filled from analytic radius intervals; only voxels within the local terrain range are sampled
+    void storeVoxelBits(OctreeNode &node);
 
     // Query voxel bits from a leaf node
     // Returns true if voxel at local position within node is solid
-    bool queryVoxelBits(const OctreeNode *node, const glm::vec3 &localPos) const;
-
-    // Recursively query voxel at position
-    bool queryVoxelRecursive(const OctreeNode *node, const glm::vec3 &pos) const;
+    bool queryVoxelBits(const OctreeNode &node, const glm::vec3 &localPos) const;
 
     // Greedy meshing helpers
     // Collect all leaf node voxel data for greedy meshing
-    void collectVoxelData(std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes) const;
-    void collectVoxelDataRecursive(const OctreeNode *node, std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes) const;
+    void collectVoxelData(std::vector<VoxelBrickRef> &voxelNodes) const;
+    void collectVoxelDataRecursive(const OctreeNode *node, std::vector<VoxelBrickRef> &voxelNodes) const;
     
     // Collect voxel data with distance filtering - only nodes within maxDistance
-    void collectVoxelDataWithDistance(std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+    void collectVoxelDataWithDistance(std::vector<VoxelBrickRef> &voxelNodes,
                                       const glm::vec3 &referencePoint,
                                       float maxDistance) const;
     void collectVoxelDataWithDistanceRecursive(const OctreeNode *node,
-                                                std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+                                                std::vector<VoxelBrickRef> &voxelNodes,
                                                 const glm::vec3 &referencePoint,
                                                 float maxDistance) const;
+
+    // Same selection as collectVoxelDataWithDistanceRecursive, as node indices
+    void collectBrickNodesWithDistance(uint32_t nodeIndex,
+                                       std::vector<uint32_t> &brickNodes,
+                                       const glm::vec3 &referencePoint,
+                                       float maxDistance) const;
     
     // Collect voxel data only at a specific depth (for low-resolution base mesh)
-    void collectVoxelDataAtDepth(std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+    void collectVoxelDataAtDepth(std::vector<VoxelBrickRef> &voxelNodes,
                                  int targetDepth) const;
     void collectVoxelDataAtDepthRecursive(const OctreeNode *node,
-                                         std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+                                         std::vector<VoxelBrickRef> &voxelNodes,
                                          int targetDepth) const;
     
     // Greedy mesh generation for a single axis
     // axis: 0=X, 1=Y, 2=Z
-    void greedyMeshAxis(const std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+    void greedyMeshAxis(const std::vector<VoxelBrickRef> &voxelNodes,
+                       float voxelSize,
                        int axis,
                        std::vector<MeshVertex> &vertices,
                        std::vector<unsigned int> &indices,
@@ -407,18 +640,20 @@ private:
     
     // Check if a voxel is solid using bitwise operations
     // x, y, z: grid coordinates (0-31)
-    bool isVoxelSolidBitwise(const std::vector<std::vector<uint32_t>> &voxelGrid, int x, int y, int z) const;
+    bool isVoxelSolidBitwise(const uint32_t *brick, int x, int y, int z) const;
     
     // Get neighbor voxel state for greedy meshing
-    bool getNeighborVoxel(const std::vector<std::pair<glm::vec3, const std::vector<std::vector<uint32_t>>*>> &voxelNodes,
+    bool getNeighborVoxel(const std::vector<VoxelBrickRef> &voxelNodes,
                           const glm::vec3 &pos,
                           int axis,
                           int direction,
                           float voxelSize) const;
 
     // Serialization helpers
-    void serializeNode(std::ostream &out, const OctreeNode *node) const;
-    void deserializeNode(std::istream &in, OctreeNode *node);
+    // Version 1 layout: nodes depth-first, each followed by its children
+    bool deserializeNodes(std::istream &in);
+    // Version 2 layout: see FileHeader in voxel-octree.cpp
+    bool mapFile(std::unique_ptr<MappedFile> file, const std::string &filepath);
 };
 
 } // namespace EarthVoxelOctree
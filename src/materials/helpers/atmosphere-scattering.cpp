@@ -0,0 +1,975 @@
+// ============================================================================
+// Precomputed Atmospheric Scattering - Implementation
+// ============================================================================
+// Follows the structure of the reference implementation: every table texel is mapped
+// back to (r, mu, mu_s, nu), integrated, and later lookups use the same filtering a
+// GPU would (bilinear / trilinear, clamped to the edge, nu interpolated between the
+// two nearest slices of the packed 3D table).
+//
+// Geometry is evaluated in double precision (radii are ~6400 km, so the ray / sphere
+// discriminants lose too much in float); spectra are 4-lane vectors (RGB + one
+// spare lane) using SSE2 on x86, NEON on ARM64 and plain C++ elsewhere.
+//
+// Two lookups dominate the cost: the scattering density integrates the incoming
+// radiance over 16 x 32 directions and the indirect irradiance over 16 x 64. For a
+// fixed zenith angle only nu changes around the circle of directions, so the eight
+// nu slices are filtered once per zenith angle and each direction only interpolates
+// between two of them.
+
+#include "atmosphere-scattering.h"
+#include "block-compression.h"
+#include "parallel-rows.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ATMOSPHERE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ATMOSPHERE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace AtmosphereScattering
+{
+
+static constexpr double PI = 3.14159265358979323846;
+
+// Integration sample counts of the reference implementation
+static constexpr int TRANSMITTANCE_SAMPLES = 500;
+static constexpr int SINGLE_SCATTERING_SAMPLES = 50;
+static constexpr int SCATTERING_DENSITY_SAMPLES = 16; // Zenith angles; twice as many azimuths
+static constexpr int MULTIPLE_SCATTERING_SAMPLES = 50;
+static constexpr int INDIRECT_IRRADIANCE_SAMPLES = 32; // Azimuth steps per half turn
+
+// ==================================
+// Spectrum (RGB + spare lane)
+// ==================================
+
+struct Spectrum
+{
+#if defined(ATMOSPHERE_SSE2)
+    __m128 v;
+#elif defined(ATMOSPHERE_NEON)
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+};
+
+static inline Spectrum splat(float value)
+{
+#if defined(ATMOSPHERE_SSE2)
+    return {_mm_set1_ps(value)};
+#elif defined(ATMOSPHERE_NEON)
+    return {vdupq_n_f32(value)};
+#else
+    return {{value, value, value, value}};
+#endif
+}
+
+static inline Spectrum load(const float *texel)
+{
+#if defined(ATMOSPHERE_SSE2)
+    return {_mm_loadu_ps(texel)};
+#elif defined(ATMOSPHERE_NEON)
+    return {vld1q_f32(texel)};
+#else
+    return {{texel[0], texel[1], texel[2], texel[3]}};
+#endif
+}
+
+static inline void store(float *texel, Spectrum value)
+{
+#if defined(ATMOSPHERE_SSE2)
+    _mm_storeu_ps(texel, value.v);
+#elif defined(ATMOSPHERE_NEON)
+    vst1q_f32(texel, value.v);
+#else
+    std::memcpy(texel, value.v, sizeof(value.v));
+#endif
+}
+
+static inline Spectrum rgb(const float values[3])
+{
+    const float texel[4] = {values[0], values[1], values[2], 0.0f};
+    return load(texel);
+}
+
+static inline Spectrum operator+(Spectrum a, Spectrum b)
+{
+#if defined(ATMOSPHERE_SSE2)
+    return {_mm_add_ps(a.v, b.v)};
+#elif defined(ATMOSPHERE_NEON)
+    return {vaddq_f32(a.v, b.v)};
+#else
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+#endif
+}
+
+static inline Spectrum operator*(Spectrum a, Spectrum b)
+{
+#if defined(ATMOSPHERE_SSE2)
+    return {_mm_mul_ps(a.v, b.v)};
+#elif defined(ATMOSPHERE_NEON)
+    return {vmulq_f32(a.v, b.v)};
+#else
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+#endif
+}
+
+static inline Spectrum operator*(Spectrum a, float s)
+{
+    return a * splat(s);
+}
+
+static inline Spectrum &operator+=(Spectrum &a, Spectrum b)
+{
+    a = a + b;
+    return a;
+}
+
+// a + (b - a) * t
+static inline Spectrum lerp(Spectrum a, Spectrum b, float t)
+{
+#if defined(ATMOSPHERE_SSE2)
+    return {_mm_add_ps(a.v, _mm_mul_ps(_mm_sub_ps(b.v, a.v), _mm_set1_ps(t)))};
+#elif defined(ATMOSPHERE_NEON)
+    return {vmlaq_n_f32(a.v, vsubq_f32(b.v, a.v), t)};
+#else
+    return {{a.v[0] + (b.v[0] - a.v[0]) * t,
+             a.v[1] + (b.v[1] - a.v[1]) * t,
+             a.v[2] + (b.v[2] - a.v[2]) * t,
+             a.v[3] + (b.v[3] - a.v[3]) * t}};
+#endif
+}
+
+static inline Spectrum minimum(Spectrum a, float s)
+{
+#if defined(ATMOSPHERE_SSE2)
+    return {_mm_min_ps(a.v, _mm_set1_ps(s))};
+#elif defined(ATMOSPHERE_NEON)
+    return {vminq_f32(a.v, vdupq_n_f32(s))};
+#else
+    return {{std::min(a.v[0], s), std::min(a.v[1], s), std::min(a.v[2], s), std::min(a.v[3], s)}};
+#endif
+}
+
+// a / b per lane, with 0 where b is 0 (transmittance ratios at the top of the atmosphere)
+static inline Spectrum safeDivide(Spectrum a, Spectrum b)
+{
+    float x[4], y[4];
+    store(x, a);
+    store(y, b);
+    for (int i = 0; i < 4; i++)
+    {
+        x[i] = y[i] > 0.0f ? x[i] / y[i] : 0.0f;
+    }
+    return load(x);
+}
+
+// ==================================
+// Table Filtering
+// ==================================
+
+static double textureCoordFromUnitRange(double x, int size)
+{
+    return 0.5 / size + x * (1.0 - 1.0 / size);
+}
+
+static double unitRangeFromTextureCoord(double u, int size)
+{
+    return (u - 0.5 / size) / (1.0 - 1.0 / size);
+}
+
+// Texel pair and weight for linear filtering of coordinate u in [0, 1] over `size` texels
+struct LinearTap
+{
+    int i0;
+    int i1;
+    float t;
+};
+
+static LinearTap linearTap(double u, int size)
+{
+    double x = std::clamp(u * size - 0.5, 0.0, static_cast<double>(size - 1));
+    int i0 = std::min(static_cast<int>(x), size - 1);
+    return {i0, std::min(i0 + 1, size - 1), static_cast<float>(x - i0)};
+}
+
+// Bilinear sample of an RGBA table
+static Spectrum sample2D(const std::vector<float> &table, int width, int height, double u, double v)
+{
+    const LinearTap x = linearTap(u, width);
+    const LinearTap y = linearTap(v, height);
+    const float *row0 = table.data() + static_cast<size_t>(y.i0) * width * 4;
+    const float *row1 = table.data() + static_cast<size_t>(y.i1) * width * 4;
+    Spectrum top = lerp(load(row0 + x.i0 * 4), load(row0 + x.i1 * 4), x.t);
+    Spectrum bottom = lerp(load(row1 + x.i0 * 4), load(row1 + x.i1 * 4), x.t);
+    return lerp(top, bottom, y.t);
+}
+
+// Texture coordinates of the scattering table that do not depend on nu
+struct ScatteringCoord
+{
+    LinearTap muS;
+    LinearTap mu;
+    LinearTap r;
+};
+
+// Trilinear sample of one nu slice of the packed scattering table
+static Spectrum sampleSlice(const std::vector<float> &table, const ScatteringCoord &coord, int slice)
+{
+    const int x0 = slice * SCATTERING_MU_S_SIZE + coord.muS.i0;
+    const int x1 = slice * SCATTERING_MU_S_SIZE + coord.muS.i1;
+    auto texel = [&](int x, int y, int z) {
+        return load(table.data() + ((static_cast<size_t>(z) * SCATTERING_HEIGHT + y) * SCATTERING_WIDTH + x) * 4);
+    };
+    auto bilinear = [&](int z) {
+        Spectrum row0 = lerp(texel(x0, coord.mu.i0, z), texel(x1, coord.mu.i0, z), coord.muS.t);
+        Spectrum row1 = lerp(texel(x0, coord.mu.i1, z), texel(x1, coord.mu.i1, z), coord.muS.t);
+        return lerp(row0, row1, coord.mu.t);
+    };
+    return lerp(bilinear(coord.r.i0), bilinear(coord.r.i1), coord.r.t);
+}
+
+// Lower slice and weight of the upper one for nu
+static void nuSlices(double nu, int &slice, float &t)
+{
+    double x = std::clamp((nu + 1.0) / 2.0, 0.0, 1.0) * (SCATTERING_NU_SIZE - 1);
+    slice = std::min(static_cast<int>(x), SCATTERING_NU_SIZE - 2);
+    t = static_cast<float>(x - slice);
+}
+
+// ==================================
+// Atmosphere Model
+// ==================================
+
+static double clampCosine(double mu)
+{
+    return std::clamp(mu, -1.0, 1.0);
+}
+
+static double safeSqrt(double a)
+{
+    return std::sqrt(std::max(a, 0.0));
+}
+
+static double layerDensity(const DensityLayer &layer, double altitude)
+{
+    double density = layer.expTerm * std::exp(layer.expScale * altitude) + layer.linearTerm * altitude +
+                     layer.constantTerm;
+    return std::clamp(density, 0.0, 1.0);
+}
+
+static double profileDensity(const DensityProfile &profile, double altitude)
+{
+    return altitude < profile.layers[0].width ? layerDensity(profile.layers[0], altitude)
+                                              : layerDensity(profile.layers[1], altitude);
+}
+
+static double rayleighPhase(double nu)
+{
+    return 3.0 / (16.0 * PI) * (1.0 + nu * nu);
+}
+
+static double miePhase(double g, double nu)
+{
+    double k = 3.0 / (8.0 * PI) * (1.0 - g * g) / (2.0 + g * g);
+    double denominator = 1.0 + g * g - 2.0 * g * nu;
+    return k * (1.0 + nu * nu) / (denominator * std::sqrt(denominator));
+}
+
+struct Atmosphere
+{
+    Parameters p;
+    Spectrum solarIrradiance;
+    Spectrum rayleighScattering;
+    Spectrum mieScattering;
+    Spectrum mieExtinction;
+    Spectrum absorptionExtinction;
+    double horizonLength = 0.0; // sqrt(top^2 - bottom^2)
+
+    std::vector<float> transmittance;
+
+    explicit Atmosphere(const Parameters &parameters)
+        : p(parameters), solarIrradiance(rgb(parameters.solarIrradiance)),
+          rayleighScattering(rgb(parameters.rayleighScattering)), mieScattering(rgb(parameters.mieScattering)),
+          mieExtinction(rgb(parameters.mieExtinction)), absorptionExtinction(rgb(parameters.absorptionExtinction)),
+          horizonLength(std::sqrt(parameters.topRadius * parameters.topRadius -
+                                  parameters.bottomRadius * parameters.bottomRadius))
+    {
+    }
+
+    double clampRadius(double r) const
+    {
+        return std::clamp(r, p.bottomRadius, p.topRadius);
+    }
+
+    double distanceToTop(double r, double mu) const
+    {
+        double discriminant = r * r * (mu * mu - 1.0) + p.topRadius * p.topRadius;
+        return std::max(0.0, -r * mu + safeSqrt(discriminant));
+    }
+
+    double distanceToBottom(double r, double mu) const
+    {
+        double discriminant = r * r * (mu * mu - 1.0) + p.bottomRadius * p.bottomRadius;
+        return std::max(0.0, -r * mu - safeSqrt(discriminant));
+    }
+
+    bool rayIntersectsGround(double r, double mu) const
+    {
+        return mu < 0.0 && r * r * (mu * mu - 1.0) + p.bottomRadius * p.bottomRadius >= 0.0;
+    }
+
+    double distanceToNearestBoundary(double r, double mu, bool intersectsGround) const
+    {
+        return intersectsGround ? distanceToBottom(r, mu) : distanceToTop(r, mu);
+    }
+
+    // ----------------------------------
+    // Transmittance
+    // ----------------------------------
+
+    double opticalLengthToTop(const DensityProfile &profile, double r, double mu) const
+    {
+        const double dx = distanceToTop(r, mu) / TRANSMITTANCE_SAMPLES;
+        double result = 0.0;
+        for (int i = 0; i <= TRANSMITTANCE_SAMPLES; i++)
+        {
+            double d = i * dx;
+            double ri = std::sqrt(d * d + 2.0 * r * mu * d + r * r);
+            double weight = (i == 0 || i == TRANSMITTANCE_SAMPLES) ? 0.5 : 1.0;
+            result += profileDensity(profile, ri - p.bottomRadius) * weight * dx;
+        }
+        return result;
+    }
+
+    Spectrum computeTransmittanceToTop(double r, double mu) const
+    {
+        const float rayleighLength = static_cast<float>(opticalLengthToTop(p.rayleighDensity, r, mu));
+        const float mieLength = static_cast<float>(opticalLengthToTop(p.mieDensity, r, mu));
+        const float absorptionLength = static_cast<float>(opticalLengthToTop(p.absorptionDensity, r, mu));
+        Spectrum opticalDepth = rayleighScattering * rayleighLength + mieExtinction * mieLength +
+                                absorptionExtinction * absorptionLength;
+        float depth[4];
+        store(depth, opticalDepth);
+        const float texel[4] = {std::exp(-depth[0]), std::exp(-depth[1]), std::exp(-depth[2]), 1.0f};
+        return load(texel);
+    }
+
+    void transmittanceUv(double r, double mu, double &u, double &v) const
+    {
+        double rho = safeSqrt(r * r - p.bottomRadius * p.bottomRadius);
+        double d = distanceToTop(r, mu);
+        double dMin = p.topRadius - r;
+        double dMax = rho + horizonLength;
+        u = textureCoordFromUnitRange((d - dMin) / (dMax - dMin), TRANSMITTANCE_WIDTH);
+        v = textureCoordFromUnitRange(rho / horizonLength, TRANSMITTANCE_HEIGHT);
+    }
+
+    void rMuFromTransmittanceUv(double u, double v, double &r, double &mu) const
+    {
+        double xMu = unitRangeFromTextureCoord(u, TRANSMITTANCE_WIDTH);
+        double xR = unitRangeFromTextureCoord(v, TRANSMITTANCE_HEIGHT);
+        double rho = horizonLength * xR;
+        r = std::sqrt(rho * rho + p.bottomRadius * p.bottomRadius);
+        double dMin = p.topRadius - r;
+        double dMax = rho + horizonLength;
+        double d = dMin + xMu * (dMax - dMin);
+        mu = d == 0.0 ? 1.0 : clampCosine((horizonLength * horizonLength - rho * rho - d * d) / (2.0 * r * d));
+    }
+
+    Spectrum transmittanceToTop(double r, double mu) const
+    {
+        double u, v;
+        transmittanceUv(r, mu, u, v);
+        return sample2D(transmittance, TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT, u, v);
+    }
+
+    // Transmittance along the segment of length d from (r, mu)
+    Spectrum transmittanceAlong(double r, double mu, double d, bool intersectsGround) const
+    {
+        double rd = clampRadius(std::sqrt(d * d + 2.0 * r * mu * d + r * r));
+        double mud = clampCosine((r * mu + d) / rd);
+        if (intersectsGround)
+        {
+            return minimum(safeDivide(transmittanceToTop(rd, -mud), transmittanceToTop(r, -mu)), 1.0f);
+        }
+        return minimum(safeDivide(transmittanceToTop(r, mu), transmittanceToTop(rd, mud)), 1.0f);
+    }
+
+    // Transmittance to the sun, including the fraction of the sun disc above the horizon
+    Spectrum transmittanceToSun(double r, double muS) const
+    {
+        double sinHorizon = p.bottomRadius / r;
+        double cosHorizon = -std::sqrt(std::max(1.0 - sinHorizon * sinHorizon, 0.0));
+        double edge = sinHorizon * p.sunAngularRadius;
+        double x = std::clamp((muS - cosHorizon + edge) / (2.0 * edge), 0.0, 1.0);
+        return transmittanceToTop(r, muS) * static_cast<float>(x * x * (3.0 - 2.0 * x));
+    }
+
+    // ----------------------------------
+    // Scattering table parameterization
+    // ----------------------------------
+
+    ScatteringCoord scatteringCoord(double r, double mu, double muS, bool intersectsGround) const
+    {
+        const double H = horizonLength;
+        double rho = safeSqrt(r * r - p.bottomRadius * p.bottomRadius);
+        double uR = textureCoordFromUnitRange(rho / H, SCATTERING_R_SIZE);
+
+        double rMu = r * mu;
+        double discriminant = rMu * rMu - r * r + p.bottomRadius * p.bottomRadius;
+        double uMu;
+        if (intersectsGround)
+        {
+            double d = -rMu - safeSqrt(discriminant);
+            double dMin = r - p.bottomRadius;
+            double dMax = rho;
+            double x = dMax == dMin ? 0.0 : (d - dMin) / (dMax - dMin);
+            uMu = 0.5 - 0.5 * textureCoordFromUnitRange(x, SCATTERING_MU_SIZE / 2);
+        }
+        else
+        {
+            double d = -rMu + safeSqrt(discriminant + H * H);
+            double dMin = p.topRadius - r;
+            double dMax = rho + H;
+            uMu = 0.5 + 0.5 * textureCoordFromUnitRange((d - dMin) / (dMax - dMin), SCATTERING_MU_SIZE / 2);
+        }
+
+        double d = distanceToTop(p.bottomRadius, muS);
+        double dMin = p.topRadius - p.bottomRadius;
+        double dMax = H;
+        double a = (d - dMin) / (dMax - dMin);
+        double A = (distanceToTop(p.bottomRadius, p.muSMin) - dMin) / (dMax - dMin);
+        double uMuS = textureCoordFromUnitRange(std::max(1.0 - a / A, 0.0) / (1.0 + a), SCATTERING_MU_S_SIZE);
+
+        return {linearTap(uMuS, SCATTERING_MU_S_SIZE),
+                linearTap(uMu, SCATTERING_MU_SIZE),
+                linearTap(uR, SCATTERING_R_SIZE)};
+    }
+
+    // (r, mu, mu_s, nu) at the center of a scattering table texel
+    void scatteringTexelParameters(int x,
+                                   int y,
+                                   int z,
+                                   double &r,
+                                   double &mu,
+                                   double &muS,
+                                   double &nu,
+                                   bool &intersectsGround) const
+    {
+        const double H = horizonLength;
+        const int nuIndex = x / SCATTERING_MU_S_SIZE;
+        const double uNu = static_cast<double>(nuIndex) / (SCATTERING_NU_SIZE - 1);
+        const double uMuS = (x - nuIndex * SCATTERING_MU_S_SIZE + 0.5) / SCATTERING_MU_S_SIZE;
+        const double uMu = (y + 0.5) / SCATTERING_MU_SIZE;
+        const double uR = (z + 0.5) / SCATTERING_R_SIZE;
+
+        double rho = H * unitRangeFromTextureCoord(uR, SCATTERING_R_SIZE);
+        r = std::sqrt(rho * rho + p.bottomRadius * p.bottomRadius);
+
+        if (uMu < 0.5)
+        {
+            double dMin = r - p.bottomRadius;
+            double dMax = rho;
+            double d = dMin + (dMax - dMin) * unitRangeFromTextureCoord(1.0 - 2.0 * uMu, SCATTERING_MU_SIZE / 2);
+            mu = d == 0.0 ? -1.0 : clampCosine(-(rho * rho + d * d) / (2.0 * r * d));
+            intersectsGround = true;
+        }
+        else
+        {
+            double dMin = p.topRadius - r;
+            double dMax = rho + H;
+            double d = dMin + (dMax - dMin) * unitRangeFromTextureCoord(2.0 * uMu - 1.0, SCATTERING_MU_SIZE / 2);
+            mu = d == 0.0 ? 1.0 : clampCosine((H * H - rho * rho - d * d) / (2.0 * r * d));
+            intersectsGround = false;
+        }
+
+        double xMuS = unitRangeFromTextureCoord(uMuS, SCATTERING_MU_S_SIZE);
+        double dMin = p.topRadius - p.bottomRadius;
+        double dMax = H;
+        double A = (distanceToTop(p.bottomRadius, p.muSMin) - dMin) / (dMax - dMin);
+        double a = (A - xMuS * A) / (1.0 + xMuS * A);
+        double d = dMin + std::min(a, A) * (dMax - dMin);
+        muS = d == 0.0 ? 1.0 : clampCosine((H * H - d * d) / (2.0 * p.bottomRadius * d));
+
+        // Only nu values possible for this mu and mu_s
+        nu = clampCosine(uNu * 2.0 - 1.0);
+        double spread = std::sqrt((1.0 - mu * mu) * (1.0 - muS * muS));
+        nu = std::clamp(nu, mu * muS - spread, mu * muS + spread);
+    }
+
+    Spectrum scatteringLookup(const std::vector<float> &table,
+                              double r,
+                              double mu,
+                              double muS,
+                              double nu,
+                              bool intersectsGround) const
+    {
+        ScatteringCoord coord = scatteringCoord(r, mu, muS, intersectsGround);
+        int slice;
+        float t;
+        nuSlices(nu, slice, t);
+        return lerp(sampleSlice(table, coord, slice), sampleSlice(table, coord, slice + 1), t);
+    }
+
+    // ----------------------------------
+    // Irradiance table parameterization
+    // ----------------------------------
+
+    void rMuSFromIrradianceTexel(int x, int y, double &r, double &muS) const
+    {
+        double xMuS = unitRangeFromTextureCoord((x + 0.5) / IRRADIANCE_WIDTH, IRRADIANCE_WIDTH);
+        double xR = unitRangeFromTextureCoord((y + 0.5) / IRRADIANCE_HEIGHT, IRRADIANCE_HEIGHT);
+        r = p.bottomRadius + xR * (p.topRadius - p.bottomRadius);
+        muS = clampCosine(2.0 * xMuS - 1.0);
+    }
+
+    // Irradiance on the ground: the bottom row of the table, so only mu_s is filtered
+    static Spectrum groundIrradianceLookup(const std::vector<float> &table, double muS)
+    {
+        const LinearTap x = linearTap(textureCoordFromUnitRange(muS * 0.5 + 0.5, IRRADIANCE_WIDTH), IRRADIANCE_WIDTH);
+        return lerp(load(table.data() + x.i0 * 4), load(table.data() + x.i1 * 4), x.t);
+    }
+
+    Spectrum irradianceLookup(const std::vector<float> &table, double r, double muS) const
+    {
+        double xR = (r - p.bottomRadius) / (p.topRadius - p.bottomRadius);
+        double xMuS = muS * 0.5 + 0.5;
+        return sample2D(table,
+                        IRRADIANCE_WIDTH,
+                        IRRADIANCE_HEIGHT,
+                        textureCoordFromUnitRange(xMuS, IRRADIANCE_WIDTH),
+                        textureCoordFromUnitRange(xR, IRRADIANCE_HEIGHT));
+    }
+
+    // ----------------------------------
+    // Integrals
+    // ----------------------------------
+
+    void computeSingleScattering(double r,
+                                 double mu,
+                                 double muS,
+                                 double nu,
+                                 bool intersectsGround,
+                                 Spectrum &rayleigh,
+                                 Spectrum &mie) const
+    {
+        const double dx = distanceToNearestBoundary(r, mu, intersectsGround) / SINGLE_SCATTERING_SAMPLES;
+        Spectrum rayleighSum = splat(0.0f);
+        Spectrum mieSum = splat(0.0f);
+        for (int i = 0; i <= SINGLE_SCATTERING_SAMPLES; i++)
+        {
+            double d = i * dx;
+            double rd = clampRadius(std::sqrt(d * d + 2.0 * r * mu * d + r * r));
+            double muSd = clampCosine((r * muS + d * nu) / rd);
+            Spectrum t = transmittanceAlong(r, mu, d, intersectsGround) * transmittanceToSun(rd, muSd);
+            float weight = (i == 0 || i == SINGLE_SCATTERING_SAMPLES) ? 0.5f : 1.0f;
+            double altitude = rd - p.bottomRadius;
+            rayleighSum += t * static_cast<float>(profileDensity(p.rayleighDensity, altitude) * weight);
+            mieSum += t * static_cast<float>(profileDensity(p.mieDensity, altitude) * weight);
+        }
+        rayleigh = rayleighSum * static_cast<float>(dx) * solarIrradiance * rayleighScattering;
+        mie = mieSum * static_cast<float>(dx) * solarIrradiance * mieScattering;
+    }
+
+    // Radiance scattered towards -omega at (r, mu, mu_s, nu) by light of the previous order:
+    // single Rayleigh + Mie (with their phase functions) when order == 2, otherwise the previous
+    // multiple scattering order; plus the previous order's irradiance reflected by the ground
+    Spectrum computeScatteringDensity(double r,
+                                      double mu,
+                                      double muS,
+                                      double nu,
+                                      int order,
+                                      const std::vector<float> &singleRayleigh,
+                                      const std::vector<float> &singleMie,
+                                      const std::vector<float> &multiple,
+                                      const std::vector<float> &irradiance) const
+    {
+        const double omegaX = std::sqrt(std::max(1.0 - mu * mu, 0.0));
+        const double omegaZ = mu;
+        const double sunX = omegaX == 0.0 ? 0.0 : (nu - mu * muS) / omegaX;
+        const double sunY = std::sqrt(std::max(1.0 - sunX * sunX - muS * muS, 0.0));
+        const double sunZ = muS;
+
+        const double dTheta = PI / SCATTERING_DENSITY_SAMPLES;
+        const double dPhi = PI / SCATTERING_DENSITY_SAMPLES;
+        const double altitude = r - p.bottomRadius;
+        const Spectrum rayleighCoefficient =
+            rayleighScattering * static_cast<float>(profileDensity(p.rayleighDensity, altitude));
+        const Spectrum mieCoefficient = mieScattering * static_cast<float>(profileDensity(p.mieDensity, altitude));
+        const Spectrum groundAlbedo = splat(static_cast<float>(p.groundAlbedo / PI));
+
+        Spectrum rayleighSlices[SCATTERING_NU_SIZE];
+        Spectrum mieSlices[SCATTERING_NU_SIZE];
+        Spectrum result = splat(0.0f);
+        for (int l = 0; l < SCATTERING_DENSITY_SAMPLES; l++)
+        {
+            const double theta = (l + 0.5) * dTheta;
+            const double cosTheta = std::cos(theta);
+            const double sinTheta = std::sin(theta);
+            const bool intersectsGround = rayIntersectsGround(r, cosTheta);
+
+            double distanceToGround = 0.0;
+            Spectrum groundReflectance = splat(0.0f);
+            if (intersectsGround)
+            {
+                distanceToGround = distanceToBottom(r, cosTheta);
+                groundReflectance = transmittanceAlong(r, cosTheta, distanceToGround, true) * groundAlbedo;
+            }
+
+            // Every direction of this ring shares r, mu and mu_s: filter the nu slices once
+            ScatteringCoord coord = scatteringCoord(r, cosTheta, muS, intersectsGround);
+            for (int slice = 0; slice < SCATTERING_NU_SIZE; slice++)
+            {
+                if (order == 2)
+                {
+                    rayleighSlices[slice] = sampleSlice(singleRayleigh, coord, slice);
+                    mieSlices[slice] = sampleSlice(singleMie, coord, slice);
+                }
+                else
+                {
+                    rayleighSlices[slice] = sampleSlice(multiple, coord, slice);
+                }
+            }
+
+            const float dOmega = static_cast<float>(dTheta * dPhi * sinTheta);
+            for (int m = 0; m < 2 * SCATTERING_DENSITY_SAMPLES; m++)
+            {
+                const double phi = (m + 0.5) * dPhi;
+                const double ix = std::cos(phi) * sinTheta;
+                const double iy = std::sin(phi) * sinTheta;
+                const double iz = cosTheta;
+
+                // Incident radiance from direction omega_i
+                const double nuIncident = sunX * ix + sunY * iy + sunZ * iz;
+                int slice;
+                float t;
+                nuSlices(nuIncident, slice, t);
+                Spectrum incident = lerp(rayleighSlices[slice], rayleighSlices[slice + 1], t);
+                if (order == 2)
+                {
+                    incident = incident * static_cast<float>(rayleighPhase(nuIncident)) +
+                               lerp(mieSlices[slice], mieSlices[slice + 1], t) *
+                                   static_cast<float>(miePhase(p.miePhaseG, nuIncident));
+                }
+
+                if (intersectsGround)
+                {
+                    // Ground normal at the point where omega_i hits the ground
+                    double nx = ix * distanceToGround;
+                    double ny = iy * distanceToGround;
+                    double nz = r + iz * distanceToGround;
+                    double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+                    double groundMuS = (nx * sunX + ny * sunY + nz * sunZ) / length;
+                    incident += groundReflectance * groundIrradianceLookup(irradiance, groundMuS);
+                }
+
+                // Scattered towards -omega
+                const double nuScattered = omegaX * ix + omegaZ * iz;
+                Spectrum phase = rayleighCoefficient * static_cast<float>(rayleighPhase(nuScattered)) +
+                                 mieCoefficient * static_cast<float>(miePhase(p.miePhaseG, nuScattered));
+                result += incident * phase * dOmega;
+            }
+        }
+        return result;
+    }
+
+    Spectrum computeMultipleScattering(double r,
+                                       double mu,
+                                       double muS,
+                                       double nu,
+                                       bool intersectsGround,
+                                       const std::vector<float> &density) const
+    {
+        const double dx = distanceToNearestBoundary(r, mu, intersectsGround) / MULTIPLE_SCATTERING_SAMPLES;
+        Spectrum sum = splat(0.0f);
+        for (int i = 0; i <= MULTIPLE_SCATTERING_SAMPLES; i++)
+        {
+            double d = i * dx;
+            double ri = clampRadius(std::sqrt(d * d + 2.0 * r * mu * d + r * r));
+            double mui = clampCosine((r * mu + d) / ri);
+            double muSi = clampCosine((r * muS + d * nu) / ri);
+            float weight = (i == 0 || i == MULTIPLE_SCATTERING_SAMPLES) ? 0.5f : 1.0f;
+            sum += scatteringLookup(density, ri, mui, muSi, nu, intersectsGround) *
+                   transmittanceAlong(r, mu, d, intersectsGround) * static_cast<float>(dx * weight);
+        }
+        return sum;
+    }
+
+    Spectrum computeDirectIrradiance(double r, double muS) const
+    {
+        const double alpha = p.sunAngularRadius;
+        // Approximate average of the cosine factor over the visible fraction of the sun disc
+        double cosineFactor =
+            muS < -alpha ? 0.0 : (muS > alpha ? muS : (muS + alpha) * (muS + alpha) / (4.0 * alpha));
+        return solarIrradiance * transmittanceToTop(r, muS) * static_cast<float>(cosineFactor);
+    }
+
+    // Sky irradiance from scattering of the given order (1 = single Rayleigh + Mie)
+    Spectrum computeIndirectIrradiance(double r,
+                                       double muS,
+                                       int order,
+                                       const std::vector<float> &singleRayleigh,
+                                       const std::vector<float> &singleMie,
+                                       const std::vector<float> &multiple) const
+    {
+        const double dPhi = PI / INDIRECT_IRRADIANCE_SAMPLES;
+        const double dTheta = PI / INDIRECT_IRRADIANCE_SAMPLES;
+        const double sunX = std::sqrt(std::max(1.0 - muS * muS, 0.0));
+
+        Spectrum rayleighSlices[SCATTERING_NU_SIZE];
+        Spectrum mieSlices[SCATTERING_NU_SIZE];
+        Spectrum result = splat(0.0f);
+        for (int j = 0; j < INDIRECT_IRRADIANCE_SAMPLES / 2; j++)
+        {
+            const double theta = (j + 0.5) * dTheta;
+            const double cosTheta = std::cos(theta);
+            const double sinTheta = std::sin(theta);
+
+            ScatteringCoord coord = scatteringCoord(r, cosTheta, muS, false);
+            for (int slice = 0; slice < SCATTERING_NU_SIZE; slice++)
+            {
+                if (order == 1)
+                {
+                    rayleighSlices[slice] = sampleSlice(singleRayleigh, coord, slice);
+                    mieSlices[slice] = sampleSlice(singleMie, coord, slice);
+                }
+                else
+                {
+                    rayleighSlices[slice] = sampleSlice(multiple, coord, slice);
+                }
+            }
+
+            const float weight = static_cast<float>(cosTheta * dTheta * dPhi * sinTheta);
+            for (int i = 0; i < 2 * INDIRECT_IRRADIANCE_SAMPLES; i++)
+            {
+                const double phi = (i + 0.5) * dPhi;
+                const double nu = std::cos(phi) * sinTheta * sunX + cosTheta * muS;
+                int slice;
+                float t;
+                nuSlices(nu, slice, t);
+                Spectrum radiance = lerp(rayleighSlices[slice], rayleighSlices[slice + 1], t);
+                if (order == 1)
+                {
+                    radiance = radiance * static_cast<float>(rayleighPhase(nu)) +
+                               lerp(mieSlices[slice], mieSlices[slice + 1], t) *
+                                   static_cast<float>(miePhase(p.miePhaseG, nu));
+                }
+                result += radiance * weight;
+            }
+        }
+        return result;
+    }
+};
+
+// ==================================
+// Precomputation
+// ==================================
+
+// Call texel(x, y, z, offset) for every texel of the scattering table, rows split across threads
+template <typename Texel>
+static void forEachScatteringTexel(bool parallel, Texel texel)
+{
+    ParallelRows::forEachRowBand(SCATTERING_HEIGHT * SCATTERING_DEPTH, 1, parallel, [&](int begin, int end) {
+        for (int row = begin; row < end; row++)
+        {
+            const int y = row % SCATTERING_HEIGHT;
+            const int z = row / SCATTERING_HEIGHT;
+            for (int x = 0; x < SCATTERING_WIDTH; x++)
+            {
+                texel(x, y, z, (static_cast<size_t>(row) * SCATTERING_WIDTH + x) * 4);
+            }
+        }
+    });
+}
+
+template <typename Texel>
+static void forEachIrradianceTexel(bool parallel, Texel texel)
+{
+    ParallelRows::forEachRowBand(IRRADIANCE_HEIGHT, 1, parallel, [&](int begin, int end) {
+        for (int y = begin; y < end; y++)
+        {
+            for (int x = 0; x < IRRADIANCE_WIDTH; x++)
+            {
+                texel(x, y, (static_cast<size_t>(y) * IRRADIANCE_WIDTH + x) * 4);
+            }
+        }
+    });
+}
+
+void precompute(const Parameters &parameters, int scatteringOrders, Tables &tables, bool parallel)
+{
+    Atmosphere atmosphere(parameters);
+    scatteringOrders = std::max(1, scatteringOrders);
+
+    const size_t scatteringFloats = static_cast<size_t>(SCATTERING_WIDTH) * SCATTERING_HEIGHT * SCATTERING_DEPTH * 4;
+    const size_t irradianceFloats = static_cast<size_t>(IRRADIANCE_WIDTH) * IRRADIANCE_HEIGHT * 4;
+
+    // 1. Transmittance to the top of the atmosphere
+    atmosphere.transmittance.assign(static_cast<size_t>(TRANSMITTANCE_WIDTH) * TRANSMITTANCE_HEIGHT * 4, 0.0f);
+    ParallelRows::forEachRowBand(TRANSMITTANCE_HEIGHT, 1, parallel, [&](int begin, int end) {
+        for (int y = begin; y < end; y++)
+        {
+            for (int x = 0; x < TRANSMITTANCE_WIDTH; x++)
+            {
+                double r, mu;
+                atmosphere.rMuFromTransmittanceUv(
+                    (x + 0.5) / TRANSMITTANCE_WIDTH, (y + 0.5) / TRANSMITTANCE_HEIGHT, r, mu);
+                store(&atmosphere.transmittance[(static_cast<size_t>(y) * TRANSMITTANCE_WIDTH + x) * 4],
+                      atmosphere.computeTransmittanceToTop(r, mu));
+            }
+        }
+    });
+
+    // 2. Direct irradiance (only feeds the ground reflection of the next orders; the stored
+    // irradiance is indirect only)
+    std::vector<float> deltaIrradiance(irradianceFloats, 0.0f);
+    tables.irradiance.assign(irradianceFloats, 0.0f);
+    forEachIrradianceTexel(parallel, [&](int x, int y, size_t offset) {
+        double r, muS;
+        atmosphere.rMuSFromIrradianceTexel(x, y, r, muS);
+        store(&deltaIrradiance[offset], atmosphere.computeDirectIrradiance(r, muS));
+    });
+
+    // 3. Single scattering
+    std::vector<float> deltaRayleigh(scatteringFloats, 0.0f);
+    std::vector<float> deltaMie(scatteringFloats, 0.0f);
+    tables.scattering.assign(scatteringFloats, 0.0f);
+    forEachScatteringTexel(parallel, [&](int x, int y, int z, size_t offset) {
+        double r, mu, muS, nu;
+        bool intersectsGround;
+        atmosphere.scatteringTexelParameters(x, y, z, r, mu, muS, nu, intersectsGround);
+        Spectrum rayleigh, mie;
+        atmosphere.computeSingleScattering(r, mu, muS, nu, intersectsGround, rayleigh, mie);
+        store(&deltaRayleigh[offset], rayleigh);
+        store(&deltaMie[offset], mie);
+        store(&tables.scattering[offset], rayleigh);
+        tables.scattering[offset + 3] = deltaMie[offset];
+    });
+
+    // 4. Multiple scattering, one order at a time
+    std::vector<float> deltaDensity;
+    std::vector<float> deltaMultiple;
+    if (scatteringOrders >= 2)
+    {
+        deltaDensity.assign(scatteringFloats, 0.0f);
+        deltaMultiple.assign(scatteringFloats, 0.0f);
+    }
+    for (int order = 2; order <= scatteringOrders; order++)
+    {
+        // Light scattered at every point by the previous order
+        forEachScatteringTexel(parallel, [&](int x, int y, int z, size_t offset) {
+            double r, mu, muS, nu;
+            bool intersectsGround;
+            atmosphere.scatteringTexelParameters(x, y, z, r, mu, muS, nu, intersectsGround);
+            store(&deltaDensity[offset],
+                  atmosphere.computeScatteringDensity(
+                      r, mu, muS, nu, order, deltaRayleigh, deltaMie, deltaMultiple, deltaIrradiance));
+        });
+
+        // Ground irradiance from the previous order
+        forEachIrradianceTexel(parallel, [&](int x, int y, size_t offset) {
+            double r, muS;
+            atmosphere.rMuSFromIrradianceTexel(x, y, r, muS);
+            Spectrum irradiance =
+                atmosphere.computeIndirectIrradiance(r, muS, order - 1, deltaRayleigh, deltaMie, deltaMultiple);
+            store(&deltaIrradiance[offset], irradiance);
+            store(&tables.irradiance[offset], load(&tables.irradiance[offset]) + irradiance);
+        });
+
+        // This order's radiance, accumulated without the Rayleigh phase like single Rayleigh
+        forEachScatteringTexel(parallel, [&](int x, int y, int z, size_t offset) {
+            double r, mu, muS, nu;
+            bool intersectsGround;
+            atmosphere.scatteringTexelParameters(x, y, z, r, mu, muS, nu, intersectsGround);
+            Spectrum multiple = atmosphere.computeMultipleScattering(r, mu, muS, nu, intersectsGround, deltaDensity);
+            store(&deltaMultiple[offset], multiple);
+
+            float *texel = &tables.scattering[offset];
+            float alpha = texel[3];
+            store(texel, load(texel) + multiple * static_cast<float>(1.0 / rayleighPhase(nu)));
+            texel[3] = alpha;
+        });
+    }
+
+    tables.transmittance = std::move(atmosphere.transmittance);
+}
+
+// ==================================
+// LUT File
+// ==================================
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool writeLutFile(const std::string &path, const Parameters &parameters, int scatteringOrders, const Tables &tables)
+{
+    LutFileHeader header;
+    std::memset(&header, 0, sizeof(LutFileHeader));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.scatteringOrders = static_cast<uint32_t>(scatteringOrders);
+    header.transmittanceSize[0] = TRANSMITTANCE_WIDTH;
+    header.transmittanceSize[1] = TRANSMITTANCE_HEIGHT;
+    header.scatteringSize[0] = SCATTERING_R_SIZE;
+    header.scatteringSize[1] = SCATTERING_MU_SIZE;
+    header.scatteringSize[2] = SCATTERING_MU_S_SIZE;
+    header.scatteringSize[3] = SCATTERING_NU_SIZE;
+    header.irradianceSize[0] = IRRADIANCE_WIDTH;
+    header.irradianceSize[1] = IRRADIANCE_HEIGHT;
+    header.bottomRadius = static_cast<float>(parameters.bottomRadius);
+    header.topRadius = static_cast<float>(parameters.topRadius);
+    header.sunAngularRadius = static_cast<float>(parameters.sunAngularRadius);
+    header.muSMin = static_cast<float>(parameters.muSMin);
+    header.miePhaseG = static_cast<float>(parameters.miePhaseG);
+    for (int c = 0; c < 3; c++)
+    {
+        header.solarIrradiance[c] = parameters.solarIrradiance[c];
+        header.rayleighScattering[c] = parameters.rayleighScattering[c];
+        header.mieScattering[c] = parameters.mieScattering[c];
+    }
+
+    const std::vector<float> *sections[3] = {&tables.transmittance, &tables.scattering, &tables.irradiance};
+    uint64_t *offsets[3] = {&header.transmittanceOffset, &header.scatteringOffset, &header.irradianceOffset};
+    uint64_t offset = alignUp(sizeof(LutFileHeader), TABLE_ALIGNMENT);
+    for (int s = 0; s < 3; s++)
+    {
+        *offsets[s] = offset;
+        offset = alignUp(offset + sections[s]->size() * sizeof(uint16_t), TABLE_ALIGNMENT);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(LutFileHeader));
+
+    std::vector<uint16_t> halves;
+    for (int s = 0; s < 3; s++)
+    {
+        static const char zeros[TABLE_ALIGNMENT] = {};
+        out.write(zeros, static_cast<std::streamsize>(*offsets[s] - static_cast<uint64_t>(out.tellp())));
+
+        const std::vector<float> &section = *sections[s];
+        halves.resize(section.size());
+        for (size_t i = 0; i < section.size(); i++)
+        {
+            halves[i] = BlockCompression::floatToHalf(section[i]);
+        }
+        out.write(reinterpret_cast<const char *>(halves.data()),
+                  static_cast<std::streamsize>(halves.size() * sizeof(uint16_t)));
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace AtmosphereScattering
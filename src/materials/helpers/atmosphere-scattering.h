@@ -0,0 +1,128 @@
+#pragma once
+
+// ============================================================================
+// Precomputed Atmospheric Scattering
+// ============================================================================
+// CPU port of Bruneton's precomputed atmospheric scattering model (2008, revised
+// 2017): integrates the transmittance of the atmosphere, single scattering, a
+// configurable number of multiple scattering orders and the sky irradiance on the
+// ground into lookup tables, so a renderer can replace per-pixel ray marching with a
+// few texture fetches.
+//
+// Tables (all RGBA, parameterizations follow the reference implementation):
+//   Transmittance (r, mu)            to the top of the atmosphere            2D
+//   Scattering    (r, mu, mu_s, nu)  packed into 3D: x = nu * MU_S + mu_s,   3D
+//                                    y = mu, z = r. RGB = Rayleigh single + all
+//                                    multiple orders (divided by the Rayleigh phase),
+//                                    A = red channel of single Mie scattering
+//   Irradiance    (r, mu_s)          indirect sky irradiance on the ground   2D
+//                                    (direct sun irradiance comes from transmittance)
+//
+// Lengths are in kilometers; radiance and irradiance are relative to the solar
+// irradiance at the top of the atmosphere.
+//
+// LUT file layout (little-endian, native struct layout, offsets from file start):
+//   LutFileHeader
+//   transmittance, scattering and irradiance texels as RGBA float16, each table
+//   starting at its header offset (aligned to TABLE_ALIGNMENT), ready for
+//   VK_FORMAT_R16G16B16A16_SFLOAT images
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AtmosphereScattering
+{
+
+// Table sizes of the reference implementation
+constexpr int TRANSMITTANCE_WIDTH = 256; // mu
+constexpr int TRANSMITTANCE_HEIGHT = 64; // r
+constexpr int SCATTERING_R_SIZE = 32;
+constexpr int SCATTERING_MU_SIZE = 128;
+constexpr int SCATTERING_MU_S_SIZE = 32;
+constexpr int SCATTERING_NU_SIZE = 8;
+constexpr int SCATTERING_WIDTH = SCATTERING_NU_SIZE * SCATTERING_MU_S_SIZE;
+constexpr int SCATTERING_HEIGHT = SCATTERING_MU_SIZE;
+constexpr int SCATTERING_DEPTH = SCATTERING_R_SIZE;
+constexpr int IRRADIANCE_WIDTH = 64;  // mu_s
+constexpr int IRRADIANCE_HEIGHT = 16; // r
+
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr char MAGIC[8] = {'V', 'N', 'T', 'A', 'T', 'M', 'O', 'S'};
+constexpr size_t TABLE_ALIGNMENT = 64;
+
+// Altitude density profile: up to two layers, each clamp(a * exp(b * h) + c * h + d, 0, 1)
+// with h the altitude in km; layers[0] applies below layers[0].width
+struct DensityLayer
+{
+    double width = 0.0;
+    double expTerm = 0.0;
+    double expScale = 0.0;
+    double linearTerm = 0.0;
+    double constantTerm = 0.0;
+};
+
+struct DensityProfile
+{
+    DensityLayer layers[2];
+};
+
+// Earth defaults (reference implementation values for 680/550/440 nm)
+struct Parameters
+{
+    double bottomRadius = 6360.0;
+    double topRadius = 6420.0;
+    double sunAngularRadius = 0.004675;
+    double muSMin = -0.2079; // cos(102 degrees): lowest sun the scattering table covers
+    double miePhaseG = 0.8;
+    double groundAlbedo = 0.1;
+    float solarIrradiance[3] = {1.474f, 1.8504f, 1.91198f};
+    float rayleighScattering[3] = {5.802e-3f, 13.558e-3f, 33.1e-3f}; // per km
+    float mieScattering[3] = {3.996e-3f, 3.996e-3f, 3.996e-3f};
+    float mieExtinction[3] = {4.44e-3f, 4.44e-3f, 4.44e-3f};
+    float absorptionExtinction[3] = {0.650e-3f, 1.881e-3f, 0.085e-3f}; // Ozone
+    DensityProfile rayleighDensity = {{{}, {0.0, 1.0, -1.0 / 8.0, 0.0, 0.0}}};
+    DensityProfile mieDensity = {{{}, {0.0, 1.0, -1.0 / 1.2, 0.0, 0.0}}};
+    DensityProfile absorptionDensity = {
+        {{25.0, 0.0, 0.0, 1.0 / 15.0, -2.0 / 3.0}, {0.0, 0.0, 0.0, -1.0 / 15.0, 8.0 / 3.0}}};
+};
+
+// Precomputed tables as RGBA floats, row-major (x fastest, then y, then z)
+struct Tables
+{
+    std::vector<float> transmittance; // TRANSMITTANCE_WIDTH x TRANSMITTANCE_HEIGHT
+    std::vector<float> scattering;    // SCATTERING_WIDTH x SCATTERING_HEIGHT x SCATTERING_DEPTH
+    std::vector<float> irradiance;    // IRRADIANCE_WIDTH x IRRADIANCE_HEIGHT
+};
+
+struct LutFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t scatteringOrders;
+    uint32_t transmittanceSize[2]; // width, height
+    uint32_t scatteringSize[4];    // r, mu, mu_s, nu
+    uint32_t irradianceSize[2];    // width, height
+    float bottomRadius;
+    float topRadius;
+    float sunAngularRadius;
+    float muSMin;
+    float miePhaseG;
+    float solarIrradiance[3];
+    float rayleighScattering[3];
+    float mieScattering[3];
+    uint64_t transmittanceOffset;
+    uint64_t scatteringOffset;
+    uint64_t irradianceOffset;
+};
+static_assert(sizeof(LutFileHeader) == 128, "LUT file header must match the on-disk layout");
+
+// Compute every table; scatteringOrders >= 1 (1 = single scattering only, 4 matches the reference)
+// parallel: split table rows across hardware threads
+void precompute(const Parameters &parameters, int scatteringOrders, Tables &tables, bool parallel = true);
+
+// Write the tables as float16 in the LUT file layout (temp file + rename is up to the caller)
+bool writeLutFile(const std::string &path, const Parameters &parameters, int scatteringOrders, const Tables &tables);
+
+} // namespace AtmosphereScattering
@@ -0,0 +1,701 @@
+// ============================================================================
+// GPU Block Compression (BC4 / BC5 / BC6H / BC7)
+// ============================================================================
+// Bit layouts follow the Direct3D / Vulkan block compression specification.
+// All blocks are written least significant bit first.
+
+#include "block-compression.h"
+#include "parallel-rows.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace BlockCompression
+{
+
+// ==================================
+// Format Info
+// ==================================
+
+uint32_t vkFormat(Format format)
+{
+    switch (format)
+    {
+    case Format::BC4:
+        return 139; // VK_FORMAT_BC4_UNORM_BLOCK
+    case Format::BC5:
+        return 141; // VK_FORMAT_BC5_UNORM_BLOCK
+    case Format::BC6H:
+        return 143; // VK_FORMAT_BC6H_UFLOAT_BLOCK
+    case Format::BC7:
+        return 145; // VK_FORMAT_BC7_UNORM_BLOCK
+    }
+    return 0;
+}
+
+size_t blockBytes(Format format)
+{
+    return format == Format::BC4 ? 8 : 16;
+}
+
+size_t compressedSize(Format format, int width, int height)
+{
+    size_t blocksX = static_cast<size_t>((width + 3) / 4);
+    size_t blocksY = static_cast<size_t>((height + 3) / 4);
+    return blocksX * blocksY * blockBytes(format);
+}
+
+const char *formatName(Format format)
+{
+    switch (format)
+    {
+    case Format::BC4:
+        return "BC4";
+    case Format::BC5:
+        return "BC5";
+    case Format::BC6H:
+        return "BC6H";
+    case Format::BC7:
+        return "BC7";
+    }
+    return "unknown";
+}
+
+// ==================================
+// Shared Helpers
+// ==================================
+
+// Interpolation weights for 4-bit indices (BC6H and BC7)
+static const int WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Appends bit fields to a zeroed block, least significant bit first
+struct BitWriter
+{
+    uint8_t *out;
+    int position = 0;
+
+    explicit BitWriter(uint8_t *block, size_t bytes) : out(block)
+    {
+        std::memset(out, 0, bytes);
+    }
+
+    void write(uint32_t value, int bits)
+    {
+        for (int i = 0; i < bits; i++, position++)
+        {
+            if ((value >> i) & 1u)
+            {
+                out[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+            }
+        }
+    }
+};
+
+// Endpoints along the principal axis of a block (power iteration on the covariance matrix)
+// points: 16 texels with `channels` floats each; outputs the two extreme projections
+static void principalAxisEndpoints(const float *points, int channels, float endpoint0[4], float endpoint1[4])
+{
+    float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            mean[c] += points[i * channels + c];
+        }
+    }
+    for (int c = 0; c < channels; c++)
+    {
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int a = 0; a < channels; a++)
+        {
+            float da = points[i * channels + a] - mean[a];
+            for (int b = 0; b < channels; b++)
+            {
+                covariance[a][b] += da * (points[i * channels + b] - mean[b]);
+            }
+        }
+    }
+
+    float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+            {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if (length < 1e-12f)
+        {
+            break; // Flat block - any axis works
+        }
+        length = std::sqrt(length);
+        for (int a = 0; a < channels; a++)
+        {
+            axis[a] = next[a] / length;
+        }
+    }
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        float projection = 0.0f;
+        for (int c = 0; c < channels; c++)
+        {
+            projection += (points[i * channels + c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    for (int c = 0; c < channels; c++)
+    {
+        endpoint0[c] = mean[c] + axis[c] * minProjection;
+        endpoint1[c] = mean[c] + axis[c] * maxProjection;
+    }
+}
+
+// ==================================
+// BC4 / BC5
+// ==================================
+
+// Palette for a BC4 block; r0 > r1 selects 8 interpolated values, otherwise 6 plus 0 and 255
+static void bc4Palette(int r0, int r1, int palette[8])
+{
+    palette[0] = r0;
+    palette[1] = r1;
+    if (r0 > r1)
+    {
+        for (int i = 2; i < 8; i++)
+        {
+            palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 2; i < 6; i++)
+        {
+            palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// Pick the nearest palette entry for every texel; returns the summed squared error
+static int bc4Indices(const uint8_t values[16], int r0, int r1, uint8_t indices[16])
+{
+    int palette[8];
+    bc4Palette(r0, r1, palette);
+
+    int totalError = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int bestError = 1 << 30;
+        for (int p = 0; p < 8; p++)
+        {
+            int diff = palette[p] - values[i];
+            if (diff * diff < bestError)
+            {
+                bestError = diff * diff;
+                indices[i] = static_cast<uint8_t>(p);
+            }
+        }
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+void encodeBlockBC4(const uint8_t values[16], uint8_t out[8])
+{
+    // 8-value mode spans the full range of the block
+    int minValue = 255;
+    int maxValue = 0;
+    // 6-value mode spans the values strictly between 0 and 255, which are then exact
+    int innerMin = 255;
+    int innerMax = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minValue = std::min(minValue, static_cast<int>(values[i]));
+        maxValue = std::max(maxValue, static_cast<int>(values[i]));
+        if (values[i] != 0 && values[i] != 255)
+        {
+            innerMin = std::min(innerMin, static_cast<int>(values[i]));
+            innerMax = std::max(innerMax, static_cast<int>(values[i]));
+        }
+    }
+    if (innerMin > innerMax)
+    {
+        innerMin = innerMax = 0;
+    }
+
+    uint8_t indices[16];
+    int r0 = maxValue;
+    int r1 = minValue;
+    int error = bc4Indices(values, r0, r1, indices);
+
+    if (error > 0)
+    {
+        uint8_t innerIndices[16];
+        int innerError = bc4Indices(values, innerMin, innerMax, innerIndices);
+        if (innerError < error)
+        {
+            r0 = innerMin;
+            r1 = innerMax;
+            std::memcpy(indices, innerIndices, sizeof(indices));
+        }
+    }
+
+    BitWriter writer(out, 8);
+    writer.write(static_cast<uint32_t>(r0), 8);
+    writer.write(static_cast<uint32_t>(r1), 8);
+    for (int i = 0; i < 16; i++)
+    {
+        writer.write(indices[i], 3);
+    }
+}
+
+void encodeBlockBC5(const uint8_t red[16], const uint8_t green[16], uint8_t out[16])
+{
+    encodeBlockBC4(red, out);
+    encodeBlockBC4(green, out + 8);
+}
+
+// ==================================
+// BC7 (mode 6)
+// ==================================
+
+void encodeBlockBC7(const uint8_t rgba[16 * 4], uint8_t out[16])
+{
+    float points[16 * 4];
+    for (int i = 0; i < 16 * 4; i++)
+    {
+        points[i] = rgba[i];
+    }
+
+    float ends[2][4];
+    principalAxisEndpoints(points, 4, ends[0], ends[1]);
+
+    // Quantize each endpoint to 7 bits per channel plus a shared p-bit (the 8th, lowest bit)
+    int quantized[2][4];
+    int pbit[2];
+    for (int e = 0; e < 2; e++)
+    {
+        float bestError = 1e30f;
+        for (int p = 0; p < 2; p++)
+        {
+            float error = 0.0f;
+            int candidate[4];
+            for (int c = 0; c < 4; c++)
+            {
+                float target = std::clamp(ends[e][c], 0.0f, 255.0f);
+                candidate[c] = std::clamp(static_cast<int>(std::lround((target - p) / 2.0f)), 0, 127);
+                float diff = static_cast<float>((candidate[c] << 1) | p) - target;
+                error += diff * diff;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pbit[e] = p;
+                std::memcpy(quantized[e], candidate, sizeof(candidate));
+            }
+        }
+    }
+
+    int palette[16][4];
+    for (int c = 0; c < 4; c++)
+    {
+        int a = (quantized[0][c] << 1) | pbit[0];
+        int b = (quantized[1][c] << 1) | pbit[1];
+        for (int i = 0; i < 16; i++)
+        {
+            palette[i][c] = ((64 - WEIGHTS4[i]) * a + WEIGHTS4[i] * b + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int t = 0; t < 16; t++)
+    {
+        int bestError = 1 << 30;
+        for (int i = 0; i < 16; i++)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                int diff = palette[i][c] - rgba[t * 4 + c];
+                error += diff * diff;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[t] = i;
+            }
+        }
+    }
+
+    // The anchor (texel 0) index is stored with its top bit implied zero; swap endpoints if needed
+    if (indices[0] & 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pbit[0], pbit[1]);
+        for (int t = 0; t < 16; t++)
+        {
+            indices[t] = 15 - indices[t];
+        }
+    }
+
+    BitWriter writer(out, 16);
+    writer.write(1u << 6, 7); // Mode 6
+    for (int c = 0; c < 4; c++)
+    {
+        writer.write(static_cast<uint32_t>(quantized[0][c]), 7);
+        writer.write(static_cast<uint32_t>(quantized[1][c]), 7);
+    }
+    writer.write(static_cast<uint32_t>(pbit[0]), 1);
+    writer.write(static_cast<uint32_t>(pbit[1]), 1);
+    writer.write(static_cast<uint32_t>(indices[0]), 3);
+    for (int t = 1; t < 16; t++)
+    {
+        writer.write(static_cast<uint32_t>(indices[t]), 4);
+    }
+}
+
+// ==================================
+// BC6H (mode 11, unsigned)
+// ==================================
+// Endpoints and errors are computed on half-float bit patterns, which the format
+// interpolates in directly - this behaves like a log encoding and keeps dark stars visible.
+
+uint16_t floatToHalf(float value)
+{
+    if (!(value > 0.0f))
+    {
+        return 0; // Negative, zero or NaN
+    }
+    if (value >= 65504.0f)
+    {
+        return 0x7BFF; // Largest finite half
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent <= 0)
+    {
+        // Subnormal half
+        if (exponent < -10)
+        {
+            return 0;
+        }
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u)
+        {
+            half++;
+        }
+        return static_cast<uint16_t>(half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+    {
+        half++; // Round to nearest; a carry correctly bumps the exponent
+    }
+    return static_cast<uint16_t>(std::min<uint32_t>(half, 0x7BFF));
+}
+
+// 10-bit endpoint -> 16-bit interpolation domain (unsigned unquantize from the spec)
+static int bc6hUnquantize(int value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+    if (value == 1023)
+    {
+        return 0xFFFF;
+    }
+    return ((value << 16) + 0x8000) >> 10;
+}
+
+void encodeBlockBC6H(const float rgb[16 * 3], uint8_t out[16])
+{
+    float halves[16 * 3];
+    for (int i = 0; i < 16 * 3; i++)
+    {
+        halves[i] = floatToHalf(rgb[i]);
+    }
+
+    float ends[2][4];
+    principalAxisEndpoints(halves, 3, ends[0], ends[1]);
+
+    // The decoder scales the interpolated value by 31/64 to get half bits, so a 10-bit
+    // endpoint q lands at roughly q * 31 + 15.5
+    int quantized[2][3];
+    for (int e = 0; e < 2; e++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            float target = std::clamp(ends[e][c], 0.0f, 31743.0f);
+            quantized[e][c] = std::clamp(static_cast<int>(std::lround((target - 15.5f) / 31.0f)), 0, 1023);
+        }
+    }
+
+    int palette[16][3];
+    for (int c = 0; c < 3; c++)
+    {
+        int a = bc6hUnquantize(quantized[0][c]);
+        int b = bc6hUnquantize(quantized[1][c]);
+        for (int i = 0; i < 16; i++)
+        {
+            int interpolated = ((64 - WEIGHTS4[i]) * a + WEIGHTS4[i] * b + 32) >> 6;
+            palette[i][c] = (interpolated * 31) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int t = 0; t < 16; t++)
+    {
+        float bestError = 1e30f;
+        for (int i = 0; i < 16; i++)
+        {
+            float error = 0.0f;
+            for (int c = 0; c < 3; c++)
+            {
+                float diff = static_cast<float>(palette[i][c]) - halves[t * 3 + c];
+                error += diff * diff;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[t] = i;
+            }
+        }
+    }
+
+    if (indices[0] & 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        for (int t = 0; t < 16; t++)
+        {
+            indices[t] = 15 - indices[t];
+        }
+    }
+
+    BitWriter writer(out, 16);
+    writer.write(0x03, 5); // Mode 11: one region, 10-bit endpoints, no deltas
+    for (int e = 0; e < 2; e++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            writer.write(static_cast<uint32_t>(quantized[e][c]), 10);
+        }
+    }
+    writer.write(static_cast<uint32_t>(indices[0]), 3);
+    for (int t = 1; t < 16; t++)
+    {
+        writer.write(static_cast<uint32_t>(indices[t]), 4);
+    }
+}
+
+// ==================================
+// Image Encoders
+// ==================================
+
+std::vector<uint8_t> compressImage(Format format, const uint8_t *rgba, int width, int height, bool parallel)
+{
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t bytesPerBlock = blockBytes(format);
+    std::vector<uint8_t> output(compressedSize(format, width, height));
+
+    ParallelRows::forEachRowBand(blocksY, 1, parallel, [&](int rowBegin, int rowEnd) {
+        uint8_t block[16 * 4];
+        uint8_t red[16];
+        uint8_t green[16];
+        for (int by = rowBegin; by < rowEnd; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                for (int y = 0; y < 4; y++)
+                {
+                    int sy = std::min(by * 4 + y, height - 1);
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int sx = std::min(bx * 4 + x, width - 1);
+                        const uint8_t *texel = rgba + (static_cast<size_t>(sy) * width + sx) * 4;
+                        std::memcpy(block + (y * 4 + x) * 4, texel, 4);
+                        red[y * 4 + x] = texel[0];
+                        green[y * 4 + x] = texel[1];
+                    }
+                }
+
+                uint8_t *dst = output.data() + (static_cast<size_t>(by) * blocksX + bx) * bytesPerBlock;
+                switch (format)
+                {
+                case Format::BC4:
+                    encodeBlockBC4(red, dst);
+                    break;
+                case Format::BC5:
+                    encodeBlockBC5(red, green, dst);
+                    break;
+                case Format::BC7:
+                    encodeBlockBC7(block, dst);
+                    break;
+                case Format::BC6H:
+                    break; // HDR input goes through compressImageHDR
+                }
+            }
+        }
+    });
+
+    return output;
+}
+
+std::vector<uint8_t> compressImageHDR(const float *rgba, int width, int height)
+{
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    std::vector<uint8_t> output(compressedSize(Format::BC6H, width, height));
+
+    ParallelRows::forEachRowBand(blocksY, 1, true, [&](int rowBegin, int rowEnd) {
+        float block[16 * 3];
+        for (int by = rowBegin; by < rowEnd; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                for (int y = 0; y < 4; y++)
+                {
+                    int sy = std::min(by * 4 + y, height - 1);
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int sx = std::min(bx * 4 + x, width - 1);
+                        const float *texel = rgba + (static_cast<size_t>(sy) * width + sx) * 4;
+                        std::memcpy(block + (y * 4 + x) * 3, texel, 3 * sizeof(float));
+                    }
+                }
+                encodeBlockBC6H(block, output.data() + (static_cast<size_t>(by) * blocksX + bx) * 16);
+            }
+        }
+    });
+
+    return output;
+}
+
+// ==================================
+// Mip Chain Helpers
+// ==================================
+
+int mipLevelCount(int width, int height)
+{
+    int levels = 1;
+    int size = std::max(width, height);
+    while (size > 1)
+    {
+        size /= 2;
+        levels++;
+    }
+    return levels;
+}
+
+void downsampleRGBA8(const uint8_t *src, int width, int height, std::vector<uint8_t> &dst, bool isNormalMap)
+{
+    int dstWidth = std::max(1, width / 2);
+    int dstHeight = std::max(1, height / 2);
+    dst.assign(static_cast<size_t>(dstWidth) * dstHeight * 4, 0);
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        int y0 = std::min(y * 2, height - 1);
+        int y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < dstWidth; x++)
+        {
+            int x0 = std::min(x * 2, width - 1);
+            int x1 = std::min(x * 2 + 1, width - 1);
+            const uint8_t *texels[4] = {src + (static_cast<size_t>(y0) * width + x0) * 4,
+                                        src + (static_cast<size_t>(y0) * width + x1) * 4,
+                                        src + (static_cast<size_t>(y1) * width + x0) * 4,
+                                        src + (static_cast<size_t>(y1) * width + x1) * 4};
+            uint8_t *out = dst.data() + (static_cast<size_t>(y) * dstWidth + x) * 4;
+
+            if (!isNormalMap)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    out[c] = static_cast<uint8_t>((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+                }
+                continue;
+            }
+
+            float sum[3] = {0.0f, 0.0f, 0.0f};
+            int alphaSum = 0;
+            int valid = 0;
+            for (const uint8_t *texel : texels)
+            {
+                alphaSum += texel[3];
+                if (texel[0] == 0 && texel[1] == 0 && texel[2] == 0)
+                {
+                    continue; // No data
+                }
+                for (int c = 0; c < 3; c++)
+                {
+                    sum[c] += texel[c] / 255.0f * 2.0f - 1.0f;
+                }
+                valid++;
+            }
+            out[3] = static_cast<uint8_t>((alphaSum + 2) / 4);
+
+            float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+            if (valid == 0 || length < 1e-6f)
+            {
+                continue;
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                float encoded = (sum[c] / length * 0.5f + 0.5f) * 255.0f;
+                out[c] = static_cast<uint8_t>(std::clamp(std::lround(encoded), 1L, 255L));
+            }
+        }
+    }
+}
+
+void downsampleRGBA32F(const float *src, int width, int height, std::vector<float> &dst)
+{
+    int dstWidth = std::max(1, width / 2);
+    int dstHeight = std::max(1, height / 2);
+    dst.assign(static_cast<size_t>(dstWidth) * dstHeight * 4, 0.0f);
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        int y0 = std::min(y * 2, height - 1);
+        int y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < dstWidth; x++)
+        {
+            int x0 = std::min(x * 2, width - 1);
+            int x1 = std::min(x * 2 + 1, width - 1);
+            float *out = dst.data() + (static_cast<size_t>(y) * dstWidth + x) * 4;
+            for (int c = 0; c < 4; c++)
+            {
+                out[c] = 0.25f * (src[(static_cast<size_t>(y0) * width + x0) * 4 + c] +
+                                  src[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+                                  src[(static_cast<size_t>(y1) * width + x0) * 4 + c] +
+                                  src[(static_cast<size_t>(y1) * width + x1) * 4 + c]);
+            }
+        }
+    }
+}
+
+} // namespace BlockCompression
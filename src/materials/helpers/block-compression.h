@@ -0,0 +1,85 @@
+#pragma once
+
+// ============================================================================
+// GPU Block Compression (BC4 / BC5 / BC6H / BC7)
+// ============================================================================
+// CPU encoders for the desktop block-compressed formats, used by preprocessing
+// to turn cubemap faces into mipmapped textures that are uploaded to the GPU as-is.
+//
+// Every format stores a 4x4 texel block in a fixed number of bytes:
+//   BC4  - 1 channel  (R),    8 bytes  -> heightmap, specular, nightlights
+//   BC5  - 2 channels (RG),   16 bytes -> tangent-space normals (B rebuilt in the shader)
+//   BC6H - HDR RGB (half),    16 bytes -> skybox
+//   BC7  - RGBA,              16 bytes -> color
+//
+// The encoders favour speed over the last fraction of a dB: BC7 uses mode 6 only
+// (one subset, 7-bit RGBA endpoints + p-bits, 4-bit indices) and BC6H uses mode 11 only
+// (one region, 10-bit endpoints, 4-bit indices). Both pick endpoints along the principal axis.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace BlockCompression
+{
+
+enum class Format
+{
+    BC4,  // R8 unorm
+    BC5,  // RG8 unorm
+    BC6H, // RGB half float (unsigned)
+    BC7   // RGBA8 unorm
+};
+
+// VkFormat value for a compressed format (numbers match the Vulkan enum, also used by KTX2)
+uint32_t vkFormat(Format format);
+
+// Bytes per 4x4 block (8 for BC4, 16 for the others)
+size_t blockBytes(Format format);
+
+// Size in bytes of a compressed image (partial edge blocks are padded to 4x4)
+size_t compressedSize(Format format, int width, int height);
+
+// Human readable name ("BC7" etc.) for log output
+const char *formatName(Format format);
+
+// ==================================
+// Single Block Encoders
+// ==================================
+// Texels are in row-major order within the block (16 texels)
+
+void encodeBlockBC4(const uint8_t values[16], uint8_t out[8]);
+void encodeBlockBC5(const uint8_t red[16], const uint8_t green[16], uint8_t out[16]);
+void encodeBlockBC6H(const float rgb[16 * 3], uint8_t out[16]);
+void encodeBlockBC7(const uint8_t rgba[16 * 4], uint8_t out[16]);
+
+// ==================================
+// Image Encoders
+// ==================================
+// Compress a whole image; edge blocks repeat the last row/column
+// Work is split across hardware threads by rows of blocks
+
+// 8-bit RGBA input (BC4 reads R, BC5 reads RG, BC7 reads RGBA)
+// parallel: false encodes on the calling thread (e.g. many small tiles compressed from worker threads)
+std::vector<uint8_t> compressImage(Format format, const uint8_t *rgba, int width, int height, bool parallel = true);
+
+// Float RGBA input (BC6H only; negative values are clamped to zero)
+std::vector<uint8_t> compressImageHDR(const float *rgba, int width, int height);
+
+// ==================================
+// Mip Chain Helpers
+// ==================================
+
+// Number of levels in a full chain down to 1x1
+int mipLevelCount(int width, int height);
+
+// 2x2 box downsample of an RGBA image (odd sizes clamp the last row/column)
+// isNormalMap: average only texels with data (non-zero RGB) and renormalize the decoded vector,
+//              so coastlines do not bend towards the "no data" value
+void downsampleRGBA8(const uint8_t *src, int width, int height, std::vector<uint8_t> &dst, bool isNormalMap = false);
+void downsampleRGBA32F(const float *src, int width, int height, std::vector<float> &dst);
+
+// IEEE half precision bits for a float (round to nearest, saturates at 65504)
+uint16_t floatToHalf(float value);
+
+} // namespace BlockCompression
@@ -0,0 +1,291 @@
+// ============================================================================
+// Connected Component Labeling - Implementation
+// ============================================================================
+// The forest lives in one array of parent pixel indices. Unions always make the smaller
+// index the root, so a root is the first pixel of its set in raster order and the
+// numbering of the final components is deterministic.
+
+#include "connected-components.h"
+#include "parallel-rows.h"
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+
+namespace ConnectedComponents
+{
+
+static constexpr uint32_t BACKGROUND = 0xFFFFFFFFu;
+
+// Root of x, halving the path on the way (only while one thread owns every node it can reach)
+static uint32_t findRoot(uint32_t *parent, uint32_t x)
+{
+    while (parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// Root of x without modifying the forest (safe while other threads read it too)
+static uint32_t findRootReadOnly(const uint32_t *parent, uint32_t x)
+{
+    while (parent[x] != x)
+    {
+        x = parent[x];
+    }
+    return x;
+}
+
+// Merge the sets of a and b under the smaller root
+static void unite(uint32_t *parent, uint32_t a, uint32_t b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b)
+    {
+        parent[b] = a;
+    }
+    else if (b < a)
+    {
+        parent[a] = b;
+    }
+}
+
+// Label rows [rowBegin, rowEnd) on their own: links to the row above rowBegin are made by joinSeam
+static void labelBand(const uint8_t *mask, int width, int rowBegin, int rowEnd, uint32_t *parent)
+{
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const uint32_t row = static_cast<uint32_t>(y) * static_cast<uint32_t>(width);
+        const bool hasAbove = y > rowBegin;
+        for (int x = 0; x < width; x++)
+        {
+            const uint32_t p = row + x;
+            if (!mask[p])
+            {
+                parent[p] = BACKGROUND;
+                continue;
+            }
+
+            // The earlier neighbours are W, NW, N and NE. N touches NW and NE, and W touches NW, so those
+            // pairs are already joined: N alone covers all of them, otherwise W (or else NW) plus NE
+            // p is a fresh set, so the first link simply adopts the neighbour's root
+            const uint32_t up = p - width;
+            if (hasAbove && mask[up])
+            {
+                parent[p] = findRoot(parent, up);
+                continue;
+            }
+            if (x > 0 && mask[p - 1])
+            {
+                parent[p] = findRoot(parent, p - 1);
+            }
+            else if (hasAbove && x > 0 && mask[up - 1])
+            {
+                parent[p] = findRoot(parent, up - 1);
+            }
+            else
+            {
+                parent[p] = p;
+            }
+            if (hasAbove && x + 1 < width && mask[up + 1])
+            {
+                unite(parent, p, up + 1);
+            }
+        }
+    }
+
+    // Point every pixel straight at its root: parents precede their children, so one pass suffices
+    const uint32_t begin = static_cast<uint32_t>(rowBegin) * static_cast<uint32_t>(width);
+    const uint32_t end = static_cast<uint32_t>(rowEnd) * static_cast<uint32_t>(width);
+    for (uint32_t p = begin; p < end; p++)
+    {
+        if (parent[p] != BACKGROUND)
+        {
+            parent[p] = parent[parent[p]];
+        }
+    }
+}
+
+// Join the first row of a band (y) with the last row of the band above it
+static void joinSeam(const uint8_t *mask, int width, int y, uint32_t *parent)
+{
+    const uint32_t row = static_cast<uint32_t>(y) * static_cast<uint32_t>(width);
+    for (int x = 0; x < width; x++)
+    {
+        const uint32_t p = row + x;
+        if (!mask[p])
+        {
+            continue;
+        }
+        const uint32_t up = p - width;
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            if (x + dx >= 0 && x + dx < width && mask[up + dx])
+            {
+                unite(parent, p, up + dx);
+            }
+        }
+    }
+}
+
+// Add the pixels [x0, x1] of row y to a component
+static void includeRun(Component &component, int x0, int x1, int y)
+{
+    if (component.size == 0)
+    {
+        component.minX = x0;
+        component.maxX = x1;
+        component.minY = component.maxY = y;
+    }
+    else
+    {
+        component.minX = std::min(component.minX, x0);
+        component.maxX = std::max(component.maxX, x1);
+        component.minY = std::min(component.minY, y);
+        component.maxY = std::max(component.maxY, y);
+    }
+    component.size += static_cast<uint32_t>(x1 - x0 + 1);
+}
+
+static void merge(Component &component, const Component &other)
+{
+    if (other.size == 0)
+    {
+        return;
+    }
+    if (component.size == 0)
+    {
+        component = other;
+        return;
+    }
+    component.size += other.size;
+    component.minX = std::min(component.minX, other.minX);
+    component.maxX = std::max(component.maxX, other.maxX);
+    component.minY = std::min(component.minY, other.minY);
+    component.maxY = std::max(component.maxY, other.maxY);
+}
+
+void label(const uint8_t *mask, int width, int height, Labels &labels, bool parallel)
+{
+    labels.pixels.clear();
+    labels.components.clear();
+    if (!mask || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    labels.pixels.resize(pixelCount);
+
+    const int bandCount = ParallelRows::bandCount(height, 64, parallel);
+    std::vector<int> bandRows(bandCount + 1);
+    for (int band = 0; band <= bandCount; band++)
+    {
+        bandRows[band] = ParallelRows::bandBegin(height, band, bandCount);
+    }
+
+    // 1. Every band builds its own forest; then the seams between bands are joined
+    std::vector<uint32_t> parent(pixelCount);
+    ParallelRows::forEachBand(bandCount, [&](int band) {
+        labelBand(mask, width, bandRows[band], bandRows[band + 1], parent.data());
+    });
+    for (int band = 1; band < bandCount; band++)
+    {
+        joinSeam(mask, width, bandRows[band], parent.data());
+    }
+
+    // 2. Resolve every pixel's root (the forest is read-only from here) and count the roots per band
+    std::vector<uint32_t> bandRoots(bandCount, 0);
+    ParallelRows::forEachBand(bandCount, [&](int band) {
+        const size_t begin = static_cast<size_t>(bandRows[band]) * width;
+        const size_t end = static_cast<size_t>(bandRows[band + 1]) * width;
+        uint32_t roots = 0;
+        for (size_t p = begin; p < end; p++)
+        {
+            if (parent[p] == BACKGROUND)
+            {
+                labels.pixels[p] = BACKGROUND;
+                continue;
+            }
+            // Neighbours along a row usually share a parent, and then a root
+            if (p > begin && parent[p] == parent[p - 1])
+            {
+                labels.pixels[p] = labels.pixels[p - 1];
+                continue;
+            }
+            labels.pixels[p] = findRootReadOnly(parent.data(), static_cast<uint32_t>(p));
+            roots += labels.pixels[p] == p;
+        }
+        bandRoots[band] = roots;
+    });
+
+    // 3. Number the roots in raster order, storing each root's component index in its parent slot
+    std::vector<uint32_t> firstComponent(bandCount + 1, 0);
+    for (int band = 0; band < bandCount; band++)
+    {
+        firstComponent[band + 1] = firstComponent[band] + bandRoots[band];
+    }
+    ParallelRows::forEachBand(bandCount, [&](int band) {
+        const size_t begin = static_cast<size_t>(bandRows[band]) * width;
+        const size_t end = static_cast<size_t>(bandRows[band + 1]) * width;
+        uint32_t next = firstComponent[band];
+        for (size_t p = begin; p < end; p++)
+        {
+            if (labels.pixels[p] == p)
+            {
+                parent[p] = next++;
+            }
+        }
+    });
+
+    // 4. Final labels and per-component size / bounding box. Components rooted in a band are counted in
+    // a dense array; the few that started in an earlier band are collected separately and merged after
+    std::vector<std::vector<Component>> local(bandCount);
+    std::vector<std::unordered_map<uint32_t, Component>> spill(bandCount);
+    ParallelRows::forEachBand(bandCount, [&](int band) {
+        const uint32_t first = firstComponent[band];
+        std::vector<Component> &own = local[band];
+        own.resize(firstComponent[band + 1] - first);
+        for (int y = bandRows[band]; y < bandRows[band + 1]; y++)
+        {
+            uint32_t *row = labels.pixels.data() + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++)
+            {
+                if (row[x] == BACKGROUND)
+                {
+                    row[x] = 0;
+                    continue;
+                }
+
+                // Runs of one component along the row are measured at once
+                const uint32_t root = row[x];
+                int runEnd = x + 1;
+                while (runEnd < width && row[runEnd] == root)
+                {
+                    runEnd++;
+                }
+                const uint32_t component = parent[root];
+                std::fill(row + x, row + runEnd, component + 1);
+                includeRun(component >= first ? own[component - first] : spill[band][component], x, runEnd - 1, y);
+                x = runEnd - 1;
+            }
+        }
+    });
+
+    labels.components.resize(firstComponent[bandCount]);
+    for (int band = 0; band < bandCount; band++)
+    {
+        std::copy(local[band].begin(), local[band].end(), labels.components.begin() + firstComponent[band]);
+    }
+    for (int band = 0; band < bandCount; band++)
+    {
+        for (const auto &[component, part] : spill[band])
+        {
+            merge(labels.components[component], part);
+        }
+    }
+}
+
+} // namespace ConnectedComponents
@@ -0,0 +1,40 @@
+#pragma once
+
+// ============================================================================
+// Connected Component Labeling
+// ============================================================================
+// Labels the 8-connected components of a binary mask and measures each one
+// (pixel count and bounding box) in the same pass.
+//
+// Rows are split into bands, one per hardware thread. Each band is labeled with a
+// union-find forest over pixel indices (a set's root is its first pixel in raster
+// order), the seams between bands are then joined, and every pixel resolves its root
+// in parallel. Component numbering follows the raster order of each component's first
+// pixel, so the result does not depend on the number of threads.
+
+#include <cstdint>
+#include <vector>
+
+namespace ConnectedComponents
+{
+
+struct Component
+{
+    uint32_t size = 0; // Pixels in the component
+    int minX = 0;      // Bounding box (inclusive)
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+};
+
+struct Labels
+{
+    std::vector<uint32_t> pixels;      // Per pixel: component index + 1, or 0 for background
+    std::vector<Component> components; // Indexed by label - 1
+};
+
+// Label the 8-connected components of the pixels where mask is non-zero
+// parallel: split rows across hardware threads
+void label(const uint8_t *mask, int width, int height, Labels &labels, bool parallel = true);
+
+} // namespace ConnectedComponents
@@ -4,11 +4,23 @@
 
 #include "cubemap-conversion.h"
 #include "../../concerns/constants.h"
+#include "parallel-rows.h"
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <new>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
 
 // Convert cubemap face pixel coordinates to 3D direction vector
 void cubemapPixelToDirection(int face, int x, int y, int faceSize, float &dirX, float &dirY, float &dirZ)
@@ -339,85 +351,723 @@ void sampleCubemapStripUChar(const unsigned char *cubemapData,
     sampleCubemapGridUChar(cubemapData, faceSize, channels, dirX, dirY, dirZ, outColor);
 }
 
-// Convert equirectangular unsigned char image to cubemap format (3x2 grid)
-unsigned char *convertEquirectangularToCubemapUChar(const unsigned char *equirectData,
-                                                    int equirectW,
-                                                    int equirectH,
-                                                    int channels,
-                                                    int faceSize)
+// ==================================
+// Conversion Engine
+// ==================================
+// Whole-image conversions avoid per-pixel trigonometry: face pixel -> equirectangular UV is read
+// from tables built once per face size and shared by every texture converted at that size, and
+// the bilinear taps are computed and blended 4 samples at a time (SSE2 / NEON).
+//
+// The tables use the symmetry of the cube:
+// - The four side faces share one table. Longitude depends only on the column (plus a quarter
+//   turn per face) and latitude is mirror-symmetric left/right, so only half a face is stored.
+// - The two polar faces share one table. -Y is +Y flipped vertically with latitude negated,
+//   and +Y is symmetric in both axes, so only one quadrant is stored.
+// At face size 8192 (32K skybox) this is about 256 MB, instead of 1.5 GB for a full per-pixel map.
+
+struct CubemapFaceTables
 {
-    // 3x2 grid: width = faceSize * 3, height = faceSize * 2
-    int gridWidth = faceSize * 3;
-    int gridHeight = faceSize * 2;
-    size_t cubemapSize = static_cast<size_t>(gridWidth) * gridHeight * channels;
-    unsigned char *cubemapData = new (std::nothrow) unsigned char[cubemapSize];
-    if (!cubemapData)
+    int faceSize = 0;
+    int half = 0;                // Stored columns / rows of the mirrored tables: ceil(faceSize / 2)
+    std::vector<float> sideLon;  // [x]: longitude of column x on +Z, in turns (-1/8 .. 1/8)
+    std::vector<float> sideV;    // [y * half + x]: equirectangular V on the side faces
+    std::vector<float> polarLon; // [y * half + x]: longitude on +Y in turns (quadrant u <= 0, v <= 0)
+    std::vector<float> polarV;   // [y * half + x]: equirectangular V on +Y
+};
+
+// Longitude of each side face's center column in turns (+X, -X, +Y, -Y, +Z, -Z); polar faces unused
+static const float FACE_LONGITUDE_OFFSET[6] = {0.25f, -0.25f, 0.0f, 0.0f, 0.0f, 0.5f};
+
+// Recently used tables (most recent first); a preprocessing run only uses one or two face sizes
+static constexpr size_t MAX_CACHED_FACE_TABLES = 2;
+static std::mutex g_faceTablesMutex;
+static std::vector<std::shared_ptr<const CubemapFaceTables>> g_faceTables;
+
+static std::shared_ptr<const CubemapFaceTables> buildFaceTables(int faceSize)
+{
+    auto tables = std::make_shared<CubemapFaceTables>();
+    tables->faceSize = faceSize;
+    tables->half = (faceSize + 1) / 2;
+    const int half = tables->half;
+    const double twoPi = 2.0 * PI;
+
+    // Same pixel-center mapping as cubemapPixelToDirection
+    std::vector<double> coord(faceSize);
+    for (int i = 0; i < faceSize; i++)
     {
-        std::cerr << "    ERROR: Failed to allocate memory for cubemap (" << cubemapSize << " bytes)\n";
-        return nullptr;
+        coord[i] = 2.0 * (i + 0.5) / faceSize - 1.0;
     }
 
-    std::cout << "    Converting equirectangular to cubemap (3x2 grid)...\n";
-    std::cout << "      Source: " << equirectW << "x" << equirectH << "\n";
-    std::cout << "      Cubemap face size: " << faceSize << "x" << faceSize << "\n";
-    std::cout << "      Output: " << gridWidth << "x" << gridHeight << " (3x2 grid)\n";
-
-    // Convert each face
-    for (int face = 0; face < 6; face++)
+    tables->sideLon.resize(faceSize);
+    for (int x = 0; x < faceSize; x++)
     {
-        // Get grid position for this face
-        int col, row;
-        getCubemapFaceGridPosition(face, col, row);
-        int faceStartX = col * faceSize;
-        int faceStartY = row * faceSize;
+        tables->sideLon[x] = static_cast<float>(std::atan(coord[x]) / twoPi);
+    }
 
-        for (int y = 0; y < faceSize; y++)
+    const size_t quadrant = static_cast<size_t>(half) * half;
+    tables->sideV.resize(static_cast<size_t>(faceSize) * half);
+    tables->polarLon.resize(quadrant);
+    tables->polarV.resize(quadrant);
+    for (int y = 0; y < faceSize; y++)
+    {
+        for (int x = 0; x < half; x++)
         {
-            for (int x = 0; x < faceSize; x++)
+            const double u = coord[x];
+            const double v = coord[y];
+            const double len = std::sqrt(u * u + v * v + 1.0);
+            const size_t index = static_cast<size_t>(y) * half + x;
+
+            // Side faces: direction (.., -v, ..) / len
+            tables->sideV[index] = static_cast<float>(0.5 + std::asin(v / len) / PI);
+
+            // +Y face: direction (u, 1, v) / len
+            if (y < half)
             {
-                // Get 3D direction for this pixel
-                float dirX, dirY, dirZ;
-                cubemapPixelToDirection(face, x, y, faceSize, dirX, dirY, dirZ);
-
-                // Convert direction to equirectangular UV
-                float u, v;
-                directionToEquirectangularUV(dirX, dirY, dirZ, u, v);
-
-                // Calculate pixel position in 3x2 grid
-                int gridX = faceStartX + x;
-                int gridY = faceStartY + y;
-                size_t pixelOffset = (static_cast<size_t>(gridY) * gridWidth + gridX) * channels;
-
-                // Sample equirectangular image
-                sampleEquirectangularUChar(equirectData,
-                                           equirectW,
-                                           equirectH,
-                                           channels,
-                                           u,
-                                           v,
-                                           &cubemapData[pixelOffset]);
+                tables->polarLon[index] = static_cast<float>(std::atan2(u, v) / twoPi);
+                tables->polarV[index] = static_cast<float>(0.5 - std::asin(1.0 / len) / PI);
             }
         }
     }
+    return tables;
+}
 
-    return cubemapData;
+static std::shared_ptr<const CubemapFaceTables> getFaceTables(int faceSize)
+{
+    std::lock_guard<std::mutex> lock(g_faceTablesMutex);
+    for (size_t i = 0; i < g_faceTables.size(); i++)
+    {
+        if (g_faceTables[i]->faceSize == faceSize)
+        {
+            std::shared_ptr<const CubemapFaceTables> tables = g_faceTables[i];
+            g_faceTables.erase(g_faceTables.begin() + static_cast<std::ptrdiff_t>(i));
+            g_faceTables.insert(g_faceTables.begin(), tables);
+            return tables;
+        }
+    }
+
+    // Built under the lock so threads converting at the same size wait for one build
+    std::shared_ptr<const CubemapFaceTables> tables = buildFaceTables(faceSize);
+    g_faceTables.insert(g_faceTables.begin(), tables);
+    if (g_faceTables.size() > MAX_CACHED_FACE_TABLES)
+    {
+        g_faceTables.pop_back();
+    }
+    return tables;
 }
 
-// Convert equirectangular HDR image to cubemap format (3x2 grid)
-float *convertEquirectangularToCubemapFloat(const float *equirectData,
-                                            int equirectW,
-                                            int equirectH,
-                                            int channels,
-                                            int faceSize)
+static inline float wrapUnit(float value)
+{
+    value -= std::floor(value);
+    return value < 1.0f ? value : 0.0f;
+}
+
+// Equirectangular UV of every pixel in row y of one face
+static void faceRowUV(const CubemapFaceTables &tables, int face, int y, float *outU, float *outV)
+{
+    const int faceSize = tables.faceSize;
+    const int half = tables.half;
+
+    if (face == FACE_POSITIVE_Y || face == FACE_NEGATIVE_Y)
+    {
+        // -Y row y looks up +Y row (faceSize - 1 - y) and negates the latitude
+        const int polarY = (face == FACE_POSITIVE_Y) ? y : faceSize - 1 - y;
+        const bool mirrorY = polarY >= half;
+        const size_t rowIndex = static_cast<size_t>(mirrorY ? faceSize - 1 - polarY : polarY) * half;
+        for (int x = 0; x < faceSize; x++)
+        {
+            const bool mirrorX = x >= half;
+            const size_t index = rowIndex + (mirrorX ? faceSize - 1 - x : x);
+            // atan2(-u, v) = -atan2(u, v); atan2(u, -v) = +-1/2 turn - atan2(u, v)
+            float lon = mirrorX ? -tables.polarLon[index] : tables.polarLon[index];
+            lon = mirrorY ? 0.5f - lon : lon;
+            outU[x] = wrapUnit(0.5f + lon);
+            outV[x] = (face == FACE_POSITIVE_Y) ? tables.polarV[index] : 1.0f - tables.polarV[index];
+        }
+        return;
+    }
+
+    const float offset = 0.5f + FACE_LONGITUDE_OFFSET[face];
+    const float *rowV = &tables.sideV[static_cast<size_t>(y) * half];
+    for (int x = 0; x < faceSize; x++)
+    {
+        outU[x] = wrapUnit(offset + tables.sideLon[x]);
+        outV[x] = rowV[x < half ? x : faceSize - 1 - x];
+    }
+}
+
+// ----------------------------------
+// Bilinear Sampling (4 samples at a time)
+// ----------------------------------
+
+// Taps and weights of 4 bilinear samples: columns wrap, rows clamp (as sampleEquirectangular*)
+struct BilinearQuad
+{
+    alignas(16) int x0[4];
+    alignas(16) int x1[4];
+    alignas(16) int y0[4];
+    alignas(16) int y1[4];
+    alignas(16) float w00[4];
+    alignas(16) float w10[4];
+    alignas(16) float w01[4];
+    alignas(16) float w11[4];
+};
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+static void computeBilinearQuad(const float *u, const float *v, int srcW, int srcH, BilinearQuad &quad)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sx = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(u), _mm_set1_ps(static_cast<float>(srcW))), _mm_set1_ps(0.5f));
+    const __m128 sy = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(v), _mm_set1_ps(static_cast<float>(srcH))), _mm_set1_ps(0.5f));
+
+    // floor() without SSE4.1: truncate, then step down where truncation rounded up (negatives)
+    __m128 fx = _mm_cvtepi32_ps(_mm_cvttps_epi32(sx));
+    fx = _mm_sub_ps(fx, _mm_and_ps(_mm_cmpgt_ps(fx, sx), one));
+    __m128 fy = _mm_cvtepi32_ps(_mm_cvttps_epi32(sy));
+    fy = _mm_sub_ps(fy, _mm_and_ps(_mm_cmpgt_ps(fy, sy), one));
+
+    const __m128 xFrac = _mm_sub_ps(sx, fx);
+    const __m128 yFrac = _mm_sub_ps(sy, fy);
+    const __m128 xInv = _mm_sub_ps(one, xFrac);
+    const __m128 yInv = _mm_sub_ps(one, yFrac);
+    _mm_store_ps(quad.w00, _mm_mul_ps(xInv, yInv));
+    _mm_store_ps(quad.w10, _mm_mul_ps(xFrac, yInv));
+    _mm_store_ps(quad.w01, _mm_mul_ps(xInv, yFrac));
+    _mm_store_ps(quad.w11, _mm_mul_ps(xFrac, yFrac));
+
+    // U is in [0, 1), so x0 is in [-1, srcW - 1] and x1 in [0, srcW]: one conditional wrap each
+    const __m128i width = _mm_set1_epi32(srcW);
+    __m128i x0 = _mm_cvttps_epi32(fx);
+    __m128i x1 = _mm_add_epi32(x0, _mm_set1_epi32(1));
+    x0 = _mm_add_epi32(x0, _mm_and_si128(_mm_cmplt_epi32(x0, _mm_setzero_si128()), width));
+    x1 = _mm_sub_epi32(x1, _mm_andnot_si128(_mm_cmplt_epi32(x1, width), width));
+    _mm_store_si128(reinterpret_cast<__m128i *>(quad.x0), x0);
+    _mm_store_si128(reinterpret_cast<__m128i *>(quad.x1), x1);
+
+    const __m128 maxRow = _mm_set1_ps(static_cast<float>(srcH - 1));
+    const __m128 y0 = _mm_min_ps(_mm_max_ps(fy, _mm_setzero_ps()), maxRow);
+    const __m128 y1 = _mm_min_ps(_mm_max_ps(_mm_add_ps(fy, one), _mm_setzero_ps()), maxRow);
+    _mm_store_si128(reinterpret_cast<__m128i *>(quad.y0), _mm_cvttps_epi32(y0));
+    _mm_store_si128(reinterpret_cast<__m128i *>(quad.y1), _mm_cvttps_epi32(y1));
+}
+
+struct Vec4
+{
+    __m128 value;
+};
+
+static inline Vec4 vecZero()
+{
+    return {_mm_setzero_ps()};
+}
+
+static inline Vec4 vecSet(float a, float b, float c, float d)
+{
+    return {_mm_setr_ps(a, b, c, d)};
+}
+
+static inline Vec4 vecLoad(const float *values)
+{
+    return {_mm_load_ps(values)};
+}
+
+static inline Vec4 vecLoadUnaligned(const float *values)
+{
+    return {_mm_loadu_ps(values)};
+}
+
+static inline Vec4 vecMulAdd(Vec4 acc, Vec4 a, Vec4 b)
+{
+    return {_mm_add_ps(acc.value, _mm_mul_ps(a.value, b.value))};
+}
+
+static inline Vec4 vecMulAdd(Vec4 acc, Vec4 a, float b)
+{
+    return {_mm_add_ps(acc.value, _mm_mul_ps(a.value, _mm_set1_ps(b)))};
+}
+
+static inline void vecStore(Vec4 v, float *out)
+{
+    _mm_storeu_ps(out, v.value);
+}
+
+// 4 bytes (RGBA) to floats
+static inline Vec4 vecFromBytes(uint32_t packed)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(packed)), zero);
+    return {_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero))};
+}
+
+// Clamp to [0, 255], truncate and pack the 4 lanes into bytes
+static inline uint32_t vecToBytes(Vec4 v)
+{
+    __m128 clamped = _mm_min_ps(_mm_max_ps(v.value, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+    __m128i ints = _mm_cvttps_epi32(clamped);
+    ints = _mm_packs_epi32(ints, ints);
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(ints, ints)));
+}
+
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+
+static void computeBilinearQuad(const float *u, const float *v, int srcW, int srcH, BilinearQuad &quad)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t sx = vsubq_f32(vmulq_n_f32(vld1q_f32(u), static_cast<float>(srcW)), vdupq_n_f32(0.5f));
+    const float32x4_t sy = vsubq_f32(vmulq_n_f32(vld1q_f32(v), static_cast<float>(srcH)), vdupq_n_f32(0.5f));
+    const float32x4_t fx = vrndmq_f32(sx);
+    const float32x4_t fy = vrndmq_f32(sy);
+
+    const float32x4_t xFrac = vsubq_f32(sx, fx);
+    const float32x4_t yFrac = vsubq_f32(sy, fy);
+    const float32x4_t xInv = vsubq_f32(one, xFrac);
+    const float32x4_t yInv = vsubq_f32(one, yFrac);
+    vst1q_f32(quad.w00, vmulq_f32(xInv, yInv));
+    vst1q_f32(quad.w10, vmulq_f32(xFrac, yInv));
+    vst1q_f32(quad.w01, vmulq_f32(xInv, yFrac));
+    vst1q_f32(quad.w11, vmulq_f32(xFrac, yFrac));
+
+    const int32x4_t width = vdupq_n_s32(srcW);
+    int32x4_t x0 = vcvtq_s32_f32(fx);
+    int32x4_t x1 = vaddq_s32(x0, vdupq_n_s32(1));
+    x0 = vaddq_s32(x0, vandq_s32(vreinterpretq_s32_u32(vcltq_s32(x0, vdupq_n_s32(0))), width));
+    x1 = vsubq_s32(x1, vandq_s32(vreinterpretq_s32_u32(vcgeq_s32(x1, width)), width));
+    vst1q_s32(quad.x0, x0);
+    vst1q_s32(quad.x1, x1);
+
+    const int32x4_t maxRow = vdupq_n_s32(srcH - 1);
+    const int32x4_t y0 = vcvtq_s32_f32(fy);
+    vst1q_s32(quad.y0, vminq_s32(vmaxq_s32(y0, vdupq_n_s32(0)), maxRow));
+    vst1q_s32(quad.y1, vminq_s32(vmaxq_s32(vaddq_s32(y0, vdupq_n_s32(1)), vdupq_n_s32(0)), maxRow));
+}
+
+struct Vec4
+{
+    float32x4_t value;
+};
+
+static inline Vec4 vecZero()
+{
+    return {vdupq_n_f32(0.0f)};
+}
+
+static inline Vec4 vecSet(float a, float b, float c, float d)
+{
+    const float values[4] = {a, b, c, d};
+    return {vld1q_f32(values)};
+}
+
+static inline Vec4 vecLoad(const float *values)
+{
+    return {vld1q_f32(values)};
+}
+
+static inline Vec4 vecLoadUnaligned(const float *values)
+{
+    return {vld1q_f32(values)};
+}
+
+static inline Vec4 vecMulAdd(Vec4 acc, Vec4 a, Vec4 b)
+{
+    return {vfmaq_f32(acc.value, a.value, b.value)};
+}
+
+static inline Vec4 vecMulAdd(Vec4 acc, Vec4 a, float b)
+{
+    return {vfmaq_n_f32(acc.value, a.value, b)};
+}
+
+static inline void vecStore(Vec4 v, float *out)
+{
+    vst1q_f32(out, v.value);
+}
+
+static inline Vec4 vecFromBytes(uint32_t packed)
+{
+    uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(packed));
+    return {vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))))};
+}
+
+static inline uint32_t vecToBytes(Vec4 v)
+{
+    float32x4_t clamped = vminq_f32(vmaxq_f32(v.value, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+    uint16x4_t words = vmovn_u32(vcvtq_u32_f32(clamped));
+    return vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(words, words))), 0);
+}
+
+#else
+
+static void computeBilinearQuad(const float *u, const float *v, int srcW, int srcH, BilinearQuad &quad)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        const float sx = u[i] * srcW - 0.5f;
+        const float sy = v[i] * srcH - 0.5f;
+        const float fx = std::floor(sx);
+        const float fy = std::floor(sy);
+        const float xFrac = sx - fx;
+        const float yFrac = sy - fy;
+        quad.w00[i] = (1.0f - xFrac) * (1.0f - yFrac);
+        quad.w10[i] = xFrac * (1.0f - yFrac);
+        quad.w01[i] = (1.0f - xFrac) * yFrac;
+        quad.w11[i] = xFrac * yFrac;
+
+        const int x0 = static_cast<int>(fx);
+        quad.x0[i] = x0 < 0 ? x0 + srcW : x0;
+        quad.x1[i] = x0 + 1 >= srcW ? x0 + 1 - srcW : x0 + 1;
+        quad.y0[i] = std::clamp(static_cast<int>(fy), 0, srcH - 1);
+        quad.y1[i] = std::clamp(static_cast<int>(fy) + 1, 0, srcH - 1);
+    }
+}
+
+struct Vec4
+{
+    float value[4];
+};
+
+static inline Vec4 vecZero()
+{
+    return {{0.0f, 0.0f, 0.0f, 0.0f}};
+}
+
+static inline Vec4 vecSet(float a, float b, float c, float d)
+{
+    return {{a, b, c, d}};
+}
+
+static inline Vec4 vecLoad(const float *values)
+{
+    return {{values[0], values[1], values[2], values[3]}};
+}
+
+static inline Vec4 vecLoadUnaligned(const float *values)
+{
+    return vecLoad(values);
+}
+
+static inline Vec4 vecMulAdd(Vec4 acc, Vec4 a, Vec4 b)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        acc.value[i] += a.value[i] * b.value[i];
+    }
+    return acc;
+}
+
+static inline Vec4 vecMulAdd(Vec4 acc, Vec4 a, float b)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        acc.value[i] += a.value[i] * b;
+    }
+    return acc;
+}
+
+static inline void vecStore(Vec4 v, float *out)
+{
+    std::memcpy(out, v.value, sizeof(v.value));
+}
+
+static inline Vec4 vecFromBytes(uint32_t packed)
+{
+    uint8_t bytes[4];
+    std::memcpy(bytes, &packed, sizeof(bytes));
+    return {{static_cast<float>(bytes[0]),
+             static_cast<float>(bytes[1]),
+             static_cast<float>(bytes[2]),
+             static_cast<float>(bytes[3])}};
+}
+
+static inline uint32_t vecToBytes(Vec4 v)
+{
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++)
+    {
+        bytes[i] = static_cast<uint8_t>(std::clamp(v.value[i], 0.0f, 255.0f));
+    }
+    uint32_t packed;
+    std::memcpy(&packed, bytes, sizeof(packed));
+    return packed;
+}
+
+#endif
+
+// One texel as 4 lanes (unused lanes are 0)
+// Assembled in registers: a partial memcpy into a word would stall the following full-width load
+template <int Channels> static inline Vec4 loadTexel(const unsigned char *texel)
+{
+    uint32_t packed = texel[0];
+    for (int c = 1; c < Channels; c++)
+    {
+        packed |= static_cast<uint32_t>(texel[c]) << (8 * c);
+    }
+    return vecFromBytes(packed);
+}
+
+template <int Channels> static inline Vec4 loadTexel(const float *texel)
+{
+    if (Channels == 4)
+    {
+        return vecLoadUnaligned(texel);
+    }
+    return vecSet(texel[0], Channels > 1 ? texel[1] : 0.0f, Channels > 2 ? texel[2] : 0.0f, 0.0f);
+}
+
+// Same conversion as sampleEquirectangularUChar (clamp, then truncate); writes the first `count` lanes
+static inline void storeLanes(Vec4 v, int count, unsigned char *out)
+{
+    uint32_t packed = vecToBytes(v);
+    std::memcpy(out, &packed, count);
+}
+
+static inline void storeLanes(Vec4 v, int count, float *out)
+{
+    alignas(16) float values[4];
+    vecStore(v, values);
+    std::memcpy(out, values, sizeof(float) * count);
+}
+
+// Blend the n (<= 4) samples of a quad; srcW is the row length of src in pixels
+template <int Channels, typename T>
+static void blendQuad(const T *src, int srcW, const BilinearQuad &quad, int n, T *out)
+{
+    if (Channels == 1)
+    {
+        // One lane per sample
+        auto tap = [&](const int *xs, const int *ys, int k) { return src[static_cast<size_t>(ys[k]) * srcW + xs[k]]; };
+        Vec4 acc = vecZero();
+        acc = vecMulAdd(acc,
+                        vecSet(tap(quad.x0, quad.y0, 0),
+                               tap(quad.x0, quad.y0, 1),
+                               tap(quad.x0, quad.y0, 2),
+                               tap(quad.x0, quad.y0, 3)),
+                        vecLoad(quad.w00));
+        acc = vecMulAdd(acc,
+                        vecSet(tap(quad.x1, quad.y0, 0),
+                               tap(quad.x1, quad.y0, 1),
+                               tap(quad.x1, quad.y0, 2),
+                               tap(quad.x1, quad.y0, 3)),
+                        vecLoad(quad.w10));
+        acc = vecMulAdd(acc,
+                        vecSet(tap(quad.x0, quad.y1, 0),
+                               tap(quad.x0, quad.y1, 1),
+                               tap(quad.x0, quad.y1, 2),
+                               tap(quad.x0, quad.y1, 3)),
+                        vecLoad(quad.w01));
+        acc = vecMulAdd(acc,
+                        vecSet(tap(quad.x1, quad.y1, 0),
+                               tap(quad.x1, quad.y1, 1),
+                               tap(quad.x1, quad.y1, 2),
+                               tap(quad.x1, quad.y1, 3)),
+                        vecLoad(quad.w11));
+        storeLanes(acc, n, out);
+        return;
+    }
+
+    // One sample per vector, channels in lanes
+    for (int k = 0; k < n; k++)
+    {
+        const T *row0 = src + static_cast<size_t>(quad.y0[k]) * srcW * Channels;
+        const T *row1 = src + static_cast<size_t>(quad.y1[k]) * srcW * Channels;
+        Vec4 acc = vecZero();
+        acc = vecMulAdd(acc, loadTexel<Channels>(row0 + quad.x0[k] * Channels), quad.w00[k]);
+        acc = vecMulAdd(acc, loadTexel<Channels>(row0 + quad.x1[k] * Channels), quad.w10[k]);
+        acc = vecMulAdd(acc, loadTexel<Channels>(row1 + quad.x0[k] * Channels), quad.w01[k]);
+        acc = vecMulAdd(acc, loadTexel<Channels>(row1 + quad.x1[k] * Channels), quad.w11[k]);
+        storeLanes(acc, Channels, out + static_cast<size_t>(k) * Channels);
+    }
+}
+
+// Bilinear samples of an equirectangular image at `count` UV positions
+template <int Channels, typename T>
+static void sampleEquirectangularRow(const T *src,
+                                     int srcW,
+                                     int srcH,
+                                     const float *u,
+                                     const float *v,
+                                     int count,
+                                     T *out)
+{
+    BilinearQuad quad;
+    alignas(16) float paddedU[4];
+    alignas(16) float paddedV[4];
+
+    for (int i = 0; i < count; i += 4)
+    {
+        const int n = std::min(4, count - i);
+        const float *quadU = u + i;
+        const float *quadV = v + i;
+        if (n < 4)
+        {
+            std::fill(paddedU, paddedU + 4, 0.0f);
+            std::fill(paddedV, paddedV + 4, 0.0f);
+            std::copy(quadU, quadU + n, paddedU);
+            std::copy(quadV, quadV + n, paddedV);
+            quadU = paddedU;
+            quadV = paddedV;
+        }
+        computeBilinearQuad(quadU, quadV, srcW, srcH, quad);
+        blendQuad<Channels>(src, srcW, quad, n, out + static_cast<size_t>(i) * Channels);
+    }
+}
+
+// Bilinear samples of a cubemap grid along one equirectangular row; dirX/dirZ per sample, dirY shared
+// Same taps as sampleCubemapGridUChar: face from the major axis, clamped to the face's own region
+template <int Channels>
+static void sampleCubemapGridRow(const unsigned char *cubemapData,
+                                 int faceSize,
+                                 const float *dirX,
+                                 float dirY,
+                                 const float *dirZ,
+                                 int count,
+                                 unsigned char *out)
+{
+    const int gridWidth = faceSize * 3;
+    BilinearQuad quad = {};
+
+    for (int i = 0; i < count; i += 4)
+    {
+        const int n = std::min(4, count - i);
+        for (int k = 0; k < n; k++)
+        {
+            int face;
+            float faceU, faceV;
+            directionToCubemapFaceUV(dirX[i + k], dirY, dirZ[i + k], face, faceU, faceV);
+
+            int col, row;
+            getCubemapFaceGridPosition(face, col, row);
+            const float srcX = (col + faceU) * faceSize - 0.5f;
+            const float srcY = (row + faceV) * faceSize - 0.5f;
+            const int x0 = static_cast<int>(std::floor(srcX));
+            const int y0 = static_cast<int>(std::floor(srcY));
+            const float xFrac = srcX - x0;
+            const float yFrac = srcY - y0;
+
+            const int faceStartX = col * faceSize;
+            const int faceStartY = row * faceSize;
+            quad.x0[k] = std::clamp(x0, faceStartX, faceStartX + faceSize - 1);
+            quad.x1[k] = std::clamp(x0 + 1, faceStartX, faceStartX + faceSize - 1);
+            quad.y0[k] = std::clamp(y0, faceStartY, faceStartY + faceSize - 1);
+            quad.y1[k] = std::clamp(y0 + 1, faceStartY, faceStartY + faceSize - 1);
+            quad.w00[k] = (1.0f - xFrac) * (1.0f - yFrac);
+            quad.w10[k] = xFrac * (1.0f - yFrac);
+            quad.w01[k] = (1.0f - xFrac) * yFrac;
+            quad.w11[k] = xFrac * yFrac;
+        }
+        blendQuad<Channels>(cubemapData, gridWidth, quad, n, out + static_cast<size_t>(i) * Channels);
+    }
+}
+
+template <typename T>
+static void sampleEquirectangularRow(const T *src,
+                                     int srcW,
+                                     int srcH,
+                                     int channels,
+                                     const float *u,
+                                     const float *v,
+                                     int count,
+                                     T *out)
+{
+    switch (channels)
+    {
+    case 1:
+        sampleEquirectangularRow<1>(src, srcW, srcH, u, v, count, out);
+        break;
+    case 2:
+        sampleEquirectangularRow<2>(src, srcW, srcH, u, v, count, out);
+        break;
+    case 3:
+        sampleEquirectangularRow<3>(src, srcW, srcH, u, v, count, out);
+        break;
+    default:
+        sampleEquirectangularRow<4>(src, srcW, srcH, u, v, count, out);
+        break;
+    }
+}
+
+static void sampleCubemapGridRow(const unsigned char *cubemapData,
+                                 int faceSize,
+                                 int channels,
+                                 const float *dirX,
+                                 float dirY,
+                                 const float *dirZ,
+                                 int count,
+                                 unsigned char *out)
+{
+    switch (channels)
+    {
+    case 1:
+        sampleCubemapGridRow<1>(cubemapData, faceSize, dirX, dirY, dirZ, count, out);
+        break;
+    case 2:
+        sampleCubemapGridRow<2>(cubemapData, faceSize, dirX, dirY, dirZ, count, out);
+        break;
+    case 3:
+        sampleCubemapGridRow<3>(cubemapData, faceSize, dirX, dirY, dirZ, count, out);
+        break;
+    default:
+        sampleCubemapGridRow<4>(cubemapData, faceSize, dirX, dirY, dirZ, count, out);
+        break;
+    }
+}
+
+// ----------------------------------
+// Row Driver
+// ----------------------------------
+
+template <typename T>
+static void convertGridRows(const CubemapFaceTables &tables,
+                            const T *equirectData,
+                            int equirectW,
+                            int equirectH,
+                            int channels,
+                            int gridBegin,
+                            int gridEnd,
+                            T *gridData)
+{
+    const int faceSize = tables.faceSize;
+    const size_t gridRowValues = static_cast<size_t>(faceSize) * 3 * channels;
+    std::vector<float> u(faceSize);
+    std::vector<float> v(faceSize);
+
+    for (int gridY = gridBegin; gridY < gridEnd; gridY++)
+    {
+        const int row = gridY / faceSize;
+        const int y = gridY % faceSize;
+        T *rowOut = gridData + static_cast<size_t>(gridY - gridBegin) * gridRowValues;
+
+        // The three faces of this grid row, left to right
+        for (int col = 0; col < 3; col++)
+        {
+            faceRowUV(tables, row * 3 + col, y, u.data(), v.data());
+            sampleEquirectangularRow(equirectData,
+                                     equirectW,
+                                     equirectH,
+                                     channels,
+                                     u.data(),
+                                     v.data(),
+                                     faceSize,
+                                     rowOut + static_cast<size_t>(col) * faceSize * channels);
+        }
+    }
+}
+
+template <typename T>
+static T *convertEquirectangularToCubemap(const T *equirectData,
+                                          int equirectW,
+                                          int equirectH,
+                                          int channels,
+                                          int faceSize,
+                                          bool parallel)
 {
     // 3x2 grid: width = faceSize * 3, height = faceSize * 2
     int gridWidth = faceSize * 3;
     int gridHeight = faceSize * 2;
     size_t cubemapSize = static_cast<size_t>(gridWidth) * gridHeight * channels;
-    float *cubemapData = new (std::nothrow) float[cubemapSize];
+    T *cubemapData = new (std::nothrow) T[cubemapSize];
     if (!cubemapData)
     {
-        std::cerr << "    ERROR: Failed to allocate memory for cubemap (" << cubemapSize * sizeof(float) << " bytes)\n";
+        std::cerr << "    ERROR: Failed to allocate memory for cubemap (" << cubemapSize * sizeof(T) << " bytes)\n";
         return nullptr;
     }
 
@@ -426,54 +1076,69 @@ float *convertEquirectangularToCubemapFloat(const float *equirectData,
     std::cout << "      Cubemap face size: " << faceSize << "x" << faceSize << "\n";
     std::cout << "      Output: " << gridWidth << "x" << gridHeight << " (3x2 grid)\n";
 
-    // Convert each face
-    for (int face = 0; face < 6; face++)
-    {
-        // Get grid position for this face
-        int col, row;
-        getCubemapFaceGridPosition(face, col, row);
-        int faceStartX = col * faceSize;
-        int faceStartY = row * faceSize;
-
-        for (int y = 0; y < faceSize; y++)
-        {
-            for (int x = 0; x < faceSize; x++)
-            {
-                // Get 3D direction for this pixel
-                float dirX, dirY, dirZ;
-                cubemapPixelToDirection(face, x, y, faceSize, dirX, dirY, dirZ);
-
-                // Convert direction to equirectangular UV
-                float u, v;
-                directionToEquirectangularUV(dirX, dirY, dirZ, u, v);
-
-                // Calculate pixel position in 3x2 grid
-                int gridX = faceStartX + x;
-                int gridY = faceStartY + y;
-                size_t pixelOffset = (static_cast<size_t>(gridY) * gridWidth + gridX) * channels;
-
-                // Sample equirectangular image
-                sampleEquirectangularFloat(equirectData,
-                                           equirectW,
-                                           equirectH,
-                                           channels,
-                                           u,
-                                           v,
-                                           &cubemapData[pixelOffset]);
-            }
-        }
-    }
+    std::shared_ptr<const CubemapFaceTables> tables = getFaceTables(faceSize);
+    ParallelRows::forEachRowBand(gridHeight, 8, parallel, [&](int rowBegin, int rowEnd) {
+        convertGridRows(*tables,
+                        equirectData,
+                        equirectW,
+                        equirectH,
+                        channels,
+                        rowBegin,
+                        rowEnd,
+                        cubemapData + static_cast<size_t>(rowBegin) * gridWidth * channels);
+    });
 
     return cubemapData;
 }
 
+// ==================================
+// Whole-Image Conversions
+// ==================================
+
+// Convert one row of the cubemap grid (3x2 layout) from an equirectangular image
+void convertEquirectangularToCubemapGridRowUChar(const unsigned char *equirectData,
+                                                 int equirectW,
+                                                 int equirectH,
+                                                 int channels,
+                                                 int faceSize,
+                                                 int gridY,
+                                                 unsigned char *rowOut)
+{
+    std::shared_ptr<const CubemapFaceTables> tables = getFaceTables(faceSize);
+    convertGridRows(*tables, equirectData, equirectW, equirectH, channels, gridY, gridY + 1, rowOut);
+}
+
+// Convert equirectangular unsigned char image to cubemap format (3x2 grid)
+unsigned char *convertEquirectangularToCubemapUChar(const unsigned char *equirectData,
+                                                    int equirectW,
+                                                    int equirectH,
+                                                    int channels,
+                                                    int faceSize,
+                                                    bool parallel)
+{
+    return convertEquirectangularToCubemap(equirectData, equirectW, equirectH, channels, faceSize, parallel);
+}
+
+// Convert equirectangular HDR image to cubemap format (3x2 grid)
+float *convertEquirectangularToCubemapFloat(const float *equirectData,
+                                            int equirectW,
+                                            int equirectH,
+                                            int channels,
+                                            int faceSize,
+                                            bool parallel)
+{
+    return convertEquirectangularToCubemap(equirectData, equirectW, equirectH, channels, faceSize, parallel);
+}
+
 // Convert cubemap grid image to equirectangular format (unsigned char version)
 // This is the inverse of convertEquirectangularToCubemapUChar
+// Directions come from per-column and per-row sin/cos tables instead of trigonometry per pixel
 unsigned char *convertCubemapToEquirectangularUChar(const unsigned char *cubemapData,
                                                     int faceSize,
                                                     int channels,
                                                     int equirectW,
-                                                    int equirectH)
+                                                    int equirectH,
+                                                    bool parallel)
 {
     size_t equirectSize = static_cast<size_t>(equirectW) * equirectH * channels;
     unsigned char *equirectData = new (std::nothrow) unsigned char[equirectSize];
@@ -487,24 +1152,38 @@ unsigned char *convertCubemapToEquirectangularUChar(const unsigned char *cubemap
     std::cout << "      Cubemap face size: " << faceSize << "x" << faceSize << "\n";
     std::cout << "      Output: " << equirectW << "x" << equirectH << "\n";
 
-    // For each pixel in the equirectangular output
-    for (int y = 0; y < equirectH; y++)
+    // Same angles as equirectangularUVToDirection at pixel centers
+    std::vector<float> sinTheta(equirectW);
+    std::vector<float> cosTheta(equirectW);
+    for (int x = 0; x < equirectW; x++)
     {
-        for (int x = 0; x < equirectW; x++)
-        {
-            // Convert pixel position to UV
-            float u = (x + 0.5f) / equirectW;
-            float v = (y + 0.5f) / equirectH;
-
-            // Convert UV to 3D direction
-            float dirX, dirY, dirZ;
-            equirectangularUVToDirection(u, v, dirX, dirY, dirZ);
+        float theta = ((x + 0.5f) / equirectW - 0.5f) * 2.0f * static_cast<float>(PI);
+        sinTheta[x] = std::sin(theta);
+        cosTheta[x] = std::cos(theta);
+    }
 
-            // Sample cubemap at this direction
-            size_t pixelOffset = (static_cast<size_t>(y) * equirectW + x) * channels;
-            sampleCubemapGridUChar(cubemapData, faceSize, channels, dirX, dirY, dirZ, &equirectData[pixelOffset]);
+    ParallelRows::forEachRowBand(equirectH, 8, parallel, [&](int rowBegin, int rowEnd) {
+        std::vector<float> dirX(equirectW);
+        std::vector<float> dirZ(equirectW);
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            float phi = (0.5f - (y + 0.5f) / equirectH) * static_cast<float>(PI);
+            float cosPhi = std::cos(phi);
+            for (int x = 0; x < equirectW; x++)
+            {
+                dirX[x] = sinTheta[x] * cosPhi;
+                dirZ[x] = cosTheta[x] * cosPhi;
+            }
+            sampleCubemapGridRow(cubemapData,
+                                 faceSize,
+                                 channels,
+                                 dirX.data(),
+                                 std::sin(phi),
+                                 dirZ.data(),
+                                 equirectW,
+                                 equirectData + static_cast<size_t>(y) * equirectW * channels);
         }
-    }
+    });
 
     return equirectData;
 }
@@ -12,6 +12,9 @@
 //   -Y  +Z  -Z   (row 1)
 // Face order: +X, -X, +Y, -Y, +Z, -Z (matches Vulkan VK_IMAGE_VIEW_TYPE_CUBE)
 // Grid dimensions: width = faceSize * 3, height = faceSize * 2
+//
+// The whole-image conversions read face pixel -> UV from lookup tables shared by every
+// texture of the same face size, sample 4 pixels at a time and split rows across threads.
 
 #include <cstddef>
 
@@ -116,11 +119,25 @@ void sampleCubemapStripUChar(const unsigned char *cubemapData,
 // Faces are arranged in 3x2 grid: +X -X +Y (row 0), -Y +Z -Z (row 1)
 // Caller must delete[] the returned array
 // Returns nullptr on allocation failure
+// parallel: split grid rows across hardware threads
 unsigned char *convertEquirectangularToCubemapUChar(const unsigned char *equirectData,
                                                     int equirectW,
                                                     int equirectH,
                                                     int channels,
-                                                    int faceSize);
+                                                    int faceSize,
+                                                    bool parallel = true);
+
+// Convert one row of the cubemap grid (3x2 layout) from an equirectangular image
+// gridY: grid row in [0, faceSize * 2); rowOut receives faceSize * 3 * channels bytes
+// Lets callers produce (and write) large grids row by row instead of holding the whole grid
+// Safe to call from several threads at once (the lookup tables are shared, read-only)
+void convertEquirectangularToCubemapGridRowUChar(const unsigned char *equirectData,
+                                                 int equirectW,
+                                                 int equirectH,
+                                                 int channels,
+                                                 int faceSize,
+                                                 int gridY,
+                                                 unsigned char *rowOut);
 
 // Convert equirectangular HDR image to cubemap format (3x2 grid)
 // Returns cubemap data as float array: (faceSize * 3) x (faceSize * 2) x channels
@@ -131,7 +148,8 @@ float *convertEquirectangularToCubemapFloat(const float *equirectData,
                                             int equirectW,
                                             int equirectH,
                                             int channels,
-                                            int faceSize);
+                                            int faceSize,
+                                            bool parallel = true);
 
 // Convert cubemap grid image to equirectangular format (unsigned char version)
 // This is the inverse of convertEquirectangularToCubemapUChar
@@ -146,7 +164,8 @@ unsigned char *convertCubemapToEquirectangularUChar(const unsigned char *cubemap
                                                     int faceSize,
                                                     int channels,
                                                     int equirectW,
-                                                    int equirectH);
+                                                    int equirectH,
+                                                    bool parallel = true);
 
 // Helper to calculate recommended face size for a given equirectangular image
 // For 2:1 aspect ratio images, returns height/2 which gives good quality
@@ -0,0 +1,67 @@
+#pragma once
+
+// ============================================================================
+// Parallel Row Bands
+// ============================================================================
+// Splits the rows of an image (or any row-major table) into contiguous bands, one per
+// hardware thread, and runs each band on its own thread. Contiguous bands let a thread
+// reuse its scratch buffers from row to row, and band boundaries depend only on the row
+// count and the number of bands, so several passes over the same bands line up.
+//
+// Every function takes `parallel`: false runs all rows on the calling thread. Pass false
+// from code that already runs one task per core, so the two levels do not oversubscribe.
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace ParallelRows
+{
+
+// Number of bands for `rows` rows: one per hardware thread, each at least minRows rows (at least 1 band)
+inline int bandCount(int rows, int minRows, bool parallel)
+{
+    int bands = parallel ? static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) : 1;
+    return std::max(1, std::min(bands, rows / std::max(1, minRows)));
+}
+
+// First row of `band` out of `bands` over `rows` rows (band == bands gives rows)
+inline int bandBegin(int rows, int band, int bands)
+{
+    return static_cast<int>(static_cast<int64_t>(rows) * band / bands);
+}
+
+// Call bandFunction(band) for every band in [0, bands), each on its own thread
+template <typename BandFunction> void forEachBand(int bands, const BandFunction &bandFunction)
+{
+    if (bands <= 1)
+    {
+        bandFunction(0);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(bands);
+    for (int band = 0; band < bands; band++)
+    {
+        workers.emplace_back([&bandFunction, band]() { bandFunction(band); });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// Call rowBand(rowBegin, rowEnd) for contiguous bands covering [0, rows), at least minRows rows each
+template <typename RowBand> void forEachRowBand(int rows, int minRows, bool parallel, const RowBand &rowBand)
+{
+    if (rows <= 0)
+    {
+        return;
+    }
+    const int bands = bandCount(rows, minRows, parallel);
+    forEachBand(bands, [&](int band) { rowBand(bandBegin(rows, band, bands), bandBegin(rows, band + 1, bands)); });
+}
+
+} // namespace ParallelRows
@@ -0,0 +1,1032 @@
+// ============================================================================
+// Image Resampling - Implementation
+// ============================================================================
+// Rows are processed as floats. Channel counts 2-4 are widened to 4 lanes per pixel so
+// the horizontal filter handles one pixel per 128-bit vector; single-channel images stay
+// packed and filter along the taps instead.
+
+#include "resampling.h"
+#include "parallel-rows.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RESAMPLING_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RESAMPLING_TARGET(isa)
+#else
+#define RESAMPLING_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define RESAMPLING_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Resampling
+{
+
+// ==================================
+// Filter Weights
+// ==================================
+
+// Weights for one axis: output i blends `taps` consecutive source samples starting at first[i]
+// (weights zero padded, so every output uses the same tap count)
+struct Axis
+{
+    int taps = 0;
+    std::vector<int> first;
+    std::vector<float> weights;
+};
+
+static float filterSupport(Filter filter)
+{
+    switch (filter)
+    {
+    case Filter::Box:
+        return 0.5f;
+    case Filter::Bilinear:
+        return 1.0f;
+    case Filter::Lanczos3:
+        return 3.0f;
+    }
+    return 1.0f;
+}
+
+static float filterWeight(Filter filter, float x)
+{
+    x = std::fabs(x);
+    switch (filter)
+    {
+    case Filter::Box:
+        return x <= 0.5f ? 1.0f : 0.0f;
+    case Filter::Bilinear:
+        return std::max(0.0f, 1.0f - x);
+    case Filter::Lanczos3:
+    {
+        if (x < 1e-6f)
+        {
+            return 1.0f;
+        }
+        if (x >= 3.0f)
+        {
+            return 0.0f;
+        }
+        const float pix = 3.14159265358979f * x;
+        return 3.0f * std::sin(pix) * std::sin(pix / 3.0f) / (pix * pix);
+    }
+    }
+    return 0.0f;
+}
+
+static Axis buildAxis(int srcSize, int dstSize, Filter filter)
+{
+    Axis axis;
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    const double filterScale = std::max(1.0, scale); // Widen the filter when downsampling
+    const double support = filterSupport(filter) * filterScale;
+
+    axis.taps = std::min(srcSize, static_cast<int>(std::floor(2.0 * support)) + 1);
+    axis.first.resize(dstSize);
+    axis.weights.assign(static_cast<size_t>(dstSize) * axis.taps, 0.0f);
+
+    for (int i = 0; i < dstSize; i++)
+    {
+        // Source position of the output pixel's center
+        const double center = (i + 0.5) * scale - 0.5;
+        const int lo = static_cast<int>(std::ceil(center - support));
+        const int hi = static_cast<int>(std::floor(center + support));
+        const int first = std::clamp(std::max(lo, 0), 0, srcSize - axis.taps);
+        float *weights = &axis.weights[static_cast<size_t>(i) * axis.taps];
+
+        // Taps outside the image fold onto the edge pixels
+        float sum = 0.0f;
+        for (int j = lo; j <= hi; j++)
+        {
+            float w = filterWeight(filter, static_cast<float>((j - center) / filterScale));
+            weights[std::clamp(j, 0, srcSize - 1) - first] += w;
+            sum += w;
+        }
+
+        if (std::fabs(sum) > 1e-8f)
+        {
+            for (int k = 0; k < axis.taps; k++)
+            {
+                weights[k] /= sum;
+            }
+        }
+        else
+        {
+            std::fill(weights, weights + axis.taps, 0.0f);
+            weights[std::clamp(static_cast<int>(std::lround(center)), 0, srcSize - 1) - first] = 1.0f;
+        }
+        axis.first[i] = first;
+    }
+    return axis;
+}
+
+// ==================================
+// Kernels
+// ==================================
+// horizontal4: 4-lane pixels; horizontal1: single-channel pixels
+// vertical:    dst[i] = sum over taps of weights[k] * rows[k][i]
+// load / store: contiguous conversion to and from float (stores round and clamp)
+// widenRGB8:   8-bit RGB to 4-lane pixels, the common case for Earth and skybox sources
+
+struct Kernels
+{
+    const char *name;
+    void (*horizontal4)(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst);
+    void (*horizontal1)(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst);
+    void (*vertical)(const float *const *rows, const float *weights, int taps, int count, float *dst);
+    void (*loadU8)(const uint8_t *src, int count, float *dst);
+    void (*loadU16)(const uint16_t *src, int count, float *dst);
+    void (*widenRGB8)(const uint8_t *src, int width, float *dst); // 3 channels -> 4 lanes
+    void (*storeU8)(const float *src, int count, uint8_t *dst);
+    void (*storeU16)(const float *src, int count, uint16_t *dst);
+};
+
+static inline uint8_t toU8(float value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+}
+
+static inline uint16_t toU16(float value)
+{
+    return static_cast<uint16_t>(std::clamp(value, 0.0f, 65535.0f) + 0.5f);
+}
+
+// ----------------------------------
+// Scalar
+// ----------------------------------
+
+static void horizontal4Scalar(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + static_cast<size_t>(first[i]) * 4;
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int k = 0; k < taps; k++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                acc[c] += w[k] * s[k * 4 + c];
+            }
+        }
+        std::memcpy(dst + static_cast<size_t>(i) * 4, acc, sizeof(acc));
+    }
+}
+
+static void horizontal1Scalar(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + first[i];
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+        {
+            acc += w[k] * s[k];
+        }
+        dst[i] = acc;
+    }
+}
+
+static void verticalScalar(const float *const *rows, const float *weights, int taps, int count, float *dst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+        {
+            acc += weights[k] * rows[k][i];
+        }
+        dst[i] = acc;
+    }
+}
+
+static void loadU8Scalar(const uint8_t *src, int count, float *dst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = src[i];
+    }
+}
+
+static void loadU16Scalar(const uint16_t *src, int count, float *dst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = src[i];
+    }
+}
+
+static void widenRGB8Scalar(const uint8_t *src, int width, float *dst)
+{
+    for (int x = 0; x < width; x++)
+    {
+        dst[x * 4 + 0] = src[x * 3 + 0];
+        dst[x * 4 + 1] = src[x * 3 + 1];
+        dst[x * 4 + 2] = src[x * 3 + 2];
+        dst[x * 4 + 3] = 0.0f;
+    }
+}
+
+static void storeU8Scalar(const float *src, int count, uint8_t *dst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = toU8(src[i]);
+    }
+}
+
+static void storeU16Scalar(const float *src, int count, uint16_t *dst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = toU16(src[i]);
+    }
+}
+
+#ifdef RESAMPLING_X86
+
+// ----------------------------------
+// SSE4.1
+// ----------------------------------
+
+RESAMPLING_TARGET("sse4.1")
+static void horizontal4SSE(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + static_cast<size_t>(first[i]) * 4;
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + k * 4), _mm_set1_ps(w[k])));
+        }
+        _mm_storeu_ps(dst + static_cast<size_t>(i) * 4, acc);
+    }
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void horizontal1SSE(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + first[i];
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        __m128 acc = _mm_setzero_ps();
+        int k = 0;
+        for (; k + 4 <= taps; k += 4)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + k), _mm_loadu_ps(w + k)));
+        }
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        float sum = _mm_cvtss_f32(acc);
+        for (; k < taps; k++)
+        {
+            sum += w[k] * s[k];
+        }
+        dst[i] = sum;
+    }
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void verticalSSE(const float *const *rows, const float *weights, int taps, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 acc = _mm_mul_ps(_mm_loadu_ps(rows[0] + i), _mm_set1_ps(weights[0]));
+        for (int k = 1; k < taps; k++)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+        }
+        _mm_storeu_ps(dst + i, acc);
+    }
+    for (; i < count; i++)
+    {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+        {
+            acc += weights[k] * rows[k][i];
+        }
+        dst[i] = acc;
+    }
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void loadU8SSE(const uint8_t *src, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        int packed;
+        std::memcpy(&packed, src + i, sizeof(packed));
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed))));
+    }
+    loadU8Scalar(src + i, count - i, dst + i);
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void loadU16SSE(const uint16_t *src, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_cvtepu16_epi32(values)));
+    }
+    loadU16Scalar(src + i, count - i, dst + i);
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void widenRGB8SSE(const uint8_t *src, int width, float *dst)
+{
+    // Spread 4 RGB pixels (12 bytes) to RGB0 byte quads, then widen each quad to floats.
+    // Each 16-byte load reads 4 bytes past the 12 it uses, hence the two spare pixels at the end
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    int x = 0;
+    for (; x + 6 <= width; x += 4)
+    {
+        __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 3));
+        __m128i quads = _mm_shuffle_epi8(rgb, spread);
+        float *d = dst + static_cast<size_t>(x) * 4;
+        _mm_storeu_ps(d + 0, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(quads)));
+        _mm_storeu_ps(d + 4, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(quads, 4))));
+        _mm_storeu_ps(d + 8, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(quads, 8))));
+        _mm_storeu_ps(d + 12, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(quads, 12))));
+    }
+    widenRGB8Scalar(src + x * 3, width - x, dst + static_cast<size_t>(x) * 4);
+}
+
+// Clamp, add 0.5 and truncate: same rounding as the scalar toU8 / toU16
+RESAMPLING_TARGET("sse4.1")
+static __m128i roundClampSSE(__m128 values, float maxValue)
+{
+    values = _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(maxValue));
+    return _mm_cvttps_epi32(_mm_add_ps(values, _mm_set1_ps(0.5f)));
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void storeU8SSE(const float *src, int count, uint8_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = roundClampSSE(_mm_loadu_ps(src + i), 255.0f);
+        __m128i hi = roundClampSSE(_mm_loadu_ps(src + i + 4), 255.0f);
+        __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(lo, hi), _mm_setzero_si128());
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), bytes);
+    }
+    storeU8Scalar(src + i, count - i, dst + i);
+}
+
+RESAMPLING_TARGET("sse4.1")
+static void storeU16SSE(const float *src, int count, uint16_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = roundClampSSE(_mm_loadu_ps(src + i), 65535.0f);
+        __m128i hi = roundClampSSE(_mm_loadu_ps(src + i + 4), 65535.0f);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi32(lo, hi));
+    }
+    storeU16Scalar(src + i, count - i, dst + i);
+}
+
+// ----------------------------------
+// AVX2 + FMA
+// ----------------------------------
+
+RESAMPLING_TARGET("avx2,fma")
+static void horizontal4AVX2(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + static_cast<size_t>(first[i]) * 4;
+        const float *w = weights + static_cast<size_t>(i) * taps;
+
+        // Two taps (two pixels) per 256-bit vector
+        __m256 acc = _mm256_setzero_ps();
+        int k = 0;
+        for (; k + 2 <= taps; k += 2)
+        {
+            __m256 wv = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(w[k])), _mm_set1_ps(w[k + 1]), 1);
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(s + k * 4), wv, acc);
+        }
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        if (k < taps)
+        {
+            sum = _mm_fmadd_ps(_mm_loadu_ps(s + k * 4), _mm_set1_ps(w[k]), sum);
+        }
+        _mm_storeu_ps(dst + static_cast<size_t>(i) * 4, sum);
+    }
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static void horizontal1AVX2(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + first[i];
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        __m256 acc = _mm256_setzero_ps();
+        int k = 0;
+        for (; k + 8 <= taps; k += 8)
+        {
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(s + k), _mm256_loadu_ps(w + k), acc);
+        }
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        float sum = _mm_cvtss_f32(half);
+        for (; k < taps; k++)
+        {
+            sum += w[k] * s[k];
+        }
+        dst[i] = sum;
+    }
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static void verticalAVX2(const float *const *rows, const float *weights, int taps, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 acc = _mm256_mul_ps(_mm256_loadu_ps(rows[0] + i), _mm256_set1_ps(weights[0]));
+        for (int k = 1; k < taps; k++)
+        {
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(rows[k] + i), _mm256_set1_ps(weights[k]), acc);
+        }
+        _mm256_storeu_ps(dst + i, acc);
+    }
+    for (; i < count; i++)
+    {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+        {
+            acc += weights[k] * rows[k][i];
+        }
+        dst[i] = acc;
+    }
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static void loadU8AVX2(const uint8_t *src, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)));
+    }
+    loadU8Scalar(src + i, count - i, dst + i);
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static void loadU16AVX2(const uint16_t *src, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(values)));
+    }
+    loadU16Scalar(src + i, count - i, dst + i);
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static __m256i roundClampAVX2(__m256 values, float maxValue)
+{
+    values = _mm256_min_ps(_mm256_max_ps(values, _mm256_setzero_ps()), _mm256_set1_ps(maxValue));
+    return _mm256_cvttps_epi32(_mm256_add_ps(values, _mm256_set1_ps(0.5f)));
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static void storeU8AVX2(const float *src, int count, uint8_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i ints = roundClampAVX2(_mm256_loadu_ps(src + i), 255.0f);
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(words, _mm_setzero_si128()));
+    }
+    storeU8Scalar(src + i, count - i, dst + i);
+}
+
+RESAMPLING_TARGET("avx2,fma")
+static void storeU16AVX2(const float *src, int count, uint16_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i ints = roundClampAVX2(_mm256_loadu_ps(src + i), 65535.0f);
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), words);
+    }
+    storeU16Scalar(src + i, count - i, dst + i);
+}
+
+static bool cpuSupportsSSE41()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static bool cpuSupportsAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif // RESAMPLING_X86
+
+#ifdef RESAMPLING_NEON
+
+// ----------------------------------
+// NEON (ARM64)
+// ----------------------------------
+
+static void horizontal4NEON(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + static_cast<size_t>(first[i]) * 4;
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (int k = 0; k < taps; k++)
+        {
+            acc = vfmaq_n_f32(acc, vld1q_f32(s + k * 4), w[k]);
+        }
+        vst1q_f32(dst + static_cast<size_t>(i) * 4, acc);
+    }
+}
+
+static void horizontal1NEON(const float *src, int dstW, int taps, const int *first, const float *weights, float *dst)
+{
+    for (int i = 0; i < dstW; i++)
+    {
+        const float *s = src + first[i];
+        const float *w = weights + static_cast<size_t>(i) * taps;
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        int k = 0;
+        for (; k + 4 <= taps; k += 4)
+        {
+            acc = vfmaq_f32(acc, vld1q_f32(s + k), vld1q_f32(w + k));
+        }
+        float sum = vaddvq_f32(acc);
+        for (; k < taps; k++)
+        {
+            sum += w[k] * s[k];
+        }
+        dst[i] = sum;
+    }
+}
+
+static void verticalNEON(const float *const *rows, const float *weights, int taps, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t acc = vmulq_n_f32(vld1q_f32(rows[0] + i), weights[0]);
+        for (int k = 1; k < taps; k++)
+        {
+            acc = vfmaq_n_f32(acc, vld1q_f32(rows[k] + i), weights[k]);
+        }
+        vst1q_f32(dst + i, acc);
+    }
+    for (; i < count; i++)
+    {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+        {
+            acc += weights[k] * rows[k][i];
+        }
+        dst[i] = acc;
+    }
+}
+
+static void loadU8NEON(const uint8_t *src, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t words = vmovl_u8(vld1_u8(src + i));
+        vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))));
+    }
+    loadU8Scalar(src + i, count - i, dst + i);
+}
+
+static void loadU16NEON(const uint16_t *src, int count, float *dst)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vld1_u16(src + i))));
+    }
+    loadU16Scalar(src + i, count - i, dst + i);
+}
+
+static void widenRGB8NEON(const uint8_t *src, int width, float *dst)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        uint8x8x3_t rgb = vld3_u8(src + x * 3);
+        uint16x8_t r = vmovl_u8(rgb.val[0]);
+        uint16x8_t g = vmovl_u8(rgb.val[1]);
+        uint16x8_t b = vmovl_u8(rgb.val[2]);
+        float32x4x4_t lo = {{vcvtq_f32_u32(vmovl_u16(vget_low_u16(r))),
+                             vcvtq_f32_u32(vmovl_u16(vget_low_u16(g))),
+                             vcvtq_f32_u32(vmovl_u16(vget_low_u16(b))),
+                             zero}};
+        float32x4x4_t hi = {{vcvtq_f32_u32(vmovl_u16(vget_high_u16(r))),
+                             vcvtq_f32_u32(vmovl_u16(vget_high_u16(g))),
+                             vcvtq_f32_u32(vmovl_u16(vget_high_u16(b))),
+                             zero}};
+        vst4q_f32(dst + static_cast<size_t>(x) * 4, lo);
+        vst4q_f32(dst + static_cast<size_t>(x) * 4 + 16, hi);
+    }
+    widenRGB8Scalar(src + x * 3, width - x, dst + static_cast<size_t>(x) * 4);
+}
+
+static uint32x4_t roundClampNEON(float32x4_t values, float maxValue)
+{
+    values = vminq_f32(vmaxq_f32(values, vdupq_n_f32(0.0f)), vdupq_n_f32(maxValue));
+    return vcvtq_u32_f32(vaddq_f32(values, vdupq_n_f32(0.5f)));
+}
+
+static void storeU8NEON(const float *src, int count, uint8_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x4_t lo = vmovn_u32(roundClampNEON(vld1q_f32(src + i), 255.0f));
+        uint16x4_t hi = vmovn_u32(roundClampNEON(vld1q_f32(src + i + 4), 255.0f));
+        vst1_u8(dst + i, vmovn_u16(vcombine_u16(lo, hi)));
+    }
+    storeU8Scalar(src + i, count - i, dst + i);
+}
+
+static void storeU16NEON(const float *src, int count, uint16_t *dst)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1_u16(dst + i, vmovn_u32(roundClampNEON(vld1q_f32(src + i), 65535.0f)));
+    }
+    storeU16Scalar(src + i, count - i, dst + i);
+}
+
+#endif // RESAMPLING_NEON
+
+static Kernels selectKernels()
+{
+#ifdef RESAMPLING_X86
+    if (cpuSupportsAVX2())
+    {
+        return {"AVX2",
+                horizontal4AVX2,
+                horizontal1AVX2,
+                verticalAVX2,
+                loadU8AVX2,
+                loadU16AVX2,
+                widenRGB8SSE,
+                storeU8AVX2,
+                storeU16AVX2};
+    }
+    if (cpuSupportsSSE41())
+    {
+        return {"SSE4.1",
+                horizontal4SSE,
+                horizontal1SSE,
+                verticalSSE,
+                loadU8SSE,
+                loadU16SSE,
+                widenRGB8SSE,
+                storeU8SSE,
+                storeU16SSE};
+    }
+#endif
+#ifdef RESAMPLING_NEON
+    return {"NEON",
+            horizontal4NEON,
+            horizontal1NEON,
+            verticalNEON,
+            loadU8NEON,
+            loadU16NEON,
+            widenRGB8NEON,
+            storeU8NEON,
+            storeU16NEON};
+#else
+    return {"scalar",
+            horizontal4Scalar,
+            horizontal1Scalar,
+            verticalScalar,
+            loadU8Scalar,
+            loadU16Scalar,
+            widenRGB8Scalar,
+            storeU8Scalar,
+            storeU16Scalar};
+#endif
+}
+
+static const Kernels &kernels()
+{
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+const char *kernelName()
+{
+    return kernels().name;
+}
+
+// ==================================
+// Row Conversion
+// ==================================
+// Rows are `lanes` floats per pixel: 1 for single-channel images, otherwise 4 (unused lanes are 0)
+// Channel counts 2 and 3 go through fixed-count loops so the compiler can unroll them
+
+template <int Channels, typename T> static void widenRow(const T *src, int width, float *dst)
+{
+    for (int x = 0; x < width; x++)
+    {
+        const T *s = src + static_cast<size_t>(x) * Channels;
+        float *d = dst + static_cast<size_t>(x) * 4;
+        for (int c = 0; c < 4; c++)
+        {
+            d[c] = c < Channels ? static_cast<float>(s[c]) : 0.0f;
+        }
+    }
+}
+
+template <int Channels, typename T, typename Convert>
+static void narrowRow(const float *src, int width, T *dst, Convert convert)
+{
+    for (int x = 0; x < width; x++)
+    {
+        const float *s = src + static_cast<size_t>(x) * 4;
+        T *d = dst + static_cast<size_t>(x) * Channels;
+        for (int c = 0; c < Channels; c++)
+        {
+            d[c] = convert(s[c]);
+        }
+    }
+}
+
+static void copyFloats(const float *src, int count, float *dst)
+{
+    std::memcpy(dst, src, sizeof(float) * count);
+}
+
+static float identity(float value)
+{
+    return value;
+}
+
+template <typename T>
+static void loadRow(const T *src, int width, int channels, void (*contiguous)(const T *, int, float *), float *dst)
+{
+    switch (channels)
+    {
+    case 2:
+        widenRow<2>(src, width, dst);
+        break;
+    case 3:
+        widenRow<3>(src, width, dst);
+        break;
+    default:
+        contiguous(src, width * channels, dst);
+        break;
+    }
+}
+
+template <typename T, typename Convert>
+static void storeRow(const float *src,
+                     int width,
+                     int channels,
+                     void (*contiguous)(const float *, int, T *),
+                     Convert convert,
+                     T *dst)
+{
+    switch (channels)
+    {
+    case 2:
+        narrowRow<2>(src, width, dst, convert);
+        break;
+    case 3:
+        narrowRow<3>(src, width, dst, convert);
+        break;
+    default:
+        contiguous(src, width * channels, dst);
+        break;
+    }
+}
+
+static void loadRow(const uint8_t *src, int width, int channels, float *dst)
+{
+    if (channels == 3)
+    {
+        kernels().widenRGB8(src, width, dst);
+        return;
+    }
+    loadRow(src, width, channels, kernels().loadU8, dst);
+}
+
+static void loadRow(const uint16_t *src, int width, int channels, float *dst)
+{
+    loadRow(src, width, channels, kernels().loadU16, dst);
+}
+
+static void loadRow(const float *src, int width, int channels, float *dst)
+{
+    loadRow(src, width, channels, copyFloats, dst);
+}
+
+static void storeRow(const float *src, int width, int channels, uint8_t *dst)
+{
+    storeRow(src, width, channels, kernels().storeU8, toU8, dst);
+}
+
+static void storeRow(const float *src, int width, int channels, uint16_t *dst)
+{
+    storeRow(src, width, channels, kernels().storeU16, toU16, dst);
+}
+
+static void storeRow(const float *src, int width, int channels, float *dst)
+{
+    storeRow(src, width, channels, copyFloats, identity, dst);
+}
+
+// ==================================
+// Separable Resize
+// ==================================
+
+template <typename T>
+static void resizeRows(const T *src,
+                       int srcW,
+                       T *dst,
+                       int dstW,
+                       int channels,
+                       const Axis &horizontal,
+                       const Axis &vertical,
+                       int rowBegin,
+                       int rowEnd)
+{
+    const Kernels &k = kernels();
+    const int lanes = (channels == 1) ? 1 : 4;
+    const size_t filteredRowFloats = static_cast<size_t>(dstW) * lanes;
+    const int taps = vertical.taps;
+
+    // Horizontally filtered source rows; source row r lives in slot r % taps, which keeps
+    // the rows of one output row's window in distinct slots as the window slides down
+    std::vector<float> sourceRow(static_cast<size_t>(srcW) * lanes);
+    std::vector<float> ring(filteredRowFloats * taps);
+    std::vector<int> ringSourceRow(taps, -1);
+    std::vector<const float *> rows(taps);
+    std::vector<float> outputRow(filteredRowFloats);
+
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const int firstRow = vertical.first[y];
+        for (int t = 0; t < taps; t++)
+        {
+            const int sourceY = firstRow + t;
+            const int slot = sourceY % taps;
+            float *filtered = &ring[static_cast<size_t>(slot) * filteredRowFloats];
+            if (ringSourceRow[slot] != sourceY)
+            {
+                loadRow(src + static_cast<size_t>(sourceY) * srcW * channels, srcW, channels, sourceRow.data());
+                if (lanes == 4)
+                {
+                    k.horizontal4(sourceRow.data(),
+                                  dstW,
+                                  horizontal.taps,
+                                  horizontal.first.data(),
+                                  horizontal.weights.data(),
+                                  filtered);
+                }
+                else
+                {
+                    k.horizontal1(sourceRow.data(),
+                                  dstW,
+                                  horizontal.taps,
+                                  horizontal.first.data(),
+                                  horizontal.weights.data(),
+                                  filtered);
+                }
+                ringSourceRow[slot] = sourceY;
+            }
+            rows[t] = filtered;
+        }
+
+        k.vertical(rows.data(),
+                   &vertical.weights[static_cast<size_t>(y) * taps],
+                   taps,
+                   static_cast<int>(filteredRowFloats),
+                   outputRow.data());
+        storeRow(outputRow.data(), dstW, channels, dst + static_cast<size_t>(y) * dstW * channels);
+    }
+}
+
+template <typename T>
+static void resizeImage(const T *src,
+                        int srcW,
+                        int srcH,
+                        T *dst,
+                        int dstW,
+                        int dstH,
+                        int channels,
+                        Filter filter,
+                        bool parallel)
+{
+    if (!src || !dst || srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0 || channels < 1 || channels > 4)
+    {
+        return;
+    }
+
+    const Axis horizontal = buildAxis(srcW, dstW, filter);
+    const Axis vertical = buildAxis(srcH, dstH, filter);
+
+    // Contiguous bands of output rows per thread, so each thread's ring buffer is reused
+    ParallelRows::forEachRowBand(dstH, 16, parallel, [&](int rowBegin, int rowEnd) {
+        resizeRows(src, srcW, dst, dstW, channels, horizontal, vertical, rowBegin, rowEnd);
+    });
+}
+
+void resize(const uint8_t *src,
+            int srcW,
+            int srcH,
+            uint8_t *dst,
+            int dstW,
+            int dstH,
+            int channels,
+            Filter filter,
+            bool parallel)
+{
+    resizeImage(src, srcW, srcH, dst, dstW, dstH, channels, filter, parallel);
+}
+
+void resize(const uint16_t *src,
+            int srcW,
+            int srcH,
+            uint16_t *dst,
+            int dstW,
+            int dstH,
+            int channels,
+            Filter filter,
+            bool parallel)
+{
+    resizeImage(src, srcW, srcH, dst, dstW, dstH, channels, filter, parallel);
+}
+
+void resize(const float *src,
+            int srcW,
+            int srcH,
+            float *dst,
+            int dstW,
+            int dstH,
+            int channels,
+            Filter filter,
+            bool parallel)
+{
+    resizeImage(src, srcW, srcH, dst, dstW, dstH, channels, filter, parallel);
+}
+
+} // namespace Resampling
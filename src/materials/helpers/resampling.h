@@ -0,0 +1,65 @@
+#pragma once
+
+// ============================================================================
+// Image Resampling
+// ============================================================================
+// Shared resizer for every preprocessor. Separable, with precomputed weights:
+// each source row is filtered horizontally once, then every output row is blended
+// vertically from the filtered rows it needs (kept in a small ring buffer).
+//
+// When downsampling, the filter is widened by the reduction factor, so every source
+// pixel contributes to the result (no aliasing when reducing 16K / 32K sources).
+// Edges are clamped. Pixels are interleaved with 1-4 channels.
+//
+// The inner loops use AVX2+FMA or SSE4.1 (picked at runtime) on x86, NEON on ARM64,
+// and plain C++ elsewhere. Work is split across hardware threads by output rows.
+
+#include <cstdint>
+
+namespace Resampling
+{
+
+enum class Filter
+{
+    Box,      // Area average (support 0.5); nearest neighbour when upsampling
+    Bilinear, // Triangle (support 1)
+    Lanczos3  // Windowed sinc (support 3); sharpest for large reductions, may ring on hard edges
+};
+
+// Resize src (srcW x srcH) into dst (dstW x dstH); both have the same number of channels (1-4)
+// Integer results are rounded and clamped; float results are not clamped
+// parallel: split output rows across hardware threads
+void resize(const uint8_t *src,
+            int srcW,
+            int srcH,
+            uint8_t *dst,
+            int dstW,
+            int dstH,
+            int channels,
+            Filter filter = Filter::Bilinear,
+            bool parallel = true);
+
+void resize(const uint16_t *src,
+            int srcW,
+            int srcH,
+            uint16_t *dst,
+            int dstW,
+            int dstH,
+            int channels,
+            Filter filter = Filter::Bilinear,
+            bool parallel = true);
+
+void resize(const float *src,
+            int srcW,
+            int srcH,
+            float *dst,
+            int dstW,
+            int dstH,
+            int channels,
+            Filter filter = Filter::Bilinear,
+            bool parallel = true);
+
+// Instruction set used by the inner loops ("AVX2", "SSE4.1", "NEON" or "scalar"), for log output
+const char *kernelName();
+
+} // namespace Resampling
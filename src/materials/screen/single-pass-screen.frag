@@ -27,6 +27,58 @@ layout(set = 0, binding = 6) uniform samplerCube earthNightlightsTexture; // Cit
 layout(set = 0, binding = 7) uniform samplerCube earthSpecularTexture;    // Specular/roughness
 layout(set = 0, binding = 8) uniform samplerCube earthHeightmapTexture;   // Heightmap for parallax/displacement
 
+// ==================================
+// Earth Virtual Textures (Streamed Pages)
+// ==================================
+// At High/Ultra resolution the Earth textures are streamed as pages (see virtual-texture.h).
+// Each texture has a page cache (2D array, one page per layer) and a slice of the page table
+// that maps (level, face, page) to a cache layer. Pages that were wanted but not resident
+// are flagged in the feedback bitset; the CPU loads them and updates the table.
+// enabled == 0 means the cubemaps above hold the whole textures instead.
+const uint VT_COLOR = 0u;
+const uint VT_NORMAL = 1u;
+const uint VT_NIGHTLIGHTS = 2u;
+const uint VT_SPECULAR = 3u;
+const uint VT_HEIGHTMAP = 4u;
+const uint VT_TEXTURE_COUNT = 5u;
+const uint VT_MAX_LEVELS = 16u;
+const float VT_PAGE_PAYLOAD = 128.0; // Level texels covered by one page
+const float VT_PAGE_BORDER = 4.0;    // Filter border around the payload
+const float VT_PAGE_SIZE = 136.0;    // Stored texels per page side
+
+struct VirtualTextureInfo
+{
+    uint pageBase; // First entry of this texture in entries[] / requested[]
+    uint levelCount;
+    uint faceSize;
+    uint _padding;
+    uint levelFirstPage[VT_MAX_LEVELS];
+    uint levelPagesPerSide[VT_MAX_LEVELS];
+};
+
+layout(std430, set = 0, binding = 10) readonly buffer VirtualTexturePageTable
+{
+    uint enabled;
+    uint totalPages;
+    uint _padding0;
+    uint _padding1;
+    VirtualTextureInfo textures[VT_TEXTURE_COUNT];
+    uint entries[]; // Cache layer + 1, 0 = not resident
+}
+pageTable;
+
+layout(std430, set = 0, binding = 11) buffer VirtualTextureFeedback
+{
+    uint requested[]; // One bit per page (pageBase + page index), cleared by the CPU after reading
+}
+pageFeedback;
+
+layout(set = 0, binding = 12) uniform sampler2DArray vtColorPages;
+layout(set = 0, binding = 13) uniform sampler2DArray vtNormalPages;
+layout(set = 0, binding = 14) uniform sampler2DArray vtNightlightsPages;
+layout(set = 0, binding = 15) uniform sampler2DArray vtSpecularPages;
+layout(set = 0, binding = 16) uniform sampler2DArray vtHeightmapPages;
+
 // Earth NAIF ID constant
 const int NAIF_EARTH = 399;
 
@@ -121,6 +173,145 @@ const float MAX_DIST = 100000.0;
 const float SURF_DIST = 0.00001; // Surface hit threshold (slightly larger for stability)
 const float MIN_STEP = 0.00001;  // Minimum step to prevent infinite loops
 
+// ==================================
+// Texture LOD
+// ==================================
+// Angle covered by one pixel (radians), set at the top of main() where derivatives are valid.
+// Ray-marched hits have no usable implicit derivatives, so Earth mip levels come from this footprint.
+float g_pixelAngle = 0.0;
+
+// Cubemap face (+X -X +Y -Y +Z -Z) and 0..1 face coordinates of a direction, using the same
+// major axis rules as hardware cubemap sampling so pages line up with the cubemap faces
+void cubeDirToFaceUV(vec3 dir, out uint face, out vec2 uv)
+{
+    vec3 a = abs(dir);
+    float majorAxis;
+    vec2 sc;
+    if (a.x >= a.y && a.x >= a.z)
+    {
+        face = dir.x >= 0.0 ? 0u : 1u;
+        majorAxis = a.x;
+        sc = vec2(dir.x >= 0.0 ? -dir.z : dir.z, -dir.y);
+    }
+    else if (a.y >= a.z)
+    {
+        face = dir.y >= 0.0 ? 2u : 3u;
+        majorAxis = a.y;
+        sc = vec2(dir.x, dir.y >= 0.0 ? dir.z : -dir.z);
+    }
+    else
+    {
+        face = dir.z >= 0.0 ? 4u : 5u;
+        majorAxis = a.z;
+        sc = vec2(dir.z >= 0.0 ? dir.x : -dir.x, -dir.y);
+    }
+    uv = clamp(sc / majorAxis * 0.5 + 0.5, 0.0, 1.0);
+}
+
+// Page caches are separate bindings; a switch keeps the sampler index dynamically uniform
+vec4 samplePageCache(uint tex, vec3 uvLayer)
+{
+    switch (tex)
+    {
+    case VT_COLOR:
+        return textureLod(vtColorPages, uvLayer, 0.0);
+    case VT_NORMAL:
+        return textureLod(vtNormalPages, uvLayer, 0.0);
+    case VT_NIGHTLIGHTS:
+        return textureLod(vtNightlightsPages, uvLayer, 0.0);
+    case VT_SPECULAR:
+        return textureLod(vtSpecularPages, uvLayer, 0.0);
+    default:
+        return textureLod(vtHeightmapPages, uvLayer, 0.0);
+    }
+}
+
+// Sample a streamed Earth texture at level floor(lod), or the finest resident level above it
+// requestPages: flag the page at floor(lod) in the feedback buffer so the CPU streams it in
+vec4 sampleVirtualTexture(uint tex, vec3 dir, float lod, bool requestPages)
+{
+    uint face;
+    vec2 uv;
+    cubeDirToFaceUV(dir, face, uv);
+
+    uint pageBase = pageTable.textures[tex].pageBase;
+    uint levelCount = pageTable.textures[tex].levelCount;
+    uint faceSize = pageTable.textures[tex].faceSize;
+    uint wantedLevel = min(uint(max(lod, 0.0)), levelCount - 1u);
+
+    for (uint level = wantedLevel; level < levelCount; level++)
+    {
+        float levelSize = float(max(faceSize >> level, 1u));
+        uint pagesPerSide = pageTable.textures[tex].levelPagesPerSide[level];
+        vec2 texel = uv * levelSize;
+        uvec2 page = min(uvec2(texel / VT_PAGE_PAYLOAD), uvec2(pagesPerSide - 1u));
+        uint index = pageBase + pageTable.textures[tex].levelFirstPage[level] +
+                     (face * pagesPerSide + page.y) * pagesPerSide + page.x;
+
+        // Read first: most pixels find their bit already set, and plain loads are cheaper than atomics
+        if (requestPages && level == wantedLevel)
+        {
+            uint mask = 1u << (index & 31u);
+            if ((pageFeedback.requested[index >> 5u] & mask) == 0u)
+            {
+                atomicOr(pageFeedback.requested[index >> 5u], mask);
+            }
+        }
+
+        uint entry = pageTable.entries[index];
+        if (entry != 0u)
+        {
+            vec2 pageUV = (texel - vec2(page) * VT_PAGE_PAYLOAD + VT_PAGE_BORDER) / VT_PAGE_SIZE;
+            return samplePageCache(tex, vec3(pageUV, float(entry - 1u)));
+        }
+    }
+    return vec4(0.0); // Unreachable once the pinned top level is resident
+}
+
+// Earth texture lookup at an explicit LOD: streamed pages when enabled, whole cubemaps otherwise
+vec4 sampleEarthTexture(uint tex, vec3 dir, float lod, bool requestPages)
+{
+    if (pageTable.enabled != 0u)
+    {
+        return sampleVirtualTexture(tex, dir, lod, requestPages);
+    }
+    switch (tex)
+    {
+    case VT_COLOR:
+        return textureLod(earthColorTexture, dir, lod);
+    case VT_NORMAL:
+        return textureLod(earthNormalTexture, dir, lod);
+    case VT_NIGHTLIGHTS:
+        return textureLod(earthNightlightsTexture, dir, lod);
+    case VT_SPECULAR:
+        return textureLod(earthSpecularTexture, dir, lod);
+    default:
+        return textureLod(earthHeightmapTexture, dir, lod);
+    }
+}
+
+// Level 0 face size of an Earth texture
+float earthTextureFaceSize(uint tex)
+{
+    if (pageTable.enabled != 0u)
+    {
+        return float(pageTable.textures[tex].faceSize);
+    }
+    switch (tex)
+    {
+    case VT_COLOR:
+        return float(textureSize(earthColorTexture, 0).x);
+    case VT_NORMAL:
+        return float(textureSize(earthNormalTexture, 0).x);
+    case VT_NIGHTLIGHTS:
+        return float(textureSize(earthNightlightsTexture, 0).x);
+    case VT_SPECULAR:
+        return float(textureSize(earthSpecularTexture, 0).x);
+    default:
+        return float(textureSize(earthHeightmapTexture, 0).x);
+    }
+}
+
 // ==================================
 // Procedural Noise for Detail
 // ==================================
@@ -222,7 +413,7 @@ float sdEarthWithHeightmap(vec3 p, vec3 center, float radius, vec3 poleDir, vec3
 
     // Sample heightmap (combined landmass + bathymetry)
     // 0.0 = Mariana Trench, SEA_LEVEL_NORMALIZED = sea level, 1.0 = Everest
-    float heightSample = textureLod(earthHeightmapTexture, cubemapDir, 0.0).r;
+    float heightSample = sampleEarthTexture(VT_HEIGHTMAP, cubemapDir, 0.0, false).r;
 
     // === PROCEDURAL DETAIL NOISE ===
     // Add multi-octave noise to break up quantization artifacts
@@ -467,8 +658,8 @@ const int NAIF_SUN = 10;                      // Sun NAIF ID
 // 0.0 = Mariana Trench, SEA_LEVEL_NORMALIZED = sea level, 1.0 = Everest
 float sampleHeight(vec3 cubemapDir)
 {
-    // Use textureLod with LOD 0 - ray marching breaks automatic mipmap selection
-    return textureLod(earthHeightmapTexture, cubemapDir, 0.0).r;
+    // Use LOD 0 - ray marching breaks automatic mipmap selection
+    return sampleEarthTexture(VT_HEIGHTMAP, cubemapDir, 0.0, false).r;
 }
 
 // Get signed displacement from sea level based on heightmap
@@ -583,6 +774,15 @@ mat3 buildBodyFrame(vec3 poleDir, vec3 primeMeridianDir)
 // Uses SPICE-derived pole and prime meridian from SSBO
 // Applies parallax occlusion mapping based on actual heightmap values
 
+// Mip level for an Earth cubemap sampled at hitDistance from the camera
+// One pixel covers hitDistance * g_pixelAngle of surface; one texel covers a 90 degree face / faceSize
+float earthTextureLod(uint tex, float hitDistance, float earthRadius)
+{
+    float texelWorldSize = 1.5707963 * earthRadius / earthTextureFaceSize(tex);
+    float pixelWorldSize = hitDistance * g_pixelAngle;
+    return max(log2(pixelWorldSize / texelWorldSize), 0.0);
+}
+
 // Sample Earth material and compute final color
 // hitPoint: actual hit position on displaced terrain
 // earthCenter: center of Earth
@@ -630,9 +830,12 @@ vec3 sampleEarthMaterial(vec3 hitPoint,
     vec3 bodyDir = transpose(bodyFrame) * radialDir;
     vec3 baseCubemapDir = vec3(bodyDir.x, bodyDir.z, -bodyDir.y);
 
-    // Sample height at current location (LOD 0 for ray marching)
+    // Sample height at current location at the pixel footprint LOD
+    // (this is also the lookup that streams in the heightmap pages the SDF reads at LOD 0)
     // Heightmap: 0.0 = Mariana, SEA_LEVEL_NORMALIZED = sea level, 1.0 = Everest
-    float heightSample = textureLod(earthHeightmapTexture, baseCubemapDir, 0.0).r;
+    float hitDistance = length(pc.cameraPosition - hitPoint);
+    float heightLod = earthTextureLod(VT_HEIGHTMAP, hitDistance, earthRadius);
+    float heightSample = sampleEarthTexture(VT_HEIGHTMAP, baseCubemapDir, heightLod, true).r;
 
     // Parallax offset calculation:
     // - Higher terrain (above sea level) needs positive offset
@@ -661,20 +864,23 @@ vec3 sampleEarthMaterial(vec3 hitPoint,
     vec3 cubemapDir = vec3(parallaxBodyDir.x, parallaxBodyDir.z, -parallaxBodyDir.y);
 
     // Sample base color texture with parallax-corrected coordinates
-    // Use textureLod LOD 0 - ray marching breaks automatic mipmap selection
-    vec3 baseColor = textureLod(earthColorTexture, cubemapDir, 0.0).rgb;
+    // Ray marching breaks automatic mipmap selection, so the LOD comes from the pixel footprint
+    float colorLod = earthTextureLod(VT_COLOR, hitDistance, earthRadius);
+    vec3 baseColor = sampleEarthTexture(VT_COLOR, cubemapDir, colorLod, true).rgb;
 
-    // Sample and decode normal map with parallax-corrected coordinates
-    vec3 normalSample = textureLod(earthNormalTexture, cubemapDir, 0.0).rgb;
+    // Sample and decode normal map with parallax-corrected coordinates (XY only, BC5 has no Z)
+    float normalLod = earthTextureLod(VT_NORMAL, hitDistance, earthRadius);
+    vec2 normalSample = sampleEarthTexture(VT_NORMAL, cubemapDir, normalLod, true).rg;
 
     // Start with terrain normal from SDF gradient (captures heightmap shape)
     vec3 worldNormal = terrainNormal;
 
     // Blend in normal map details for micro-surface detail
-    if (normalSample.r > 0.001 || normalSample.g > 0.001 || normalSample.b > 0.001)
+    if (normalSample.r > 0.001 || normalSample.g > 0.001)
     {
-        // Decode tangent-space normal from texture (stored as 0-1, convert to -1 to 1)
-        vec3 tangentNormal = normalSample * 2.0 - 1.0;
+        // Decode tangent-space normal from texture (stored as 0-1, convert to -1 to 1) and rebuild Z
+        vec2 normalXY = normalSample * 2.0 - 1.0;
+        vec3 tangentNormal = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
         // Transform to world space using the TBN at the hit point
         vec3 mapNormal = normalize(TBN * tangentNormal);
         // Blend terrain normal with normal map for combined detail
@@ -698,13 +904,15 @@ vec3 sampleEarthMaterial(vec3 hitPoint,
 
     // === Specular Lighting (Blinn-Phong) ===
     // Reduced reflectiveness for more realistic Earth appearance
-    float specularMask = textureLod(earthSpecularTexture, cubemapDir, 0.0).r;
+    float specularLod = earthTextureLod(VT_SPECULAR, hitDistance, earthRadius);
+    float specularMask = sampleEarthTexture(VT_SPECULAR, cubemapDir, specularLod, true).r;
     vec3 halfDir = normalize(toSun + viewDir);
     float specNdotH = max(dot(worldNormal, halfDir), 0.0);
     float specular = pow(specNdotH, 128.0) * specularMask * 0.3; // Tight highlights, reduced intensity
 
     // === Night Lights ===
-    float nightlights = textureLod(earthNightlightsTexture, cubemapDir, 0.0).r;
+    float nightlightsLod = earthTextureLod(VT_NIGHTLIGHTS, hitDistance, earthRadius);
+    float nightlights = sampleEarthTexture(VT_NIGHTLIGHTS, cubemapDir, nightlightsLod, true).r;
     vec3 nightlightColor = vec3(1.0, 0.9, 0.7) * nightlights * 3.0; // Warm city lights
 
     // === Combine Lighting ===
@@ -737,11 +945,16 @@ void main()
     vec3 ro = pc.cameraPosition;
     vec3 rd = getRayDirection(fragUV, pc.fov, aspect);
 
+    // Derivatives are only valid here, before any per-pixel branching
+    g_pixelAngle = radians(pc.fov) * fwidth(fragUV.y);
+    vec3 rdDx = dFdx(rd);
+    vec3 rdDy = dFdy(rd);
+
     // Early out if no objects to render - just show skybox
     if (celestialData.objectCount == 0u)
     {
         // Native cubemap sampling with HDR exposure
-        vec3 skyColor = texture(skyboxCubemap, rd).rgb * SKYBOX_EXPOSURE;
+        vec3 skyColor = textureGrad(skyboxCubemap, rd, rdDx, rdDy).rgb * SKYBOX_EXPOSURE;
         fragColor = vec4(skyColor, 1.0);
         gl_FragDepth = 1.0;
         return;
@@ -845,7 +1058,7 @@ void main()
     else
     {
         // Ray miss: sample skybox using native cubemap with HDR exposure
-        color = texture(skyboxCubemap, rd).rgb * SKYBOX_EXPOSURE;
+        color = textureGrad(skyboxCubemap, rd, rdDx, rdDy).rgb * SKYBOX_EXPOSURE;
         depth = 1.0;
     }
 